@@ -0,0 +1,101 @@
+//! Criterion benchmarks over the generated FFI bindings.
+//!
+//! Usage:
+//!   cargo bench
+//!
+//! Covers the full inference path (ei_ffi_signal_from_buffer +
+//! ei_ffi_run_classifier) and micro-benches marshalling an
+//! ei_impulse_result_t into Rust types. Inputs are a deterministic ramp
+//! sized from model_metadata.rs, so numbers stay comparable across model
+//! updates as long as the input geometry is unchanged.
+
+use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use edge_impulse_ffi_rs::bindings::*;
+use edge_impulse_ffi_rs::model_metadata::*;
+use std::ffi::CStr;
+
+/// Synthetic input: the same deterministic ramp the ffi_benchmark example
+/// uses, sized from the model's raw sample geometry.
+fn synthetic_features() -> Vec<f32> {
+    let sample_count = EI_CLASSIFIER_RAW_SAMPLE_COUNT as usize
+        * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME as usize;
+    (0..sample_count)
+        .map(|i| ((i % 256) as f32) - 128.0)
+        .collect()
+}
+
+/// Marshal the classification entries of a populated result into owned
+/// Rust pairs, the way a typical caller lifts the C struct across the
+/// boundary.
+fn marshal_result(result: &ei_impulse_result_t) -> Vec<(String, f32)> {
+    let mut out = Vec::with_capacity(EI_CLASSIFIER_LABEL_COUNT as usize);
+    for classification in result
+        .classification
+        .iter()
+        .take(EI_CLASSIFIER_LABEL_COUNT as usize)
+    {
+        if classification.label.is_null() {
+            continue;
+        }
+        let label = unsafe { CStr::from_ptr(classification.label) }
+            .to_string_lossy()
+            .into_owned();
+        out.push((label, classification.value));
+    }
+    out
+}
+
+fn bench_inference(c: &mut Criterion) {
+    let features = synthetic_features();
+
+    unsafe {
+        ei_ffi_run_classifier_init();
+    }
+
+    let mut signal = ei_signal_t::default();
+    let rc = unsafe { ei_ffi_signal_from_buffer(features.as_ptr(), features.len(), &mut signal) };
+    assert_eq!(rc, EI_IMPULSE_ERROR::EI_IMPULSE_OK, "signal setup failed");
+
+    let mut result = ei_impulse_result_t::default();
+
+    // Absorb first-run costs (arena allocation, delegate weight packing)
+    // before criterion starts sampling.
+    let rc = unsafe { ei_ffi_run_classifier(&mut signal, &mut result, 0) };
+    assert_eq!(rc, EI_IMPULSE_ERROR::EI_IMPULSE_OK, "warm-up inference failed");
+
+    c.bench_function("signal_from_buffer", |b| {
+        b.iter(|| {
+            let mut s = ei_signal_t::default();
+            let rc = unsafe {
+                ei_ffi_signal_from_buffer(
+                    black_box(features.as_ptr()),
+                    features.len(),
+                    &mut s,
+                )
+            };
+            assert_eq!(rc, EI_IMPULSE_ERROR::EI_IMPULSE_OK);
+            black_box(s)
+        })
+    });
+
+    c.bench_function("run_classifier", |b| {
+        b.iter(|| {
+            let rc = unsafe {
+                ei_ffi_run_classifier(black_box(&mut signal), &mut result, 0)
+            };
+            assert_eq!(rc, EI_IMPULSE_ERROR::EI_IMPULSE_OK);
+            black_box(&result)
+        })
+    });
+
+    c.bench_function("marshal_result", |b| {
+        b.iter(|| black_box(marshal_result(black_box(&result))))
+    });
+
+    unsafe {
+        ei_ffi_run_classifier_deinit();
+    }
+}
+
+criterion_group!(benches, bench_inference);
+criterion_main!(benches);
@@ -49,10 +49,107 @@ struct JobStatus {
     finished_successful: Option<bool>,
 }
 
+#[derive(Debug, Deserialize)]
+struct DeploymentInfoResponse {
+    success: bool,
+    #[serde(rename = "hasDeployment")]
+    has_deployment: Option<bool>,
+    version: Option<i32>,
+}
+
+/// Directory for cached deployment zips. Configurable via EI_MODEL_CACHE_DIR
+/// so CI can persist it between runs; defaults to .ei-model-cache in the
+/// crate root.
+fn model_cache_dir() -> PathBuf {
+    match env::var("EI_MODEL_CACHE_DIR") {
+        Ok(dir) => PathBuf::from(dir),
+        Err(_) => {
+            let manifest_dir = env::var("CARGO_MANIFEST_DIR").unwrap_or_else(|_| ".".to_string());
+            Path::new(&manifest_dir).join(".ei-model-cache")
+        }
+    }
+}
+
+/// Cache key: project + impulse + engine + deployment version uniquely
+/// identify a built model zip.
+fn model_cache_path(project_id: &str, impulse_id: i32, engine: &str, version: i32) -> PathBuf {
+    model_cache_dir().join(format!(
+        "{}-impulse{}-{}-v{}.zip",
+        project_id, impulse_id, engine, version
+    ))
+}
+
+/// Ask the studio which deployment version (if any) it currently holds for
+/// this impulse + engine. Returns None when there is no deployment or the
+/// request fails; callers fall back to a fresh build in that case.
+fn get_deployment_version(
+    base_url: &str,
+    project_id: &str,
+    api_key: &str,
+    impulse_id: i32,
+    engine: &str,
+) -> Option<i32> {
+    let info_url = format!(
+        "{}/{}/deployment?type=zip&impulse={}&engine={}",
+        base_url, project_id, impulse_id, engine
+    );
+    let info: DeploymentInfoResponse = match ureq::get(&info_url).set("x-api-key", api_key).call() {
+        Ok(response) if response.status() == 200 => response.into_json().ok()?,
+        _ => return None,
+    };
+    if !info.success || info.has_deployment != Some(true) {
+        return None;
+    }
+    info.version
+}
+
 /// Copy FFI glue files from ffi_glue/ to the selected model folder (e.g., cpp/ or cpp2/)
 fn copy_ffi_glue(model_dir: &str) {
     let files = [
+        "asset_blob_support.cpp",
         "edge_impulse_c_api.cpp",
+        "edge_impulse_async.cpp",
+        "dsp_arena_support.cpp",
+        "dsp_parallel_support.cpp",
+        "edge_impulse_http_server.cpp",
+        "ethos_u_support.cpp",
+        "gpu_delegate_support.cpp",
+        "xnnpack_cache_support.cpp",
+        "build_arena_support.cpp",
+        "cold_text_support.cpp",
+        "cold_text.ld",
+        "fp16_support.cpp",
+        "int16_mfe_support.cpp",
+        "infer_daemon.cpp",
+        "infer_client.cpp",
+        "eim_compat.cpp",
+        "aggregator_support.cpp",
+        "frame_delta_support.cpp",
+        "audio_ring_support.cpp",
+        "capture_support.cpp",
+        "cuda_pinned_support.cpp",
+        "dmabuf_support.cpp",
+        "ladder_support.cpp",
+        "model_delta_support.cpp",
+        "perf_counters_support.cpp",
+        "power_hint_support.cpp",
+        "python_bridge.cpp",
+        "result_cache_support.cpp",
+        "shm_results_support.cpp",
+        "stats_ring_support.cpp",
+        "stress_test.cpp",
+        "calibrate_tool.cpp",
+        "edge_impulse_kernels.cpp",
+        "edge_impulse_pipeline.cpp",
+        "edge_impulse_scheduler.cpp",
+        "lean_op_resolver.cpp",
+        "log_support.cpp",
+        "abi_version_support.cpp",
+        "error_detail_support.cpp",
+        "latency_trace_support.cpp",
+        "object_tracker_support.cpp",
+        "spectral_cache_support.cpp",
+        "tflite_profiler_support.cpp",
         "edge_impulse_wrapper.h",
         "CMakeLists.txt",
         "tflite_detection_postprocess_wrapper.cc",
@@ -61,9 +158,380 @@ fn copy_ffi_glue(model_dir: &str) {
         let src = format!("ffi_glue/{}", file);
         let dst = format!("{}/{}", model_dir, file);
         if std::path::Path::new(&src).exists() {
-            fs::copy(&src, &dst).unwrap_or_else(|_| panic!("Failed to copy {} to {}", src, dst));
+            // Skip identical copies so mtimes stay stable and incremental
+            // native builds don't recompile unchanged glue.
+            let src_bytes =
+                fs::read(&src).unwrap_or_else(|_| panic!("Failed to read {}", src));
+            if fs::read(&dst).map(|d| d == src_bytes).unwrap_or(false) {
+                continue;
+            }
+            fs::write(&dst, &src_bytes)
+                .unwrap_or_else(|_| panic!("Failed to copy {} to {}", src, dst));
+        }
+    }
+}
+
+/// Consolidate auxiliary model-folder data files (anomaly cluster data,
+/// tracker configs, ...) into one blob plus a generated offset index, so
+/// classifier initialization never touches stdio. asset_blob_support.cpp
+/// links the blob page-aligned into .rodata with the same .incbin mechanism
+/// INCBIN uses for the model weights, and serves lookups from the index.
+/// Regenerated (write-if-changed) on every build.
+fn generate_asset_index(model_dir: &str) {
+    let data_exts = ["bin", "dat", "json", "txt", "csv", "params", "npy"];
+    // SDK sources and the already-INCBIN'd model graph are not assets.
+    let skip_dirs = ["edge-impulse-sdk", "tflite-model", "build"];
+
+    let root = PathBuf::from(model_dir);
+    let mut assets: Vec<(String, Vec<u8>)> = Vec::new();
+    let mut stack = vec![root.clone()];
+    while let Some(dir) = stack.pop() {
+        let entries = match fs::read_dir(&dir) {
+            Ok(entries) => entries,
+            Err(_) => continue,
+        };
+        for entry in entries.flatten() {
+            let path = entry.path();
+            if path.is_dir() {
+                let name = path.file_name().and_then(|n| n.to_str()).unwrap_or("");
+                if !skip_dirs.contains(&name) {
+                    stack.push(path);
+                }
+            } else if let Some(ext) = path.extension().and_then(|e| e.to_str()) {
+                if data_exts.contains(&ext) {
+                    if let Ok(bytes) = fs::read(&path) {
+                        let rel = path
+                            .strip_prefix(&root)
+                            .unwrap()
+                            .to_string_lossy()
+                            .replace('\\', "/");
+                        assets.push((rel, bytes));
+                    }
+                }
+            }
+        }
+    }
+    // Deterministic blob layout so unchanged assets don't dirty the build.
+    assets.sort_by(|a, b| a.0.cmp(&b.0));
+
+    let blob_path = fs::canonicalize(&root)
+        .unwrap_or_else(|_| root.clone())
+        .join("ei_ffi_assets.blob");
+    let mut blob: Vec<u8> = Vec::new();
+    let mut index = String::from(
+        "// Generated by build.rs -- offset index for the consolidated asset blob.\n\
+         // Do not edit; regenerated on every build.\n\
+         #pragma once\n\n",
+    );
+    index.push_str(&format!("#define EI_FFI_ASSET_COUNT {}\n", assets.len()));
+    index.push_str(&format!(
+        "#define EI_FFI_ASSET_BLOB_PATH \"{}\"\n",
+        blob_path.display()
+    ));
+    if !assets.is_empty() {
+        index.push_str(
+            "\nstatic const struct {\n    const char* name;\n    unsigned long offset;\n    unsigned long size;\n} ei_ffi_asset_index[] = {\n",
+        );
+        for (name, bytes) in &assets {
+            // Records start cache-line aligned inside the page-aligned blob.
+            while blob.len() % 64 != 0 {
+                blob.push(0);
+            }
+            index.push_str(&format!(
+                "    {{ \"{}\", {}UL, {}UL }},\n",
+                name,
+                blob.len(),
+                bytes.len()
+            ));
+            blob.extend_from_slice(bytes);
+        }
+        index.push_str("};\n");
+    }
+
+    for (path, bytes) in [
+        (blob_path, blob),
+        (root.join("ei_ffi_asset_index.h"), index.into_bytes()),
+    ] {
+        if fs::read(&path).map(|d| d == bytes).unwrap_or(false) {
+            continue;
+        }
+        fs::write(&path, &bytes)
+            .unwrap_or_else(|_| panic!("Failed to write {}", path.display()));
+    }
+    println!("cargo:info=Consolidated {} model assets into the linked blob", assets.len());
+}
+
+/// Micro-kernel source files implementing a builtin op, for ops whose kernel
+/// file name is not just the lowercased op name. Ops sharing a kernel file
+/// (pooling, reduce, comparisons, ...) map to the same entry.
+fn micro_kernel_files_for_op(op: &str) -> Vec<&'static str> {
+    match op {
+        "AVERAGE_POOL_2D" | "MAX_POOL_2D" => vec!["pooling.cc"],
+        "CONV_2D" => vec!["conv.cc"],
+        "DEPTHWISE_CONV_2D" => vec!["depthwise_conv.cc"],
+        "RELU" | "RELU6" => vec!["activations.cc"],
+        "MEAN" | "SUM" | "REDUCE_MAX" | "REDUCE_MIN" | "REDUCE_PROD" => vec!["reduce.cc"],
+        "MAXIMUM" | "MINIMUM" => vec!["maximum_minimum.cc"],
+        "LESS" | "LESS_EQUAL" | "GREATER" | "GREATER_EQUAL" | "EQUAL" | "NOT_EQUAL" => {
+            vec!["comparisons.cc"]
+        }
+        "LOGICAL_AND" | "LOGICAL_OR" | "LOGICAL_NOT" => vec!["logical.cc"],
+        "ABS" | "SIN" | "COS" | "LOG" | "SQRT" | "RSQRT" | "SQUARE" => vec!["elementwise.cc"],
+        "ARG_MAX" | "ARG_MIN" => vec!["arg_min_max.cc"],
+        "PADV2" => vec!["pad.cc"],
+        "L2_NORMALIZATION" => vec!["l2norm.cc"],
+        "UNIDIRECTIONAL_SEQUENCE_LSTM" => vec!["unidirectional_sequence_lstm.cc", "lstm_eval.cc"],
+        _ => vec![],
+    }
+}
+
+/// Build model/micro_kernels.cmake from the op census in model_ops.inc: the
+/// list of micro kernel .cc files the graph actually needs. CMake then
+/// compiles only those (plus the shared kernel support files) instead of
+/// every kernel under edge-impulse-sdk/tensorflow. Returns false when no
+/// census exists.
+fn generate_micro_kernel_allowlist(model_dir: &str) -> bool {
+    let census_path = format!("{}/model_ops.inc", model_dir);
+    let census = match fs::read_to_string(&census_path) {
+        Ok(content) => content,
+        Err(_) => return false,
+    };
+
+    let op_re = regex::Regex::new(r"EI_FFI_TFLITE_OP\(\s*([A-Z0-9_]+)").unwrap();
+    let mut kernels: Vec<String> = Vec::new();
+    for caps in op_re.captures_iter(&census) {
+        let op = &caps[1];
+        let files = micro_kernel_files_for_op(op);
+        if files.is_empty() {
+            kernels.push(format!("{}.cc", op.to_lowercase()));
+        } else {
+            for file in files {
+                kernels.push(file.to_string());
+            }
+        }
+    }
+    kernels.sort();
+    kernels.dedup();
+
+    let mut cmake = String::from(
+        "# Generated by build.rs from model_ops.inc -- the micro kernels the\n# model's graph actually uses. Do not edit by hand.\nset(EI_FFI_MICRO_KERNEL_ALLOWLIST\n",
+    );
+    for kernel in &kernels {
+        cmake.push_str(&format!("    \"{}\"\n", kernel));
+    }
+    cmake.push_str(")\n");
+
+    let out_path = format!("{}/micro_kernels.cmake", model_dir);
+    // Skip identical writes so incremental CMake reruns stay quiet.
+    if fs::read_to_string(&out_path).map(|c| c == cmake).unwrap_or(false) {
+        return true;
+    }
+    fs::write(&out_path, cmake).unwrap_or_else(|_| panic!("Failed to write {}", out_path));
+    true
+}
+
+/// Fold the model's DSP block configuration into a constexpr header. The
+/// generated per-model config structs are consulted through pointers at
+/// runtime even though every field is a deployment-time constant; the
+/// generated initializers carry `// field_name` trailing comments, which is
+/// what this parses. The glue includes the header via __has_include, so a
+/// model drop without the recognized fields (or raw-data impulses) just
+/// compiles the generic paths. Returns false when model_variables.h is
+/// missing.
+fn extract_and_write_dsp_constexpr(model_dir: &str) -> bool {
+    let header_path = format!("{}/model-parameters/model_variables.h", model_dir);
+    let header = match fs::read_to_string(&header_path) {
+        Ok(content) => content,
+        Err(_) => return false,
+    };
+
+    // First occurrence wins: multi-block impulses keep their first DSP
+    // block's constants, same as the spectral cache configuration.
+    let fields = [
+        ("frame_length", "kFrameLength", "float"),
+        ("frame_stride", "kFrameStride", "float"),
+        ("num_filters", "kNumFilters", "int"),
+        ("fft_length", "kFftLength", "int"),
+        ("num_cepstral", "kNumCepstral", "int"),
+        ("low_frequency", "kLowFrequency", "int"),
+        ("high_frequency", "kHighFrequency", "int"),
+    ];
+
+    let mut found: Vec<(usize, String)> = Vec::new();
+    for (ix, (field, _, _)) in fields.iter().enumerate() {
+        let re = regex::Regex::new(&format!(
+            r"(?m)^\s*([-0-9.]+)f?,?\s*//.*\b{}\b",
+            field
+        ))
+        .unwrap();
+        if let Some(caps) = re.captures(&header) {
+            found.push((ix, caps[1].to_string()));
         }
     }
+    if found.is_empty() {
+        return false;
+    }
+
+    let mut out = String::from(
+        "// This file is @generated by build.rs. Do not edit manually.\n// DSP block configuration folded to compile-time constants; values come\n// from the first DSP block initializer in model_variables.h.\n#pragma once\n\n#define EI_FFI_DSP_CONSTEXPR 1\n\nnamespace ei_ffi_dsp {\n",
+    );
+    for (ix, value) in &found {
+        let (_, name, ctype) = fields[*ix];
+        let literal = if ctype == "float" && !value.contains('.') {
+            format!("{}.0f", value)
+        } else if ctype == "float" {
+            format!("{}f", value)
+        } else {
+            value.clone()
+        };
+        out.push_str(&format!("constexpr {} {} = {};\n", ctype, name, literal));
+    }
+    out.push_str("} // namespace ei_ffi_dsp\n");
+    if let Some((_, value)) = found.iter().find(|(ix, _)| fields[*ix].0 == "fft_length") {
+        out.push_str(&format!("\n#define EI_FFI_DSP_FFT_LENGTH {}\n", value));
+    }
+
+    let out_path = format!("{}/model-parameters/ei_dsp_constexpr.h", model_dir);
+    // Skip identical writes so incremental native builds stay warm.
+    if fs::read_to_string(&out_path).map(|c| c == out).unwrap_or(false) {
+        return true;
+    }
+    fs::write(&out_path, out).unwrap_or_else(|_| panic!("Failed to write {}", out_path));
+    true
+}
+
+/// Census of the DSP blocks the deployed impulse actually uses, for the
+/// binary diet mode. model_variables.h wires each block up through an
+/// `extract_*_features` function pointer, so the names referenced there
+/// enumerate the used implementations exactly -- everything else is dead
+/// weight the linker can drop. Empty when model_variables.h is missing.
+fn extract_used_dsp_blocks(model_dir: &str) -> Vec<String> {
+    let header_path = format!("{}/model-parameters/model_variables.h", model_dir);
+    let header = match fs::read_to_string(&header_path) {
+        Ok(content) => content,
+        Err(_) => return Vec::new(),
+    };
+    let re = regex::Regex::new(r"extract_([a-z0-9_]+)_features").unwrap();
+    let mut blocks: Vec<String> = re
+        .captures_iter(&header)
+        .map(|caps| caps[1].to_string())
+        .collect();
+    blocks.sort();
+    blocks.dedup();
+    blocks
+}
+
+/// Sequence the postprocessing chain as direct calls. model_variables.h
+/// lists the deployed chain in an ei_postprocessing_block_t array whose
+/// designated initializers name each block's postprocess function; for a
+/// fixed deployment those names are compile-time constants, so the SDK's
+/// walk with its indirect call per block per frame can be replaced by a
+/// generated macro of direct (inlinable) calls. Configs and per-block
+/// state are still read from the block table so live threshold updates
+/// keep working. Returns false -- the generic walk compiles -- when the
+/// array or the recognized initializer style is missing.
+fn extract_and_write_postprocess_chain(model_dir: &str) -> bool {
+    let header_path = format!("{}/model-parameters/model_variables.h", model_dir);
+    let header = match fs::read_to_string(&header_path) {
+        Ok(content) => content,
+        Err(_) => return false,
+    };
+
+    // First postprocessing array wins, matching the default impulse the
+    // glue's postprocess path runs on.
+    let start_re =
+        regex::Regex::new(r"ei_postprocessing_block_t\s+[A-Za-z0-9_]+\s*\[\]\s*=\s*\{").unwrap();
+    let start = match start_re.find(&header) {
+        Some(m) => m.end(),
+        None => return false,
+    };
+    let mut depth = 1usize;
+    let mut end = start;
+    for (ix, ch) in header[start..].char_indices() {
+        match ch {
+            '{' => depth += 1,
+            '}' => {
+                depth -= 1;
+                if depth == 0 {
+                    end = start + ix;
+                    break;
+                }
+            }
+            _ => {}
+        }
+    }
+    if depth != 0 {
+        return false;
+    }
+
+    // Split the body into top-level { ... } entries; positions in the
+    // array are what config/state indices must match.
+    let body = &header[start..end];
+    let mut entries: Vec<String> = Vec::new();
+    let mut entry_start = None;
+    depth = 0;
+    for (ix, ch) in body.char_indices() {
+        match ch {
+            '{' => {
+                if depth == 0 {
+                    entry_start = Some(ix + 1);
+                }
+                depth += 1;
+            }
+            '}' => {
+                depth -= 1;
+                if depth == 0 {
+                    if let Some(s) = entry_start.take() {
+                        entries.push(body[s..ix].to_string());
+                    }
+                }
+            }
+            _ => {}
+        }
+    }
+    if entries.is_empty() {
+        return false;
+    }
+
+    let fn_re = regex::Regex::new(r"postprocess_fn\s*=\s*&?\s*([A-Za-z0-9_]+)").unwrap();
+    let mut chain = String::new();
+    let mut emitted = 0usize;
+    for (ix, entry) in entries.iter().enumerate() {
+        let name = match fn_re.captures(entry) {
+            Some(caps) => caps[1].to_string(),
+            // Positional initializers (or a renamed field): bail out and
+            // leave the dynamic walk in place rather than misnumbering.
+            None => return false,
+        };
+        if name == "NULL" || name == "nullptr" {
+            continue;
+        }
+        if emitted > 0 {
+            chain.push_str("        if ((status) != EI_IMPULSE_OK) break; \\\n");
+        }
+        chain.push_str(&format!(
+            "        (status) = {}((handle), (result), (handle)->impulse->postprocessing_blocks[{}].config, EI_FFI_PP_STATE((handle), {})); \\\n",
+            name, ix, ix
+        ));
+        emitted += 1;
+    }
+    if emitted == 0 {
+        return false;
+    }
+
+    let out = format!(
+        "// This file is @generated by build.rs. Do not edit manually.\n// The deployed impulse's postprocessing chain sequenced as direct calls;\n// names resolve against model_variables.h's definitions in the including\n// TU. Configs and per-block state are still read from the block table so\n// live threshold updates keep working.\n#pragma once\n\n#define EI_FFI_STATIC_POSTPROCESS 1\n#define EI_FFI_POSTPROCESS_CHAIN_SIZE {}\n\n#define EI_FFI_POSTPROCESS_CHAIN(handle, result, status) \\\n    do {{ \\\n{}    }} while (0)\n",
+        entries.len(),
+        chain
+    );
+
+    let out_path = format!("{}/model-parameters/ei_postprocess_chain.h", model_dir);
+    // Skip identical writes so incremental native builds stay warm.
+    if fs::read_to_string(&out_path).map(|c| c == out).unwrap_or(false) {
+        return true;
+    }
+    fs::write(&out_path, out).unwrap_or_else(|_| panic!("Failed to write {}", out_path));
+    true
 }
 
 /// Copy model files from a custom directory specified by EI_MODEL environment variable
@@ -200,6 +668,126 @@ fn read_edge_impulse_config() -> Option<(String, String)> {
     None
 }
 
+/// Single-stream download of the deployment zip (the fallback path, and
+/// the only path for servers that don't advertise byte ranges).
+fn download_zip_single(download_url: &str, api_key: &str) -> Option<Vec<u8>> {
+    let response = match ureq::get(download_url).set("x-api-key", api_key).call() {
+        Ok(response) => {
+            if response.status() != 200 {
+                println!(
+                    "cargo:error=Failed to download model: HTTP {}",
+                    response.status()
+                );
+                return None;
+            }
+            response
+        }
+        Err(e) => {
+            println!("cargo:error=Failed to download model: {}", e);
+            return None;
+        }
+    };
+    let mut zip_data = Vec::new();
+    if let Err(e) = response.into_reader().read_to_end(&mut zip_data) {
+        println!("cargo:error=Failed to read download data: {}", e);
+        return None;
+    }
+    Some(zip_data)
+}
+
+/// Ranged download: `streams` concurrent requests, each fetching one
+/// contiguous byte range, reassembled in order. Any short or failed chunk
+/// fails the whole attempt (the caller falls back to a single stream), so
+/// a corrupt reassembly can never reach the zip extractor.
+fn download_zip_ranged(
+    download_url: &str,
+    api_key: &str,
+    total: u64,
+    streams: usize,
+) -> Option<Vec<u8>> {
+    let chunk = (total + streams as u64 - 1) / streams as u64;
+    let mut handles = Vec::new();
+    for ix in 0..streams {
+        let start = ix as u64 * chunk;
+        if start >= total {
+            break;
+        }
+        let end = (start + chunk - 1).min(total - 1);
+        let url = download_url.to_string();
+        let key = api_key.to_string();
+        handles.push(std::thread::spawn(move || -> Option<Vec<u8>> {
+            let response = ureq::get(&url)
+                .set("x-api-key", &key)
+                .set("Range", &format!("bytes={}-{}", start, end))
+                .call()
+                .ok()?;
+            if response.status() != 206 {
+                return None;
+            }
+            let mut buf = Vec::with_capacity((end - start + 1) as usize);
+            response.into_reader().read_to_end(&mut buf).ok()?;
+            if buf.len() as u64 != end - start + 1 {
+                return None;
+            }
+            Some(buf)
+        }));
+    }
+
+    let mut data = Vec::with_capacity(total as usize);
+    for handle in handles {
+        match handle.join() {
+            Ok(Some(chunk_data)) => data.extend_from_slice(&chunk_data),
+            _ => return None,
+        }
+    }
+    if data.len() as u64 == total {
+        Some(data)
+    } else {
+        None
+    }
+}
+
+/// Download the deployment zip, using parallel ranged streams when the
+/// server advertises them and the artifact is big enough to benefit
+/// (TensorRT-enabled exports run hundreds of MB; small micro drops aren't
+/// worth the extra requests).
+fn download_zip(download_url: &str, api_key: &str) -> Option<Vec<u8>> {
+    const STREAMS: usize = 6;
+    const MIN_RANGED_BYTES: u64 = 8 * 1024 * 1024;
+
+    let ranged_total = match ureq::head(download_url).set("x-api-key", api_key).call() {
+        Ok(response) => {
+            let ranges_ok = response
+                .header("accept-ranges")
+                .map(|v| v.eq_ignore_ascii_case("bytes"))
+                .unwrap_or(false);
+            if ranges_ok {
+                response
+                    .header("content-length")
+                    .and_then(|v| v.parse::<u64>().ok())
+            } else {
+                None
+            }
+        }
+        Err(_) => None,
+    };
+
+    if let Some(total) = ranged_total {
+        if total >= MIN_RANGED_BYTES {
+            println!(
+                "cargo:info=Downloading {} MB with {} parallel streams...",
+                total / (1024 * 1024),
+                STREAMS
+            );
+            if let Some(data) = download_zip_ranged(download_url, api_key, total, STREAMS) {
+                return Some(data);
+            }
+            println!("cargo:warning=Ranged download failed, falling back to a single stream");
+        }
+    }
+    download_zip_single(download_url, api_key)
+}
+
 /// Download Edge Impulse model from the REST API using curl
 ///
 /// This function:
@@ -279,6 +867,39 @@ fn download_model_from_edge_impulse(project_id: &str, api_key: &str) -> bool {
     let engine = env::var("EI_ENGINE").unwrap_or_else(|_| "tflite-eon".to_string());
     println!("cargo:info=Using engine: {}", engine);
 
+    // Before paying for a build job, check whether we already have the
+    // studio's current deployment cached on disk. If the deployed model has
+    // not changed since the cached zip was stored, restore it and skip the
+    // API round trips entirely.
+    if let Some(version) = get_deployment_version(
+        &base_url,
+        project_id,
+        api_key,
+        default_impulse_id,
+        &engine,
+    ) {
+        let cache_path = model_cache_path(project_id, default_impulse_id, &engine, version);
+        if cache_path.exists() {
+            println!(
+                "cargo:info=Restoring deployment v{} from cache: {}",
+                version,
+                cache_path.display()
+            );
+            match fs::read(&cache_path) {
+                Ok(zip_data) => {
+                    if extract_model_zip(zip_data) {
+                        println!("cargo:info=Model restored from cache, skipping build job");
+                        return true;
+                    }
+                    println!(
+                        "cargo:warning=Cached model archive was unusable, rebuilding from studio"
+                    );
+                }
+                Err(e) => println!("cargo:warning=Failed to read model cache: {}", e),
+            }
+        }
+    }
+
     let build_response: BuildJobResponse = match ureq::post(&build_url)
         .set("x-api-key", api_key)
         .set("content-type", "application/json")
@@ -402,33 +1023,56 @@ fn download_model_from_edge_impulse(project_id: &str, api_key: &str) -> bool {
         }
     }
 
-    // Download the model
-    let download_response = match ureq::get(&download_url).set("x-api-key", api_key).call() {
-        Ok(response) => {
-            if response.status() != 200 {
-                println!(
-                    "cargo:error=Failed to download model: HTTP {}",
-                    response.status()
-                );
-                return false;
-            }
-            response
-        }
-        Err(e) => {
-            println!("cargo:error=Failed to download model: {}", e);
-            return false;
-        }
+    // Download the model (ranged parallel streams when the server supports
+    // them, single stream otherwise)
+    let zip_data = match download_zip(&download_url, api_key) {
+        Some(data) => data,
+        None => return false,
     };
 
     // Step 5: Extract the model
     println!("cargo:info=Step 5/5: Extracting model files...");
 
-    // Read the ZIP data
-    let mut zip_data = Vec::new();
-    match download_response.into_reader().read_to_end(&mut zip_data) {
-        Ok(_) => {}
-        Err(e) => {
-            println!("cargo:error=Failed to read download data: {}", e);
+    // Store the freshly built zip under its deployment version so the next
+    // clean build can restore it without touching the API.
+    if let Some(version) = get_deployment_version(
+        &base_url,
+        project_id,
+        api_key,
+        default_impulse_id,
+        &engine,
+    ) {
+        let cache_path = model_cache_path(project_id, default_impulse_id, &engine, version);
+        if let Some(parent) = cache_path.parent() {
+            let _ = fs::create_dir_all(parent);
+        }
+        match fs::write(&cache_path, &zip_data) {
+            Ok(_) => println!(
+                "cargo:info=Cached deployment v{} at {}",
+                version,
+                cache_path.display()
+            ),
+            Err(e) => println!("cargo:warning=Failed to write model cache: {}", e),
+        }
+    }
+
+    if !extract_model_zip(zip_data) {
+        return false;
+    }
+
+    println!("cargo:info=Model downloaded and extracted successfully!");
+    println!("cargo:info=Model is now ready for use. Future builds will use the local copy.");
+
+    true
+}
+
+/// Extract a deployment zip into model/, preserving any existing .gitignore
+/// and README.md. Shared by the download and cache-restore paths.
+fn extract_model_zip(zip_data: Vec<u8>) -> bool {
+    let model_dir = PathBuf::from("model");
+    if !model_dir.exists() {
+        if let Err(e) = fs::create_dir(&model_dir) {
+            println!("cargo:error=Failed to create model directory: {}", e);
             return false;
         }
     }
@@ -516,12 +1160,50 @@ fn download_model_from_edge_impulse(project_id: &str, api_key: &str) -> bool {
         }
     }
 
-    println!("cargo:info=Model downloaded and extracted successfully!");
-    println!("cargo:info=Model is now ready for use. Future builds will use the local copy.");
-
     true
 }
 
+/// Fingerprint of the inputs that feed the native build: path, size and
+/// mtime of every file in the model tree (build/ excluded) plus the CMake
+/// arguments. Stored in build/.ei-build-stamp so an unchanged model skips
+/// make entirely and a changed one rebuilds incrementally.
+fn compute_model_fingerprint(model_dir: &Path, cmake_args: &[String]) -> u64 {
+    use std::collections::hash_map::DefaultHasher;
+    use std::hash::{Hash, Hasher};
+
+    fn hash_dir(dir: &Path, hasher: &mut DefaultHasher) {
+        let mut entries: Vec<_> = match fs::read_dir(dir) {
+            Ok(entries) => entries.flatten().collect(),
+            Err(_) => return,
+        };
+        entries.sort_by_key(|entry| entry.path());
+        for entry in entries {
+            let path = entry.path();
+            if path.file_name().map_or(false, |name| name == "build") {
+                continue;
+            }
+            if path.is_dir() {
+                hash_dir(&path, hasher);
+            } else if let Ok(meta) = entry.metadata() {
+                path.hash(hasher);
+                meta.len().hash(hasher);
+                if let Ok(mtime) = meta.modified() {
+                    if let Ok(elapsed) = mtime.duration_since(std::time::UNIX_EPOCH) {
+                        elapsed.as_secs().hash(hasher);
+                    }
+                }
+            }
+        }
+    }
+
+    let mut hasher = DefaultHasher::new();
+    hash_dir(model_dir, &mut hasher);
+    for arg in cmake_args {
+        arg.hash(&mut hasher);
+    }
+    hasher.finish()
+}
+
 fn clean_model_folder() {
     let model_dir = "model";
 
@@ -638,7 +1320,72 @@ fn fix_header_file_path(build_dir: &Path) {
     }
 }
 
-fn extract_and_write_model_metadata() {
+/// Fingerprint of the generated-code inputs: the two model-parameters
+/// headers the extractors below parse. Content-based rather than mtime so a
+/// model restored from the zip cache (fresh timestamps, same bytes) still
+/// counts as warm.
+fn metadata_fingerprint() -> String {
+    use std::collections::hash_map::DefaultHasher;
+    use std::hash::{Hash, Hasher};
+
+    let mut hasher = DefaultHasher::new();
+    for header in &[
+        "model/model-parameters/model_metadata.h",
+        "model/model-parameters/model_variables.h",
+    ] {
+        fs::read(header).unwrap_or_default().hash(&mut hasher);
+    }
+    format!("{:016x}", hasher.finish())
+}
+
+/// True when the generated file at `path` carries this fingerprint, i.e. it
+/// was produced from the exact header bytes currently on disk and the
+/// extraction pass can be skipped.
+fn generated_output_current(path: &str, fingerprint: &str) -> bool {
+    let marker = format!("// source-hash: {}", fingerprint);
+    fs::read_to_string(path).map_or(false, |content| content.lines().take(4).any(|line| line == marker))
+}
+
+/// Fingerprint of the inputs bindgen parses: every header under model/
+/// (build/ excluded) plus build.rs itself, which owns the allowlist.
+/// Content-based like metadata_fingerprint, so a model restored from the
+/// zip cache still counts as warm.
+fn bindings_fingerprint(manifest_path: &Path) -> String {
+    use std::collections::hash_map::DefaultHasher;
+    use std::hash::{Hash, Hasher};
+
+    fn hash_headers(dir: &Path, hasher: &mut DefaultHasher) {
+        let mut entries: Vec<_> = match fs::read_dir(dir) {
+            Ok(entries) => entries.flatten().collect(),
+            Err(_) => return,
+        };
+        entries.sort_by_key(|entry| entry.path());
+        for entry in entries {
+            let path = entry.path();
+            if path.file_name().map_or(false, |name| name == "build") {
+                continue;
+            }
+            if path.is_dir() {
+                hash_headers(&path, hasher);
+            } else if path
+                .extension()
+                .map_or(false, |ext| ext == "h" || ext == "hpp")
+            {
+                path.hash(hasher);
+                fs::read(&path).unwrap_or_default().hash(hasher);
+            }
+        }
+    }
+
+    let mut hasher = DefaultHasher::new();
+    fs::read(manifest_path.join("build.rs"))
+        .unwrap_or_default()
+        .hash(&mut hasher);
+    hash_headers(&manifest_path.join("model"), &mut hasher);
+    format!("{:016x}", hasher.finish())
+}
+
+fn extract_and_write_model_metadata(fingerprint: &str) {
     use std::collections::HashMap;
     use std::fs;
     let header_path = "model/model-parameters/model_metadata.h";
@@ -646,6 +1393,7 @@ fn extract_and_write_model_metadata() {
     let header = fs::read_to_string(header_path).expect("Failed to read model_metadata.h");
 
     let mut out = String::from("// This file is @generated by build.rs. Do not edit manually.\n");
+    out.push_str(&format!("// source-hash: {}\n", fingerprint));
     out.push_str("// Model metadata constants extracted from model_metadata.h\n\n");
 
     let mut seen = HashMap::new();
@@ -892,6 +1640,126 @@ fn patch_model_for_full_tflite(model_dir: &Path, use_full_tflite: bool) {
             .expect("Failed to patch ei_run_classifier.h");
         println!("cargo:info=Patched ei_run_classifier.h for full TFLite");
     }
+    // Patch tflite_full.h so the interpreter thread count can be overridden at
+    // runtime via ei_ffi_set_xnnpack_threads(). The override routes the SDK's
+    // SetNumThreads() argument through ei_ffi_get_xnnpack_threads().
+    let tflite_full_header =
+        model_dir.join("edge-impulse-sdk/classifier/inferencing_engines/tflite_full.h");
+    if let Ok(content) = std::fs::read_to_string(&tflite_full_header) {
+        if !content.contains("ei_ffi_get_xnnpack_threads") {
+            let patched = regex::Regex::new(r"(\w+)->SetNumThreads\(([^;]+)\);")
+                .unwrap()
+                .replace_all(
+                    &content,
+                    // Also attach the per-op profiler here: this runs once per
+                    // interpreter construction, which is exactly when
+                    // SetProfiler must be called. &* works for both raw and
+                    // smart interpreter pointers.
+                    "$1->SetNumThreads(ei_ffi_get_xnnpack_threads($2));\n    ei_ffi_internal_attach_profiler((void*)&*$1);\n    ei_ffi_internal_apply_delegate((void*)&*$1);\n    ei_ffi_internal_apply_precision((void*)&*$1);",
+                );
+            // Under EI_FFI_LEAN_OPS, build the interpreter from the selective
+            // MutableOpResolver (populated from model_ops.inc) instead of the
+            // register-everything BuiltinOpResolver.
+            let patched = regex::Regex::new(
+                r"tflite::ops::builtin::BuiltinOpResolver(\w*) (\w+);",
+            )
+            .unwrap()
+            .replace_all(
+                &patched,
+                "#if defined(EI_FFI_LEAN_OPS)\n    tflite::MutableOpResolver $2;\n    ei_ffi_register_selected_ops(&$2);\n#else\n    tflite::ops::builtin::BuiltinOpResolver$1 $2;\n#endif",
+            );
+            // Under EI_FFI_TRUSTED_MODEL the embedded blob ships inside a
+            // signed image, so the flatbuffer verification pass at
+            // interpreter construction is redundant; route the builder call
+            // through a macro so the choice stays compile-time. Models
+            // loaded from files at runtime are verified separately in
+            // ei_ffi_map_model_weights.
+            let patched = regex::Regex::new(r"FlatBufferModel::VerifyAndBuildFromBuffer\b")
+                .unwrap()
+                .replace_all(&patched, "FlatBufferModel::EI_FFI_BUILD_MODEL_FN");
+            if patched != content {
+                let with_decl = format!(
+                    "extern \"C\" int ei_ffi_get_xnnpack_threads(int sdk_default);\nextern \"C\" void ei_ffi_internal_attach_profiler(void* interpreter);\nextern \"C\" void ei_ffi_internal_apply_delegate(void* interpreter);\nextern \"C\" void ei_ffi_internal_apply_precision(void* interpreter);\n#if defined(EI_FFI_LEAN_OPS)\nnamespace tflite {{ class MutableOpResolver; }}\nvoid ei_ffi_register_selected_ops(tflite::MutableOpResolver* resolver);\n#endif\n#if defined(EI_FFI_TRUSTED_MODEL)\n#define EI_FFI_BUILD_MODEL_FN BuildFromBuffer\n#else\n#define EI_FFI_BUILD_MODEL_FN VerifyAndBuildFromBuffer\n#endif\n{}",
+                    patched
+                );
+                std::fs::write(&tflite_full_header, with_decl.as_bytes())
+                    .expect("Failed to patch tflite_full.h");
+                println!("cargo:info=Patched tflite_full.h for runtime thread-count control");
+            } else {
+                println!(
+                    "cargo:warning=No SetNumThreads call found in tflite_full.h, thread-count override will be inert"
+                );
+            }
+        }
+    }
+
+    // Patch the TensorRT engine so its serialized plan lands in the directory
+    // configured via ei_ffi_set_tensorrt_cache_path() instead of hardcoded
+    // /tmp (tmpfs on Jetson, so the multi-minute engine build re-runs every
+    // boot). Rewrites `snprintf(buf, n, "/tmp/...")` into
+    // `snprintf(buf, n, "%s/...", ei_ffi_tensorrt_cache_dir())`.
+    let tensorrt_header =
+        model_dir.join("edge-impulse-sdk/classifier/inferencing_engines/tensorrt.h");
+    if let Ok(content) = std::fs::read_to_string(&tensorrt_header) {
+        if !content.contains("ei_ffi_tensorrt_cache_dir") {
+            let patched = regex::Regex::new(r#"snprintf\(([^,]+),([^,]+),\s*"/tmp/([^"]*)""#)
+                .unwrap()
+                .replace_all(
+                    &content,
+                    "snprintf($1,$2, \"%s/$3\", ei_ffi_tensorrt_cache_dir()",
+                );
+            if patched != content {
+                let with_decl = format!(
+                    "extern \"C\" const char* ei_ffi_tensorrt_cache_dir(void);\n{}",
+                    patched
+                );
+                std::fs::write(&tensorrt_header, with_decl.as_bytes())
+                    .expect("Failed to patch tensorrt.h");
+                println!("cargo:info=Patched tensorrt.h for configurable engine cache directory");
+            }
+        }
+    }
+
+    // Patch the detection postprocess kernel so its per-class NMS loop skips
+    // classes outside the glue's allowlist (ei_ffi_set_class_filter); the
+    // filter then saves the score-threshold scan, sort and IoU work for
+    // suppressed class planes instead of trimming the finished box list.
+    for name in [
+        "edge-impulse-sdk/tensorflow/lite/micro/kernels/detection_postprocess.cpp",
+        "edge-impulse-sdk/tensorflow/lite/micro/kernels/detection_postprocess.cc",
+    ] {
+        let postprocess_kernel = model_dir.join(name);
+        let Ok(content) = std::fs::read_to_string(&postprocess_kernel) else {
+            continue;
+        };
+        if content.contains("ei_ffi_internal_class_allowed") {
+            break;
+        }
+        let patched = regex::Regex::new(
+            r"(for \(int col = 0;\s*col < num_classes_with_background - label_offset;\s*col\+\+\) \{)",
+        )
+        .unwrap()
+        .replace_all(
+            &content,
+            "$1\n    if (!ei_ffi_internal_class_allowed(col)) {\n      continue;\n    }",
+        );
+        if patched != content {
+            let with_decl = format!(
+                "extern \"C\" bool ei_ffi_internal_class_allowed(int class_id);\n{}",
+                patched
+            );
+            std::fs::write(&postprocess_kernel, with_decl.as_bytes())
+                .expect("Failed to patch detection postprocess kernel");
+            println!("cargo:info=Patched detection postprocess for the class filter");
+        } else {
+            println!(
+                "cargo:warning=No per-class NMS loop found in {}, class filter will be inert",
+                name
+            );
+        }
+        break;
+    }
+
     // Patch model/CMakeLists.txt to filter out micro sources
     let cmake_lists = model_dir.join("CMakeLists.txt");
     if let Ok(content) = std::fs::read_to_string(&cmake_lists) {
@@ -906,7 +1774,7 @@ fn patch_model_for_full_tflite(model_dir: &Path, use_full_tflite: bool) {
     }
 }
 
-fn extract_and_write_thresholds() {
+fn extract_and_write_thresholds(fingerprint: &str) {
     use std::fs;
     let header_path = "model/model-parameters/model_variables.h";
     let out_path = "src/thresholds.rs";
@@ -925,6 +1793,7 @@ fn extract_and_write_thresholds() {
     let header = fs::read_to_string(header_path).expect("Failed to read model_variables.h");
 
     let mut out = String::from("// This file is @generated by build.rs. Do not edit manually.\n");
+    out.push_str(&format!("// source-hash: {}\n", fingerprint));
     out.push_str("// Threshold information extracted from model_variables.h\n\n");
 
     out.push_str(
@@ -1244,80 +2113,442 @@ fn main() {
     if has_valid_model {
         println!("cargo:info=Valid Edge Impulse model found, generating real bindings...");
 
-        // Generate real bindings using bindgen
-        let wrapper_header = manifest_path.join("model/edge_impulse_wrapper.h");
-        let bindings = bindgen::Builder::default()
-            .header(wrapper_header.to_str().unwrap())
-            .clang_arg("-xc++")
-            .clang_arg("-std=c++17")
-            .clang_arg("-Imodel")
-            .clang_arg("-Imodel/edge-impulse-sdk")
-            .clang_arg("-O3")
-            .clang_arg("-flto")
-            .clang_arg("-ffast-math")
-            .clang_arg("-funroll-loops")
-            // Force inclusion of visual anomaly detection fields for consistent bindings
-            .clang_arg("-DEI_CLASSIFIER_HAS_VISUAL_ANOMALY=1")
-            .rustified_enum(".*")
-            .default_enum_style(bindgen::EnumVariation::Rust {
-                non_exhaustive: false,
-            })
-            .prepend_enum_name(false)
-            .translate_enum_integer_types(true)
-            .derive_copy(true)
-            .derive_debug(true)
-            .derive_default(true)
-            // Do NOT derive Eq, PartialEq, Hash, Ord, PartialOrd to avoid function pointer comparison warnings
-            .derive_eq(false)
-            .derive_hash(false)
-            .derive_partialeq(false)
-            .derive_partialord(false)
-            .derive_ord(false)
-            // Disable problematic traits for structs with function pointers
-            .disable_name_namespacing()
-            .disable_untagged_union()
-            // Ignore INCBIN macro to avoid processing .tflite files
-            .blocklist_item("INCBIN")
-            .blocklist_item("incbin_.*")
-            .blocklist_item("gincbin_.*")
-            .allowlist_type("ei_impulse_handle_t")
-            .allowlist_type("ei_impulse_result_t")
-            .allowlist_type("ei_feature_t")
-            .allowlist_type("ei_signal_t")
-            .allowlist_type("EI_IMPULSE_ERROR")
-            .allowlist_type("ei_impulse_result_classification_t")
-            .allowlist_type("ei_impulse_result_bounding_box_t")
-            .allowlist_type("ei_impulse_result_timing_t")
-            .allowlist_type("ei_impulse_visual_ad_result_t")
-            .allowlist_function("ei_ffi_run_classifier_init")
-            .allowlist_function("ei_ffi_run_classifier_deinit")
-            .allowlist_function("ei_ffi_init_impulse")
-            .allowlist_function("ei_ffi_run_classifier")
-            .allowlist_function("ei_ffi_run_classifier_continuous")
-            .allowlist_function("ei_ffi_run_inference")
-            .allowlist_function("ei_ffi_signal_from_buffer")
-            .allowlist_function("ei_ffi_set_object_detection_threshold")
-            .allowlist_function("ei_ffi_set_anomaly_threshold")
-            .allowlist_function("ei_ffi_set_object_tracking_threshold")
-            .generate()
-            .expect("Unable to generate bindings");
-
-        bindings
-            .write_to_file(&out_bindings)
-            .expect("Couldn't write bindings!");
-
-        // Add allow attributes to suppress warnings in generated bindings
-        let bindings_content =
-            std::fs::read_to_string(&out_bindings).expect("Failed to read generated bindings");
-        let modified_content = format!(
-            "#![allow(non_camel_case_types, non_snake_case, non_upper_case_globals)]\n{}",
-            bindings_content
-        );
-        std::fs::write(&out_bindings, modified_content).expect("Failed to write modified bindings");
+        // Bindgen dominates the warm-model build, and rewriting bindings.rs
+        // recompiles every downstream crate. Hash the headers it parses and
+        // skip the whole pass when the existing bindings came from those
+        // exact bytes (the hash rides in the file, like the metadata files).
+        let bindings_fp = bindings_fingerprint(&manifest_path);
+        if generated_output_current("src/bindings.rs", &bindings_fp) {
+            println!("cargo:info=bindings.rs up to date, skipping bindgen");
+        } else {
+            // Generate real bindings using bindgen
+            let wrapper_header = manifest_path.join("model/edge_impulse_wrapper.h");
+            let bindings = bindgen::Builder::default()
+                .header(wrapper_header.to_str().unwrap())
+                .clang_arg("-xc++")
+                .clang_arg("-std=c++17")
+                .clang_arg("-Imodel")
+                .clang_arg("-Imodel/edge-impulse-sdk")
+                .clang_arg("-O3")
+                .clang_arg("-flto")
+                .clang_arg("-ffast-math")
+                .clang_arg("-funroll-loops")
+                // Force inclusion of visual anomaly detection fields for consistent bindings
+                .clang_arg("-DEI_CLASSIFIER_HAS_VISUAL_ANOMALY=1")
+                .rustified_enum(".*")
+                .default_enum_style(bindgen::EnumVariation::Rust {
+                    non_exhaustive: false,
+                })
+                .prepend_enum_name(false)
+                .translate_enum_integer_types(true)
+                .derive_copy(true)
+                .derive_debug(true)
+                .derive_default(true)
+                // Do NOT derive Eq, PartialEq, Hash, Ord, PartialOrd to avoid function pointer comparison warnings
+                .derive_eq(false)
+                .derive_hash(false)
+                .derive_partialeq(false)
+                .derive_partialord(false)
+                .derive_ord(false)
+                // Disable problematic traits for structs with function pointers
+                .disable_name_namespacing()
+                .disable_untagged_union()
+                // Ignore INCBIN macro to avoid processing .tflite files
+                .blocklist_item("INCBIN")
+                .blocklist_item("incbin_.*")
+                .blocklist_item("gincbin_.*")
+                .allowlist_type("ei_impulse_handle_t")
+                .allowlist_type("ei_impulse_result_t")
+                .allowlist_type("ei_feature_t")
+                .allowlist_type("ei_signal_t")
+                .allowlist_type("EI_IMPULSE_ERROR")
+                .allowlist_type("ei_impulse_result_classification_t")
+                .allowlist_type("ei_impulse_result_bounding_box_t")
+                .allowlist_type("ei_impulse_result_timing_t")
+                .allowlist_type("ei_ffi_timing_t")
+                .allowlist_type("ei_ffi_result_arena_t")
+                .allowlist_function("ei_ffi_get_timing")
+                .allowlist_function("ei_ffi_detach_result")
+                .allowlist_type("ei_impulse_visual_ad_result_t")
+                .allowlist_function("ei_ffi_create_instance")
+                .allowlist_function("ei_ffi_destroy_instance")
+                .allowlist_function("ei_ffi_run_classifier_on")
+                .allowlist_function("ei_ffi_run_classifier_init_on")
+                .allowlist_function("ei_ffi_run_classifier_deinit_on")
+                .allowlist_function("ei_ffi_run_classifier_continuous_on")
+                .allowlist_function("ei_ffi_run_classifier_init")
+                .allowlist_function("ei_ffi_run_classifier_deinit")
+                .allowlist_function("ei_ffi_teardown")
+                .allowlist_function("ei_ffi_init_impulse")
+                .allowlist_function("ei_ffi_run_classifier")
+                .allowlist_function("ei_ffi_run_classifier_traced")
+                .allowlist_function("ei_ffi_trace_id")
+                .allowlist_function("ei_ffi_signal_set_capture_time")
+                .allowlist_function("ei_ffi_get_latency_trace")
+                .allowlist_type("ei_ffi_latency_trace_t")
+                .allowlist_function("ei_ffi_signal_bind")
+                .allowlist_function("ei_ffi_run_classifier_bound")
+                .allowlist_type("ei_ffi_bound_signal_t")
+                .allowlist_function("ei_ffi_run_classifier_batch")
+                .allowlist_function("ei_ffi_run_multi")
+                .allowlist_function("ei_ffi_run_racing")
+                .allowlist_function("ei_ffi_run_classifier_continuous")
+                .allowlist_function("ei_ffi_smoothing_configure")
+                .allowlist_function("ei_ffi_smoothing_reset")
+                .allowlist_function("ei_ffi_get_stream_health")
+                .allowlist_function("ei_ffi_stream_health_reset")
+                .allowlist_type("ei_stream_health_t")
+                .allowlist_function("ei_ffi_run_classifier_continuous_i16")
+                .allowlist_function("ei_ffi_int16_dsp_active")
+                .allowlist_function("ei_ffi_run_inference")
+                .allowlist_function("ei_ffi_feature_matrix_from_buffer")
+                .allowlist_function("ei_ffi_feature_matrix_free")
+                .allowlist_function("ei_ffi_run_nn_only")
+                .allowlist_function("ei_ffi_postprocess")
+                .allowlist_function("ei_ffi_signal_from_buffer")
+                .allowlist_function("ei_ffi_signal_from_buffer_i8")
+                .allowlist_function("ei_ffi_signal_from_buffer_u8")
+                .allowlist_function("ei_ffi_signal_from_dmabuf")
+                .allowlist_function("ei_ffi_signal_from_file")
+                .allowlist_function("ei_ffi_signal_from_iovec")
+                .allowlist_type("ei_ffi_iovec_t")
+                .allowlist_function("ei_ffi_run_classifier_zero_copy")
+                .allowlist_function("ei_ffi_run_classifier_sliding")
+                .allowlist_type("ei_ffi_window_result_cb")
+                .allowlist_function("ei_ffi_warmup")
+                .allowlist_function("ei_ffi_warmup_on")
+                .allowlist_function("ei_ffi_warmup_async")
+                .allowlist_function("ei_ffi_warmup_wait")
+                .allowlist_function("ei_ffi_async_init")
+                .allowlist_function("ei_ffi_async_deinit")
+                .allowlist_function("ei_ffi_run_classifier_async")
+                .allowlist_type("ei_ffi_completion_cb")
+                .allowlist_function("ei_ffi_threadpool_init")
+                .allowlist_function("ei_ffi_threadpool_init_pinned")
+                .allowlist_function("ei_ffi_big_cores")
+                .allowlist_function("ei_ffi_threadpool_deinit")
+                .allowlist_function("ei_ffi_threadpool_handle")
+                .allowlist_function("ei_ffi_parallel_for")
+                .allowlist_type("ei_ffi_parallel_fn")
+                .allowlist_function("ei_ffi_frame_queue_init")
+                .allowlist_function("ei_ffi_frame_queue_deinit")
+                .allowlist_function("ei_ffi_frame_queue_push")
+                .allowlist_function("ei_ffi_frame_queue_pop")
+                .allowlist_function("ei_ffi_frame_queue_depth")
+                .allowlist_function("ei_ffi_set_latency_budget")
+                .allowlist_function("ei_ffi_governor_note_result")
+                .allowlist_function("ei_ffi_frame_queue_pop_fresh")
+                .allowlist_function("ei_ffi_governor_dropped")
+                .allowlist_function("ei_ffi_audio_ring_create")
+                .allowlist_function("ei_ffi_audio_ring_destroy")
+                .allowlist_function("ei_ffi_audio_push_i16")
+                .allowlist_function("ei_ffi_audio_ring_available")
+                .allowlist_function("ei_ffi_audio_ring_set_input_rate")
+                .allowlist_function("ei_ffi_audio_ring_signal")
+                .allowlist_function("ei_ffi_audio_ring_consume")
+                .allowlist_function("ei_ffi_audio_ring_set_norm")
+                .allowlist_function("ei_ffi_audio_ring_norm_stats")
+                .allowlist_function("ei_ffi_audio_ring_signal_normalized")
+                .allowlist_function("ei_ffi_stream_set_sched")
+                .allowlist_function("ei_ffi_stream_start")
+                .allowlist_function("ei_ffi_stream_stop")
+                .allowlist_var("EI_FFI_SCHED_OTHER")
+                .allowlist_var("EI_FFI_SCHED_FIFO")
+                .allowlist_var("EI_FFI_SCHED_RR")
+                .allowlist_function("ei_ffi_enable_capture")
+                .allowlist_function("ei_ffi_disable_capture")
+                .allowlist_function("ei_ffi_capture_dropped")
+                .allowlist_function("ei_ffi_enable_result_cache")
+                .allowlist_function("ei_ffi_disable_result_cache")
+                .allowlist_function("ei_ffi_result_cache_clear")
+                .allowlist_function("ei_ffi_result_cache_stats")
+                .allowlist_function("ei_ffi_map_model_weights")
+                .allowlist_function("ei_ffi_prefetch_weights")
+                .allowlist_function("ei_ffi_hot_swap_model")
+                .allowlist_function("ei_ffi_model_delta_create")
+                .allowlist_function("ei_ffi_model_delta_apply")
+                .allowlist_function("ei_ffi_model_delta_update")
+                .allowlist_function("ei_ffi_asset_lookup")
+                .allowlist_function("ei_ffi_asset_count")
+                .allowlist_function("ei_ffi_asset_name")
+                .allowlist_function("ei_ffi_ladder_add")
+                .allowlist_function("ei_ffi_ladder_config")
+                .allowlist_function("ei_ffi_ladder_rung")
+                .allowlist_function("ei_ffi_ladder_run")
+                .allowlist_function("ei_ffi_ladder_reset")
+                .allowlist_function("ei_ffi_set_dsp_arena")
+                .allowlist_function("ei_ffi_dsp_arena_begin")
+                .allowlist_function("ei_ffi_dsp_arena_end")
+                .allowlist_function("ei_ffi_dsp_arena_stats")
+                .allowlist_function("ei_ffi_set_arena_options")
+                .allowlist_var("EI_FFI_ARENA_HUGEPAGES")
+                .allowlist_function("ei_ffi_set_delegate")
+                .allowlist_function("ei_ffi_get_delegate")
+                .allowlist_function("ei_ffi_xnnpack_cache_hits")
+                .allowlist_function("ei_ffi_cold_text_bytes")
+                .allowlist_function("ei_ffi_release_cold_text")
+                .allowlist_function("ei_ffi_build_arena_begin")
+                .allowlist_function("ei_ffi_build_arena_end")
+                .allowlist_function("ei_ffi_build_arena_release")
+                .allowlist_function("ei_ffi_build_arena_bytes")
+                .allowlist_var("EI_FFI_DELEGATE_CPU")
+                .allowlist_var("EI_FFI_DELEGATE_GPU")
+                .allowlist_function("ei_ffi_last_error")
+                .allowlist_function("ei_ffi_clear_last_error")
+                .allowlist_type("ei_ffi_error_detail_t")
+                .allowlist_var("EI_FFI_STAGE_NONE")
+                .allowlist_var("EI_FFI_STAGE_CONFIG")
+                .allowlist_var("EI_FFI_STAGE_DSP")
+                .allowlist_var("EI_FFI_STAGE_INFERENCE")
+                .allowlist_var("EI_FFI_STAGE_IO")
+                .allowlist_function("ei_ffi_set_precision")
+                .allowlist_function("ei_ffi_get_precision")
+                .allowlist_var("EI_PRECISION_FP32")
+                .allowlist_var("EI_PRECISION_FP16")
+                .allowlist_function("ei_ffi_cascade_create")
+                .allowlist_function("ei_ffi_cascade_run")
+                .allowlist_function("ei_ffi_cascade_destroy")
+                .allowlist_type("ei_ffi_cascade_t")
+                .allowlist_function("ei_ffi_spectral_cache_init")
+                .allowlist_function("ei_ffi_spectral_frame")
+                .allowlist_function("ei_ffi_spectral_cache_stats")
+                .allowlist_function("ei_ffi_spectral_cache_reset")
+                .allowlist_function("ei_ffi_spectral_cache_deinit")
+                .allowlist_function("ei_ffi_matrix_batch_vector_mul_i8")
+                .allowlist_function("ei_ffi_tensor_kernel_tier")
+                .allowlist_function("ei_ffi_fc_pack_i4")
+                .allowlist_function("ei_ffi_matrix_batch_vector_mul_i4")
+                .allowlist_function("ei_ffi_tensor_kernel_tier_i4")
+                .allowlist_function("ei_ffi_requantize_per_channel")
+                .allowlist_function("ei_ffi_requant_kernel_tier")
+                .allowlist_function("ei_ffi_softmax_f32")
+                .allowlist_function("ei_ffi_sigmoid_f32")
+                .allowlist_function("ei_ffi_reproducible_math")
+                .allowlist_function("ei_ffi_mel_apply_log10_f32")
+                .allowlist_function("ei_ffi_run_classifier_gated")
+                .allowlist_function("ei_ffi_aggregator_create")
+                .allowlist_function("ei_ffi_aggregator_set_callback")
+                .allowlist_function("ei_ffi_aggregator_set_boundary")
+                .allowlist_function("ei_ffi_aggregator_read")
+                .allowlist_function("ei_ffi_aggregator_destroy")
+                .allowlist_type("ei_ffi_aggregate_t")
+                .allowlist_var("EI_FFI_AGG_MAJORITY")
+                .allowlist_var("EI_FFI_AGG_EWMA")
+                .allowlist_function("ei_ffi_abi_version")
+                .allowlist_function("ei_ffi_result_layout_fingerprint")
+                .allowlist_function("ei_ffi_serialized_result_version")
+                .allowlist_var("EI_FFI_ABI_VERSION")
+                .allowlist_var("EI_FFI_SERIALIZED_RESULT_VERSION")
+                .allowlist_function("ei_ffi_serialize_result")
+                .allowlist_function("ei_ffi_result_to_json")
+                .allowlist_type("ei_ffi_serialized_header_t")
+                .allowlist_type("ei_ffi_serialized_class_t")
+                .allowlist_type("ei_ffi_serialized_box_t")
+                .allowlist_function("ei_ffi_get_anomaly_grid")
+                .allowlist_function("ei_ffi_anomaly_grid_stats")
+                .allowlist_function("ei_ffi_run_classifier_small")
+                .allowlist_type("ei_ffi_small_result_t")
+                .allowlist_function("ei_ffi_set_topk")
+                .allowlist_function("ei_ffi_get_topk")
+                .allowlist_type("ei_ffi_topk_entry_t")
+                .allowlist_function("ei_ffi_results_shm_create")
+                .allowlist_function("ei_ffi_results_shm_publish")
+                .allowlist_function("ei_ffi_results_shm_drops")
+                .allowlist_function("ei_ffi_results_shm_destroy")
+                .allowlist_function("ei_ffi_results_shm_open")
+                .allowlist_function("ei_ffi_results_shm_read_latest")
+                .allowlist_function("ei_ffi_results_shm_close")
+                .allowlist_function("ei_ffi_pipeline_init")
+                .allowlist_function("ei_ffi_pipeline_submit")
+                .allowlist_function("ei_ffi_pipeline_collect")
+                .allowlist_function("ei_ffi_pipeline_deinit")
+                .allowlist_function("ei_ffi_scheduler_start")
+                .allowlist_function("ei_ffi_scheduler_submit")
+                .allowlist_function("ei_ffi_scheduler_wait")
+                .allowlist_function("ei_ffi_scheduler_stop")
+                .allowlist_function("ei_ffi_set_invoke_timeout")
+                .allowlist_function("ei_ffi_power_hint")
+                .allowlist_var("EI_HINT_BURST_BEGIN")
+                .allowlist_var("EI_HINT_BURST_END")
+                .allowlist_var("EI_FFI_LANE_HIGH")
+                .allowlist_var("EI_FFI_LANE_LOW")
+                .allowlist_function("ei_ffi_start_memory_trace")
+                .allowlist_function("ei_ffi_stop_memory_trace")
+                .allowlist_function("ei_ffi_get_memory_stats")
+                .allowlist_type("ei_ffi_mem_stats_t")
+                .allowlist_function("ei_ffi_get_arena_stats")
+                .allowlist_type("ei_ffi_arena_stats_t")
+                .allowlist_function("ei_ffi_pin_arena")
+                .allowlist_function("ei_ffi_unpin_arena")
+                .allowlist_function("ei_ffi_arena_toucher_start")
+                .allowlist_function("ei_ffi_arena_toucher_stop")
+                .allowlist_function("ei_ffi_stats_ring_open")
+                .allowlist_function("ei_ffi_stats_ring_close")
+                .allowlist_function("ei_ffi_stats_ring_set_queue_depth")
+                .allowlist_function("ei_ffi_stats_ring_read")
+                .allowlist_type("ei_ffi_stats_record_t")
+                .allowlist_function("ei_ffi_ethos_u_init")
+                .allowlist_function("ei_ffi_ethos_u_available")
+                .allowlist_function("ei_ffi_ethos_u_run")
+                .allowlist_function("ei_ffi_run_classifier_npu")
+                .allowlist_function("ei_ffi_ethos_u_deinit")
+                .allowlist_function("ei_ffi_hybrid_configure")
+                .allowlist_function("ei_ffi_hybrid_submit")
+                .allowlist_function("ei_ffi_hybrid_await")
+                .allowlist_function("ei_ffi_hybrid_deinit")
+                .allowlist_function("ei_ffi_http_server_start")
+                .allowlist_function("ei_ffi_http_server_stop")
+                .allowlist_function("ei_ffi_set_tensorrt_cache_path")
+                .allowlist_function("ei_ffi_tensorrt_cache_dir")
+                .allowlist_function("ei_ffi_alloc_pinned")
+                .allowlist_function("ei_ffi_free_pinned")
+                .allowlist_function("ei_ffi_signal_from_pinned_buffer")
+                .allowlist_function("ei_ffi_cuda_stream")
+                .allowlist_function("ei_ffi_cuda_stream_sync")
+                .allowlist_function("ei_ffi_instance_pool_init")
+                .allowlist_function("ei_ffi_instance_pool_deinit")
+                .allowlist_function("ei_ffi_run_classifier_pooled")
+                .allowlist_function("ei_ffi_pool_set_affinity")
+                .allowlist_function("ei_ffi_pool_set_max_concurrency")
+                .allowlist_function("ei_ffi_pool_autotune_concurrency")
+                .allowlist_function("ei_ffi_pool_set_autoscale")
+                .allowlist_function("ei_ffi_prepare_image_input")
+                .allowlist_function("ei_ffi_prepare_image_input_quantized")
+                .allowlist_function("ei_ffi_frame_delta_configure")
+                .allowlist_function("ei_ffi_frame_delta_disable")
+                .allowlist_function("ei_ffi_frame_delta_stats")
+                .allowlist_function("ei_ffi_run_classifier_video")
+                .allowlist_function("ei_ffi_run_classifier_roi")
+                .allowlist_function("ei_ffi_preprocess_image_streamed")
+                .allowlist_function("ei_ffi_run_classifier_streamed")
+                .allowlist_type("ei_ffi_row_reader_t")
+                .allowlist_function("ei_ffi_nms")
+                .allowlist_function("ei_ffi_nms_multiclass")
+                .allowlist_function("ei_ffi_fomo_decode")
+                .allowlist_function("ei_ffi_f32_grid_stats")
+                .allowlist_function("ei_ffi_tracker_init")
+                .allowlist_function("ei_ffi_tracker_update")
+                .allowlist_function("ei_ffi_tracker_reset")
+                .allowlist_function("ei_ffi_get_result_delta")
+                .allowlist_type("ei_ffi_track_t")
+                .allowlist_type("ei_ffi_track_delta_t")
+                .allowlist_var("EI_FFI_TRACK_NEW")
+                .allowlist_var("EI_FFI_TRACK_MOVED")
+                .allowlist_var("EI_FFI_TRACK_LOST")
+                .allowlist_function("ei_ffi_pack_rgb888_features")
+                .allowlist_function("ei_ffi_pack_gray8_features")
+                .allowlist_function("ei_ffi_pack_channels")
+                .allowlist_var("EI_FFI_LAYOUT_INTERLEAVED")
+                .allowlist_var("EI_FFI_LAYOUT_PLANAR")
+                .allowlist_function("ei_ffi_quantize_f32_to_i8")
+                .allowlist_function("ei_ffi_pack_rgb888_quantized_i8")
+                .allowlist_function("ei_ffi_dequantize_i8_to_f32")
+                .allowlist_function("ei_ffi_conv2d_f32")
+                .allowlist_function("ei_ffi_conv_autotune")
+                .allowlist_function("ei_ffi_conv_set_tiling")
+                .allowlist_function("ei_ffi_conv_tuning_save")
+                .allowlist_function("ei_ffi_conv_tuning_load")
+                .allowlist_function("ei_ffi_lstm_sequence_init")
+                .allowlist_function("ei_ffi_lstm_sequence_run")
+                .allowlist_function("ei_ffi_lstm_sequence_reset")
+                .allowlist_function("ei_ffi_lstm_sequence_deinit")
+                .allowlist_function("ei_ffi_image_resize")
+                .allowlist_function("ei_ffi_image_crop")
+                .allowlist_function("ei_ffi_image_crop_and_interpolate_rgb888")
+                .allowlist_function("ei_ffi_output_tensor_count")
+                .allowlist_function("ei_ffi_get_output_tensor")
+                .allowlist_function("ei_ffi_get_output_tensor_quantized")
+                .allowlist_function("ei_ffi_output_index_by_name")
+                .allowlist_function("ei_ffi_get_output_by_name")
+                .allowlist_function("ei_ffi_get_output_by_name_quantized")
+                .allowlist_function("ei_ffi_set_quantized_threshold")
+                .allowlist_function("ei_ffi_classify_quantized")
+                .allowlist_function("ei_ffi_profiling_start")
+                .allowlist_function("ei_ffi_profiling_stop")
+                .allowlist_function("ei_ffi_profiling_summary")
+                .allowlist_function("ei_ffi_describe_model")
+                .allowlist_function("ei_ffi_perf_begin")
+                .allowlist_function("ei_ffi_perf_end")
+                .allowlist_type("ei_ffi_perf_counters_t")
+                .allowlist_var("EI_FFI_PERF_CYCLES")
+                .allowlist_var("EI_FFI_PERF_INSTRUCTIONS")
+                .allowlist_var("EI_FFI_PERF_CACHE_REFS")
+                .allowlist_var("EI_FFI_PERF_CACHE_MISSES")
+                .allowlist_var("EI_FFI_PERF_STALLS")
+                .allowlist_function("ei_ffi_register_telemetry")
+                .allowlist_function("ei_ffi_telemetry_drain")
+                .allowlist_function("ei_ffi_telemetry_dropped")
+                .allowlist_function("ei_ffi_telemetry_note")
+                .allowlist_type("ei_telemetry_event_t")
+                .allowlist_type("ei_telemetry_cb_t")
+                .allowlist_var("EI_TELEMETRY_TAG_LEN")
+                .allowlist_var("EI_TELEMETRY_OP_BEGIN")
+                .allowlist_var("EI_TELEMETRY_OP_END")
+                .allowlist_var("EI_TELEMETRY_OP_EVENT")
+                .allowlist_var("EI_TELEMETRY_RUNTIME")
+                .allowlist_var("EI_TELEMETRY_NOTE")
+                .allowlist_function("ei_ffi_watch_tensor")
+                .allowlist_function("ei_ffi_unwatch_tensor")
+                .allowlist_type("ei_ffi_tensor_stats_t")
+                .allowlist_function("ei_ffi_subgraph_count")
+                .allowlist_function("ei_ffi_subgraph_arena_bytes")
+                .allowlist_function("ei_ffi_offload_subgraph")
+                .allowlist_function("ei_ffi_calibration_begin")
+                .allowlist_function("ei_ffi_calibration_end")
+                .allowlist_function("ei_ffi_calibration_table")
+                .allowlist_type("ei_ffi_tensor_watch_cb")
+                .allowlist_function("ei_ffi_set_xnnpack_threads")
+                .allowlist_function("ei_ffi_get_xnnpack_threads")
+                .allowlist_function("ei_ffi_set_object_detection_threshold")
+                .allowlist_function("ei_ffi_set_anomaly_threshold")
+                .allowlist_function("ei_ffi_set_object_tracking_threshold")
+                .allowlist_function("ei_ffi_set_log_callback")
+                .allowlist_function("ei_ffi_set_log_sink")
+                .allowlist_function("ei_ffi_log_sink_dropped")
+                .allowlist_function("ei_ffi_set_thresholds")
+                .allowlist_function("ei_ffi_publish_thresholds")
+                .allowlist_function("ei_ffi_thresholds_epoch")
+                .allowlist_function("ei_ffi_set_class_filter")
+                .allowlist_function("ei_ffi_apply_config")
+                .allowlist_function("ei_ffi_config_epoch")
+                .allowlist_type("ei_runtime_config_t")
+                .allowlist_function("ei_ffi_get_all_block_configs")
+                .allowlist_function("ei_ffi_set_logit_gate")
+                .allowlist_function("ei_ffi_run_classifier_early_exit")
+                .allowlist_function("ei_ffi_get_labels")
+                .allowlist_function("ei_ffi_label_index")
+                .allowlist_function("ei_ffi_input_frame_size")
+                .allowlist_function("ei_ffi_run_classifier_cooperative")
+                .allowlist_type("ei_threshold_update_t")
+                .allowlist_type("ei_ffi_block_config_t")
+                .allowlist_var("EI_FFI_THRESHOLD_OBJECT_DETECTION")
+                .allowlist_var("EI_FFI_THRESHOLD_ANOMALY")
+                .allowlist_var("EI_FFI_THRESHOLD_OBJECT_TRACKING")
+                .generate()
+                .expect("Unable to generate bindings");
+
+            bindings
+                .write_to_file(&out_bindings)
+                .expect("Couldn't write bindings!");
+
+            // Add allow attributes to suppress warnings in generated bindings
+            let bindings_content =
+                std::fs::read_to_string(&out_bindings).expect("Failed to read generated bindings");
+            let modified_content = format!(
+                "// source-hash: {}\n#![allow(non_camel_case_types, non_snake_case, non_upper_case_globals)]\n{}",
+                bindings_fp, bindings_content
+            );
+            std::fs::write(&out_bindings, modified_content).expect("Failed to write modified bindings");
+        }
 
         // Generate model metadata
         if model_header.exists() {
-            extract_and_write_model_metadata();
+            let fingerprint = metadata_fingerprint();
+            if generated_output_current("src/model_metadata.rs", &fingerprint) {
+                println!("cargo:info=model_metadata.rs up to date, skipping extraction");
+            } else {
+                extract_and_write_model_metadata(&fingerprint);
+            }
         } else {
             println!("cargo:warning=Model metadata header not found, skipping metadata generation");
         }
@@ -1349,6 +2580,7 @@ fn main() {
     // If we have a valid model, we need to build the C++ library
     if has_valid_model {
         copy_ffi_glue(model_dir);
+        generate_asset_index(model_dir);
 
         // Create build directory if it doesn't exist
         std::fs::create_dir_all(&build_dir).expect("Failed to create build directory");
@@ -1552,7 +2784,14 @@ fn main() {
             };
             let header_source = tflite_model_dir.join(&header_filename);
             let header_dest = tflite_build_dir.join(&header_filename);
-            std::fs::copy(&header_dest, &header_source)
+            // Only copy back when the fixed header actually differs, so the
+            // model tree's mtimes stay stable across no-op builds.
+            let fixed = std::fs::read(&header_dest)
+                .expect("Failed to read fixed header file");
+            if std::fs::read(&header_source).map(|d| d == fixed).unwrap_or(false) {
+                continue;
+            }
+            std::fs::write(&header_source, &fixed)
                 .expect("Failed to overwrite original header file with fixed path");
         }
 
@@ -1578,7 +2817,11 @@ fn main() {
     let use_full_tflite = env::var("USE_FULL_TFLITE").is_ok();
 
     // Detect platform target
-    let target_platform = if env::var("TARGET_MAC_ARM64").is_ok() {
+    let target_platform = if env::var("TARGET_WASM").is_ok()
+        || env::var("CARGO_CFG_TARGET_ARCH").map_or(false, |arch| arch == "wasm32")
+    {
+        "wasm"
+    } else if env::var("TARGET_MAC_ARM64").is_ok() {
         "mac-arm64"
     } else if env::var("TARGET_MAC_X86_64").is_ok() {
         "mac-x86_64"
@@ -1620,11 +2863,23 @@ fn main() {
         }
     };
 
+    // The prebuilt TFLite archives are native-only; wasm always runs the
+    // micro interpreter (its kernels vectorize under -msimd128).
+    let use_full_tflite = if target_platform == "wasm" && use_full_tflite {
+        println!("cargo:warning=USE_FULL_TFLITE is not available for wasm, falling back to TensorFlow Lite Micro");
+        false
+    } else {
+        use_full_tflite
+    };
+
     // Detect additional backend/accelerator support
     let use_tvm = env::var("USE_TVM").is_ok();
     let use_onnx = env::var("USE_ONNX").is_ok();
     let use_qualcomm_qnn = env::var("USE_QUALCOMM_QNN").is_ok();
-    let use_ethos = env::var("USE_ETHOS").is_ok();
+    // EI_ENGINE=ethos-u is shorthand for USE_ETHOS=1 (matches the studio's
+    // engine naming on i.MX93 deployments).
+    let use_ethos = env::var("USE_ETHOS").is_ok()
+        || env::var("EI_ENGINE").map_or(false, |e| e == "ethos-u");
     let use_akida = env::var("USE_AKIDA").is_ok();
     let use_memryx = env::var("USE_MEMRYX").is_ok();
     let link_tflite_flex = env::var("LINK_TFLITE_FLEX_LIBRARY").is_ok();
@@ -1688,14 +2943,65 @@ fn main() {
     if use_full_tflite {
         cmake_args.push("-DEI_CLASSIFIER_USE_FULL_TFLITE=1".to_string());
         cmake_args.push(format!("-DTARGET_PLATFORM={}", target_platform));
+        if env::var("DISABLE_XNNPACK").is_ok() {
+            cmake_args.push("-DDISABLE_XNNPACK=1".to_string());
+            println!("cargo:info=Building without the XNNPACK delegate");
+        }
+        if env::var("EI_LEAN_OPS").is_ok() {
+            cmake_args.push("-DEI_FFI_LEAN_OPS=1".to_string());
+            println!("cargo:info=Building with the lean op resolver (model_ops.inc)");
+        }
+        if env::var("EI_FP16").is_ok() {
+            cmake_args.push("-DEI_FFI_FP16=1".to_string());
+            println!("cargo:info=Building with fp16 inference support (DISABLEFLOAT16 dropped)");
+        }
         println!(
             "cargo:info=Building with full TensorFlow Lite for platform: {}",
             target_platform
         );
     } else {
+        // EI_LEAN_OPS on the micro path trims kernel compilation instead of
+        // resolver registration: build.rs emits micro_kernels.cmake from the
+        // op census and CMake compiles only those kernels.
+        if env::var("EI_LEAN_OPS").is_ok() {
+            if generate_micro_kernel_allowlist("model") {
+                cmake_args.push("-DEI_FFI_LEAN_OPS=1".to_string());
+                println!("cargo:info=Compiling only the micro kernels in the model's op census");
+            } else {
+                println!("cargo:warning=EI_LEAN_OPS set but model/model_ops.inc not found; compiling all micro kernels");
+            }
+        }
         println!("cargo:info=Building with TensorFlow Lite Micro");
     }
 
+    // Fold the DSP block configuration into a constexpr header before the
+    // native build; the glue picks it up via __has_include.
+    if extract_and_write_dsp_constexpr("model") {
+        println!("cargo:info=DSP block configuration folded into ei_dsp_constexpr.h");
+    }
+
+    // Sequence the postprocessing chain as direct calls when the block
+    // table in model_variables.h is statically parseable; the dynamic
+    // walk stays in place for drops that are not.
+    if extract_and_write_postprocess_chain("model") {
+        println!("cargo:info=Postprocessing chain sequenced into ei_postprocess_chain.h");
+    }
+
+    if target_platform == "wasm" {
+        cmake_args.push("-DTARGET_PLATFORM=wasm".to_string());
+        // Under emcmake the toolchain is already configured; otherwise point
+        // CMake at the Emscripten toolchain file from an installed EMSDK.
+        if let Ok(emsdk) = env::var("EMSDK") {
+            cmake_args.push(format!(
+                "-DCMAKE_TOOLCHAIN_FILE={}/upstream/emscripten/cmake/Modules/Platform/Emscripten.cmake",
+                emsdk
+            ));
+        } else {
+            println!("cargo:warning=Building for wasm without EMSDK set; configure through emcmake or pass an Emscripten CMAKE_TOOLCHAIN_FILE");
+        }
+        println!("cargo:info=Building micro interpreter for wasm with SIMD128");
+    }
+
     // Pass additional backend/accelerator flags
     if use_tvm {
         cmake_args.push("-DUSE_TVM=1".to_string());
@@ -1730,6 +3036,288 @@ fn main() {
         println!("cargo:info=Using MemryX software mode");
     }
 
+    if env::var("EI_HTTP_SERVER").is_ok() {
+        cmake_args.push("-DEI_FFI_HTTP_SERVER=1".to_string());
+        println!("cargo:info=Building with the HTTP inference server");
+    }
+    if env::var("USE_GPU_DELEGATE").is_ok() {
+        cmake_args.push("-DEI_FFI_GPU_DELEGATE=1".to_string());
+        println!("cargo:info=Building with the TFLite GPU delegate");
+    }
+    if env::var("USE_CUDA_PINNED").is_ok() {
+        cmake_args.push("-DEI_FFI_CUDA_PINNED=1".to_string());
+        println!("cargo:info=Building with pinned CUDA host staging buffers");
+    }
+    if env::var("USE_XNNPACK_CACHE").is_ok() {
+        cmake_args.push("-DEI_FFI_XNNPACK_CACHE=1".to_string());
+        println!("cargo:info=Building with the XNNPACK weights cache");
+    }
+    // Build-arena interpreter construction: interpose the library's global
+    // operator new/delete so metadata allocated inside an explicit
+    // begin/end scope (bracketing init or a hot swap) comes from a
+    // grow-only arena freed wholesale after deinit -- the prebuilt TFLite
+    // objects cannot be taught about an arena directly. Opt-in because it
+    // interposes allocation for the whole cdylib.
+    if env::var("EI_BUILD_ARENA").is_ok() {
+        cmake_args.push("-DEI_FFI_BUILD_ARENA=1".to_string());
+        println!("cargo:info=Building with the interpreter-construction arena");
+    }
+    // Cold-text isolation: group the init-only SDK objects (flatbuffer
+    // parsing, model/interpreter construction, arena planning) into a
+    // page-aligned region away from the hot invoke text, and expose
+    // ei_ffi_release_cold_text() to drop its residency after init. The
+    // section split is compiled in by CMake; the regrouping script has to
+    // ride the final cargo link, which only the GNU linker understands.
+    if env::var("USE_COLD_TEXT").is_ok() {
+        if target_platform.starts_with("linux") {
+            cmake_args.push("-DEI_FFI_COLD_TEXT=1".to_string());
+            println!(
+                "cargo:rustc-link-arg=-Wl,-T,{}/ffi_glue/cold_text.ld",
+                env::var("CARGO_MANIFEST_DIR").unwrap()
+            );
+            println!("cargo:info=Building with cold-text isolation");
+        } else {
+            println!("cargo:warning=USE_COLD_TEXT ignored: requires a Linux target (GNU ld)");
+        }
+    }
+    // Reproducible-math flavor: compile with strict FP (no fast-math, no
+    // FP contraction) so two builds of the same sources produce
+    // bit-identical outputs and A/B latency harnesses can gate on output
+    // equality instead of ULP-tolerance review. Costs a few percent of
+    // DSP throughput; not for shipping builds.
+    if env::var("REPRODUCIBLE_MATH").is_ok() {
+        cmake_args.push("-DEI_FFI_REPRODUCIBLE_MATH=1".to_string());
+        println!("cargo:info=Building with reproducible (strict FP) math");
+    }
+    // On-device quantization calibration harness: build ei_ffi_calibrate,
+    // which replays a capture log through the float classifier with range
+    // collection armed and emits the converter's scale/zero-point table.
+    // Build it against the float deployment of the impulse.
+    if env::var("EI_CALIBRATE").is_ok() {
+        cmake_args.push("-DEI_FFI_CALIBRATE=1".to_string());
+        println!("cargo:info=Building the ei_ffi_calibrate quantization harness");
+    }
+    // Notebook profiling bridge: build the pybind11 module (ei_ffi.*.so in
+    // the CMake build dir) alongside the static library, wrapping the same
+    // ei_ffi_* surface so Python-side latency numbers match the shipped
+    // binary.
+    if env::var("EI_PYTHON").is_ok() {
+        cmake_args.push("-DEI_FFI_PYTHON=1".to_string());
+        println!("cargo:info=Building the ei_ffi Python profiling module");
+    }
+    // Concurrency stress harness: build the ei_ffi_stress binary that hammers
+    // lifecycle, invoke, threshold and instance paths concurrently. EI_TSAN=1
+    // additionally rebuilds the static library under ThreadSanitizer so races
+    // inside the glue are caught, not just in the harness.
+    if env::var("EI_STRESS_TEST").is_ok() {
+        cmake_args.push("-DEI_FFI_STRESS_TEST=1".to_string());
+        if env::var("EI_TSAN").is_ok() {
+            cmake_args.push("-DEI_FFI_TSAN=1".to_string());
+            println!("cargo:info=Building the ei_ffi_stress harness under ThreadSanitizer");
+        } else if env::var("EI_ASAN").is_ok() {
+            // Leak checking for the teardown/reload churn mode (--churn).
+            cmake_args.push("-DEI_FFI_ASAN=1".to_string());
+            println!("cargo:info=Building the ei_ffi_stress harness under AddressSanitizer");
+        } else {
+            println!("cargo:info=Building the ei_ffi_stress harness");
+        }
+    }
+    // One-shot CLI pair: a daemon that parks the warm interpreter behind a
+    // Unix socket and a plain-POSIX client with no model linkage, so batch
+    // scripts shelling out per file stop paying startup per invocation.
+    if env::var("EI_INFER_CLI").is_ok() {
+        cmake_args.push("-DEI_FFI_INFER_CLI=1".to_string());
+        println!("cargo:info=Building the ei_infer daemon/client pair");
+    }
+    // EIM-protocol compatibility server: a drop-in .eim runner replacement
+    // that classifies in-process, for orchestration stacks speaking the
+    // EIM hello/classify socket protocol.
+    if env::var("EI_EIM_COMPAT").is_ok() {
+        cmake_args.push("-DEI_FFI_EIM_COMPAT=1".to_string());
+        println!("cargo:info=Building the ei_eim_compat protocol server");
+    }
+    if env::var("EI_PCH").is_ok() {
+        cmake_args.push("-DEI_FFI_PCH=1".to_string());
+        println!("cargo:info=Building with precompiled classifier headers");
+    }
+    if env::var("EI_UNITY_BUILD").is_ok() {
+        cmake_args.push("-DEI_FFI_UNITY_BUILD=1".to_string());
+        println!("cargo:info=Building SDK sources as unity batches");
+    }
+    // Sealed dispatch: freeze the runtime engine knobs (delegate, precision,
+    // interpreter threads) at their build-time values. The engine itself is
+    // already a build-time choice (EI_ENGINE); sealing removes the glue's
+    // remaining runtime indirection so the interpreter-construction hooks
+    // constant-fold and the unselected paths dead-strip under LTO.
+    if env::var("EI_SEALED").is_ok() {
+        cmake_args.push("-DEI_FFI_SEALED=1".to_string());
+        if let Ok(threads) = env::var("EI_SEALED_THREADS") {
+            if threads.parse::<u32>().is_ok() {
+                cmake_args.push(format!("-DEI_FFI_SEALED_THREADS={}", threads));
+            } else {
+                println!("cargo:warning=EI_SEALED_THREADS must be a number, ignoring '{}'", threads);
+            }
+        }
+        println!("cargo:info=Sealed build: delegate/precision/threads fixed at build time");
+    }
+    // Per-target CPU tuning: flow EI_TARGET_CPU (neoverse-n1, cortex-a76,
+    // x86-64-v3, ...) into the native build as -mcpu (Arm) / -march (x86).
+    // The dispatch-tier kernels still guard by runtime cpuinfo, so the
+    // preset tunes codegen without changing which kernels are eligible at
+    // run time. The value is passed to the compiler as-is, so it is
+    // restricted to the characters CPU names use.
+    if let Ok(cpu) = env::var("EI_TARGET_CPU") {
+        let valid = !cpu.is_empty()
+            && cpu
+                .chars()
+                .all(|c| c.is_ascii_alphanumeric() || c == '-' || c == '.' || c == '+');
+        if valid {
+            cmake_args.push(format!("-DEI_FFI_TARGET_CPU={}", cpu));
+            println!("cargo:info=Tuning native build for {}", cpu);
+        } else {
+            println!(
+                "cargo:warning=EI_TARGET_CPU '{}' is not a plausible CPU name, ignoring",
+                cpu
+            );
+        }
+    }
+    // Trusted model: skip flatbuffer verification of the embedded blob at
+    // interpreter construction (it ships inside a signed firmware image).
+    // Model files loaded at runtime still get the full verifier pass.
+    if env::var("EI_TRUSTED_MODEL").is_ok() {
+        cmake_args.push("-DEI_FFI_TRUSTED_MODEL=1".to_string());
+        println!("cargo:info=Trusted model: skipping embedded-blob flatbuffer verification");
+    }
+    // Binary diet mode: dead-strip SDK code the deployed model never
+    // references. The block implementations are selected through function
+    // pointers in model_variables.h rather than preprocessor guards, so
+    // definitions alone cannot compile them out; instead every function and
+    // data item gets its own section and the final link garbage-collects
+    // whatever the exported ei_ffi_* surface doesn't reach. On micro builds
+    // this also implies the kernel-census trim (same as EI_LEAN_OPS) when
+    // model_ops.inc is present. The used-block census goes to CMake so size
+    // regressions can be traced to a block appearing in the model.
+    if env::var("EI_DIET").is_ok() {
+        cmake_args.push("-DEI_FFI_DIET=1".to_string());
+        let blocks = extract_used_dsp_blocks("model");
+        if !blocks.is_empty() {
+            cmake_args.push(format!("-DEI_FFI_USED_DSP_BLOCKS={}", blocks.join(";")));
+            println!(
+                "cargo:info=Diet build: model uses DSP blocks [{}]",
+                blocks.join(", ")
+            );
+        }
+        if !use_full_tflite && generate_micro_kernel_allowlist("model") {
+            cmake_args.push("-DEI_FFI_LEAN_OPS=1".to_string());
+            println!("cargo:info=Diet build: compiling only the micro kernels in the op census");
+        }
+        if target_platform.starts_with("mac") {
+            println!("cargo:rustc-link-arg=-Wl,-dead_strip");
+        } else {
+            println!("cargo:rustc-link-arg=-Wl,--gc-sections");
+        }
+    }
+    // Q15 fixed-point audio DSP: compile the integer MFE frontend so the
+    // int16 continuous path skips float DSP entirely. Only meaningful when
+    // the model's input tensor is quantized -- a float model re-quantizing
+    // integer features would lose the cycles and the accuracy -- so the
+    // metadata is checked before the flag is passed through.
+    if env::var("EI_INT16_DSP").is_ok() {
+        let metadata = fs::read_to_string("model/model-parameters/model_metadata.h")
+            .unwrap_or_default();
+        let quantized = regex::Regex::new(r"EI_CLASSIFIER_TFLITE_INPUT_QUANTIZED\s+1")
+            .unwrap()
+            .is_match(&metadata);
+        if quantized {
+            cmake_args.push("-DEI_FFI_INT16_DSP=1".to_string());
+            println!("cargo:info=Building the Q15 fixed-point audio DSP path");
+        } else {
+            println!(
+                "cargo:warning=EI_INT16_DSP ignored: the model's input tensor is not quantized"
+            );
+        }
+    }
+    // Small-result mode: when the model census shows no object detection
+    // and no visual anomaly grid, results are a fixed score vector and the
+    // fully inline ei_ffi_small_result_t path is safe -- enable it
+    // automatically so plain classifiers get allocation-free results
+    // without opting in.
+    {
+        let metadata = fs::read_to_string("model/model-parameters/model_metadata.h")
+            .unwrap_or_default();
+        let has_boxes = regex::Regex::new(r"EI_CLASSIFIER_OBJECT_DETECTION\s+1")
+            .unwrap()
+            .is_match(&metadata);
+        // The metadata's EI_CLASSIFIER_HAS_VISUAL_ANOMALY is force-patched
+        // to 1 for struct-layout stability, so the real census signal is
+        // whether model_variables.h wires up a visual anomaly block.
+        let variables = fs::read_to_string("model/model-parameters/model_variables.h")
+            .unwrap_or_default();
+        let has_visual_ad = variables.contains("visual_anomaly");
+        if !metadata.is_empty() && !has_boxes && !has_visual_ad {
+            cmake_args.push("-DEI_FFI_SMALL_RESULT=1".to_string());
+            println!("cargo:info=Plain classifier: enabling the inline small-result path");
+        }
+    }
+    // Strip SDK log call sites at compile time. Accepts the SDK's numeric
+    // levels (0-4) or the names; "none" compiles EI_LOG* to nothing.
+    if let Ok(level) = env::var("EI_LOG_LEVEL") {
+        let numeric = match level.to_lowercase().as_str() {
+            "none" | "0" => Some("0"),
+            "error" | "1" => Some("1"),
+            "warn" | "warning" | "2" => Some("2"),
+            "info" | "3" => Some("3"),
+            "debug" | "4" => Some("4"),
+            _ => None,
+        };
+        match numeric {
+            Some(n) => {
+                cmake_args.push(format!("-DEI_FFI_LOG_LEVEL={}", n));
+                println!("cargo:info=Building with EI_LOG_LEVEL={}", n);
+            }
+            None => println!(
+                "cargo:warning=Unknown EI_LOG_LEVEL '{}', keeping the SDK default",
+                level
+            ),
+        }
+    }
+
+    // Two-phase profile-guided optimization. EI_PGO=generate builds an
+    // instrumented library; run the calibration set through
+    // ei_ffi_run_classifier (any host program linking this crate), then
+    // rebuild with EI_PGO=use to compile against the recorded profile.
+    // Profiles land in EI_PGO_DIR (default <crate>/.ei-pgo); with clang,
+    // merge the .profraw files into default.profdata before the use phase.
+    if let Ok(pgo) = env::var("EI_PGO") {
+        let pgo_dir = env::var("EI_PGO_DIR")
+            .unwrap_or_else(|_| manifest_path.join(".ei-pgo").display().to_string());
+        match pgo.as_str() {
+            "generate" => {
+                let _ = fs::create_dir_all(&pgo_dir);
+                cmake_args.push("-DEI_FFI_PGO=generate".to_string());
+                cmake_args.push(format!("-DEI_FFI_PGO_DIR={}", pgo_dir));
+                // The profiling runtime has to reach the final link.
+                println!("cargo:rustc-link-arg=-fprofile-generate={}", pgo_dir);
+                println!(
+                    "cargo:info=PGO phase one: instrumented build, profiles in {}",
+                    pgo_dir
+                );
+            }
+            "use" => {
+                cmake_args.push("-DEI_FFI_PGO=use".to_string());
+                cmake_args.push(format!("-DEI_FFI_PGO_DIR={}", pgo_dir));
+                println!(
+                    "cargo:info=PGO phase two: building against profile data in {}",
+                    pgo_dir
+                );
+            }
+            other => println!(
+                "cargo:warning=Unknown EI_PGO mode '{}' (expected generate|use), ignoring",
+                other
+            ),
+        }
+    }
+
     // Pass TensorRT version for Jetson builds
     cmake_args.push(format!("-DTENSORRT_VERSION={}", tensorrt_version));
 
@@ -1738,34 +3326,81 @@ fn main() {
         cmake_args.push(format!("-DPYTHON_CROSS_PATH={}", path));
     }
 
+    // Optional compiler launcher (ccache/sccache) for fast warm rebuilds
+    if let Ok(launcher) = env::var("EI_COMPILER_LAUNCHER") {
+        cmake_args.push(format!("-DCMAKE_C_COMPILER_LAUNCHER={}", launcher));
+        cmake_args.push(format!("-DCMAKE_CXX_COMPILER_LAUNCHER={}", launcher));
+        println!("cargo:info=Using compiler launcher: {}", launcher);
+    }
+
     // If we have a valid model, check if we need to build the C++ library
     if has_valid_model {
-        // Check if the library already exists
+        // Rebuild when the library is missing, a rebuild is forced, or the
+        // model inputs changed since the last build. The CMake build
+        // directory persists across cargo invocations, so a changed model
+        // only recompiles what make decides is stale.
         let lib_path = build_dir.join("libedge-impulse-sdk.a");
-        let should_rebuild = !lib_path.exists() || env::var("FORCE_REBUILD").is_ok();
+        let stamp_path = build_dir.join(".ei-build-stamp");
+        // The stamp's second line hashes the configure flags alone, so a
+        // flag change (e.g. switching PGO phases) forces a reconfigure even
+        // though the persistent CMake cache would otherwise keep old flags.
+        let args_fingerprint = {
+            use std::collections::hash_map::DefaultHasher;
+            use std::hash::{Hash, Hasher};
+            let mut hasher = DefaultHasher::new();
+            for arg in &cmake_args {
+                arg.hash(&mut hasher);
+            }
+            format!("{:016x}", hasher.finish())
+        };
+        let fingerprint = format!("{:016x}", compute_model_fingerprint(&cpp_dir, &cmake_args));
+        let stamp_contents = format!("{}\n{}", fingerprint, args_fingerprint);
+        let previous_stamp = fs::read_to_string(&stamp_path).unwrap_or_default();
+        let stamp_matches = previous_stamp.trim() == stamp_contents;
+        let should_rebuild =
+            !lib_path.exists() || !stamp_matches || env::var("FORCE_REBUILD").is_ok();
 
         if should_rebuild {
             if !lib_path.exists() {
                 println!("cargo:warning=Library not found, building C++ library...");
+            } else if !stamp_matches {
+                println!("cargo:warning=Model inputs changed, rebuilding C++ library incrementally...");
             } else {
                 println!("cargo:warning=Force rebuild requested, rebuilding C++ library...");
             }
 
-            println!("cargo:warning=CMake args: {:?}", cmake_args);
-            let cmake_status = Command::new("cmake")
-                .args(&cmake_args)
-                .current_dir(&build_dir)
-                .status()
-                .expect("Failed to run cmake configure");
+            if previous_stamp.lines().nth(1) != Some(args_fingerprint.as_str()) {
+                let cache = build_dir.join("CMakeCache.txt");
+                if cache.exists() {
+                    let _ = fs::remove_file(&cache);
+                    println!("cargo:warning=Configure flags changed, re-running cmake");
+                }
+            }
 
-            if !cmake_status.success() {
-                panic!("CMake configuration failed");
+            // Configure only when there is no cache yet; make re-runs cmake
+            // on its own if CMakeLists.txt changed.
+            if !build_dir.join("CMakeCache.txt").exists() {
+                println!("cargo:warning=CMake args: {:?}", cmake_args);
+                let cmake_status = Command::new("cmake")
+                    .args(&cmake_args)
+                    .current_dir(&build_dir)
+                    .status()
+                    .expect("Failed to run cmake configure");
+
+                if !cmake_status.success() {
+                    panic!("CMake configuration failed");
+                }
             }
 
-            // Build the library
+            // Build the library; cargo sets NUM_JOBS to its own -j value
+            let jobs = env::var("NUM_JOBS").unwrap_or_else(|_| {
+                std::thread::available_parallelism()
+                    .map(|n| n.to_string())
+                    .unwrap_or_else(|_| "4".to_string())
+            });
             let make_status = Command::new("make")
                 .arg("-j")
-                .arg(env::var("NUM_JOBS").unwrap_or_else(|_| "4".to_string()))
+                .arg(jobs)
                 .current_dir(&build_dir)
                 .status()
                 .expect("Failed to run make");
@@ -1773,8 +3408,12 @@ fn main() {
             if !make_status.success() {
                 panic!("Make build failed");
             }
+
+            if let Err(e) = fs::write(&stamp_path, &stamp_contents) {
+                println!("cargo:warning=Failed to write build stamp: {}", e);
+            }
         } else {
-            println!("cargo:warning=Library already exists, skipping build");
+            println!("cargo:warning=Library up to date, skipping native build");
         }
 
         // Diagnostic: print contents of build directory
@@ -1847,6 +3486,19 @@ fn main() {
                 println!("cargo:rustc-link-lib=static=pthreadpool");
                 println!("cargo:rustc-link-lib=static=flatbuffers");
 
+                // GPU delegate middle tier (USE_GPU_DELEGATE=1): ships as a
+                // shared library next to the static archives.
+                if env::var("USE_GPU_DELEGATE").is_ok() {
+                    println!("cargo:rustc-link-lib=dylib=tensorflowlite_gpu_delegate");
+                }
+
+                // Pinned host staging (USE_CUDA_PINNED=1) links the CUDA
+                // runtime, which JetPack installs under /usr/local/cuda.
+                if env::var("USE_CUDA_PINNED").is_ok() {
+                    println!("cargo:rustc-link-search=native=/usr/local/cuda/lib64");
+                    println!("cargo:rustc-link-lib=dylib=cudart");
+                }
+
                 // Add system libraries that TensorFlow Lite depends on
                 println!("cargo:rustc-link-lib=dl");
 
@@ -1895,10 +3547,19 @@ fn main() {
         println!("cargo:info=No valid model found, skipping library linking");
     }
 
-    // Only extract model metadata if we have a valid model
+    // Only extract model metadata if we have a valid model. Warm builds
+    // (unchanged model-parameters headers) skip the parse entirely: the
+    // generated files carry a source-hash of the header bytes they came from.
     if has_valid_model {
-        extract_and_write_model_metadata();
-        extract_and_write_thresholds();
+        let fingerprint = metadata_fingerprint();
+        if generated_output_current("src/model_metadata.rs", &fingerprint)
+            && generated_output_current("src/thresholds.rs", &fingerprint)
+        {
+            println!("cargo:info=Generated metadata up to date, skipping extraction");
+        } else {
+            extract_and_write_model_metadata(&fingerprint);
+            extract_and_write_thresholds(&fingerprint);
+        }
         // Emit cargo:root for dependents
         println!("cargo:root={}", build_dir.display());
     } else {
@@ -1907,4 +3568,121 @@ fn main() {
 
     // Call this function after model download/extract and before C++ build
     patch_model_for_full_tflite(&manifest_path.join("model"), use_full_tflite);
+
+    emit_model_delta_if_requested(&manifest_path.join("model"));
+}
+
+/// OTA delta emission (EI_MODEL_DELTA_BASE=<previous .tflite>): diff the
+/// freshly downloaded model flatbuffer against the previous deploy's and
+/// write an "EID1" delta -- the payload ei_ffi_model_delta_apply expects on
+/// the device -- next to the new file (or at EI_MODEL_DELTA_OUT). Retrains
+/// keep the flatbuffer layout stable, so the delta is the changed weight
+/// bytes, not the whole model.
+fn emit_model_delta_if_requested(model_dir: &Path) {
+    let Ok(base) = env::var("EI_MODEL_DELTA_BASE") else {
+        return;
+    };
+    let new_path = match env::var("EI_MODEL_DELTA_NEW") {
+        Ok(path) => Some(PathBuf::from(path)),
+        // Default to the model flatbuffer shipped with this deploy.
+        Err(_) => fs::read_dir(model_dir.join("tflite-model"))
+            .ok()
+            .and_then(|entries| {
+                entries
+                    .filter_map(|entry| entry.ok())
+                    .map(|entry| entry.path())
+                    .find(|path| path.extension().map_or(false, |ext| ext == "tflite"))
+            }),
+    };
+    let Some(new_path) = new_path else {
+        println!(
+            "cargo:warning=EI_MODEL_DELTA_BASE set but no .tflite found under tflite-model/ (set EI_MODEL_DELTA_NEW)"
+        );
+        return;
+    };
+    let out_path = env::var("EI_MODEL_DELTA_OUT")
+        .map(PathBuf::from)
+        .unwrap_or_else(|_| new_path.with_extension("eid1"));
+    match emit_model_delta(Path::new(&base), &new_path, &out_path) {
+        Ok((new_size, delta_size)) => {
+            println!(
+                "cargo:info=Model delta: {} -> {} bytes written to {}",
+                new_size,
+                delta_size,
+                out_path.display()
+            );
+        }
+        Err(err) => {
+            println!("cargo:warning=Model delta emission failed: {}", err);
+        }
+    }
+}
+
+/// Same "EID1" format as ei_ffi_model_delta_create in the glue (sequential
+/// same-offset runs of copy/literal ops, FNV-1a 64 hashes over base and new);
+/// the two must stay in lockstep. Returns (new model size, delta size).
+fn emit_model_delta(
+    base_path: &Path,
+    new_path: &Path,
+    out_path: &Path,
+) -> std::io::Result<(usize, usize)> {
+    fn fnv1a64(data: &[u8]) -> u64 {
+        let mut hash: u64 = 0xcbf2_9ce4_8422_2325;
+        for &byte in data {
+            hash ^= byte as u64;
+            hash = hash.wrapping_mul(0x100_0000_01b3);
+        }
+        hash
+    }
+    // Matching runs shorter than this cost more as op headers than as
+    // literal bytes (mirrors kMinCopyRun in model_delta_support.cpp).
+    const MIN_COPY_RUN: usize = 16;
+
+    let base = fs::read(base_path)?;
+    let fresh = fs::read(new_path)?;
+
+    let mut delta: Vec<u8> = Vec::with_capacity(4096);
+    delta.extend_from_slice(&0x3144_4945u32.to_le_bytes()); // "EID1"
+    delta.extend_from_slice(&(base.len() as u64).to_le_bytes());
+    delta.extend_from_slice(&(fresh.len() as u64).to_le_bytes());
+    delta.extend_from_slice(&fnv1a64(&base).to_le_bytes());
+    delta.extend_from_slice(&fnv1a64(&fresh).to_le_bytes());
+
+    let common = base.len().min(fresh.len());
+    let mut pos = 0usize;
+    while pos < fresh.len() {
+        let mut matched = pos;
+        while matched < common && base[matched] == fresh[matched] {
+            matched += 1;
+        }
+        let match_len = matched - pos;
+        if match_len >= MIN_COPY_RUN || (match_len > 0 && matched == fresh.len()) {
+            delta.extend_from_slice(&0u32.to_le_bytes());
+            delta.extend_from_slice(&(match_len as u32).to_le_bytes());
+            pos = matched;
+            continue;
+        }
+        let mut lit_end = pos + match_len;
+        while lit_end < fresh.len() {
+            if lit_end >= common || base[lit_end] != fresh[lit_end] {
+                lit_end += 1;
+                continue;
+            }
+            let mut run = lit_end;
+            while run < common && base[run] == fresh[run] {
+                run += 1;
+            }
+            if run - lit_end >= MIN_COPY_RUN || run == fresh.len() {
+                break;
+            }
+            lit_end = run;
+        }
+        delta.extend_from_slice(&1u32.to_le_bytes());
+        delta.extend_from_slice(&((lit_end - pos) as u32).to_le_bytes());
+        delta.extend_from_slice(&fresh[pos..lit_end]);
+        pos = lit_end;
+    }
+
+    fs::write(out_path, &delta)?;
+    Ok((fresh.len(), delta.len()))
 }
@@ -0,0 +1,285 @@
+//! Preprocessing Benchmark: Rust image crate vs native FFI kernels
+//!
+//! Usage:
+//!   cargo run --release --example bench_preprocess -- [--image <path>] [--iterations 100]
+//!
+//! Runs identical inputs through the Rust-side preprocessing used by
+//! ffi_image_infer (image crate resize + pixel packing loop) and through
+//! the native kernels (ei_ffi_image_crop_and_interpolate_rgb888 +
+//! ei_ffi_pack_rgb888_features staged, and ei_ffi_prepare_image_input
+//! fused), reporting per-stage times. The packing stage is validated for
+//! bit-equality on the same resized buffer; the resize stages use
+//! different interpolation kernels, so those are compared by feature
+//! delta rather than asserted identical.
+
+use clap::Parser;
+use edge_impulse_ffi_rs::bindings::*;
+use edge_impulse_ffi_rs::model_metadata::*;
+use image::{imageops::FilterType, DynamicImage, GenericImageView, RgbImage};
+use std::error::Error;
+use std::time::Instant;
+
+/// Command line parameters for the preprocessing benchmark
+#[derive(Parser, Debug)]
+#[command(author, version, about, long_about = None)]
+struct Args {
+    /// Path to an image file; a deterministic synthetic frame is used if omitted
+    #[arg(short, long)]
+    image: Option<String>,
+
+    /// Width of the synthetic frame (ignored with --image)
+    #[arg(long, default_value_t = 640)]
+    source_width: u32,
+
+    /// Height of the synthetic frame (ignored with --image)
+    #[arg(long, default_value_t = 480)]
+    source_height: u32,
+
+    /// Number of timed iterations per stage
+    #[arg(short = 'n', long, default_value_t = 100)]
+    iterations: usize,
+
+    /// Number of untimed warm-up iterations per stage
+    #[arg(short, long, default_value_t = 5)]
+    warmup: usize,
+}
+
+/// Resize and crop exactly as examples/ffi_image_infer.rs does, so the
+/// numbers here describe that example's actual Rust-side cost.
+fn resize_and_crop(
+    img: &DynamicImage,
+    input_width: u32,
+    input_height: u32,
+    resize_mode: usize,
+) -> RgbImage {
+    let (w, h) = img.dimensions();
+    match resize_mode {
+        x if x == 0 => img // EI_CLASSIFIER_RESIZE_SQUASH
+            .resize_exact(input_width, input_height, FilterType::Triangle)
+            .to_rgb8(),
+        x if x == 1 => {
+            // EI_CLASSIFIER_RESIZE_FIT_SHORTEST
+            let factor = (input_width as f32 / w as f32).min(input_height as f32 / h as f32);
+            let resize_w = (w as f32 * factor).round() as u32;
+            let resize_h = (h as f32 * factor).round() as u32;
+            let resized = img.resize_exact(resize_w, resize_h, FilterType::Triangle);
+            let crop_x = if resize_w > input_width {
+                (resize_w - input_width) / 2
+            } else {
+                0
+            };
+            let crop_y = if resize_h > input_height {
+                (resize_h - input_height) / 2
+            } else {
+                0
+            };
+            image::DynamicImage::ImageRgba8(
+                image::imageops::crop_imm(&resized, crop_x, crop_y, input_width, input_height)
+                    .to_image(),
+            )
+            .to_rgb8()
+        }
+        x if x == 2 => {
+            // EI_CLASSIFIER_RESIZE_FIT_LONGEST
+            let factor = (input_width as f32 / w as f32).max(input_height as f32 / h as f32);
+            let resize_w = (w as f32 * factor).round() as u32;
+            let resize_h = (h as f32 * factor).round() as u32;
+            let resized = img.resize_exact(resize_w, resize_h, FilterType::Triangle);
+            let mut out = RgbImage::new(input_width, input_height);
+            let x_offset = if input_width > resize_w {
+                (input_width - resize_w) / 2
+            } else {
+                0
+            };
+            let y_offset = if input_height > resize_h {
+                (input_height - resize_h) / 2
+            } else {
+                0
+            };
+            image::imageops::replace(
+                &mut out,
+                &resized.to_rgb8(),
+                x_offset as i64,
+                y_offset as i64,
+            );
+            out
+        }
+        _ => img
+            .resize_exact(input_width, input_height, FilterType::Triangle)
+            .to_rgb8(),
+    }
+}
+
+/// Pack each pixel as (r << 16) + (g << 8) + b, as f32 -- the packing
+/// loop from examples/ffi_image_infer.rs.
+fn pack_features_rust(rgb: &[u8], out: &mut Vec<f32>) {
+    out.clear();
+    for pixel in rgb.chunks_exact(3) {
+        let packed = ((pixel[0] as u32) << 16) + ((pixel[1] as u32) << 8) + (pixel[2] as u32);
+        out.push(packed as f32);
+    }
+}
+
+/// Time `body` over the configured iteration count, returning (mean µs, p50 µs).
+fn time_stage(args: &Args, mut body: impl FnMut()) -> (f64, u64) {
+    for _ in 0..args.warmup {
+        body();
+    }
+    let mut samples: Vec<u64> = Vec::with_capacity(args.iterations);
+    for _ in 0..args.iterations {
+        let start = Instant::now();
+        body();
+        samples.push(start.elapsed().as_micros() as u64);
+    }
+    samples.sort_unstable();
+    let mean = samples.iter().sum::<u64>() as f64 / samples.len() as f64;
+    (mean, samples[(samples.len() - 1) / 2])
+}
+
+fn print_stage(name: &str, (mean, p50): (f64, u64)) {
+    println!("  {:<34} mean {:>8.1} µs   p50 {:>8} µs", name, mean, p50);
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args = Args::parse();
+
+    let input_width = EI_CLASSIFIER_INPUT_WIDTH as u32;
+    let input_height = EI_CLASSIFIER_INPUT_HEIGHT as u32;
+    let resize_mode = EI_CLASSIFIER_RESIZE_MODE;
+    let feature_count = (input_width * input_height) as usize;
+
+    println!("⚡ Preprocessing Benchmark: Rust vs native");
+    println!("==========================================");
+    println!(
+        "Model: {} (v{}), input {}x{}, resize mode {}",
+        EI_CLASSIFIER_PROJECT_NAME,
+        EI_CLASSIFIER_PROJECT_DEPLOY_VERSION,
+        input_width,
+        input_height,
+        resize_mode
+    );
+
+    // Identical input for every path: a decoded image, or a deterministic
+    // gradient frame so runs are comparable without test assets.
+    let img: DynamicImage = match &args.image {
+        Some(path) => {
+            let img = image::open(path)?;
+            let (w, h) = img.dimensions();
+            println!("Source: {} ({}x{})", path, w, h);
+            img
+        }
+        None => {
+            let w = args.source_width;
+            let h = args.source_height;
+            println!("Source: synthetic gradient ({}x{})", w, h);
+            DynamicImage::ImageRgb8(RgbImage::from_fn(w, h, |x, y| {
+                image::Rgb([(x % 256) as u8, (y % 256) as u8, ((x + y) % 256) as u8])
+            }))
+        }
+    };
+    let src_rgb = img.to_rgb8();
+    let (src_width, src_height) = (src_rgb.width() as i32, src_rgb.height() as i32);
+
+    println!(
+        "\n📊 Per-stage times ({} iterations, {} warm-up):",
+        args.iterations, args.warmup
+    );
+
+    // --- Rust path: image crate resize + packing loop --------------------
+    let mut rust_resized = RgbImage::new(input_width, input_height);
+    print_stage(
+        "rust: resize_and_crop",
+        time_stage(&args, || {
+            rust_resized = resize_and_crop(&img, input_width, input_height, resize_mode);
+        }),
+    );
+    let mut features_rust: Vec<f32> = Vec::with_capacity(feature_count);
+    print_stage(
+        "rust: pack features",
+        time_stage(&args, || {
+            pack_features_rust(rust_resized.as_raw(), &mut features_rust);
+        }),
+    );
+
+    // --- Native staged path: SDK resize kernel + packing kernel ----------
+    let mut native_resized = vec![0u8; feature_count * 3];
+    print_stage(
+        "native: crop_and_interpolate",
+        time_stage(&args, || unsafe {
+            ei_ffi_image_crop_and_interpolate_rgb888(
+                src_rgb.as_raw().as_ptr(),
+                src_width,
+                src_height,
+                native_resized.as_mut_ptr(),
+                input_width as i32,
+                input_height as i32,
+            );
+        }),
+    );
+    let mut features_native_pack = vec![0f32; feature_count];
+    print_stage(
+        "native: pack_rgb888_features",
+        time_stage(&args, || unsafe {
+            ei_ffi_pack_rgb888_features(
+                native_resized.as_ptr(),
+                feature_count,
+                features_native_pack.as_mut_ptr(),
+            );
+        }),
+    );
+
+    // --- Native fused path: one-pass resize + pack -----------------------
+    let mut features_fused = vec![0f32; feature_count];
+    print_stage(
+        "native: prepare_image_input",
+        time_stage(&args, || unsafe {
+            ei_ffi_prepare_image_input(
+                src_rgb.as_raw().as_ptr(),
+                src_width,
+                src_height,
+                features_fused.as_mut_ptr(),
+            );
+        }),
+    );
+
+    // --- Validation -------------------------------------------------------
+    // Packing on the same resized buffer must be bit-identical: both sides
+    // compute (r << 16 | g << 8 | b) as f32, which is exact in f32.
+    let mut features_pack_check: Vec<f32> = Vec::with_capacity(feature_count);
+    pack_features_rust(&native_resized, &mut features_pack_check);
+    let pack_mismatches = features_pack_check
+        .iter()
+        .zip(features_native_pack.iter())
+        .filter(|(a, b)| a.to_bits() != b.to_bits())
+        .count();
+
+    // The resize kernels interpolate differently (Triangle vs the SDK's
+    // bilinear), so end-to-end features are compared, not asserted.
+    let mut exact = 0usize;
+    let mut max_delta = 0f32;
+    for (a, b) in features_rust.iter().zip(features_fused.iter()) {
+        if a.to_bits() == b.to_bits() {
+            exact += 1;
+        }
+        max_delta = max_delta.max((a - b).abs());
+    }
+
+    println!("\n🔍 Validation:");
+    if pack_mismatches == 0 {
+        println!("  packing: bit-identical on the shared resized buffer ✓");
+    } else {
+        println!(
+            "  packing: {} of {} features differ on the shared resized buffer ✗",
+            pack_mismatches, feature_count
+        );
+    }
+    println!(
+        "  end-to-end (different resize kernels): {}/{} bit-exact, max packed-value delta {:.1}",
+        exact, feature_count, max_delta
+    );
+
+    if pack_mismatches != 0 {
+        return Err("packing kernels disagree on identical input".into());
+    }
+    Ok(())
+}
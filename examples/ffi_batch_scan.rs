@@ -0,0 +1,301 @@
+//! Batch Image Scan Example using Edge Impulse FFI Raw Bindings
+//!
+//! Scans a directory of images and runs inference on every file. Image
+//! decode, resize_and_crop, and feature packing run on a pool of worker
+//! threads that feed a bounded ready queue; the main thread drains the
+//! queue and runs the interpreter, so preprocessing of the next frames
+//! overlaps inference of the current one and the XNNPACK threads stay
+//! saturated instead of idling during decode.
+//!
+//! Usage:
+//!   cargo run --example ffi_batch_scan -- --dir <path_to_images> [--workers N] [--queue-depth K] [--debug]
+
+use clap::Parser;
+use edge_impulse_ffi_rs::bindings::*;
+use edge_impulse_ffi_rs::model_metadata::*;
+use image::{self, GenericImageView};
+use image::{imageops::FilterType, DynamicImage, RgbImage};
+use std::error::Error;
+use std::path::PathBuf;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::mpsc::sync_channel;
+use std::sync::Arc;
+use std::time::Instant;
+
+/// Command line parameters for the batch scan example
+#[derive(Parser, Debug)]
+#[command(author, version, about, long_about = None)]
+struct Args {
+    /// Directory to scan for images (jpg/jpeg/png/bmp, recursive)
+    #[arg(short, long)]
+    dir: String,
+
+    /// Number of decode/preprocess worker threads (default: available cores)
+    #[arg(short, long)]
+    workers: Option<usize>,
+
+    /// Ready-queue depth: preprocessed frames buffered ahead of the
+    /// interpreter (bounds memory; each entry is one feature vector)
+    #[arg(short, long, default_value_t = 8)]
+    queue_depth: usize,
+
+    /// Print per-file results instead of just the summary
+    #[arg(long, default_value_t = false)]
+    debug: bool,
+}
+
+/// Resize and crop the image according to Edge Impulse model metadata
+fn resize_and_crop(
+    img: &DynamicImage,
+    input_width: u32,
+    input_height: u32,
+    resize_mode: usize,
+) -> RgbImage {
+    let (w, h) = img.dimensions();
+    match resize_mode {
+        x if x == 0 => img // EI_CLASSIFIER_RESIZE_SQUASH
+            .resize_exact(input_width, input_height, FilterType::Triangle)
+            .to_rgb8(),
+        x if x == 1 => {
+            // EI_CLASSIFIER_RESIZE_FIT_SHORTEST
+            let factor = (input_width as f32 / w as f32).min(input_height as f32 / h as f32);
+            let resize_w = (w as f32 * factor).round() as u32;
+            let resize_h = (h as f32 * factor).round() as u32;
+            let resized = img.resize_exact(resize_w, resize_h, FilterType::Triangle);
+            let crop_x = if resize_w > input_width {
+                (resize_w - input_width) / 2
+            } else {
+                0
+            };
+            let crop_y = if resize_h > input_height {
+                (resize_h - input_height) / 2
+            } else {
+                0
+            };
+            image::DynamicImage::ImageRgba8(
+                image::imageops::crop_imm(&resized, crop_x, crop_y, input_width, input_height)
+                    .to_image(),
+            )
+            .to_rgb8()
+        }
+        x if x == 2 => {
+            // EI_CLASSIFIER_RESIZE_FIT_LONGEST
+            let factor = (input_width as f32 / w as f32).max(input_height as f32 / h as f32);
+            let resize_w = (w as f32 * factor).round() as u32;
+            let resize_h = (h as f32 * factor).round() as u32;
+            let resized = img.resize_exact(resize_w, resize_h, FilterType::Triangle);
+            // Pad to center
+            let mut out = RgbImage::new(input_width, input_height);
+            let x_offset = if input_width > resize_w {
+                (input_width - resize_w) / 2
+            } else {
+                0
+            };
+            let y_offset = if input_height > resize_h {
+                (input_height - resize_h) / 2
+            } else {
+                0
+            };
+            image::imageops::replace(
+                &mut out,
+                &resized.to_rgb8(),
+                x_offset as i64,
+                y_offset as i64,
+            );
+            out
+        }
+        _ => {
+            // Default to squash if unknown
+            img.resize_exact(input_width, input_height, FilterType::Triangle)
+                .to_rgb8()
+        }
+    }
+}
+
+/// Collect image files under `dir` recursively
+fn collect_images(dir: &PathBuf, out: &mut Vec<PathBuf>) -> Result<(), Box<dyn Error>> {
+    for entry in std::fs::read_dir(dir)? {
+        let path = entry?.path();
+        if path.is_dir() {
+            collect_images(&path, out)?;
+        } else if let Some(ext) = path.extension().and_then(|e| e.to_str()) {
+            match ext.to_ascii_lowercase().as_str() {
+                "jpg" | "jpeg" | "png" | "bmp" => out.push(path),
+                _ => {}
+            }
+        }
+    }
+    Ok(())
+}
+
+/// Decode one image into a packed feature vector, or None if it fails
+fn preprocess(
+    path: &PathBuf,
+    input_width: u32,
+    input_height: u32,
+    resize_mode: usize,
+) -> Option<Vec<f32>> {
+    let img = image::open(path).ok()?;
+    let rgb = resize_and_crop(&img, input_width, input_height, resize_mode);
+
+    // Pack each pixel as (r << 16) + (g << 8) + b, as f32
+    let mut features = Vec::with_capacity((input_width * input_height) as usize);
+    for pixel in rgb.pixels() {
+        let [r, g, b] = pixel.0;
+        let packed = ((r as u32) << 16) + ((g as u32) << 8) + (b as u32);
+        features.push(packed as f32);
+    }
+    Some(features)
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args = Args::parse();
+
+    let input_width = EI_CLASSIFIER_INPUT_WIDTH as u32;
+    let input_height = EI_CLASSIFIER_INPUT_HEIGHT as u32;
+    let resize_mode = EI_CLASSIFIER_RESIZE_MODE;
+
+    println!(
+        "Model: {} (v{}), input {}x{}",
+        EI_CLASSIFIER_PROJECT_NAME, EI_CLASSIFIER_PROJECT_DEPLOY_VERSION, input_width, input_height
+    );
+
+    let mut paths = Vec::new();
+    collect_images(&PathBuf::from(&args.dir), &mut paths)?;
+    if paths.is_empty() {
+        return Err(format!("No images found under {}", args.dir).into());
+    }
+    let n_images = paths.len();
+
+    let n_workers = args
+        .workers
+        .unwrap_or_else(|| {
+            std::thread::available_parallelism()
+                .map(|n| n.get())
+                .unwrap_or(4)
+        })
+        .max(1);
+    println!(
+        "Scanning {} images with {} preprocess workers (queue depth {})",
+        n_images, n_workers, args.queue_depth
+    );
+
+    // Workers pull the next path index from a shared counter and push
+    // preprocessed frames into a bounded channel; send() blocks when the
+    // interpreter falls behind, which caps memory at queue_depth frames.
+    let paths = Arc::new(paths);
+    let next_ix = Arc::new(AtomicUsize::new(0));
+    let (tx, rx) = sync_channel::<(usize, Option<Vec<f32>>)>(args.queue_depth.max(1));
+
+    let mut workers = Vec::with_capacity(n_workers);
+    for _ in 0..n_workers {
+        let paths = Arc::clone(&paths);
+        let next_ix = Arc::clone(&next_ix);
+        let tx = tx.clone();
+        workers.push(std::thread::spawn(move || loop {
+            let ix = next_ix.fetch_add(1, Ordering::Relaxed);
+            if ix >= paths.len() {
+                break;
+            }
+            let features = preprocess(&paths[ix], input_width, input_height, resize_mode);
+            if tx.send((ix, features)).is_err() {
+                break; // receiver gone, stop early
+            }
+        }));
+    }
+    // Drop the main thread's sender so the channel closes once workers finish
+    drop(tx);
+
+    unsafe {
+        ei_ffi_run_classifier_init();
+    }
+
+    let started = Instant::now();
+    let mut n_ok = 0usize;
+    let mut n_decode_failed = 0usize;
+    let mut n_infer_failed = 0usize;
+    let debug_int = if args.debug { 1 } else { 0 };
+
+    while let Ok((ix, features)) = rx.recv() {
+        let features = match features {
+            Some(f) => f,
+            None => {
+                n_decode_failed += 1;
+                if args.debug {
+                    eprintln!("{}: decode failed", paths[ix].display());
+                }
+                continue;
+            }
+        };
+
+        let mut signal = ei_signal_t::default();
+        let result_code =
+            unsafe { ei_ffi_signal_from_buffer(features.as_ptr(), features.len(), &mut signal) };
+        if result_code != EI_IMPULSE_ERROR::EI_IMPULSE_OK {
+            n_infer_failed += 1;
+            continue;
+        }
+
+        let mut result = ei_impulse_result_t::default();
+        let result_code = unsafe { ei_ffi_run_classifier(&mut signal, &mut result, debug_int) };
+        match result_code {
+            EI_IMPULSE_ERROR::EI_IMPULSE_OK => {
+                n_ok += 1;
+                if args.debug {
+                    if result.bounding_boxes_count > 0 && !result.bounding_boxes.is_null() {
+                        println!(
+                            "{}: {} boxes",
+                            paths[ix].display(),
+                            result.bounding_boxes_count
+                        );
+                    } else {
+                        let classification = &result.classification[0];
+                        if !classification.label.is_null() {
+                            let label = unsafe {
+                                std::ffi::CStr::from_ptr(classification.label).to_string_lossy()
+                            };
+                            println!(
+                                "{}: {} ({:.3})",
+                                paths[ix].display(),
+                                label,
+                                classification.value
+                            );
+                        }
+                    }
+                }
+            }
+            error_code => {
+                n_infer_failed += 1;
+                if args.debug {
+                    eprintln!(
+                        "{}: inference failed: {:?} (code: {})",
+                        paths[ix].display(),
+                        error_code,
+                        error_code as i32
+                    );
+                }
+            }
+        }
+    }
+
+    for worker in workers {
+        let _ = worker.join();
+    }
+
+    unsafe {
+        ei_ffi_run_classifier_deinit();
+    }
+
+    let elapsed = started.elapsed();
+    let per_sec = n_ok as f64 / elapsed.as_secs_f64().max(1e-9);
+    println!(
+        "Done: {} ok, {} decode failures, {} inference failures in {:.1}s ({:.1} images/s)",
+        n_ok,
+        n_decode_failed,
+        n_infer_failed,
+        elapsed.as_secs_f64(),
+        per_sec
+    );
+
+    Ok(())
+}
@@ -0,0 +1,132 @@
+//! Benchmark Harness using Edge Impulse FFI Raw Bindings
+//!
+//! Usage:
+//!   cargo run --release --example ffi_benchmark -- [--iterations 200] [--warmup 10]
+//!
+//! Exercises the full FFI path (signal setup, DSP, inference, result
+//! population) with synthetic input and reports wall-time percentiles plus
+//! the per-stage breakdown from ei_ffi_get_timing.
+
+use clap::Parser;
+use edge_impulse_ffi_rs::bindings::*;
+use edge_impulse_ffi_rs::model_metadata::*;
+use std::error::Error;
+use std::time::Instant;
+
+/// Command line parameters for the benchmark harness
+#[derive(Parser, Debug)]
+#[command(author, version, about, long_about = None)]
+struct Args {
+    /// Number of timed iterations
+    #[arg(short, long, default_value_t = 200)]
+    iterations: usize,
+
+    /// Number of untimed warm-up iterations
+    #[arg(short, long, default_value_t = 10)]
+    warmup: usize,
+
+    /// Enable debug output on the first timed iteration
+    #[arg(short, long, default_value_t = false)]
+    debug: bool,
+}
+
+fn percentile(sorted_us: &[u64], p: f64) -> u64 {
+    if sorted_us.is_empty() {
+        return 0;
+    }
+    let idx = ((sorted_us.len() - 1) as f64 * p / 100.0).round() as usize;
+    sorted_us[idx]
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args = Args::parse();
+
+    println!("⚡ Edge Impulse FFI Benchmark");
+    println!("=============================");
+    println!(
+        "Model: {} (v{})",
+        EI_CLASSIFIER_PROJECT_NAME, EI_CLASSIFIER_PROJECT_DEPLOY_VERSION
+    );
+    println!("Raw sample count: {}", EI_CLASSIFIER_RAW_SAMPLE_COUNT);
+    println!("NN input frame size: {}", EI_CLASSIFIER_NN_INPUT_FRAME_SIZE);
+    println!(
+        "Iterations: {} (+{} warm-up)",
+        args.iterations, args.warmup
+    );
+
+    // Synthetic input: a deterministic ramp so runs are comparable.
+    let sample_count = EI_CLASSIFIER_RAW_SAMPLE_COUNT as usize
+        * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME as usize;
+    let features: Vec<f32> = (0..sample_count)
+        .map(|i| ((i % 256) as f32) - 128.0)
+        .collect();
+
+    unsafe {
+        ei_ffi_run_classifier_init();
+    }
+
+    let mut signal = ei_signal_t::default();
+    let rc = unsafe { ei_ffi_signal_from_buffer(features.as_ptr(), features.len(), &mut signal) };
+    if rc != EI_IMPULSE_ERROR::EI_IMPULSE_OK {
+        return Err(format!("Failed to create signal: {:?}", rc).into());
+    }
+
+    let mut result = ei_impulse_result_t::default();
+
+    // Warm-up: absorb arena allocation and delegate weight packing.
+    for _ in 0..args.warmup {
+        let rc = unsafe { ei_ffi_run_classifier(&mut signal, &mut result, 0) };
+        if rc != EI_IMPULSE_ERROR::EI_IMPULSE_OK {
+            return Err(format!("Warm-up inference failed: {:?}", rc).into());
+        }
+    }
+
+    let mut wall_us: Vec<u64> = Vec::with_capacity(args.iterations);
+    let mut dsp_us_total: u64 = 0;
+    let mut classification_us_total: u64 = 0;
+    let mut anomaly_us_total: u64 = 0;
+
+    for i in 0..args.iterations {
+        let debug_int = if args.debug && i == 0 { 1 } else { 0 };
+        let start = Instant::now();
+        let rc = unsafe { ei_ffi_run_classifier(&mut signal, &mut result, debug_int) };
+        let elapsed = start.elapsed();
+        if rc != EI_IMPULSE_ERROR::EI_IMPULSE_OK {
+            return Err(format!("Inference failed at iteration {}: {:?}", i, rc).into());
+        }
+        wall_us.push(elapsed.as_micros() as u64);
+
+        let mut timing = ei_ffi_timing_t::default();
+        let rc = unsafe { ei_ffi_get_timing(&result, &mut timing) };
+        if rc == EI_IMPULSE_ERROR::EI_IMPULSE_OK {
+            dsp_us_total += timing.dsp_us;
+            classification_us_total += timing.classification_us;
+            anomaly_us_total += timing.anomaly_us;
+        }
+    }
+
+    wall_us.sort_unstable();
+    let n = args.iterations as u64;
+    let sum: u64 = wall_us.iter().sum();
+
+    println!("\n📊 Wall time per inference (full FFI path):");
+    println!("  mean: {:.1} ms", sum as f64 / n as f64 / 1000.0);
+    println!("  p50:  {:.1} ms", percentile(&wall_us, 50.0) as f64 / 1000.0);
+    println!("  p90:  {:.1} ms", percentile(&wall_us, 90.0) as f64 / 1000.0);
+    println!("  p99:  {:.1} ms", percentile(&wall_us, 99.0) as f64 / 1000.0);
+    println!("  max:  {:.1} ms", wall_us[wall_us.len() - 1] as f64 / 1000.0);
+
+    println!("\n⏱️  Mean per-stage breakdown (SDK timers):");
+    println!("  DSP:            {:.1} ms", dsp_us_total as f64 / n as f64 / 1000.0);
+    println!(
+        "  Classification: {:.1} ms",
+        classification_us_total as f64 / n as f64 / 1000.0
+    );
+    println!("  Anomaly:        {:.1} ms", anomaly_us_total as f64 / n as f64 / 1000.0);
+
+    unsafe {
+        ei_ffi_run_classifier_deinit();
+    }
+
+    Ok(())
+}
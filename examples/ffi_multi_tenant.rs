@@ -0,0 +1,315 @@
+//! Multi-Tenant Inference Server over dlopen'd Model Libraries
+//!
+//! Usage:
+//!   cargo run --release --example ffi_multi_tenant -- \
+//!       --model acme=/opt/models/libacme.so \
+//!       --model globex=/opt/models/libglobex.so \
+//!       [--port 8080] [--pool 2]
+//!
+//! Loads N model libraries (cdylib builds of this crate, one per impulse),
+//! gives each a bounded interpreter pool via ei_ffi_instance_pool_init, and
+//! routes HTTP requests by URL path — one process instead of one container
+//! per customer, so the TFLite runtime's code pages are shared while each
+//! tenant keeps its own arenas and interpreter state.
+//!
+//! Routes:
+//!   GET  /tenants                 list tenants and their input sizes
+//!   POST /classify/<tenant>       body = raw little-endian float32 features
+//!
+//! Results cross the library boundary through ei_ffi_serialize_result's
+//! flat layout, which is stable across model builds — the server never
+//! touches a tenant's ei_impulse_result_t struct directly, since its size
+//! depends on the model it was generated for.
+
+use clap::Parser;
+use edge_impulse_ffi_rs::bindings::{
+    ei_ffi_serialized_box_t, ei_ffi_serialized_class_t, ei_ffi_serialized_header_t,
+};
+use libloading::Library;
+use std::collections::HashMap;
+use std::error::Error;
+use std::io::{Read, Write};
+use std::net::{TcpListener, TcpStream};
+use std::sync::Arc;
+
+/// Command line parameters for the multi-tenant server
+#[derive(Parser, Debug)]
+#[command(author, version, about, long_about = None)]
+struct Args {
+    /// Tenant as name=path-to-model-library; repeat per tenant
+    #[arg(short, long)]
+    model: Vec<String>,
+
+    /// Port to listen on
+    #[arg(short, long, default_value_t = 8080)]
+    port: u16,
+
+    /// Interpreter pool size per tenant
+    #[arg(long, default_value_t = 2)]
+    pool: usize,
+}
+
+/// Opaque buffer sizes for per-tenant C structs whose layout we must not
+/// assume: large enough for any generated model, zero-initialized like the
+/// generated bindings' Default impls.
+const SIGNAL_BYTES: usize = 512;
+const RESULT_BYTES: usize = 64 * 1024;
+
+type InitFn = unsafe extern "C" fn() -> i32;
+type PoolInitFn = unsafe extern "C" fn(usize) -> i32;
+type InputSizeFn = unsafe extern "C" fn() -> usize;
+type SignalFromBufferFn = unsafe extern "C" fn(*const f32, usize, *mut u8) -> i32;
+type RunPooledFn = unsafe extern "C" fn(*mut u8, *mut u8, i32) -> i32;
+type SerializeFn = unsafe extern "C" fn(*const u8, *mut u8, usize) -> i32;
+
+/// One loaded model library. The function pointers stay valid for as long
+/// as `_lib` is alive, which is the lifetime of the server.
+struct Tenant {
+    name: String,
+    input_len: usize,
+    signal_from_buffer: SignalFromBufferFn,
+    run_pooled: RunPooledFn,
+    serialize: SerializeFn,
+    _lib: Library,
+}
+
+impl Tenant {
+    fn load(name: &str, path: &str, pool: usize) -> Result<Self, Box<dyn Error>> {
+        let lib = unsafe { Library::new(path) }?;
+        unsafe {
+            let init: InitFn = *lib.get(b"ei_ffi_run_classifier_init")?;
+            let pool_init: PoolInitFn = *lib.get(b"ei_ffi_instance_pool_init")?;
+            let input_size: InputSizeFn = *lib.get(b"ei_ffi_input_frame_size")?;
+            let signal_from_buffer: SignalFromBufferFn = *lib.get(b"ei_ffi_signal_from_buffer")?;
+            let run_pooled: RunPooledFn = *lib.get(b"ei_ffi_run_classifier_pooled")?;
+            let serialize: SerializeFn = *lib.get(b"ei_ffi_serialize_result")?;
+
+            init();
+            let rc = pool_init(pool);
+            if rc != 0 {
+                return Err(format!("{}: instance pool init failed ({})", name, rc).into());
+            }
+            Ok(Tenant {
+                name: name.to_string(),
+                input_len: input_size(),
+                signal_from_buffer,
+                run_pooled,
+                serialize,
+                _lib: lib,
+            })
+        }
+    }
+
+    /// Classify one frame and return the serialized result buffer.
+    fn classify(&self, features: &[f32]) -> Result<Vec<u8>, String> {
+        let mut signal = vec![0u8; SIGNAL_BYTES];
+        let mut result = vec![0u8; RESULT_BYTES];
+        unsafe {
+            let rc = (self.signal_from_buffer)(features.as_ptr(), features.len(), signal.as_mut_ptr());
+            if rc != 0 {
+                return Err(format!("signal setup failed ({})", rc));
+            }
+            // Blocks while all pool instances are busy — the bounded queue.
+            let rc = (self.run_pooled)(signal.as_mut_ptr(), result.as_mut_ptr(), 0);
+            if rc != 0 {
+                return Err(format!("inference failed ({})", rc));
+            }
+            let needed = (self.serialize)(result.as_ptr(), std::ptr::null_mut(), 0);
+            if needed < 0 {
+                return Err("result serialization failed".to_string());
+            }
+            let mut buf = vec![0u8; needed as usize];
+            (self.serialize)(result.as_ptr(), buf.as_mut_ptr(), buf.len());
+            Ok(buf)
+        }
+    }
+}
+
+/// Render the flat serialized result as JSON without touching any
+/// model-specific struct.
+fn serialized_to_json(buf: &[u8]) -> String {
+    if buf.len() < std::mem::size_of::<ei_ffi_serialized_header_t>() {
+        return "{}".to_string();
+    }
+    let header: ei_ffi_serialized_header_t =
+        unsafe { std::ptr::read_unaligned(buf.as_ptr() as *const _) };
+    let label_table =
+        &buf[header.label_table_offset as usize..(header.label_table_offset + header.label_table_bytes) as usize];
+    let label_at = |offset: u32| -> &str {
+        let bytes = &label_table[offset as usize..];
+        let end = bytes.iter().position(|&b| b == 0).unwrap_or(bytes.len());
+        std::str::from_utf8(&bytes[..end]).unwrap_or("")
+    };
+
+    let mut json = String::from("{\"classification\":{");
+    let mut cursor = std::mem::size_of::<ei_ffi_serialized_header_t>();
+    for ix in 0..header.classification_count {
+        let class: ei_ffi_serialized_class_t =
+            unsafe { std::ptr::read_unaligned(buf[cursor..].as_ptr() as *const _) };
+        cursor += std::mem::size_of::<ei_ffi_serialized_class_t>();
+        if ix > 0 {
+            json.push(',');
+        }
+        json.push_str(&format!("\"{}\":{}", label_at(class.label_offset), class.value));
+    }
+    json.push_str("},\"bounding_boxes\":[");
+    let box_count = header.bounding_box_count + header.grid_cell_count;
+    for ix in 0..box_count {
+        let bb: ei_ffi_serialized_box_t =
+            unsafe { std::ptr::read_unaligned(buf[cursor..].as_ptr() as *const _) };
+        cursor += std::mem::size_of::<ei_ffi_serialized_box_t>();
+        if ix > 0 {
+            json.push(',');
+        }
+        json.push_str(&format!(
+            "{{\"label\":\"{}\",\"value\":{},\"x\":{},\"y\":{},\"width\":{},\"height\":{}}}",
+            label_at(bb.label_offset),
+            bb.value,
+            bb.x,
+            bb.y,
+            bb.width,
+            bb.height
+        ));
+    }
+    json.push_str(&format!(
+        "],\"anomaly\":{},\"timing\":{{\"dsp_us\":{},\"classification_us\":{},\"anomaly_us\":{}}}}}",
+        header.anomaly, header.dsp_us, header.classification_us, header.anomaly_us
+    ));
+    json
+}
+
+fn respond(stream: &mut TcpStream, status: &str, content_type: &str, body: &str) {
+    let _ = write!(
+        stream,
+        "HTTP/1.1 {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+        status,
+        content_type,
+        body.len(),
+        body
+    );
+}
+
+fn handle_connection(mut stream: TcpStream, tenants: &HashMap<String, Tenant>) {
+    // Minimal HTTP/1.1: request line, headers, Content-Length body.
+    let mut buf = Vec::new();
+    let mut chunk = [0u8; 4096];
+    let header_end = loop {
+        match stream.read(&mut chunk) {
+            Ok(0) => return,
+            Ok(n) => buf.extend_from_slice(&chunk[..n]),
+            Err(_) => return,
+        }
+        if let Some(pos) = buf.windows(4).position(|w| w == b"\r\n\r\n") {
+            break pos + 4;
+        }
+        if buf.len() > 64 * 1024 {
+            return; // header flood
+        }
+    };
+    let head = String::from_utf8_lossy(&buf[..header_end]).to_string();
+    let mut lines = head.lines();
+    let request_line = lines.next().unwrap_or("");
+    let mut parts = request_line.split_whitespace();
+    let method = parts.next().unwrap_or("");
+    let path = parts.next().unwrap_or("");
+    let content_length = lines
+        .filter_map(|l| l.split_once(':'))
+        .find(|(k, _)| k.eq_ignore_ascii_case("content-length"))
+        .and_then(|(_, v)| v.trim().parse::<usize>().ok())
+        .unwrap_or(0);
+
+    match (method, path) {
+        ("GET", "/tenants") => {
+            let list: Vec<String> = tenants
+                .values()
+                .map(|t| format!("{{\"name\":\"{}\",\"input_features\":{}}}", t.name, t.input_len))
+                .collect();
+            respond(&mut stream, "200 OK", "application/json", &format!("[{}]", list.join(",")));
+        }
+        ("POST", _) if path.starts_with("/classify/") => {
+            let name = &path["/classify/".len()..];
+            let tenant = match tenants.get(name) {
+                Some(t) => t,
+                None => {
+                    respond(&mut stream, "404 Not Found", "application/json", "{\"error\":\"unknown tenant\"}");
+                    return;
+                }
+            };
+            let mut body = buf[header_end..].to_vec();
+            while body.len() < content_length {
+                match stream.read(&mut chunk) {
+                    Ok(0) | Err(_) => return,
+                    Ok(n) => body.extend_from_slice(&chunk[..n]),
+                }
+            }
+            if body.len() != tenant.input_len * std::mem::size_of::<f32>() {
+                respond(
+                    &mut stream,
+                    "400 Bad Request",
+                    "application/json",
+                    &format!(
+                        "{{\"error\":\"expected raw float32 body\",\"expected_bytes\":{}}}",
+                        tenant.input_len * std::mem::size_of::<f32>()
+                    ),
+                );
+                return;
+            }
+            let features: Vec<f32> = body
+                .chunks_exact(4)
+                .map(|c| f32::from_le_bytes([c[0], c[1], c[2], c[3]]))
+                .collect();
+            match tenant.classify(&features) {
+                Ok(serialized) => {
+                    respond(&mut stream, "200 OK", "application/json", &serialized_to_json(&serialized))
+                }
+                Err(e) => respond(
+                    &mut stream,
+                    "500 Internal Server Error",
+                    "application/json",
+                    &format!("{{\"error\":\"{}\"}}", e),
+                ),
+            }
+        }
+        _ => respond(&mut stream, "404 Not Found", "application/json", "{\"error\":\"not found\"}"),
+    }
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args = Args::parse();
+    if args.model.is_empty() {
+        return Err("no tenants; pass at least one --model name=path".into());
+    }
+
+    println!("🏢 Edge Impulse Multi-Tenant Server");
+    println!("===================================");
+
+    let mut tenants = HashMap::new();
+    for spec in &args.model {
+        let (name, path) = spec
+            .split_once('=')
+            .ok_or_else(|| format!("bad --model spec '{}', expected name=path", spec))?;
+        let tenant = Tenant::load(name, path, args.pool)?;
+        println!(
+            "  loaded {} ({} input features, pool of {})",
+            name, tenant.input_len, args.pool
+        );
+        tenants.insert(name.to_string(), tenant);
+    }
+    let tenants = Arc::new(tenants);
+
+    let listener = TcpListener::bind(("0.0.0.0", args.port))?;
+    println!("\n🌐 Listening on 0.0.0.0:{}", args.port);
+    println!("  GET  /tenants");
+    println!("  POST /classify/<tenant>  (raw float32 body)");
+
+    for stream in listener.incoming() {
+        match stream {
+            Ok(stream) => {
+                let tenants = Arc::clone(&tenants);
+                std::thread::spawn(move || handle_connection(stream, &tenants));
+            }
+            Err(e) => eprintln!("accept failed: {}", e),
+        }
+    }
+    Ok(())
+}
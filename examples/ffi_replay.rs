@@ -0,0 +1,156 @@
+//! Deterministic Replay Example using Edge Impulse FFI Raw Bindings
+//!
+//! Re-runs signals recorded with ei_ffi_enable_capture through
+//! ei_ffi_run_classifier, so a latency spike seen in the field can be
+//! reproduced offline with the exact input that caused it. Run this
+//! binary under `perf record` (or attach the crate's TFLite op profiler)
+//! to see where the time goes; --repeat re-runs each captured frame N
+//! times so short frames accumulate enough samples.
+//!
+//! Capture file layout (little-endian u32 fields): a 16-byte file header
+//! ("EICP", version, frame sample count, reserved), then per record a
+//! 16-byte header ("EIC1", signal bytes, result bytes, sequence number)
+//! followed by the raw float32 signal and the serialized result. The
+//! recorded result is skipped here; it is there for offline accuracy
+//! comparison against the replayed one.
+//!
+//! Usage:
+//!   cargo run --release --example ffi_replay -- --file capture.eic [--repeat N] [--debug]
+
+use clap::Parser;
+use edge_impulse_ffi_rs::bindings::*;
+use std::error::Error;
+use std::time::Instant;
+
+const FILE_MAGIC: u32 = 0x50434945; // "EICP"
+const RECORD_MAGIC: u32 = 0x31434945; // "EIC1"
+
+/// Command line parameters for the replay example
+#[derive(Parser, Debug)]
+#[command(author, version, about, long_about = None)]
+struct Args {
+    /// Capture file written by ei_ffi_enable_capture
+    #[arg(short, long)]
+    file: String,
+
+    /// Times to re-run each captured signal
+    #[arg(short, long, default_value_t = 1)]
+    repeat: usize,
+
+    /// Print per-invoke timing instead of just the summary
+    #[arg(long, default_value_t = false)]
+    debug: bool,
+}
+
+fn read_u32(buf: &[u8], offset: usize) -> Option<u32> {
+    let bytes = buf.get(offset..offset + 4)?;
+    Some(u32::from_le_bytes([bytes[0], bytes[1], bytes[2], bytes[3]]))
+}
+
+/// Parse all records into (sequence number, signal floats) pairs. A
+/// truncated final record (capture killed mid-write) is tolerated.
+fn parse_capture(buf: &[u8]) -> Result<Vec<(u32, Vec<f32>)>, Box<dyn Error>> {
+    if read_u32(buf, 0) != Some(FILE_MAGIC) {
+        return Err("not a capture file (bad magic)".into());
+    }
+    let version = read_u32(buf, 4).unwrap_or(0);
+    if version != 1 {
+        return Err(format!("unsupported capture format version {}", version).into());
+    }
+
+    let mut records = Vec::new();
+    let mut cursor = 16usize;
+    while cursor + 16 <= buf.len() {
+        if read_u32(buf, cursor) != Some(RECORD_MAGIC) {
+            break; // zero padding or corruption past the last record
+        }
+        let signal_bytes = read_u32(buf, cursor + 4).unwrap_or(0) as usize;
+        let result_bytes = read_u32(buf, cursor + 8).unwrap_or(0) as usize;
+        let seq = read_u32(buf, cursor + 12).unwrap_or(0);
+        cursor += 16;
+        if cursor + signal_bytes + result_bytes > buf.len() {
+            eprintln!("Warning: truncated record {} at end of file, skipping", seq);
+            break;
+        }
+        let signal: Vec<f32> = buf[cursor..cursor + signal_bytes]
+            .chunks_exact(4)
+            .map(|c| f32::from_le_bytes([c[0], c[1], c[2], c[3]]))
+            .collect();
+        cursor += signal_bytes + result_bytes;
+        records.push((seq, signal));
+    }
+    Ok(records)
+}
+
+fn main() -> Result<(), Box<dyn Error>> {
+    let args = Args::parse();
+
+    let buf = std::fs::read(&args.file)?;
+    let records = parse_capture(&buf)?;
+    if records.is_empty() {
+        return Err(format!("No records in {}", args.file).into());
+    }
+    println!(
+        "Replaying {} captured signals x{} from {}",
+        records.len(),
+        args.repeat.max(1),
+        args.file
+    );
+
+    unsafe {
+        ei_ffi_run_classifier_init();
+    }
+
+    let debug_int = if args.debug { 1 } else { 0 };
+    let mut invoke_us: Vec<u64> = Vec::with_capacity(records.len() * args.repeat.max(1));
+    let started = Instant::now();
+
+    for (seq, features) in &records {
+        for _ in 0..args.repeat.max(1) {
+            let mut signal = ei_signal_t::default();
+            let result_code =
+                unsafe { ei_ffi_signal_from_buffer(features.as_ptr(), features.len(), &mut signal) };
+            if result_code != EI_IMPULSE_ERROR::EI_IMPULSE_OK {
+                return Err(format!("signal setup failed for record {}", seq).into());
+            }
+
+            let mut result = ei_impulse_result_t::default();
+            let result_code = unsafe { ei_ffi_run_classifier(&mut signal, &mut result, debug_int) };
+            if result_code != EI_IMPULSE_ERROR::EI_IMPULSE_OK {
+                eprintln!("Record {}: inference failed: {:?}", seq, result_code);
+                continue;
+            }
+            let us = (result.timing.dsp_us + result.timing.classification_us
+                + result.timing.anomaly_us) as u64;
+            if args.debug {
+                println!(
+                    "Record {}: dsp {} us, classification {} us, anomaly {} us",
+                    seq, result.timing.dsp_us, result.timing.classification_us,
+                    result.timing.anomaly_us
+                );
+            }
+            invoke_us.push(us);
+        }
+    }
+
+    unsafe {
+        ei_ffi_run_classifier_deinit();
+    }
+
+    if invoke_us.is_empty() {
+        return Err("All replayed invokes failed".into());
+    }
+    invoke_us.sort_unstable();
+    let pct = |p: f64| invoke_us[((invoke_us.len() - 1) as f64 * p) as usize];
+    println!(
+        "Done: {} invokes in {:.1}s; p50 {} us, p90 {} us, p99 {} us, max {} us",
+        invoke_us.len(),
+        started.elapsed().as_secs_f64(),
+        pct(0.50),
+        pct(0.90),
+        pct(0.99),
+        invoke_us[invoke_us.len() - 1]
+    );
+
+    Ok(())
+}
@@ -0,0 +1,95 @@
+// ABI surface versioning for multi-tenant loaders.
+//
+// Multi-tenant servers dlopen several model libraries built from
+// different crate versions into one process, and a silent layout change
+// in ei_impulse_result_t between SDK drops corrupts memory with no
+// diagnostic. The negotiation is deliberately dead simple: a loader asks
+// each library three questions at dlopen time --
+//
+//   ei_ffi_abi_version()              the glue's own surface version,
+//                                     bumped on any breaking ei_ffi_*
+//                                     signature or struct change;
+//   ei_ffi_result_layout_fingerprint() a hash of the sizes and offsets
+//                                     this build compiled against, so two
+//                                     libraries agree on raw struct
+//                                     passing iff fingerprints match;
+//   ei_ffi_serialized_result_version() the flat-buffer contract version.
+//
+// Raw ei_impulse_result_t exchange is only safe between libraries with
+// equal fingerprints; everything else goes through the serialized-result
+// path, whose layout is frozen by the static assertions below -- any
+// edit to those structs that moves a field fails the build here instead
+// of corrupting a tenant at runtime.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cstddef>
+
+// The serialized-result structs are the stable cross-version contract;
+// freeze their layout. Bump EI_FFI_SERIALIZED_RESULT_VERSION and extend
+// the reader before touching these.
+static_assert(sizeof(ei_ffi_serialized_header_t) == 64, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, magic) == 0, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, version) == 4, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, total_bytes) == 8, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, classification_count) == 12, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, bounding_box_count) == 16, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, grid_cell_count) == 20, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, anomaly) == 24, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, dsp_us) == 32, "serialized header layout is frozen");
+static_assert(offsetof(ei_ffi_serialized_header_t, label_table_offset) == 56, "serialized header layout is frozen");
+static_assert(sizeof(ei_ffi_serialized_class_t) == 8, "serialized record layout is frozen");
+static_assert(sizeof(ei_ffi_serialized_box_t) == 24, "serialized record layout is frozen");
+
+namespace {
+
+// FNV-1a folding of the layout facts a raw-struct exchange depends on.
+// Not a secure hash; it only has to differ when a layout differs.
+constexpr uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr uint64_t kFnvPrime = 0x100000001b3ULL;
+
+constexpr uint64_t fnv_fold(uint64_t h, uint64_t v) {
+    for (int ix = 0; ix < 8; ix++) {
+        h = (h ^ ((v >> (ix * 8)) & 0xff)) * kFnvPrime;
+    }
+    return h;
+}
+
+uint64_t layout_fingerprint() {
+    uint64_t h = kFnvOffset;
+    h = fnv_fold(h, sizeof(ei_impulse_result_t));
+    h = fnv_fold(h, sizeof(ei_impulse_result_classification_t));
+    h = fnv_fold(h, sizeof(ei_impulse_result_bounding_box_t));
+    h = fnv_fold(h, offsetof(ei_impulse_result_t, classification));
+    h = fnv_fold(h, offsetof(ei_impulse_result_t, bounding_boxes));
+    h = fnv_fold(h, offsetof(ei_impulse_result_t, bounding_boxes_count));
+    h = fnv_fold(h, offsetof(ei_impulse_result_t, anomaly));
+    h = fnv_fold(h, offsetof(ei_impulse_result_t, timing));
+    h = fnv_fold(h, offsetof(ei_impulse_result_bounding_box_t, label));
+    h = fnv_fold(h, offsetof(ei_impulse_result_bounding_box_t, value));
+    h = fnv_fold(h, (uint64_t)EI_CLASSIFIER_LABEL_COUNT);
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    h = fnv_fold(h, offsetof(ei_impulse_result_t, visual_ad_grid_cells));
+    h = fnv_fold(h, offsetof(ei_impulse_result_t, visual_ad_count));
+#endif
+    return h;
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) uint32_t ei_ffi_abi_version(void) {
+    return EI_FFI_ABI_VERSION;
+}
+
+__attribute__((visibility("default"))) uint64_t ei_ffi_result_layout_fingerprint(void) {
+    static const uint64_t fingerprint = layout_fingerprint();
+    return fingerprint;
+}
+
+__attribute__((visibility("default"))) uint32_t ei_ffi_serialized_result_version(void) {
+    return EI_FFI_SERIALIZED_RESULT_VERSION;
+}
+
+} // extern "C"
@@ -0,0 +1,213 @@
+// Native time-series result aggregation for the Edge Impulse SDK FFI.
+//
+// Decision pipelines that vote over the last N inference results were
+// copying every result across the FFI boundary just to conclude, frame
+// after frame, that nothing changed. The aggregator consumes results
+// in-place on the invoke thread (via the ei_ffi_internal_aggregator_note
+// hook in edge_impulse_c_api.cpp) and only surfaces a callback when the
+// aggregate actually moves: the windowed top class changes, or the
+// smoothed anomaly score crosses the configured boundary. Steady-state
+// FFI traffic for the always-normal case drops to zero; the host can
+// still poll the current aggregate with ei_ffi_aggregator_read.
+//
+// Two policies. Majority keeps a ring of per-frame top classes and a
+// count per label, so the vote is O(labels) per frame with no rescan.
+// EWMA keeps exponentially weighted means of every class score and the
+// anomaly value, with alpha = 2 / (window + 1) so `window` reads as the
+// familiar effective averaging length.
+//
+// The callback runs synchronously on the invoke thread, between the
+// classify returning and ei_ffi_run_classifier returning -- keep it
+// short. Disabled cost on the invoke path is one relaxed load.
+#include "edge_impulse_wrapper.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct aggregator {
+    uint32_t window = 0;
+    int policy = EI_FFI_AGG_MAJORITY;
+    float boundary = -1.0f; // < 0: anomaly-crossing trigger disabled
+    ei_ffi_aggregate_cb cb = nullptr;
+    void* cb_user_data = nullptr;
+
+    // Majority state: ring of per-frame winners plus running counts.
+    std::vector<uint16_t> ring;
+    size_t ring_next = 0;
+    uint32_t counts[EI_CLASSIFIER_LABEL_COUNT] = { 0 };
+
+    // EWMA state.
+    float ewma[EI_CLASSIFIER_LABEL_COUNT] = { 0.0f };
+    float ewma_anomaly = 0.0f;
+
+    uint64_t frames = 0;
+    uint32_t last_top = (uint32_t)-1;
+    bool last_above = false;
+};
+
+std::mutex s_agg_mutex;
+aggregator* s_agg = nullptr;
+std::atomic<bool> s_agg_enabled{ false };
+
+uint32_t frame_top(const ei_impulse_result_t* result) {
+    uint32_t top = 0;
+    for (uint32_t ix = 1; ix < (uint32_t)EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (result->classification[ix].value > result->classification[top].value) {
+            top = ix;
+        }
+    }
+    return top;
+}
+
+// Fill `out` from the current state. Caller holds s_agg_mutex.
+void snapshot(const aggregator* agg, ei_ffi_aggregate_t* out) {
+    memset(out, 0, sizeof(*out));
+    out->window_count =
+        agg->frames < agg->window ? (uint32_t)agg->frames : agg->window;
+    if (agg->policy == EI_FFI_AGG_MAJORITY) {
+        uint32_t top = 0;
+        for (uint32_t ix = 1; ix < (uint32_t)EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            if (agg->counts[ix] > agg->counts[top]) {
+                top = ix;
+            }
+        }
+        out->top_index = top;
+        out->confidence = out->window_count > 0
+            ? (float)agg->counts[top] / (float)out->window_count
+            : 0.0f;
+    }
+    else {
+        uint32_t top = 0;
+        for (uint32_t ix = 1; ix < (uint32_t)EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            if (agg->ewma[ix] > agg->ewma[top]) {
+                top = ix;
+            }
+        }
+        out->top_index = top;
+        out->confidence = agg->ewma[top];
+    }
+    out->anomaly = agg->ewma_anomaly;
+}
+
+} // namespace
+
+// Called from edge_impulse_c_api.cpp after every successful classify.
+void ei_ffi_internal_aggregator_note(const ei_impulse_result_t* result) {
+    if (!s_agg_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ei_ffi_aggregate_cb cb = nullptr;
+    void* user_data = nullptr;
+    ei_ffi_aggregate_t agg_out;
+    {
+        std::lock_guard<std::mutex> lock(s_agg_mutex);
+        aggregator* agg = s_agg;
+        if (agg == nullptr) {
+            return;
+        }
+        const uint32_t top = frame_top(result);
+        if (agg->policy == EI_FFI_AGG_MAJORITY) {
+            if (agg->frames >= agg->window) {
+                agg->counts[agg->ring[agg->ring_next]]--;
+            }
+            agg->ring[agg->ring_next] = (uint16_t)top;
+            agg->ring_next = (agg->ring_next + 1) % agg->window;
+            agg->counts[top]++;
+        }
+        else {
+            const float alpha = 2.0f / ((float)agg->window + 1.0f);
+            for (uint32_t ix = 0; ix < (uint32_t)EI_CLASSIFIER_LABEL_COUNT; ix++) {
+                agg->ewma[ix] += alpha * (result->classification[ix].value - agg->ewma[ix]);
+            }
+        }
+#if EI_CLASSIFIER_HAS_ANOMALY
+        const float alpha = 2.0f / ((float)agg->window + 1.0f);
+        agg->ewma_anomaly += alpha * (result->anomaly - agg->ewma_anomaly);
+#endif
+        agg->frames++;
+
+        snapshot(agg, &agg_out);
+        const bool above = agg->boundary >= 0.0f && agg_out.anomaly >= agg->boundary;
+        const bool top_changed = agg_out.top_index != agg->last_top;
+        const bool crossed = above != agg->last_above;
+        agg->last_top = agg_out.top_index;
+        agg->last_above = above;
+        if ((top_changed || crossed) && agg->cb != nullptr) {
+            cb = agg->cb;
+            user_data = agg->cb_user_data;
+        }
+    }
+    // Deliver outside the lock so the callback may call aggregator_read.
+    if (cb != nullptr) {
+        cb(&agg_out, user_data);
+    }
+}
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_aggregator_create(uint32_t window, int policy) {
+    if (window == 0 || window > 65536 ||
+        (policy != EI_FFI_AGG_MAJORITY && policy != EI_FFI_AGG_EWMA)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_agg_mutex);
+    delete s_agg;
+    s_agg = new aggregator();
+    s_agg->window = window;
+    s_agg->policy = policy;
+    if (policy == EI_FFI_AGG_MAJORITY) {
+        s_agg->ring.assign(window, 0);
+    }
+    s_agg_enabled.store(true, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+// Callback fires on the invoke thread whenever the aggregated top class
+// changes or the smoothed anomaly crosses the boundary (either way).
+// NULL unregisters; polling via ei_ffi_aggregator_read keeps working.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_aggregator_set_callback(ei_ffi_aggregate_cb cb, void* user_data) {
+    std::lock_guard<std::mutex> lock(s_agg_mutex);
+    if (s_agg == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_agg->cb = cb;
+    s_agg->cb_user_data = user_data;
+    return EI_IMPULSE_OK;
+}
+
+// Boundary for the anomaly-crossing trigger; < 0 disables it (the
+// default), leaving only top-class changes as callback causes.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_aggregator_set_boundary(float boundary) {
+    std::lock_guard<std::mutex> lock(s_agg_mutex);
+    if (s_agg == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_agg->boundary = boundary;
+    return EI_IMPULSE_OK;
+}
+
+// Poll the current aggregate without waiting for a callback.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_aggregator_read(ei_ffi_aggregate_t* out) {
+    if (out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_agg_mutex);
+    if (s_agg == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    snapshot(s_agg, out);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_aggregator_destroy(void) {
+    std::lock_guard<std::mutex> lock(s_agg_mutex);
+    s_agg_enabled.store(false, std::memory_order_release);
+    delete s_agg;
+    s_agg = nullptr;
+}
+
+} // extern "C"
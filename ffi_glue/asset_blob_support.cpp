@@ -0,0 +1,86 @@
+// fread-free embedded filesystem for auxiliary model assets.
+//
+// The model weights already link in through INCBIN, but smaller assets
+// (anomaly cluster data, tracker configs) historically loaded through
+// stdio at init -- on slow eMMC that is ~120 ms of fopen/fread before the
+// first inference. build.rs now consolidates every auxiliary data file in
+// the model folder into one blob (ei_ffi_assets.blob) plus a generated
+// offset index (ei_ffi_asset_index.h); this TU links the blob page-aligned
+// into the read-only segment and serves lookups from it, so initialization
+// does zero file I/O.
+//
+// Asset names are paths relative to the model folder, forward slashes.
+// The index header only exists after build.rs has run against a model, so
+// everything degrades to an empty catalogue in its absence.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cstring>
+
+#if defined(__has_include)
+#if __has_include("ei_ffi_asset_index.h")
+#include "ei_ffi_asset_index.h"
+#endif
+#endif
+
+#if defined(EI_FFI_ASSET_COUNT) && EI_FFI_ASSET_COUNT > 0
+
+// Link the blob page-aligned into the read-only segment -- the same
+// mechanism INCBIN uses for the model data, inlined here so the section
+// name, alignment and Mach-O symbol prefix stay in one place.
+#if defined(__APPLE__)
+__asm__(".section __TEXT,__const\n"
+        ".p2align 12\n"
+        ".globl _ei_ffi_asset_blob\n"
+        "_ei_ffi_asset_blob:\n"
+        ".incbin \"" EI_FFI_ASSET_BLOB_PATH "\"\n");
+#else
+__asm__(".section .rodata\n"
+        ".balign 4096\n"
+        ".globl ei_ffi_asset_blob\n"
+        "ei_ffi_asset_blob:\n"
+        ".incbin \"" EI_FFI_ASSET_BLOB_PATH "\"\n"
+        ".previous\n");
+#endif
+extern "C" const uint8_t ei_ffi_asset_blob[];
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_asset_lookup(const char* name, const uint8_t** data, size_t* size) {
+    if (name == nullptr || data == nullptr || size == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t ix = 0; ix < EI_FFI_ASSET_COUNT; ix++) {
+        if (strcmp(ei_ffi_asset_index[ix].name, name) == 0) {
+            *data = ei_ffi_asset_blob + ei_ffi_asset_index[ix].offset;
+            *size = (size_t)ei_ffi_asset_index[ix].size;
+            return EI_IMPULSE_OK;
+        }
+    }
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) size_t ei_ffi_asset_count(void) {
+    return (size_t)EI_FFI_ASSET_COUNT;
+}
+
+__attribute__((visibility("default"))) const char* ei_ffi_asset_name(size_t ix) {
+    if (ix >= EI_FFI_ASSET_COUNT) {
+        return nullptr;
+    }
+    return ei_ffi_asset_index[ix].name;
+}
+
+#else // no generated index: empty catalogue
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_asset_lookup(const char*, const uint8_t**, size_t*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) size_t ei_ffi_asset_count(void) {
+    return 0;
+}
+
+__attribute__((visibility("default"))) const char* ei_ffi_asset_name(size_t) {
+    return nullptr;
+}
+
+#endif // EI_FFI_ASSET_COUNT
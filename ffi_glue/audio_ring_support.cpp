@@ -0,0 +1,651 @@
+// Audio ring buffer with fused int16 -> float conversion.
+//
+// Live audio paths (ALSA capture, WAV replay) convert int16 samples to the
+// classifier's float domain sample-by-sample on the caller's side; on armv7
+// that conversion alone is a measurable slice of the DSP-stage cost. The
+// ring here fuses conversion, scaling, optional sample-rate decimation
+// (ei_ffi_audio_ring_set_input_rate), DC-offset removal and buffering into
+// one NEON/SSE2 pass as samples are pushed, and hands the continuous
+// classifier a signal_t that reads converted floats straight out of the
+// ring -- no intermediate copy on either side.
+//
+// Single producer (the capture thread calling ei_ffi_audio_push_i16),
+// single consumer (the inference thread building signals and consuming
+// slices); the cursors use the same acquire/release scheme as the frame
+// queue. When the ring is full, push writes what fits and reports it --
+// drop-not-block, the capture callback must never stall.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define EI_FFI_HAVE_NEON 1
+#endif
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EI_FFI_HAVE_SSE2 1
+#endif
+
+namespace {
+
+constexpr float kI16Scale = 1.0f / 32768.0f;
+
+// Per-push-block DC estimate update weight. With typical capture block
+// sizes (256-1024 samples) this behaves like a one-pole high-pass slow
+// enough to leave speech untouched while absorbing mic bias.
+constexpr float kDcAlpha = 0.05f;
+
+struct audio_ring {
+    std::vector<float> storage;
+    size_t capacity = 0; // power of two
+    std::atomic<uint64_t> write{0}; // absolute sample counts
+    std::atomic<uint64_t> read{0};
+    float dc = 0.0f; // producer-owned
+
+    // Incremental window normalization. The running sums (producer-owned,
+    // double so add/subtract drift stays below float noise) cover the most
+    // recent norm_window pushed samples: each push adds the new slice and
+    // subtracts the slice that fell out, O(slice) instead of an O(window)
+    // recompute despite the ~90% overlap of consecutive windows. The
+    // derived stats are published through the atomics for the consumer.
+    size_t norm_window = 0;
+    uint64_t norm_start = 0;
+    double norm_sum = 0.0;
+    double norm_sumsq = 0.0;
+    std::atomic<float> norm_mean{0.0f};
+    std::atomic<float> norm_inv_std{1.0f};
+
+    // Polyphase decimation state (producer-owned). decim == 1 is the
+    // passthrough path; otherwise fir_buf carries the converted input
+    // tail across pushes (at most taps - 1 samples), fir_next is the
+    // fir_buf index of the next output window's last sample, and
+    // stage_out is reused scratch for one push's decimated output.
+    size_t decim = 1;
+    std::vector<float> fir_taps;
+    std::vector<float> fir_buf;
+    std::vector<float> stage_out;
+    size_t fir_next = 0;
+};
+
+static audio_ring s_audio;
+
+// Convert one contiguous block: dst[i] = src[i] * kI16Scale - dc, and
+// return the sum of the scaled (pre-subtraction) values for the DC update.
+float convert_block(const int16_t* src, float* dst, size_t n, float dc) {
+    float sum = 0.0f;
+    size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    float32x4_t scale_v = vdupq_n_f32(kI16Scale);
+    float32x4_t dc_v = vdupq_n_f32(dc);
+    float32x4_t sum_v = vdupq_n_f32(0.0f);
+    for (; ix + 8 <= n; ix += 8) {
+        int16x8_t raw = vld1q_s16(src + ix);
+        float32x4_t lo = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(raw))), scale_v);
+        float32x4_t hi = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(raw))), scale_v);
+        sum_v = vaddq_f32(sum_v, vaddq_f32(lo, hi));
+        vst1q_f32(dst + ix, vsubq_f32(lo, dc_v));
+        vst1q_f32(dst + ix + 4, vsubq_f32(hi, dc_v));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sum_v);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128 scale_v = _mm_set1_ps(kI16Scale);
+    __m128 dc_v = _mm_set1_ps(dc);
+    __m128 sum_v = _mm_setzero_ps();
+    for (; ix + 8 <= n; ix += 8) {
+        __m128i raw = _mm_loadu_si128((const __m128i*)(src + ix));
+        // Sign-extend via unpack-with-self then arithmetic shift.
+        __m128i lo_i = _mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16);
+        __m128i hi_i = _mm_srai_epi32(_mm_unpackhi_epi16(raw, raw), 16);
+        __m128 lo = _mm_mul_ps(_mm_cvtepi32_ps(lo_i), scale_v);
+        __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(hi_i), scale_v);
+        sum_v = _mm_add_ps(sum_v, _mm_add_ps(lo, hi));
+        _mm_storeu_ps(dst + ix, _mm_sub_ps(lo, dc_v));
+        _mm_storeu_ps(dst + ix + 4, _mm_sub_ps(hi, dc_v));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum_v);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; ix < n; ix++) {
+        float v = (float)src[ix] * kI16Scale;
+        sum += v;
+        dst[ix] = v - dc;
+    }
+    return sum;
+}
+
+// Float-source twin of convert_block for the resampled path: the samples
+// are already in the classifier's domain, only the DC subtraction and
+// the sum for the EWMA update remain.
+float copy_block(const float* src, float* dst, size_t n, float dc) {
+    float sum = 0.0f;
+    size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    float32x4_t dc_v = vdupq_n_f32(dc);
+    float32x4_t sum_v = vdupq_n_f32(0.0f);
+    for (; ix + 4 <= n; ix += 4) {
+        float32x4_t v = vld1q_f32(src + ix);
+        sum_v = vaddq_f32(sum_v, v);
+        vst1q_f32(dst + ix, vsubq_f32(v, dc_v));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sum_v);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128 dc_v = _mm_set1_ps(dc);
+    __m128 sum_v = _mm_setzero_ps();
+    for (; ix + 4 <= n; ix += 4) {
+        __m128 v = _mm_loadu_ps(src + ix);
+        sum_v = _mm_add_ps(sum_v, v);
+        _mm_storeu_ps(dst + ix, _mm_sub_ps(v, dc_v));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum_v);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; ix < n; ix++) {
+        sum += src[ix];
+        dst[ix] = src[ix] - dc;
+    }
+    return sum;
+}
+
+// Dense FIR dot product over one output window.
+float fir_dot(const float* x, const float* taps, size_t n) {
+    float acc = 0.0f;
+    size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    float32x4_t acc_v = vdupq_n_f32(0.0f);
+    for (; ix + 4 <= n; ix += 4) {
+        acc_v = vmlaq_f32(acc_v, vld1q_f32(x + ix), vld1q_f32(taps + ix));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, acc_v);
+    acc = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128 acc_v = _mm_setzero_ps();
+    for (; ix + 4 <= n; ix += 4) {
+        acc_v = _mm_add_ps(acc_v, _mm_mul_ps(_mm_loadu_ps(x + ix),
+                                             _mm_loadu_ps(taps + ix)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc_v);
+    acc = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; ix < n; ix++) {
+        acc += x[ix] * taps[ix];
+    }
+    return acc;
+}
+
+// Append one block -- int16 (converted via convert_block) or, on the
+// resampled path, float (via copy_block) -- clamped to free space, with
+// the DC update, norm-window bookkeeping and the wrap handled here.
+// Exactly one of s16 / f32 is non-null. Returns the samples appended.
+size_t ring_append(const int16_t* s16, const float* f32, size_t n) {
+    uint64_t write = s_audio.write.load(std::memory_order_relaxed);
+    uint64_t read = s_audio.read.load(std::memory_order_acquire);
+    size_t free_samples = s_audio.capacity - (size_t)(write - read);
+    if (n > free_samples) {
+        n = free_samples;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t mask = s_audio.capacity - 1;
+
+    // Retire samples leaving the normalization window before this push
+    // overwrites any storage, while their values are still intact.
+    uint64_t add_from = write;
+    if (s_audio.norm_window > 0 && write + n - s_audio.norm_start > s_audio.norm_window) {
+        uint64_t expire_end = write + n - s_audio.norm_window;
+        uint64_t expire_begin = write - s_audio.norm_start > s_audio.norm_window
+            ? write - s_audio.norm_window
+            : s_audio.norm_start;
+        uint64_t old_end = expire_end < write ? expire_end : write;
+        for (uint64_t ix = expire_begin; ix < old_end; ix++) {
+            double v = s_audio.storage[(size_t)(ix & mask)];
+            s_audio.norm_sum -= v;
+            s_audio.norm_sumsq -= v * v;
+        }
+        // Samples of this very slice that already fall outside the window
+        // (slice longer than the window) are never added below.
+        if (expire_end > add_from) {
+            add_from = expire_end;
+        }
+    }
+
+    size_t pos = (size_t)(write & mask);
+    size_t first = n < s_audio.capacity - pos ? n : s_audio.capacity - pos;
+    float sum = s16 != nullptr
+        ? convert_block(s16, &s_audio.storage[pos], first, s_audio.dc)
+        : copy_block(f32, &s_audio.storage[pos], first, s_audio.dc);
+    if (n > first) {
+        sum += s16 != nullptr
+            ? convert_block(s16 + first, &s_audio.storage[0], n - first, s_audio.dc)
+            : copy_block(f32 + first, &s_audio.storage[0], n - first, s_audio.dc);
+    }
+    // Block-mean EWMA; the next push subtracts the refreshed estimate.
+    s_audio.dc += kDcAlpha * (sum / (float)n - s_audio.dc);
+
+    if (s_audio.norm_window > 0) {
+        for (uint64_t ix = add_from; ix < write + n; ix++) {
+            double v = s_audio.storage[(size_t)(ix & mask)];
+            s_audio.norm_sum += v;
+            s_audio.norm_sumsq += v * v;
+        }
+        uint64_t total = write + n - s_audio.norm_start;
+        size_t count = total < s_audio.norm_window ? (size_t)total : s_audio.norm_window;
+        double mean = s_audio.norm_sum / (double)count;
+        double var = s_audio.norm_sumsq / (double)count - mean * mean;
+        if (var < 1e-12) {
+            var = 1e-12; // silence: normalize to zero rather than blow up
+        }
+        s_audio.norm_mean.store((float)mean, std::memory_order_relaxed);
+        s_audio.norm_inv_std.store((float)(1.0 / sqrt(var)), std::memory_order_relaxed);
+    }
+
+    s_audio.write.store(write + n, std::memory_order_release);
+    return n;
+}
+
+} // namespace
+
+extern "C" {
+
+// Size the ring in samples; rounded up to a power of two. Re-creating
+// drops any buffered audio.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_audio_ring_create(size_t capacity) {
+    if (capacity == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    s_audio.storage.assign(rounded, 0.0f);
+    s_audio.capacity = rounded;
+    s_audio.write.store(0, std::memory_order_relaxed);
+    s_audio.read.store(0, std::memory_order_relaxed);
+    s_audio.dc = 0.0f;
+    s_audio.norm_window = 0;
+    s_audio.norm_start = 0;
+    s_audio.norm_sum = 0.0;
+    s_audio.norm_sumsq = 0.0;
+    s_audio.norm_mean.store(0.0f, std::memory_order_relaxed);
+    s_audio.norm_inv_std.store(1.0f, std::memory_order_relaxed);
+    s_audio.decim = 1;
+    s_audio.fir_taps.clear();
+    s_audio.fir_buf.clear();
+    s_audio.fir_next = 0;
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_audio_ring_destroy(void) {
+    s_audio.storage.clear();
+    s_audio.storage.shrink_to_fit();
+    s_audio.capacity = 0;
+    s_audio.write.store(0, std::memory_order_relaxed);
+    s_audio.read.store(0, std::memory_order_relaxed);
+    s_audio.norm_window = 0;
+    s_audio.norm_start = 0;
+    s_audio.norm_sum = 0.0;
+    s_audio.norm_sumsq = 0.0;
+    s_audio.decim = 1;
+    s_audio.fir_taps.clear();
+    s_audio.fir_buf.clear();
+    s_audio.fir_next = 0;
+}
+
+// Producer side: convert, scale to [-1, 1), remove DC and append in one
+// pass. Returns the number of samples accepted -- less than `n` when the
+// consumer has fallen behind (the rest of the block is dropped). With an
+// input rate configured, `samples` are at that rate, the decimator runs
+// before the ring, and the return value is the input-domain equivalent
+// of what was appended (decim * appended output samples).
+__attribute__((visibility("default"))) size_t ei_ffi_audio_push_i16(const int16_t* samples, size_t n) {
+    if (samples == nullptr || s_audio.capacity == 0) {
+        return 0;
+    }
+    if (s_audio.decim > 1) {
+        // Convert the block once, appended after the carried tail, then
+        // evaluate the FIR only at output positions -- that is the whole
+        // polyphase trick for plain decimation.
+        const size_t taps = s_audio.fir_taps.size();
+        size_t base = s_audio.fir_buf.size();
+        s_audio.fir_buf.resize(base + n);
+        convert_block(samples, s_audio.fir_buf.data() + base, n, 0.0f);
+
+        s_audio.stage_out.clear();
+        while (s_audio.fir_next < s_audio.fir_buf.size()) {
+            s_audio.stage_out.push_back(
+                fir_dot(&s_audio.fir_buf[s_audio.fir_next + 1 - taps],
+                        s_audio.fir_taps.data(), taps));
+            s_audio.fir_next += s_audio.decim;
+        }
+        // Carry the last taps - 1 samples into the next push.
+        size_t keep = s_audio.fir_buf.size() < taps - 1 ? s_audio.fir_buf.size()
+                                                        : taps - 1;
+        size_t drop = s_audio.fir_buf.size() - keep;
+        s_audio.fir_buf.erase(s_audio.fir_buf.begin(),
+                              s_audio.fir_buf.begin() + drop);
+        s_audio.fir_next -= drop;
+
+        return s_audio.decim *
+               ring_append(nullptr, s_audio.stage_out.data(),
+                           s_audio.stage_out.size());
+    }
+    return ring_append(samples, nullptr, n);
+}
+
+// Enable (input_rate != model rate) or disable the built-in sample-rate
+// conversion stage. Only integer decimation factors are supported (48 kHz
+// or 32 kHz capture into a 16 kHz model, and the like); the anti-aliasing
+// FIR is a Hamming-windowed sinc, 8 * factor + 1 taps, cut off 10% below
+// the output Nyquist. Producer-owned state -- call from the producer
+// thread or before pushing starts.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_audio_ring_set_input_rate(uint32_t input_rate_hz) {
+    if (s_audio.capacity == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const uint32_t model_rate = (uint32_t)EI_CLASSIFIER_FREQUENCY;
+    if (input_rate_hz == 0 || input_rate_hz == model_rate) {
+        s_audio.decim = 1;
+        s_audio.fir_taps.clear();
+        s_audio.fir_buf.clear();
+        s_audio.fir_next = 0;
+        return EI_IMPULSE_OK;
+    }
+    if (model_rate == 0 || input_rate_hz % model_rate != 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const size_t decim = input_rate_hz / model_rate;
+    const size_t taps = 8 * decim + 1;
+
+    // Windowed-sinc low-pass at wc = 0.45 / decim of the input rate,
+    // normalized to unity DC gain so levels match the passthrough path.
+    s_audio.fir_taps.assign(taps, 0.0f);
+    const double wc = 0.45 / (double)decim;
+    const double center = (double)(taps - 1) / 2.0;
+    double tap_sum = 0.0;
+    for (size_t ix = 0; ix < taps; ix++) {
+        double k = (double)ix - center;
+        double sinc = k == 0.0 ? 2.0 * wc
+                               : sin(2.0 * M_PI * wc * k) / (M_PI * k);
+        double window = 0.54 - 0.46 * cos(2.0 * M_PI * (double)ix / (double)(taps - 1));
+        s_audio.fir_taps[ix] = (float)(sinc * window);
+        tap_sum += s_audio.fir_taps[ix];
+    }
+    for (size_t ix = 0; ix < taps; ix++) {
+        s_audio.fir_taps[ix] = (float)(s_audio.fir_taps[ix] / tap_sum);
+    }
+
+    s_audio.decim = decim;
+    s_audio.fir_buf.clear();
+    s_audio.fir_buf.reserve(taps + 4096);
+    s_audio.stage_out.reserve(4096 / decim + 1);
+    s_audio.fir_next = taps - 1;
+    return EI_IMPULSE_OK;
+}
+
+// Converted samples buffered and not yet consumed.
+__attribute__((visibility("default"))) size_t ei_ffi_audio_ring_available(void) {
+    if (s_audio.capacity == 0) {
+        return 0;
+    }
+    uint64_t write = s_audio.write.load(std::memory_order_acquire);
+    uint64_t read = s_audio.read.load(std::memory_order_acquire);
+    return (size_t)(write - read);
+}
+
+// Build a signal over the next `window` buffered samples (starting at the
+// read cursor) without consuming them; reads past what is buffered come
+// back zero-filled. Typical continuous loop: wait until available >= slice,
+// build the signal, run the classifier, then consume the slice.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_audio_ring_signal(signal_t* signal, size_t window) {
+    if (signal == nullptr || s_audio.capacity == 0 || window == 0 || window > s_audio.capacity) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    signal->total_length = window;
+    signal->get_data = [](size_t offset, size_t length, float* out_ptr) -> int {
+        uint64_t read = s_audio.read.load(std::memory_order_relaxed);
+        uint64_t write = s_audio.write.load(std::memory_order_acquire);
+        size_t available = (size_t)(write - read);
+        size_t mask = s_audio.capacity - 1;
+        for (size_t ix = 0; ix < length; ix++) {
+            size_t sample = offset + ix;
+            out_ptr[ix] = sample < available
+                ? s_audio.storage[(size_t)((read + sample) & mask)]
+                : 0.0f;
+        }
+        return 0;
+    };
+    return EI_IMPULSE_OK;
+}
+
+// Consumer side: release `n` samples (clamped to what is buffered) so the
+// producer can reuse the space.
+__attribute__((visibility("default"))) void ei_ffi_audio_ring_consume(size_t n) {
+    if (s_audio.capacity == 0) {
+        return;
+    }
+    uint64_t write = s_audio.write.load(std::memory_order_acquire);
+    uint64_t read = s_audio.read.load(std::memory_order_relaxed);
+    size_t available = (size_t)(write - read);
+    s_audio.read.store(read + (n < available ? n : available), std::memory_order_release);
+}
+
+// Enable (window > 0) or disable (window == 0) incremental mean/variance
+// tracking over the most recent `window` pushed samples. The sums are
+// producer-owned, so call this from the producer thread or before pushing
+// starts; enabling resets the stats and they warm up over the next window.
+// The window must fit in the ring so expired samples are still in storage
+// when they are subtracted.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_audio_ring_set_norm(size_t window) {
+    if (s_audio.capacity == 0 || window > s_audio.capacity) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_audio.norm_window = window;
+    s_audio.norm_start = s_audio.write.load(std::memory_order_relaxed);
+    s_audio.norm_sum = 0.0;
+    s_audio.norm_sumsq = 0.0;
+    s_audio.norm_mean.store(0.0f, std::memory_order_relaxed);
+    s_audio.norm_inv_std.store(1.0f, std::memory_order_relaxed);
+    return EI_IMPULSE_OK;
+}
+
+// Current normalization stats as maintained by the producer. Either output
+// pointer may be null.
+__attribute__((visibility("default"))) void ei_ffi_audio_ring_norm_stats(float* mean_out, float* std_out) {
+    float mean = s_audio.norm_mean.load(std::memory_order_relaxed);
+    float inv_std = s_audio.norm_inv_std.load(std::memory_order_relaxed);
+    if (mean_out != nullptr) {
+        *mean_out = mean;
+    }
+    if (std_out != nullptr) {
+        *std_out = 1.0f / inv_std;
+    }
+}
+
+// Like ei_ffi_audio_ring_signal, but samples come back normalized with the
+// incrementally maintained stats: (x - mean) * inv_std. The stats are read
+// once per get_data call, so a window is self-consistent even while the
+// producer keeps pushing.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_audio_ring_signal_normalized(signal_t* signal, size_t window) {
+    if (signal == nullptr || s_audio.capacity == 0 || window == 0 || window > s_audio.capacity ||
+        s_audio.norm_window == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    signal->total_length = window;
+    signal->get_data = [](size_t offset, size_t length, float* out_ptr) -> int {
+        uint64_t read = s_audio.read.load(std::memory_order_relaxed);
+        uint64_t write = s_audio.write.load(std::memory_order_acquire);
+        float mean = s_audio.norm_mean.load(std::memory_order_relaxed);
+        float inv_std = s_audio.norm_inv_std.load(std::memory_order_relaxed);
+        size_t available = (size_t)(write - read);
+        size_t mask = s_audio.capacity - 1;
+        for (size_t ix = 0; ix < length; ix++) {
+            size_t sample = offset + ix;
+            out_ptr[ix] = sample < available
+                ? (s_audio.storage[(size_t)((read + sample) & mask)] - mean) * inv_std
+                : 0.0f;
+        }
+        return 0;
+    };
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
+
+// ---------------------------------------------------------------------------
+// Dedicated DSP/stream thread with real-time scheduling
+//
+// run_classifier_continuous otherwise runs on whatever application thread
+// calls it and gets preempted mid-window under load, overrunning the slice
+// deadline and dropping audio. The stream thread here owns the continuous
+// loop -- wait for a slice in the ring, classify, consume -- and can be
+// pinned to a core and lifted to SCHED_FIFO/SCHED_RR so the feature
+// pipeline keeps its slice deadline regardless of what the rest of the
+// process is doing. Elevating priority needs CAP_SYS_NICE (or root) on
+// Linux; call ei_ffi_stream_set_sched while the stream is running to get
+// the failure back as an error code.
+// ---------------------------------------------------------------------------
+
+#include <chrono>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+
+// Defined in power_hint_support.cpp: lets ei_ffi_power_hint clamp the
+// stream thread's frequency during bursts.
+extern "C" void ei_ffi_internal_power_register_thread(void);
+
+namespace {
+
+struct stream_state {
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::mutex config_mutex; // start/stop and sched fields
+    int core = -1;           // < 0: no pinning
+    int policy = EI_FFI_SCHED_OTHER;
+    int priority = 0;
+};
+
+static stream_state s_stream;
+
+int native_policy(int policy) {
+    switch (policy) {
+        case EI_FFI_SCHED_FIFO: return SCHED_FIFO;
+        case EI_FFI_SCHED_RR: return SCHED_RR;
+        default: return SCHED_OTHER;
+    }
+}
+
+// Apply pinning + scheduling to `handle`; caller holds config_mutex.
+EI_IMPULSE_ERROR apply_stream_sched(pthread_t handle) {
+#if defined(__linux__)
+    if (s_stream.core >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(s_stream.core, &set);
+        if (pthread_setaffinity_np(handle, sizeof(set), &set) != 0) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+#endif
+    int policy = native_policy(s_stream.policy);
+    struct sched_param param = {};
+    if (policy != SCHED_OTHER) {
+        int lo = sched_get_priority_min(policy);
+        int hi = sched_get_priority_max(policy);
+        int prio = s_stream.priority;
+        param.sched_priority = prio < lo ? lo : (prio > hi ? hi : prio);
+    }
+    if (pthread_setschedparam(handle, policy, &param) != 0) {
+        return EI_IMPULSE_INFERENCE_ERROR; // typically EPERM without CAP_SYS_NICE
+    }
+    return EI_IMPULSE_OK;
+}
+
+void stream_main(size_t slice, ei_ffi_completion_cb callback, void* user_data, int debug) {
+    ei_ffi_internal_power_register_thread();
+    while (s_stream.running.load(std::memory_order_acquire)) {
+        if (ei_ffi_audio_ring_available() < slice) {
+            // The producer side is lock-free, so there is no condvar to
+            // wait on; half a millisecond of poll granularity is noise
+            // against a 16 ms slice.
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            continue;
+        }
+        signal_t signal;
+        if (ei_ffi_audio_ring_signal(&signal, slice) != EI_IMPULSE_OK) {
+            break;
+        }
+        ei_impulse_result_t result = {};
+        EI_IMPULSE_ERROR status = ::run_classifier_continuous(&signal, &result, debug, 1);
+        ei_ffi_audio_ring_consume(slice);
+        if (callback != nullptr) {
+            callback(status, &result, user_data);
+        }
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+// Stores the pinning/priority configuration; when the stream thread is
+// already running it is re-applied immediately and failures (EPERM, bad
+// core index) come back as an error.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_stream_set_sched(int core, int policy, int prio) {
+    if (policy != EI_FFI_SCHED_OTHER && policy != EI_FFI_SCHED_FIFO && policy != EI_FFI_SCHED_RR) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_stream.config_mutex);
+    s_stream.core = core;
+    s_stream.policy = policy;
+    s_stream.priority = prio;
+    if (s_stream.running.load(std::memory_order_relaxed)) {
+        return apply_stream_sched(s_stream.thread.native_handle());
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Starts the dedicated DSP thread. The audio ring must exist; each loop
+// iteration classifies one `slice_length`-sample slice and fires the
+// callback from the stream thread (same validity rules as the async
+// callbacks). The stored sched config is applied at start, best-effort.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_stream_start(size_t slice_length, ei_ffi_completion_cb callback, void* user_data, int debug) {
+    if (slice_length == 0 || s_audio.capacity == 0 || slice_length > s_audio.capacity) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_stream.config_mutex);
+    if (s_stream.running.load(std::memory_order_relaxed)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_stream.running.store(true, std::memory_order_release);
+    s_stream.thread = std::thread(stream_main, slice_length, callback, user_data, debug);
+    apply_stream_sched(s_stream.thread.native_handle());
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_stream_stop(void) {
+    std::lock_guard<std::mutex> lock(s_stream.config_mutex);
+    if (!s_stream.running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    s_stream.running.store(false, std::memory_order_release);
+    s_stream.thread.join();
+}
+
+} // extern "C"
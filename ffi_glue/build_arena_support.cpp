@@ -0,0 +1,218 @@
+// Build-arena allocation for interpreter construction.
+//
+// Interpreter construction allocates tens of thousands of small metadata
+// objects (node/tensor vectors, registration tables, subgraph state), and
+// on armv7 boxes with slow allocators that dominates init and fragments
+// the heap -- which the hot-swap path then pays for again. The TFLite
+// translation units doing the allocating ship prebuilt, so they cannot be
+// taught about an arena; instead, EI_BUILD_ARENA=1 builds interpose the
+// global operator new/delete for this library and route allocations made
+// inside an explicit scope through a grow-only bump arena:
+//
+//   ei_ffi_build_arena_begin();
+//   ei_ffi_run_classifier_init();   // or hot swap + re-init
+//   ei_ffi_build_arena_end();
+//   ...
+//   ei_ffi_run_classifier_deinit();
+//   ei_ffi_build_arena_release();   // frees every block wholesale
+//
+// The scope is thread-local, so only the constructing thread is routed;
+// other threads (and the same thread outside the scope) go straight to
+// malloc. Deleting an arena pointer is a no-op -- the memory is reclaimed
+// wholesale by release, which must only run after the interpreter built
+// inside the scope has been destroyed. Coverage note: this catches the
+// C++-side metadata (the bulk of the small-alloc storm); TfLiteIntArrays
+// allocated through C malloc in the prebuilt runtime still hit the system
+// allocator, which is why this is an arena, not a full interposer.
+#include "edge_impulse_wrapper.h"
+
+#if defined(EI_FFI_BUILD_ARENA)
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace {
+
+constexpr size_t kBlockBytes = 256 * 1024;
+constexpr size_t kMaxBlocks = 256; // 64 MB ceiling, far past any model
+constexpr size_t kAlign = 16;
+
+// Block registry: starts/ends are published once and never move, so the
+// delete-path membership test is a lock-free scan over a few entries.
+std::atomic<uintptr_t> s_block_start[kMaxBlocks];
+std::atomic<uintptr_t> s_block_end[kMaxBlocks];
+std::atomic<size_t> s_block_count{0};
+std::atomic<size_t> s_arena_bytes{0};
+
+std::mutex s_grow_mutex;
+uint8_t* s_bump = nullptr;   // current block cursor (under s_grow_mutex)
+size_t s_bump_left = 0;
+
+thread_local bool s_in_scope = false;
+
+void* arena_alloc(size_t size, size_t align) {
+    if (align < kAlign) {
+        align = kAlign;
+    }
+    std::lock_guard<std::mutex> lock(s_grow_mutex);
+    uintptr_t p = ((uintptr_t)s_bump + align - 1) & ~(uintptr_t)(align - 1);
+    size_t pad = p - (uintptr_t)s_bump;
+    if (s_bump == nullptr || pad + size > s_bump_left) {
+        const size_t count = s_block_count.load(std::memory_order_relaxed);
+        const size_t want = size + align > kBlockBytes ? size + align : kBlockBytes;
+        if (count >= kMaxBlocks) {
+            return nullptr; // registry full: spill to malloc
+        }
+        uint8_t* block = (uint8_t*)malloc(want);
+        if (block == nullptr) {
+            return nullptr;
+        }
+        s_block_start[count].store((uintptr_t)block, std::memory_order_relaxed);
+        s_block_end[count].store((uintptr_t)block + want, std::memory_order_release);
+        s_block_count.store(count + 1, std::memory_order_release);
+        s_arena_bytes.fetch_add(want, std::memory_order_relaxed);
+        s_bump = block;
+        s_bump_left = want;
+        p = ((uintptr_t)s_bump + align - 1) & ~(uintptr_t)(align - 1);
+        pad = p - (uintptr_t)s_bump;
+    }
+    s_bump += pad + size;
+    s_bump_left -= pad + size;
+    return (void*)p;
+}
+
+bool arena_owns(void* ptr) {
+    const size_t count = s_block_count.load(std::memory_order_acquire);
+    if (count == 0) {
+        return false;
+    }
+    const uintptr_t p = (uintptr_t)ptr;
+    for (size_t ix = 0; ix < count; ix++) {
+        if (p >= s_block_start[ix].load(std::memory_order_relaxed) &&
+            p < s_block_end[ix].load(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void* route_new(size_t size, size_t align) {
+    if (s_in_scope) {
+        void* p = arena_alloc(size, align);
+        if (p != nullptr) {
+            return p;
+        }
+        // Oversized or registry full: fall through to the system allocator.
+    }
+    return align > alignof(std::max_align_t) ? aligned_alloc(align, (size + align - 1) & ~(align - 1))
+                                             : malloc(size);
+}
+
+void route_delete(void* ptr) {
+    if (ptr == nullptr || arena_owns(ptr)) {
+        return;
+    }
+    free(ptr);
+}
+
+} // namespace
+
+// Global replacements. Every variant funnels through route_new /
+// route_delete so arena pointers are recognized no matter which form the
+// (prebuilt) caller uses.
+void* operator new(size_t size) {
+    void* p = route_new(size, alignof(std::max_align_t));
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return route_new(size, alignof(std::max_align_t));
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return route_new(size, alignof(std::max_align_t));
+}
+void* operator new(size_t size, std::align_val_t align) {
+    void* p = route_new(size, (size_t)align);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void* operator new[](size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+void operator delete(void* ptr) noexcept { route_delete(ptr); }
+void operator delete[](void* ptr) noexcept { route_delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { route_delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { route_delete(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { route_delete(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { route_delete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { route_delete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { route_delete(ptr); }
+
+extern "C" {
+
+// Route this thread's allocations through the build arena until end.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_build_arena_begin(void) {
+    s_in_scope = true;
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_build_arena_end(void) {
+    s_in_scope = false;
+}
+
+// Free every arena block wholesale. Only call after the interpreter(s)
+// constructed inside arena scopes have been destroyed; their metadata
+// lives here.
+__attribute__((visibility("default"))) void ei_ffi_build_arena_release(void) {
+    std::lock_guard<std::mutex> lock(s_grow_mutex);
+    const size_t count = s_block_count.load(std::memory_order_acquire);
+    // Unpublish before freeing so a concurrent delete cannot classify a
+    // just-freed block as arena-owned.
+    s_block_count.store(0, std::memory_order_release);
+    for (size_t ix = 0; ix < count; ix++) {
+        free((void*)s_block_start[ix].load(std::memory_order_relaxed));
+    }
+    s_arena_bytes.store(0, std::memory_order_relaxed);
+    s_bump = nullptr;
+    s_bump_left = 0;
+}
+
+// Bytes currently reserved by the arena (block granularity).
+__attribute__((visibility("default"))) size_t ei_ffi_build_arena_bytes(void) {
+    return s_arena_bytes.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
+
+#else // !EI_FFI_BUILD_ARENA
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_build_arena_begin(void) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_build_arena_end(void) {
+}
+
+__attribute__((visibility("default"))) void ei_ffi_build_arena_release(void) {
+}
+
+__attribute__((visibility("default"))) size_t ei_ffi_build_arena_bytes(void) {
+    return 0;
+}
+
+} // extern "C"
+
+#endif // EI_FFI_BUILD_ARENA
@@ -0,0 +1,140 @@
+// On-device quantization calibration harness.
+//
+// Not part of the shipped library: built only with EI_CALIBRATE=1, and
+// meant to be built against the FLOAT deployment of the impulse. It
+// replays a capture log (ei_ffi_enable_capture's "EICP" format) through
+// the classifier with calibration ranges armed, so per-tensor activation
+// ranges come from real production frames on the device class that will
+// run the quantized model -- no round trip of raw data to the cloud --
+// and emits the scale/zero-point table the converter consumes.
+//
+// Usage: ei_ffi_calibrate <capture.log> [table.json]
+//   (table goes to stdout when no output path is given)
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x50434945;   // "EICP", see capture_support.cpp
+constexpr uint32_t kRecordMagic = 0x31434945; // "EIC1"
+
+// Mirrors the capture record header layout (packed 4-byte fields).
+struct capture_record_header {
+    uint32_t magic;
+    uint32_t signal_bytes;
+    uint32_t result_bytes;
+    uint32_t seq;
+    uint32_t trace_lo;
+    uint32_t trace_hi;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <capture.log> [table.json]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* log = fopen(argv[1], "rb");
+    if (log == nullptr) {
+        fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    uint32_t file_header[4];
+    if (fread(file_header, sizeof(file_header), 1, log) != 1 ||
+        file_header[0] != kFileMagic) {
+        fprintf(stderr, "%s is not a capture log\n", argv[1]);
+        fclose(log);
+        return 1;
+    }
+    uint32_t frame_samples = file_header[2];
+    if (frame_samples != (uint32_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+        fprintf(stderr, "capture frame size %u does not match this model (%d)\n",
+                frame_samples, EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+        fclose(log);
+        return 1;
+    }
+
+    ei_ffi_run_classifier_init();
+    if (ei_ffi_calibration_begin() != EI_IMPULSE_OK) {
+        fprintf(stderr, "calibration unavailable (micro build? build against the full-TFLite float deployment)\n");
+        fclose(log);
+        return 1;
+    }
+
+    std::vector<float> frame(frame_samples);
+    uint64_t replayed = 0;
+    uint64_t failed = 0;
+    for (;;) {
+        capture_record_header record;
+        if (fread(&record, sizeof(record), 1, log) != 1) {
+            break; // end of log
+        }
+        if (record.magic != kRecordMagic ||
+            record.signal_bytes != frame_samples * sizeof(float)) {
+            fprintf(stderr, "record %llu malformed; stopping at the last good frame\n",
+                    (unsigned long long)replayed);
+            break;
+        }
+        if (fread(frame.data(), record.signal_bytes, 1, log) != 1) {
+            break;
+        }
+        // The serialized result is replay metadata; ranges come from
+        // re-running the frame, so skip past it.
+        if (record.result_bytes > 0 && fseek(log, record.result_bytes, SEEK_CUR) != 0) {
+            break;
+        }
+
+        signal_t signal;
+        ei_ffi_signal_from_buffer(frame.data(), frame.size(), &signal);
+        ei_impulse_result_t result;
+        if (ei_ffi_run_classifier(&signal, &result, 0) == EI_IMPULSE_OK) {
+            replayed++;
+        }
+        else {
+            failed++;
+        }
+    }
+    fclose(log);
+    ei_ffi_calibration_end();
+
+    if (replayed == 0) {
+        fprintf(stderr, "no frames replayed (%llu failed)\n", (unsigned long long)failed);
+        return 1;
+    }
+
+    // Size, then emit in one shot (the table contract never truncates).
+    std::vector<char> table(64 * 1024);
+    int written = ei_ffi_calibration_table(table.data(), table.size());
+    while (written < 0 && table.size() < (size_t)16 * 1024 * 1024) {
+        table.resize(table.size() * 2);
+        written = ei_ffi_calibration_table(table.data(), table.size());
+    }
+    if (written < 0) {
+        fprintf(stderr, "calibration table too large\n");
+        return 1;
+    }
+
+    FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (out == nullptr) {
+        fprintf(stderr, "cannot open %s\n", argv[2]);
+        return 1;
+    }
+    fwrite(table.data(), 1, (size_t)written, out);
+    fputc('\n', out);
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    fprintf(stderr, "replayed %llu frames (%llu failed)\n",
+            (unsigned long long)replayed, (unsigned long long)failed);
+    return 0;
+}
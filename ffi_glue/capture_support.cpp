@@ -0,0 +1,299 @@
+// Capture mode for deterministic replay.
+//
+// A latency spike seen in the field is unreproducible once the input frame
+// is gone. With capture enabled, every Nth classified signal is appended to
+// a compact log together with its serialized result, so the exact inputs
+// behind a spike can be re-run offline under a profiler (see the
+// ffi_replay example). Records are assembled on the classifier thread but
+// written by a background thread -- with O_DIRECT on Linux so the log
+// never pollutes the page cache the model weights live in -- and when the
+// writer falls behind, records are dropped and counted rather than ever
+// blocking an invoke.
+//
+// File format (all fields little-endian uint32 unless noted):
+//   file header:    magic "EICP", version, raw frame sample count, reserved
+//   per record:     magic "EIC1", signal bytes, result bytes,
+//                   sequence number, trace id (uint64, 0 = untraced); then
+//                   the raw float32 signal and the ei_ffi_serialize_result
+//                   flat buffer.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Defined in edge_impulse_c_api.cpp: the invoke thread's current trace id
+// (0 = untraced), recorded with every captured frame.
+extern "C" uint64_t ei_ffi_internal_current_trace(void);
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x50434945;   // "EICP"
+constexpr uint32_t kRecordMagic = 0x31434945; // "EIC1"
+constexpr uint32_t kFormatVersion = 2;
+
+// O_DIRECT alignment unit; the staging buffer flushes in whole multiples
+// of this and the unaligned tail is written once, at disable time, after
+// clearing O_DIRECT on the descriptor.
+constexpr size_t kBlockSize = 4096;
+constexpr size_t kStageBytes = 256 * 1024;
+
+// Bound on records waiting for the writer. Past this the classifier
+// thread drops instead of queueing -- capture must never grow the heap
+// without limit on a stalled disk.
+constexpr size_t kMaxQueuedRecords = 8;
+
+struct capture_record_header {
+    uint32_t magic;
+    uint32_t signal_bytes;
+    uint32_t result_bytes;
+    uint32_t seq;
+    uint32_t trace_lo; // split so the header stays packed 4-byte fields
+    uint32_t trace_hi;
+};
+
+struct capture_state {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::vector<uint8_t>> queue; // guarded by mutex
+    std::thread writer;
+    int fd = -1;
+    bool direct = false;
+    bool stop = false; // guarded by mutex
+    uint32_t sample_every_n = 1;
+};
+
+capture_state s_capture;
+std::mutex s_capture_config_mutex; // serializes enable/disable
+std::atomic<bool> s_capture_active{false};
+std::atomic<uint64_t> s_capture_invokes{0};
+std::atomic<uint32_t> s_capture_seq{0};
+std::atomic<uint64_t> s_capture_dropped{0};
+
+// Flush the aligned prefix of the staging buffer; the remainder moves to
+// the front and waits for more data (or the final tail write).
+void flush_aligned(uint8_t* stage, size_t& staged) {
+    size_t aligned = (staged / kBlockSize) * kBlockSize;
+    if (aligned == 0) {
+        return;
+    }
+    ssize_t written = write(s_capture.fd, stage, aligned);
+    if (written > 0) {
+        memmove(stage, stage + written, staged - (size_t)written);
+        staged -= (size_t)written;
+    }
+    else {
+        // Disk error: drop the staged bytes so capture degrades to a
+        // counter instead of wedging the writer.
+        s_capture_dropped.fetch_add(1, std::memory_order_relaxed);
+        staged = 0;
+    }
+}
+
+void writer_main() {
+    uint8_t* stage = nullptr;
+    if (posix_memalign((void**)&stage, kBlockSize, kStageBytes) != 0) {
+        return;
+    }
+    size_t staged = 0;
+
+    // The file header rides in the staging buffer like any other payload,
+    // so the very first write is still block-aligned.
+    uint32_t file_header[4] = { kFileMagic, kFormatVersion,
+                                (uint32_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE, 0 };
+    memcpy(stage, file_header, sizeof(file_header));
+    staged = sizeof(file_header);
+
+    for (;;) {
+        std::vector<std::vector<uint8_t>> batch;
+        {
+            std::unique_lock<std::mutex> lock(s_capture.mutex);
+            s_capture.cv.wait(lock, [] { return s_capture.stop || !s_capture.queue.empty(); });
+            batch.swap(s_capture.queue);
+            if (batch.empty() && s_capture.stop) {
+                break;
+            }
+        }
+        for (auto& record : batch) {
+            size_t offset = 0;
+            while (offset < record.size()) {
+                size_t room = kStageBytes - staged;
+                size_t chunk = record.size() - offset;
+                if (chunk > room) {
+                    chunk = room;
+                }
+                memcpy(stage + staged, record.data() + offset, chunk);
+                staged += chunk;
+                offset += chunk;
+                if (staged == kStageBytes) {
+                    flush_aligned(stage, staged);
+                }
+            }
+        }
+        flush_aligned(stage, staged);
+    }
+
+    // Unaligned tail: drop O_DIRECT for the final write.
+    if (staged > 0) {
+        if (s_capture.direct) {
+#if defined(__linux__)
+            int flags = fcntl(s_capture.fd, F_GETFL);
+            if (flags >= 0) {
+                fcntl(s_capture.fd, F_SETFL, flags & ~O_DIRECT);
+            }
+#endif
+        }
+        if (write(s_capture.fd, stage, staged) < 0) {
+            s_capture_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    free(stage);
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_enable_capture(const char* path, uint32_t sample_every_n) {
+    if (path == nullptr || sample_every_n == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> config_lock(s_capture_config_mutex);
+    if (s_capture_active.load(std::memory_order_relaxed)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    int fd = -1;
+    bool direct = false;
+#if defined(__linux__)
+    fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_DIRECT, 0644);
+    direct = (fd >= 0);
+#endif
+    if (fd < 0) {
+        // Filesystem without O_DIRECT support (or macOS): buffered append.
+        fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+    if (fd < 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+#if defined(__APPLE__)
+    fcntl(fd, F_NOCACHE, 1);
+#endif
+
+    s_capture.fd = fd;
+    s_capture.direct = direct;
+    s_capture.stop = false;
+    s_capture.sample_every_n = sample_every_n;
+    s_capture.queue.clear();
+    s_capture_invokes.store(0, std::memory_order_relaxed);
+    s_capture_seq.store(0, std::memory_order_relaxed);
+    s_capture_dropped.store(0, std::memory_order_relaxed);
+    s_capture.writer = std::thread(writer_main);
+    s_capture_active.store(true, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_disable_capture(void) {
+    std::lock_guard<std::mutex> config_lock(s_capture_config_mutex);
+    if (!s_capture_active.load(std::memory_order_relaxed)) {
+        return;
+    }
+    s_capture_active.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(s_capture.mutex);
+        s_capture.stop = true;
+    }
+    s_capture.cv.notify_one();
+    s_capture.writer.join();
+    close(s_capture.fd);
+    s_capture.fd = -1;
+}
+
+__attribute__((visibility("default"))) uint64_t ei_ffi_capture_dropped(void) {
+    return s_capture_dropped.load(std::memory_order_relaxed);
+}
+
+// Called by the run_classifier wrappers after a successful invoke; not
+// part of the public surface.
+__attribute__((visibility("default"))) void ei_ffi_internal_capture_note(signal_t* signal, const ei_impulse_result_t* result) {
+    // Acquire pairs with the release store in enable, which published
+    // sample_every_n and the writer state.
+    if (!s_capture_active.load(std::memory_order_acquire)) {
+        return;
+    }
+    uint64_t invoke = s_capture_invokes.fetch_add(1, std::memory_order_relaxed);
+    if (invoke % s_capture.sample_every_n != 0) {
+        return;
+    }
+
+    // Re-read the signal on the classifier thread; for buffer-backed
+    // signals this is a copy, and it is the only way to capture the exact
+    // floats the DSP stage consumed.
+    std::vector<float> samples(signal->total_length);
+    if (signal->get_data(0, signal->total_length, samples.data()) != 0) {
+        s_capture_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    int result_bytes = ei_ffi_serialize_result(result, nullptr, 0);
+    if (result_bytes < 0) {
+        s_capture_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    capture_record_header header;
+    header.magic = kRecordMagic;
+    header.signal_bytes = (uint32_t)(samples.size() * sizeof(float));
+    header.result_bytes = (uint32_t)result_bytes;
+    header.seq = s_capture_seq.fetch_add(1, std::memory_order_relaxed);
+    uint64_t trace = ei_ffi_internal_current_trace();
+    header.trace_lo = (uint32_t)trace;
+    header.trace_hi = (uint32_t)(trace >> 32);
+
+    std::vector<uint8_t> record(sizeof(header) + header.signal_bytes + header.result_bytes);
+    memcpy(record.data(), &header, sizeof(header));
+    memcpy(record.data() + sizeof(header), samples.data(), header.signal_bytes);
+    ei_ffi_serialize_result(result, record.data() + sizeof(header) + header.signal_bytes,
+                            header.result_bytes);
+
+    {
+        std::lock_guard<std::mutex> lock(s_capture.mutex);
+        if (s_capture.queue.size() >= kMaxQueuedRecords) {
+            s_capture_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        s_capture.queue.push_back(std::move(record));
+    }
+    s_capture.cv.notify_one();
+}
+
+} // extern "C"
+
+#else // !(__linux__ || __APPLE__)
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_enable_capture(const char*, uint32_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_disable_capture(void) {}
+
+__attribute__((visibility("default"))) uint64_t ei_ffi_capture_dropped(void) {
+    return 0;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_internal_capture_note(signal_t*, const ei_impulse_result_t*) {}
+
+} // extern "C"
+
+#endif // __linux__ || __APPLE__
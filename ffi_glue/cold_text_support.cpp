@@ -0,0 +1,84 @@
+// Cold-text isolation for the Edge Impulse SDK FFI.
+//
+// The shipped library mixes init-only code (flatbuffer parsing, model and
+// interpreter construction, arena planning) with the hot invoke path, so
+// invoke-time I-cache/iTLB locality pays for megabytes of text it never
+// executes. USE_COLD_TEXT=1 builds compile the SDK with -ffunction-sections
+// and link with cold_text.ld, which groups those init-only objects into a
+// page-aligned .text.ei_cold region placed after the hot text. Once the
+// classifier is initialized, ei_ffi_release_cold_text() advises the kernel
+// to drop that range; the pages fault back in from the file on the rare
+// re-init, so this is a locality hint, never a correctness hazard.
+#include "edge_impulse_wrapper.h"
+
+#if defined(EI_FFI_COLD_TEXT) && defined(__linux__)
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// MADV_COLD landed in Linux 5.4; older uapi headers lack the constant but
+// the syscall just returns EINVAL on kernels without it.
+#ifndef MADV_COLD
+#define MADV_COLD 20
+#endif
+
+// Boundary symbols provided by cold_text.ld. Weak so a build that drops the
+// script (e.g. a non-GNU linker) still links; both resolve to 0 then and the
+// functions below degrade to no-ops.
+extern "C" {
+extern const char __ei_cold_text_start[] __attribute__((weak));
+extern const char __ei_cold_text_end[] __attribute__((weak));
+}
+
+extern "C" {
+
+// Size of the cold-text region grouped by the linker script, in bytes.
+// 0 when the script was not applied (or nothing matched its patterns).
+__attribute__((visibility("default"))) size_t ei_ffi_cold_text_bytes(void) {
+    if (__ei_cold_text_start == nullptr || __ei_cold_text_end == nullptr) {
+        return 0;
+    }
+    return (size_t)(__ei_cold_text_end - __ei_cold_text_start);
+}
+
+// Advise the kernel that the init-only text is cold so it leaves residency
+// first. Call after init (ei_ffi_run_classifier_init / first inference);
+// safe to call repeatedly. MADV_COLD keeps the pages mapped and merely
+// deactivates them; on pre-5.4 kernels we fall back to MADV_DONTNEED,
+// which is also safe for file-backed text (re-faulted on demand).
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_release_cold_text(void) {
+    const size_t len = ei_ffi_cold_text_bytes();
+    if (len == 0) {
+        return EI_IMPULSE_OK;
+    }
+    void* start = (void*)__ei_cold_text_start;
+    if (madvise(start, len, MADV_COLD) == 0) {
+        return EI_IMPULSE_OK;
+    }
+    if (errno == EINVAL && madvise(start, len, MADV_DONTNEED) == 0) {
+        return EI_IMPULSE_OK;
+    }
+    ei_printf("WARN: madvise on cold text failed (%s)\n", strerror(errno));
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#else // !EI_FFI_COLD_TEXT || !__linux__
+
+extern "C" {
+
+__attribute__((visibility("default"))) size_t ei_ffi_cold_text_bytes(void) {
+    return 0;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_release_cold_text(void) {
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
+
+#endif // EI_FFI_COLD_TEXT && __linux__
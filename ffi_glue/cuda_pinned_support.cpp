@@ -0,0 +1,128 @@
+// Pinned host staging for the TensorRT path (Jetson builds).
+//
+// The engine's per-inference H2D copy runs out of whatever memory the
+// caller hands it; from pageable memory that is a staged copy through a
+// driver bounce buffer plus a sync, ~4 ms per frame on a Jetson Nano.
+// Buffers from ei_ffi_alloc_pinned are cudaHostAlloc'd portable+mapped,
+// so the copy is a straight DMA -- and on Jetson's unified memory the
+// mapped flag makes it effectively zero-copy. Point capture DMA at a
+// pinned buffer, wrap it with ei_ffi_signal_from_pinned_buffer, and the
+// frame never takes the bounce-buffer detour.
+//
+// ei_ffi_cuda_stream hands out one process-wide non-blocking stream,
+// created once and reused across invokes, for app-side async copies
+// (enqueue the next frame's H2D while the current frame is still in
+// preprocessing); ei_ffi_cuda_stream_sync drains it before handing the
+// buffer to the classifier.
+//
+// Opt-in (USE_CUDA_PINNED=1) since it links libcudart. Without the flag
+// ei_ffi_alloc_pinned degrades to page-aligned heap memory so calling
+// code is portable, and the stream entry points report unavailability.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cstdlib>
+
+#if defined(EI_FFI_CUDA_PINNED)
+
+// libcudart's C entry points; the headers are not vendored but the ABI
+// is stable (cudaError_t is an int, 0 = cudaSuccess).
+extern "C" int cudaHostAlloc(void** ptr, size_t size, unsigned int flags);
+extern "C" int cudaFreeHost(void* ptr);
+extern "C" int cudaStreamCreateWithFlags(void** stream, unsigned int flags);
+extern "C" int cudaStreamSynchronize(void* stream);
+
+namespace {
+
+// cudaHostAllocPortable | cudaHostAllocMapped
+constexpr unsigned int kPinnedFlags = 0x01u | 0x02u;
+// cudaStreamNonBlocking
+constexpr unsigned int kStreamFlags = 0x01u;
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) void* ei_ffi_alloc_pinned(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+    void* ptr = nullptr;
+    if (cudaHostAlloc(&ptr, bytes, kPinnedFlags) != 0) {
+        return nullptr;
+    }
+    return ptr;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_free_pinned(void* ptr) {
+    if (ptr != nullptr) {
+        cudaFreeHost(ptr);
+    }
+}
+
+__attribute__((visibility("default"))) void* ei_ffi_cuda_stream(void) {
+    // One stream serves the process for its lifetime; never destroyed, so
+    // there is no teardown race with in-flight copies.
+    static void* stream = [] {
+        void* s = nullptr;
+        return cudaStreamCreateWithFlags(&s, kStreamFlags) == 0 ? s : nullptr;
+    }();
+    return stream;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_cuda_stream_sync(void) {
+    void* stream = ei_ffi_cuda_stream();
+    if (stream == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    return cudaStreamSynchronize(stream) == 0 ? EI_IMPULSE_OK
+                                              : EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#else // !EI_FFI_CUDA_PINNED
+
+extern "C" {
+
+// Portable fallback: page-aligned heap memory, so code written against
+// the pinned API runs unchanged on non-CUDA targets (minus the DMA win).
+__attribute__((visibility("default"))) void* ei_ffi_alloc_pinned(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, 4096, bytes) == 0 ? ptr : nullptr;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_free_pinned(void* ptr) {
+    free(ptr);
+}
+
+__attribute__((visibility("default"))) void* ei_ffi_cuda_stream(void) {
+    return nullptr;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_cuda_stream_sync(void) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#endif // EI_FFI_CUDA_PINNED
+
+extern "C" {
+
+// Wrap a pinned (or fallback-aligned) float buffer as a signal without
+// copying; the buffer must stay valid and untouched until the classify
+// call returns. Same contract as the SDK's signal_from_buffer.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_pinned_buffer(float* buffer, size_t length, signal_t* signal) {
+    if (buffer == nullptr || signal == nullptr || length == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    return ei::numpy::signal_from_buffer(buffer, length, signal) == 0
+               ? EI_IMPULSE_OK
+               : EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
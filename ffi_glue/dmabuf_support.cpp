@@ -0,0 +1,211 @@
+// Zero-copy camera ingestion from V4L2 DMA-buf planes.
+//
+// A capture stack handing out DMA-buf fds otherwise forces two frame-size
+// copies per frame (kernel buffer -> caller Vec -> signal buffer) plus a
+// separate colorspace pass. Here the plane is mapped read-only straight
+// from the fd and one fused SIMD pass converts pixels to the classifier's
+// packed feature format ((r << 16) | (g << 8) | b as float) in a
+// persistent frame buffer the signal borrows -- the only write per frame
+// is the feature store itself.
+//
+// YUYV uses the BT.601 integer approximation (the usual 298/409/208/100/516
+// coefficients, studio swing); RGB24 and GREY reuse the packing kernels.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cstring>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define EI_FFI_HAVE_NEON 1
+#endif
+
+#if defined(__linux__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// V4L2 fourcc values (little-endian character codes).
+constexpr uint32_t fourcc(char a, char b, char c, char d) {
+    return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+}
+constexpr uint32_t kFourccYUYV = fourcc('Y', 'U', 'Y', 'V');
+constexpr uint32_t kFourccRGB24 = fourcc('R', 'G', 'B', '3');
+constexpr uint32_t kFourccGrey = fourcc('G', 'R', 'E', 'Y');
+
+// Packed features for the current frame; the signal borrows this, so it
+// stays valid until the next ei_ffi_signal_from_dmabuf call.
+std::vector<float> s_dmabuf_features;
+
+inline uint8_t clamp_u8(int32_t v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+#if defined(EI_FFI_HAVE_NEON)
+// BT.601 for 8 luma samples sharing precomputed chroma terms: returns the
+// clamped 8-bit channel as uint16 lanes.
+inline uint16x8_t yuv_channel(int16x8_t c, int32x4_t chroma_lo, int32x4_t chroma_hi) {
+    int32x4_t lo = vaddq_s32(vmull_n_s16(vget_low_s16(c), 298), chroma_lo);
+    int32x4_t hi = vaddq_s32(vmull_n_s16(vget_high_s16(c), 298), chroma_hi);
+    uint16x8_t out = vcombine_u16(vqmovun_s32(vshrq_n_s32(lo, 8)),
+                                  vqmovun_s32(vshrq_n_s32(hi, 8)));
+    return vminq_u16(out, vdupq_n_u16(255));
+}
+
+// Pack interleaved r/g/b uint16 lanes into 8 packed-float features.
+inline void store_packed(float* out, uint16x8_t r, uint16x8_t g, uint16x8_t b) {
+    uint32x4_t lo = vorrq_u32(
+        vorrq_u32(vshlq_n_u32(vmovl_u16(vget_low_u16(r)), 16),
+                  vshlq_n_u32(vmovl_u16(vget_low_u16(g)), 8)),
+        vmovl_u16(vget_low_u16(b)));
+    uint32x4_t hi = vorrq_u32(
+        vorrq_u32(vshlq_n_u32(vmovl_u16(vget_high_u16(r)), 16),
+                  vshlq_n_u32(vmovl_u16(vget_high_u16(g)), 8)),
+        vmovl_u16(vget_high_u16(b)));
+    vst1q_f32(out, vcvtq_f32_u32(lo));
+    vst1q_f32(out + 4, vcvtq_f32_u32(hi));
+}
+#endif
+
+// YUYV (4:2:2, Y0 U Y1 V) -> packed features, one pass.
+void yuyv_to_features(const uint8_t* src, size_t pixel_count, float* out) {
+    size_t ix = 0;
+
+#if defined(EI_FFI_HAVE_NEON)
+    for (; ix + 16 <= pixel_count; ix += 16) {
+        // 32 bytes = 16 pixels: 8 even lumas, 8 odd lumas, 8 chroma pairs.
+        uint8x8x4_t yuyv = vld4_u8(src + ix * 2);
+        int16x8_t y0 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(yuyv.val[0])), vdupq_n_s16(16));
+        int16x8_t y1 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(yuyv.val[2])), vdupq_n_s16(16));
+        int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(yuyv.val[1])), vdupq_n_s16(128));
+        int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(yuyv.val[3])), vdupq_n_s16(128));
+
+        int32x4_t bias = vdupq_n_s32(128); // rounding term for the >> 8
+        int32x4_t r_lo = vaddq_s32(vmull_n_s16(vget_low_s16(e), 409), bias);
+        int32x4_t r_hi = vaddq_s32(vmull_n_s16(vget_high_s16(e), 409), bias);
+        int32x4_t g_lo = vsubq_s32(bias, vaddq_s32(vmull_n_s16(vget_low_s16(d), 100),
+                                                   vmull_n_s16(vget_low_s16(e), 208)));
+        int32x4_t g_hi = vsubq_s32(bias, vaddq_s32(vmull_n_s16(vget_high_s16(d), 100),
+                                                   vmull_n_s16(vget_high_s16(e), 208)));
+        int32x4_t b_lo = vaddq_s32(vmull_n_s16(vget_low_s16(d), 516), bias);
+        int32x4_t b_hi = vaddq_s32(vmull_n_s16(vget_high_s16(d), 516), bias);
+
+        uint16x8_t r0 = yuv_channel(y0, r_lo, r_hi);
+        uint16x8_t r1 = yuv_channel(y1, r_lo, r_hi);
+        uint16x8_t g0 = yuv_channel(y0, g_lo, g_hi);
+        uint16x8_t g1 = yuv_channel(y1, g_lo, g_hi);
+        uint16x8_t b0 = yuv_channel(y0, b_lo, b_hi);
+        uint16x8_t b1 = yuv_channel(y1, b_lo, b_hi);
+
+        // Re-interleave even/odd lumas back into pixel order.
+        uint16x8x2_t r = vzipq_u16(r0, r1);
+        uint16x8x2_t g = vzipq_u16(g0, g1);
+        uint16x8x2_t b = vzipq_u16(b0, b1);
+        store_packed(out + ix, r.val[0], g.val[0], b.val[0]);
+        store_packed(out + ix + 8, r.val[1], g.val[1], b.val[1]);
+    }
+#endif
+
+    for (; ix + 2 <= pixel_count; ix += 2) {
+        const uint8_t* p = src + ix * 2;
+        int32_t c0 = 298 * ((int32_t)p[0] - 16);
+        int32_t c1 = 298 * ((int32_t)p[2] - 16);
+        int32_t d = (int32_t)p[1] - 128;
+        int32_t e = (int32_t)p[3] - 128;
+        int32_t rt = 409 * e + 128;
+        int32_t gt = 128 - 100 * d - 208 * e;
+        int32_t bt = 516 * d + 128;
+        for (int px = 0; px < 2; px++) {
+            int32_t c = px == 0 ? c0 : c1;
+            uint32_t r = clamp_u8((c + rt) >> 8);
+            uint32_t g = clamp_u8((c + gt) >> 8);
+            uint32_t b = clamp_u8((c + bt) >> 8);
+            out[ix + px] = (float)((r << 16) | (g << 8) | b);
+        }
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+// Map `len` bytes at `offset` of the DMA-buf `fd` and convert the plane to
+// packed features in one pass. The signal borrows an internal frame buffer
+// valid until the next call; the mapping itself is released before
+// returning. Supported fourcc values: YUYV, RGB3, GREY.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_dmabuf(int fd, size_t offset, size_t len, uint32_t fourcc_code, signal_t* signal) {
+    if (fd < 0 || len == 0 || signal == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t pixel_count;
+    switch (fourcc_code) {
+        case kFourccYUYV:
+            if (len % 4 != 0) {
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+            pixel_count = len / 2;
+            break;
+        case kFourccRGB24:
+            if (len % 3 != 0) {
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+            pixel_count = len / 3;
+            break;
+        case kFourccGrey:
+            pixel_count = len;
+            break;
+        default:
+            return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    // Plane offsets are not necessarily page-aligned; map from the aligned
+    // base and index in.
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t map_offset = offset & ~(page - 1);
+    size_t delta = offset - map_offset;
+    void* mapping = mmap(nullptr, len + delta, PROT_READ, MAP_SHARED, fd, (off_t)map_offset);
+    if (mapping == MAP_FAILED) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const uint8_t* plane = (const uint8_t*)mapping + delta;
+
+    s_dmabuf_features.resize(pixel_count);
+    EI_IMPULSE_ERROR res = EI_IMPULSE_OK;
+    switch (fourcc_code) {
+        case kFourccYUYV:
+            yuyv_to_features(plane, pixel_count, s_dmabuf_features.data());
+            break;
+        case kFourccRGB24:
+            res = ei_ffi_pack_rgb888_features(plane, pixel_count, s_dmabuf_features.data());
+            break;
+        case kFourccGrey:
+            res = ei_ffi_pack_gray8_features(plane, pixel_count, s_dmabuf_features.data());
+            break;
+    }
+    munmap(mapping, len + delta);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    return static_cast<EI_IMPULSE_ERROR>(
+        ei::numpy::signal_from_buffer(s_dmabuf_features.data(), pixel_count, signal));
+}
+
+} // extern "C"
+
+#else // !__linux__
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_dmabuf(int, size_t, size_t, uint32_t, signal_t* signal) {
+    (void)signal;
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#endif // __linux__
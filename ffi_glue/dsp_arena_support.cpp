@@ -0,0 +1,243 @@
+// Bump-allocator arena for DSP temporaries.
+//
+// The SDK's dsp types heap-allocate their working matrices through the
+// porting layer's ei_malloc/ei_calloc/ei_free, which are weak symbols on
+// POSIX targets. The strong definitions here route allocations made inside
+// an arena scope into a per-thread bump allocator that resets when the
+// scope closes -- at 200 Hz that removes thousands of malloc/free pairs
+// per second and the fragmentation they build up over weeks of uptime.
+//
+// Outside a scope (and for anything that does not fit the arena) the
+// functions fall through to the real allocator, so model init, result
+// buffers and continuous-mode state are untouched. Scopes must be opened,
+// used and closed on the same thread, and nothing allocated inside a scope
+// may outlive it; the pipeline's DSP stage brackets exactly one window's
+// feature extraction, which satisfies both.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+constexpr size_t kArenaAlign = 16;
+
+struct dsp_arena {
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+    bool active = false;
+    uint64_t served = 0;
+    uint64_t spilled = 0;
+};
+
+thread_local dsp_arena t_arena;
+
+// Requested size; each thread (re)sizes its arena at the next scope open.
+std::atomic<size_t> s_arena_size{0};
+
+bool in_arena(const void* ptr) {
+    const dsp_arena& arena = t_arena;
+    return arena.base != nullptr && ptr >= arena.base && ptr < arena.base + arena.size;
+}
+
+void* arena_alloc(size_t size) {
+    dsp_arena& arena = t_arena;
+    if (!arena.active || arena.base == nullptr || arena.offset + size > arena.size) {
+        if (arena.active) {
+            arena.spilled++;
+        }
+        return nullptr;
+    }
+    void* ptr = arena.base + arena.offset;
+    arena.offset = (arena.offset + size + kArenaAlign - 1) & ~(kArenaAlign - 1);
+    arena.served++;
+    return ptr;
+}
+
+// ---------------------------------------------------------------------------
+// Hugepage-backed large allocations
+//
+// With EI_FFI_ARENA_HUGEPAGES set, allocations at or past 2 MB coming
+// through the porting layer are served from anonymous mmaps rounded to
+// the hugepage size and marked MADV_HUGEPAGE, cutting dTLB pressure on
+// multi-megabyte working sets (4 KB pages mean a 60 MB working set
+// cannot fit the dTLB; 2 MB pages cover it in ~30 entries). Failed maps
+// or failed madvise fall back to plain malloc, so the option is safe to
+// set unconditionally. Linux only.
+// ---------------------------------------------------------------------------
+
+std::atomic<int> s_arena_options{0};
+
+#if defined(__linux__)
+
+constexpr size_t kHugePageSize = 2u * 1024 * 1024;
+
+// Hugepage mappings in flight; ei_free consults this before free().
+// Allocation at this size is rare (arenas, workspaces), so a mutex is
+// fine here.
+std::mutex s_huge_mutex;
+std::unordered_map<void*, size_t> s_huge_mappings;
+
+void* huge_alloc(size_t size) {
+    size_t mapped = (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    void* ptr = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return nullptr;
+    }
+#if defined(MADV_HUGEPAGE)
+    // Advisory: the region still works (and still skips heap
+    // fragmentation) when THP is unavailable.
+    madvise(ptr, mapped, MADV_HUGEPAGE);
+#endif
+    std::lock_guard<std::mutex> lock(s_huge_mutex);
+    s_huge_mappings.emplace(ptr, mapped);
+    return ptr;
+}
+
+bool huge_free(void* ptr) {
+    size_t mapped = 0;
+    {
+        std::lock_guard<std::mutex> lock(s_huge_mutex);
+        auto it = s_huge_mappings.find(ptr);
+        if (it == s_huge_mappings.end()) {
+            return false;
+        }
+        mapped = it->second;
+        s_huge_mappings.erase(it);
+    }
+    munmap(ptr, mapped);
+    return true;
+}
+
+void* maybe_huge_alloc(size_t size) {
+    if ((s_arena_options.load(std::memory_order_relaxed) & EI_FFI_ARENA_HUGEPAGES) == 0 ||
+        size < kHugePageSize) {
+        return nullptr;
+    }
+    return huge_alloc(size);
+}
+
+#else // !__linux__
+
+void* maybe_huge_alloc(size_t) {
+    return nullptr;
+}
+
+bool huge_free(void*) {
+    return false;
+}
+
+#endif // __linux__
+
+} // namespace
+
+// Strong overrides of the porting layer's weak allocator hooks.
+
+void* ei_malloc(size_t size) {
+    void* ptr = arena_alloc(size);
+    if (ptr != nullptr) {
+        return ptr;
+    }
+    ptr = maybe_huge_alloc(size);
+    return ptr != nullptr ? ptr : malloc(size);
+}
+
+void* ei_calloc(size_t nitems, size_t size) {
+    void* ptr = arena_alloc(nitems * size);
+    if (ptr != nullptr) {
+        memset(ptr, 0, nitems * size);
+        return ptr;
+    }
+    // Anonymous mmaps are already zeroed.
+    ptr = maybe_huge_alloc(nitems * size);
+    return ptr != nullptr ? ptr : calloc(nitems, size);
+}
+
+void ei_free(void* ptr) {
+    if (ptr == nullptr || in_arena(ptr)) {
+        // Arena memory is reclaimed wholesale when the scope closes.
+        return;
+    }
+    if (huge_free(ptr)) {
+        return;
+    }
+    free(ptr);
+}
+
+extern "C" {
+
+// Configure the per-thread arena size; 0 disables arena scopes entirely.
+// Applies when each thread next opens a scope.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_dsp_arena(size_t size) {
+    s_arena_size.store(size);
+    return EI_IMPULSE_OK;
+}
+
+// Arena placement options (bitmask of EI_FFI_ARENA_*). Applies to
+// allocations made after the call; existing blocks keep their backing.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_arena_options(int options) {
+    if ((options & ~EI_FFI_ARENA_HUGEPAGES) != 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+#if !defined(__linux__)
+    if ((options & EI_FFI_ARENA_HUGEPAGES) != 0) {
+        return EI_IMPULSE_INFERENCE_ERROR; // hugepage control is Linux-only
+    }
+#endif
+    s_arena_options.store(options);
+    return EI_IMPULSE_OK;
+}
+
+// Open an arena scope on the calling thread: allocations via the porting
+// layer bump-allocate until the matching end. No-op while size is 0.
+__attribute__((visibility("default"))) void ei_ffi_dsp_arena_begin(void) {
+    dsp_arena& arena = t_arena;
+    size_t want = s_arena_size.load();
+    if (arena.size != want) {
+        free(arena.base);
+        arena.base = want > 0 ? (uint8_t*)malloc(want) : nullptr;
+        arena.size = arena.base != nullptr ? want : 0;
+    }
+    arena.offset = 0;
+    arena.active = arena.base != nullptr;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_dsp_arena_end(void) {
+    dsp_arena& arena = t_arena;
+    arena.active = false;
+    arena.offset = 0;
+}
+
+// Called from ei_ffi_teardown() (edge_impulse_c_api.cpp): frees the
+// calling thread's arena backing now instead of at the next scope open.
+// The arena is per-thread, so a host unloading a model library should
+// tear down on each thread that ran inference (in practice the one
+// invoke thread it dedicated to this tenant).
+__attribute__((visibility("default"))) void ei_ffi_internal_dsp_arena_release(void) {
+    dsp_arena& arena = t_arena;
+    free(arena.base);
+    arena = dsp_arena{};
+}
+
+// Allocations served from the arena vs. spilled to the heap (spills mean
+// the configured size is too small for one window).
+__attribute__((visibility("default"))) void ei_ffi_dsp_arena_stats(uint64_t* served, uint64_t* spilled) {
+    if (served != nullptr) {
+        *served = t_arena.served;
+    }
+    if (spilled != nullptr) {
+        *spilled = t_arena.spilled;
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,110 @@
+// Per-block DSP parallelism for multi-axis spectral analysis.
+//
+// A 6-axis impulse runs the spectral-analysis extractor once over the
+// interleaved frame, axis after axis, on the invoke thread -- the axes
+// are fully independent, so on a quad-core device three cores idle
+// through the DSP stage. This layer splits the block by axis: the frame
+// is pulled once and deinterleaved into axis-contiguous scratch, then
+// each axis runs the extractor as one work item on the shared
+// pthreadpool (ei_ffi_parallel_for -- the same pool XNNPACK uses), each
+// writing its feature slice of the block's output matrix in place.
+//
+// Only the spectral-analysis block splits this way (its per-axis outputs
+// are equal-sized contiguous slices and the extractor is re-entrant);
+// every other block, and every call made before ei_ffi_threadpool_init,
+// takes the serial path unchanged. Callers go through
+// ei_ffi_internal_extract_block instead of block->extract_fn directly.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct axis_split {
+    const ei_model_dsp_t* block;
+    ei_dsp_config_spectral_analysis_t config; // per-axis copy, axes = 1
+    const float* axis_data;                   // deinterleaved, axis-major
+    size_t axis_samples;
+    float* out;
+    size_t axis_features;
+    float frequency;
+    std::atomic<int> status{EIDSP_OK};
+};
+
+// One work item = one axis: contiguous single-axis signal in, the axis's
+// slice of the block's output matrix out.
+void extract_axis(void* context, size_t axis) {
+    axis_split* split = (axis_split*)context;
+
+    ei::signal_t signal;
+    ei::numpy::signal_from_buffer(split->axis_data + axis * split->axis_samples,
+                                  split->axis_samples, &signal);
+    ei::matrix_t slice(1, split->axis_features,
+                       split->out + axis * split->axis_features);
+
+    int ret = split->block->extract_fn(&signal, &slice, &split->config, split->frequency);
+    if (ret != EIDSP_OK) {
+        int expected = EIDSP_OK;
+        split->status.compare_exchange_strong(expected, ret);
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+// Cross-TU DSP dispatch for the glue's own feature-extraction loops
+// (ei_ffi_run_nn_only, the pipeline's DSP stage); not part of the public
+// surface. Returns the extractor's EIDSP code either way.
+__attribute__((visibility("default"))) int ei_ffi_internal_extract_block(const ei_model_dsp_t* block, signal_t* signal, ei::matrix_t* output, float frequency) {
+    const ei_dsp_config_spectral_analysis_t* config =
+        (const ei_dsp_config_spectral_analysis_t*)block->config;
+    size_t axes = block->extract_fn == &extract_spectral_analysis_features
+        ? (size_t)config->axes
+        : 1;
+
+    // Serial path: not spectral, single axis, no pool to fan out on, or a
+    // geometry the split arithmetic can't represent exactly.
+    if (axes < 2 || ei_ffi_threadpool_handle() == nullptr ||
+        block->n_output_features % axes != 0 ||
+        signal->total_length % axes != 0) {
+        return block->extract_fn(signal, output, block->config, frequency);
+    }
+
+    size_t axis_samples = signal->total_length / axes;
+
+    // Pull the frame once and deinterleave sample-major -> axis-major, so
+    // each work item reads a contiguous run. The scratch is reused across
+    // frames on the invoke thread.
+    static thread_local std::vector<float> interleaved;
+    static thread_local std::vector<float> axis_major;
+    interleaved.resize(signal->total_length);
+    axis_major.resize(signal->total_length);
+    int ret = signal->get_data(0, signal->total_length, interleaved.data());
+    if (ret != EIDSP_OK) {
+        return ret;
+    }
+    for (size_t sample = 0; sample < axis_samples; sample++) {
+        for (size_t axis = 0; axis < axes; axis++) {
+            axis_major[axis * axis_samples + sample] = interleaved[sample * axes + axis];
+        }
+    }
+
+    axis_split split;
+    split.block = block;
+    split.config = *config;
+    split.config.axes = 1;
+    split.axis_data = axis_major.data();
+    split.axis_samples = axis_samples;
+    split.out = output->buffer;
+    split.axis_features = block->n_output_features / axes;
+    split.frequency = frequency;
+
+    ei_ffi_parallel_for(extract_axis, &split, axes);
+    return split.status.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
@@ -0,0 +1,529 @@
+// Asynchronous (non-blocking) inference for the Edge Impulse SDK FFI.
+//
+// A small worker pool pulls jobs off a mutex-guarded queue; each worker owns
+// its own classifier instance so submissions from any thread never contend
+// on interpreter state. Completion callbacks fire on the worker thread; the
+// result pointer handed to the callback is only valid for the duration of
+// the callback (use ei_ffi_detach_result to keep it).
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Defined in power_hint_support.cpp: lets ei_ffi_power_hint clamp this
+// worker's frequency during bursts.
+extern "C" void ei_ffi_internal_power_register_thread(void);
+
+// Defined in edge_impulse_c_api.cpp: carry the submitter's trace id onto
+// the worker so capture notes and callback-side ei_ffi_trace_id() see it.
+extern "C" uint64_t ei_ffi_internal_current_trace(void);
+extern "C" void ei_ffi_internal_set_trace(uint64_t trace_id);
+
+// Defined in latency_trace_support.cpp: hand a pending capture-time stamp
+// from the submitting thread to the worker, so the budget covers the
+// queue wait and is readable inside the completion callback.
+extern "C" int ei_ffi_internal_latency_depart(const void* signal, uint64_t* capture_ns, uint64_t* submit_ns);
+extern "C" void ei_ffi_internal_latency_adopt(const void* signal, uint64_t capture_ns, uint64_t submit_ns);
+extern "C" void ei_ffi_internal_latency_note_start(const void* signal);
+extern "C" void ei_ffi_internal_latency_note_done(const ei_impulse_result_t* result);
+
+namespace {
+
+struct async_job {
+    signal_t* signal;
+    int debug;
+    ei_ffi_completion_cb callback;
+    void* user_data;
+    uint64_t trace_id;
+    uint64_t capture_ns; // 0 when the submitter left the signal unstamped
+    uint64_t submit_ns;
+};
+
+struct async_engine {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<async_job> queue;
+    std::vector<std::thread> workers;
+    bool running = false;
+
+    void worker_main(ei_impulse_handle_t* handle) {
+        ei_ffi_internal_power_register_thread();
+        for (;;) {
+            async_job job;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return !running || !queue.empty(); });
+                if (!running && queue.empty()) {
+                    break;
+                }
+                job = queue.front();
+                queue.pop_front();
+            }
+            ei_impulse_result_t result = {};
+            ei_ffi_internal_set_trace(job.trace_id);
+            if (job.capture_ns != 0) {
+                ei_ffi_internal_latency_adopt(job.signal, job.capture_ns, job.submit_ns);
+            }
+            ei_ffi_internal_latency_note_start(job.signal);
+            EI_IMPULSE_ERROR status = run_classifier(handle, job.signal, &result, job.debug);
+            if (status == EI_IMPULSE_OK) {
+                ei_ffi_internal_latency_note_done(&result);
+            }
+            if (job.callback != nullptr) {
+                job.callback(status, &result, job.user_data);
+            }
+            ei_ffi_internal_set_trace(0);
+        }
+        ei_ffi_destroy_instance(handle);
+    }
+};
+
+static async_engine s_engine;
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_async_init(size_t num_workers) {
+    if (num_workers == 0) {
+        num_workers = 1;
+    }
+    std::lock_guard<std::mutex> lock(s_engine.mtx);
+    if (s_engine.running) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    // Create the instances up front so a failure surfaces here, not on a
+    // worker thread where we could only report it through a callback.
+    std::vector<ei_impulse_handle_t*> handles;
+    for (size_t ix = 0; ix < num_workers; ix++) {
+        ei_impulse_handle_t* handle = ei_ffi_create_instance();
+        if (handle == nullptr) {
+            for (ei_impulse_handle_t* h : handles) {
+                ei_ffi_destroy_instance(h);
+            }
+            return EI_IMPULSE_OUT_OF_MEMORY;
+        }
+        handles.push_back(handle);
+    }
+    s_engine.running = true;
+    for (ei_impulse_handle_t* handle : handles) {
+        s_engine.workers.emplace_back([handle] { s_engine.worker_main(handle); });
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Drains the queue (every submitted job still gets its callback) and joins
+// the workers.
+__attribute__((visibility("default"))) void ei_ffi_async_deinit(void) {
+    {
+        std::lock_guard<std::mutex> lock(s_engine.mtx);
+        if (!s_engine.running) {
+            return;
+        }
+        s_engine.running = false;
+    }
+    s_engine.cv.notify_all();
+    for (std::thread& t : s_engine.workers) {
+        t.join();
+    }
+    s_engine.workers.clear();
+}
+
+// Enqueue an inference. The signal (and the buffer it borrows) must stay
+// valid until the completion callback has run.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_async(signal_t* signal, ei_ffi_completion_cb callback, void* user_data, int debug) {
+    if (signal == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_engine.mtx);
+        if (!s_engine.running) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        uint64_t capture_ns = 0;
+        uint64_t submit_ns = 0;
+        ei_ffi_internal_latency_depart(signal, &capture_ns, &submit_ns);
+        s_engine.queue.push_back(async_job{signal, debug, callback, user_data,
+                                           ei_ffi_internal_current_trace(), capture_ns, submit_ns});
+    }
+    s_engine.cv.notify_one();
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
+
+// ---------------------------------------------------------------------------
+// Shared pthreadpool for caller-side parallelism
+//
+// Full-TFLite builds already link libpthreadpool.a for XNNPACK; instead of
+// every DSP/preprocessing stage spinning up its own worker threads, expose
+// one process-wide pool that those stages (and FFI callers) share. The
+// delegate's internal pool is still created by the SDK — handing it an
+// external pool would need TfLiteXNNPackDelegateCreate ownership — but
+// keeping all of *our* fan-out on a single pool stops the worst
+// oversubscription. Builds without the library fall back to sequential
+// execution so the API is always safe to call.
+// ---------------------------------------------------------------------------
+
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE)
+
+// libpthreadpool has a stable C ABI; the header isn't vendored, so declare
+// the few entry points we use.
+extern "C" {
+typedef struct pthreadpool* pthreadpool_t;
+pthreadpool_t pthreadpool_create(size_t threads_count);
+void pthreadpool_destroy(pthreadpool_t threadpool);
+void pthreadpool_parallelize_1d(pthreadpool_t threadpool, void (*function)(void*, size_t), void* argument, size_t range, uint32_t flags);
+}
+
+namespace {
+static pthreadpool_t s_threadpool = nullptr;
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_threadpool_init(size_t num_threads) {
+    if (s_threadpool != nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    // 0 lets pthreadpool size itself to the online processor count.
+    s_threadpool = pthreadpool_create(num_threads);
+    return s_threadpool != nullptr ? EI_IMPULSE_OK : EI_IMPULSE_OUT_OF_MEMORY;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_threadpool_deinit(void) {
+    if (s_threadpool != nullptr) {
+        pthreadpool_destroy(s_threadpool);
+        s_threadpool = nullptr;
+    }
+}
+
+__attribute__((visibility("default"))) void* ei_ffi_threadpool_handle(void) {
+    return (void*)s_threadpool;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_parallel_for(ei_ffi_parallel_fn fn, void* ctx, size_t range) {
+    if (fn == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (s_threadpool == nullptr) {
+        for (size_t ix = 0; ix < range; ix++) {
+            fn(ctx, ix);
+        }
+        return EI_IMPULSE_OK;
+    }
+    pthreadpool_parallelize_1d(s_threadpool, fn, ctx, range, 0 /* flags */);
+    return EI_IMPULSE_OK;
+}
+
+// Create the shared pool with its workers bound to a cpuset (the big
+// cluster, typically -- see ei_ffi_big_cores). pthreadpool workers
+// inherit the creating thread's affinity, so the caller is pinned for
+// the duration of pthreadpool_create and restored afterwards -- the same
+// trick the instance pool uses for first-touch NUMA placement.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_threadpool_init_pinned(size_t num_threads, const uint32_t* cpus, size_t n_cpus) {
+#if defined(__linux__)
+    if (cpus == nullptr || n_cpus == 0 || s_threadpool != nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    cpu_set_t saved;
+    bool have_saved = pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t ix = 0; ix < n_cpus; ix++) {
+        CPU_SET(cpus[ix], &set);
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_threadpool = pthreadpool_create(num_threads != 0 ? num_threads : n_cpus);
+    if (have_saved) {
+        pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+    }
+    return s_threadpool != nullptr ? EI_IMPULSE_OK : EI_IMPULSE_OUT_OF_MEMORY;
+#else
+    (void)cpus;
+    (void)n_cpus;
+    return ei_ffi_threadpool_init(num_threads);
+#endif
+}
+
+} // extern "C"
+
+#else // !EI_CLASSIFIER_USE_FULL_TFLITE
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_threadpool_init(size_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_threadpool_init_pinned(size_t, const uint32_t*, size_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_threadpool_deinit(void) {}
+
+__attribute__((visibility("default"))) void* ei_ffi_threadpool_handle(void) {
+    return nullptr;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_parallel_for(ei_ffi_parallel_fn fn, void* ctx, size_t range) {
+    if (fn == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t ix = 0; ix < range; ix++) {
+        fn(ctx, ix);
+    }
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
+
+#endif // EI_CLASSIFIER_USE_FULL_TFLITE
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+extern "C" {
+
+// ---------------------------------------------------------------------------
+// big.LITTLE topology
+//
+// On asymmetric parts the scheduler is free to place pool workers on a
+// LITTLE core mid-invoke, and the critical path stretches by whatever
+// the cluster performance ratio is -- the frame-to-frame variance shows
+// up long before any counter does. The cluster split is visible in
+// sysfs: LITTLE cores advertise a lower cpufreq ceiling. Classify the
+// online CPUs by that ceiling and hand the big cluster to
+// ei_ffi_threadpool_init_pinned so pool fan-out stays off the LITTLE
+// cores entirely.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) int ei_ffi_big_cores(uint32_t* cpus, size_t cap) {
+#if defined(__linux__)
+    long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_cpus <= 0) {
+        return -1;
+    }
+    std::vector<unsigned long long> ceiling((size_t)n_cpus, 0);
+    unsigned long long top = 0;
+    for (long cpu = 0; cpu < n_cpus; cpu++) {
+        char path[96];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%ld/cpufreq/cpuinfo_max_freq", cpu);
+        FILE* f = fopen(path, "r");
+        if (f == nullptr) {
+            return -1; // no cpufreq (container, old kernel): unreadable
+        }
+        unsigned long long khz = 0;
+        int got = fscanf(f, "%llu", &khz);
+        fclose(f);
+        if (got != 1) {
+            return -1;
+        }
+        ceiling[(size_t)cpu] = khz;
+        top = khz > top ? khz : top;
+    }
+    bool uniform = true;
+    for (long cpu = 0; cpu < n_cpus; cpu++) {
+        if (ceiling[(size_t)cpu] != top) {
+            uniform = false;
+            break;
+        }
+    }
+    if (uniform) {
+        return 0; // homogeneous part; pinning buys nothing
+    }
+    int n_big = 0;
+    for (long cpu = 0; cpu < n_cpus; cpu++) {
+        if (ceiling[(size_t)cpu] == top) {
+            if (cpus != nullptr && (size_t)n_big < cap) {
+                cpus[n_big] = (uint32_t)cpu;
+            }
+            n_big++;
+        }
+    }
+    return n_big;
+#else
+    (void)cpus;
+    (void)cap;
+    return -1;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Lock-free SPSC frame queue
+//
+// A single-producer/single-consumer ring of fixed-size frames for handing
+// capture data to an inference thread without locks. One slot is kept free
+// to distinguish full from empty, so usable capacity is `capacity`. Only
+// the head index is written by the consumer and only the tail by the
+// producer (acquire/release ordering); push/pop are wait-free.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct frame_queue {
+    std::vector<float> storage;
+    size_t frame_size = 0;
+    size_t slots = 0; // capacity + 1
+    std::atomic<size_t> head{0}; // next frame to pop (consumer-owned)
+    std::atomic<size_t> tail{0}; // next free slot (producer-owned)
+};
+
+static frame_queue s_frame_queue;
+
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_frame_queue_init(size_t frame_size, size_t capacity) {
+    if (frame_size == 0 || capacity == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_frame_queue.frame_size = frame_size;
+    s_frame_queue.slots = capacity + 1;
+    s_frame_queue.storage.assign(frame_size * s_frame_queue.slots, 0.0f);
+    s_frame_queue.head.store(0, std::memory_order_relaxed);
+    s_frame_queue.tail.store(0, std::memory_order_relaxed);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_frame_queue_deinit(void) {
+    s_frame_queue.storage.clear();
+    s_frame_queue.storage.shrink_to_fit();
+    s_frame_queue.frame_size = 0;
+    s_frame_queue.slots = 0;
+    s_frame_queue.head.store(0, std::memory_order_relaxed);
+    s_frame_queue.tail.store(0, std::memory_order_relaxed);
+}
+
+// Producer side. Returns 1 when the frame was enqueued, 0 when the queue is
+// full (caller decides whether to drop or retry).
+__attribute__((visibility("default"))) int ei_ffi_frame_queue_push(const float* frame) {
+    if (frame == nullptr || s_frame_queue.slots == 0) {
+        return 0;
+    }
+    size_t tail = s_frame_queue.tail.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % s_frame_queue.slots;
+    if (next == s_frame_queue.head.load(std::memory_order_acquire)) {
+        return 0; // full
+    }
+    memcpy(&s_frame_queue.storage[tail * s_frame_queue.frame_size], frame,
+           s_frame_queue.frame_size * sizeof(float));
+    s_frame_queue.tail.store(next, std::memory_order_release);
+    return 1;
+}
+
+// Consumer side. Returns 1 when a frame was dequeued into frame_out, 0 when
+// the queue is empty.
+__attribute__((visibility("default"))) int ei_ffi_frame_queue_pop(float* frame_out) {
+    if (frame_out == nullptr || s_frame_queue.slots == 0) {
+        return 0;
+    }
+    size_t head = s_frame_queue.head.load(std::memory_order_relaxed);
+    if (head == s_frame_queue.tail.load(std::memory_order_acquire)) {
+        return 0; // empty
+    }
+    memcpy(frame_out, &s_frame_queue.storage[head * s_frame_queue.frame_size],
+           s_frame_queue.frame_size * sizeof(float));
+    s_frame_queue.head.store((head + 1) % s_frame_queue.slots, std::memory_order_release);
+    return 1;
+}
+
+__attribute__((visibility("default"))) size_t ei_ffi_frame_queue_depth(void) {
+    if (s_frame_queue.slots == 0) {
+        return 0;
+    }
+    size_t head = s_frame_queue.head.load(std::memory_order_acquire);
+    size_t tail = s_frame_queue.tail.load(std::memory_order_acquire);
+    return (tail + s_frame_queue.slots - head) % s_frame_queue.slots;
+}
+
+// ---------------------------------------------------------------------------
+// Latency-bounded frame-skip governor
+//
+// Under overload the frame queue grows and every result describes an
+// increasingly old frame. The governor bounds result age instead: given a
+// latency budget and a running estimate of the per-inference cost (fed from
+// the timing the SDK already writes into ei_impulse_result_t), popping
+// through ei_ffi_frame_queue_pop_fresh discards the oldest frames until the
+// backlog fits inside the budget, then returns the survivor. When the
+// device keeps up, nothing is dropped and pop_fresh degrades to a plain
+// pop.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::atomic<uint32_t> s_latency_budget_ms{0};
+// EWMA of per-inference cost in microseconds; 0 until the first sample.
+std::atomic<uint64_t> s_invoke_ewma_us{0};
+std::atomic<uint64_t> s_governor_dropped{0};
+
+} // namespace
+
+// Bound on end-to-end result age; 0 disables the governor. Frames are only
+// dropped once an invoke-time estimate exists, so feed results to
+// ei_ffi_governor_note_result from the consumer loop.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_latency_budget(uint32_t budget_ms) {
+    s_latency_budget_ms.store(budget_ms, std::memory_order_relaxed);
+    return EI_IMPULSE_OK;
+}
+
+// Feed a finished result's timing into the invoke-time estimate (EWMA,
+// weight 1/4 on the new sample so one slow frame does not trigger a drop
+// burst).
+__attribute__((visibility("default"))) void ei_ffi_governor_note_result(const ei_impulse_result_t* result) {
+    if (result == nullptr) {
+        return;
+    }
+    uint64_t invoke_us = (uint64_t)result->timing.dsp_us +
+        (uint64_t)result->timing.classification_us +
+        (uint64_t)result->timing.anomaly_us;
+    if (invoke_us == 0) {
+        return;
+    }
+    uint64_t ewma = s_invoke_ewma_us.load(std::memory_order_relaxed);
+    s_invoke_ewma_us.store(ewma == 0 ? invoke_us : (3 * ewma + invoke_us) / 4,
+                           std::memory_order_relaxed);
+}
+
+// Consumer-side pop that enforces the budget: frames the consumer cannot
+// reach within the budget (backlog depth x estimated invoke time) are
+// discarded oldest-first, coalescing the queue toward the newest frame.
+// Returns 1 when a frame was written to frame_out, 0 when the queue is
+// empty. Call only from the queue's consumer thread.
+__attribute__((visibility("default"))) int ei_ffi_frame_queue_pop_fresh(float* frame_out) {
+    uint32_t budget_ms = s_latency_budget_ms.load(std::memory_order_relaxed);
+    uint64_t invoke_us = s_invoke_ewma_us.load(std::memory_order_relaxed);
+    if (budget_ms > 0 && invoke_us > 0) {
+        // Deepest backlog whose last frame still comes out within budget.
+        size_t max_depth = (size_t)(((uint64_t)budget_ms * 1000u) / invoke_us);
+        if (max_depth == 0) {
+            max_depth = 1; // always run the newest frame
+        }
+        while (ei_ffi_frame_queue_depth() > max_depth) {
+            size_t head = s_frame_queue.head.load(std::memory_order_relaxed);
+            s_frame_queue.head.store((head + 1) % s_frame_queue.slots,
+                                     std::memory_order_release);
+            s_governor_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return ei_ffi_frame_queue_pop(frame_out);
+}
+
+// Total frames discarded by the governor since process start.
+__attribute__((visibility("default"))) uint64_t ei_ffi_governor_dropped(void) {
+    return s_governor_dropped.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
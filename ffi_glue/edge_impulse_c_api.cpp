@@ -3,12 +3,192 @@
 #include "edge-impulse-sdk/classifier/ei_run_classifier.h"
 #include "edge-impulse-sdk/classifier/postprocessing/ei_postprocessing_common.h"
 #include "edge-impulse-sdk/dsp/numpy.hpp"
+#include "edge-impulse-sdk/dsp/image/processing.hpp"
+
+// Postprocessing chain sequenced as direct calls by build.rs; absent when
+// the block table in model_variables.h is not statically parseable, in
+// which case ei_ffi_postprocess keeps the SDK's dynamic walk.
+#if defined(__has_include)
+#if __has_include("model-parameters/ei_postprocess_chain.h")
+#include "model-parameters/ei_postprocess_chain.h"
+#endif
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE) && defined(EI_FFI_TRUSTED_MODEL)
+// Verifier for model files loaded at runtime (the embedded blob skips
+// verification in trusted-model builds; see ei_ffi_map_model_weights).
+#include "tensorflow/lite/schema/schema_generated.h"
+#endif
+
+// Branch-likelihood annotations for the invoke chain. The argument and
+// error checks below never fire in steady-state production, but on the
+// in-order cores this crate ships to (Cortex-A7/A53) every mispredicted
+// guard stalls the frontend; pinning the expected direction keeps the
+// fall-through path straight-line. C++17 has no [[likely]], so this uses
+// the builtin on compilers that have it and costs nothing elsewhere.
+#if defined(__GNUC__) || defined(__clang__)
+#define EI_FFI_LIKELY(x) __builtin_expect(!!(x), 1)
+#define EI_FFI_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define EI_FFI_LIKELY(x) (x)
+#define EI_FFI_UNLIKELY(x) (x)
+#endif
 
 // Forward declaration of the default impulse (C++ linkage)
 extern ei_impulse_handle_t& ei_default_impulse;
 
 extern "C" {
 
+// ---------------------------------------------------------------------------
+// Multi-instance classifier handles
+//
+// Every handle owns its own interpreter state (tensor arena, continuous-mode
+// buffers), but all handles share the same read-only impulse description and
+// model weights. This lets N streams run in one process instead of N forked
+// address spaces.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) ei_impulse_handle_t* ei_ffi_create_instance(void) {
+    // Share the impulse description (graph config, weights) with the default
+    // impulse; only the mutable per-instance state is new.
+    ei_impulse_handle_t* handle = new (std::nothrow) ei_impulse_handle_t(ei_default_impulse.impulse);
+    if (handle == nullptr) {
+        return nullptr;
+    }
+
+    if (::init_impulse(handle) != EI_IMPULSE_OK) {
+        delete handle;
+        return nullptr;
+    }
+
+    return handle;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_destroy_instance(ei_impulse_handle_t* handle) {
+    if (handle == nullptr || handle == &ei_default_impulse) {
+        // The default impulse is process-global and is torn down via
+        // ei_ffi_run_classifier_deinit(), never through a handle.
+        return;
+    }
+    delete handle;
+}
+
+// Defined in capture_support.cpp; records the signal/result pair when
+// capture mode is enabled, otherwise a single atomic load.
+void ei_ffi_internal_capture_note(signal_t* signal, const ei_impulse_result_t* result);
+
+// Defined in tflite_profiler_support.cpp: arm the invoke deadline before a
+// classify and, after a failed one, tell whether the timeout tripped so the
+// cancellation surfaces as EI_IMPULSE_CANCELED rather than a generic
+// interpreter error.
+void ei_ffi_internal_arm_invoke_deadline(void);
+bool ei_ffi_internal_invoke_timed_out(void);
+
+// Defined in result_cache_support.cpp: content-hash memo cache for the
+// default-impulse path. try returns true on a hit (result filled, invoke
+// skipped); store detaches a fresh result under the hash try computed.
+// Disabled cost is one atomic load each.
+bool ei_ffi_internal_result_cache_try(signal_t* signal, ei_impulse_result_t* result);
+void ei_ffi_internal_result_cache_store(const ei_impulse_result_t* result);
+
+// Defined with the threshold tuning section below: drain the epoch-
+// published threshold batch, if any, before the frame starts, so
+// postprocessing never observes a partial multi-field config update.
+// Idle cost is one relaxed load.
+void ei_ffi_internal_apply_pending_thresholds(void);
+
+// Defined in stats_ring_support.cpp: append this frame's telemetry to
+// the persistent stats ring when one is open; one relaxed load otherwise.
+void ei_ffi_internal_stats_ring_note(const ei_impulse_result_t* result);
+
+// Defined with the runtime-config section below: drain the epoch-
+// published unified config snapshot (thresholds, class filter, top-k)
+// before the frame starts, and trim a successful frame's box list to
+// the configured top-k. Idle cost is one relaxed load each.
+void ei_ffi_internal_apply_pending_config(void);
+void ei_ffi_internal_apply_top_k(ei_impulse_result_t* result);
+
+// Defined in aggregator_support.cpp: fold this frame's result into the
+// native aggregation window when one is open; one relaxed load otherwise.
+void ei_ffi_internal_aggregator_note(const ei_impulse_result_t* result);
+
+// Defined in dsp_parallel_support.cpp: run one DSP block's extractor,
+// fanning a multi-axis spectral-analysis block out per axis across the
+// shared pthreadpool when one is live; serial otherwise.
+int ei_ffi_internal_extract_block(const ei_model_dsp_t* block, signal_t* signal, ei::matrix_t* output, float frequency);
+
+// Defined in error_detail_support.cpp: record thread-local failure
+// detail for ei_ffi_last_error. Called only on paths already returning
+// an error, so the success path never touches it.
+void ei_ffi_internal_note_error(int code, int stage, uint32_t block_id, int os_errno, const char* message);
+
+// Defined in tflite_profiler_support.cpp: drop every pointer that TU
+// cached off the (now destroyed) interpreter -- profiler buffers, tensor
+// watches, pinned arena regions. Teardown path only.
+void ei_ffi_internal_profiler_release(void);
+
+// Defined in dsp_arena_support.cpp: free the calling thread's DSP arena
+// backing immediately. Teardown path only.
+void ei_ffi_internal_dsp_arena_release(void);
+
+// Defined in latency_trace_support.cpp: absolute per-stage timestamps for
+// frames the caller stamped with ei_ffi_signal_set_capture_time. One
+// thread-local pointer compare per frame when no stamp is pending.
+void ei_ffi_internal_latency_note_start(const void* signal);
+void ei_ffi_internal_latency_note_done(const ei_impulse_result_t* result);
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_on(ei_impulse_handle_t* handle, signal_t* signal, ei_impulse_result_t* result, int debug) {
+    if (EI_FFI_UNLIKELY(handle == nullptr)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    ei_ffi_internal_latency_note_start(signal);
+    ei_ffi_internal_apply_pending_thresholds();
+    ei_ffi_internal_apply_pending_config();
+    ei_ffi_internal_arm_invoke_deadline();
+    EI_IMPULSE_ERROR res = ::run_classifier(handle, signal, result, debug);
+    if (EI_FFI_LIKELY(res == EI_IMPULSE_OK)) {
+        ei_ffi_internal_apply_top_k(result);
+        ei_ffi_internal_capture_note(signal, result);
+        ei_ffi_internal_stats_ring_note(result);
+        ei_ffi_internal_aggregator_note(result);
+        ei_ffi_internal_latency_note_done(result);
+    }
+    else if (ei_ffi_internal_invoke_timed_out()) {
+        res = EI_IMPULSE_CANCELED;
+        ei_ffi_internal_note_error(res, EI_FFI_STAGE_INFERENCE, 0, 0,
+                                   "invoke deadline tripped");
+    }
+    else {
+        ei_ffi_internal_note_error(res, EI_FFI_STAGE_INFERENCE, 0, 0,
+                                   "run_classifier (explicit handle)");
+    }
+    return res;
+}
+
 __attribute__((visibility("default"))) void ei_ffi_run_classifier_init(void) {
     ::run_classifier_init();
 }
@@ -17,82 +197,3087 @@ __attribute__((visibility("default"))) void ei_ffi_run_classifier_deinit(void) {
     ::run_classifier_deinit();
 }
 
+// Full teardown for hosts that dlclose the model library after use.
+// ei_ffi_run_classifier_deinit() only destroys what init allocated; the
+// glue accretes its own state around the engine -- threadpool, caches,
+// capture/aggregation buffers, profiler attachments, DSP arenas -- and a
+// multi-tenant server that unloads a tenant leaks all of it unless every
+// piece is released. This walks the lot in dependency order (engine
+// first, so nothing here still references interpreter memory). Safe to
+// call without a prior init, and ei_ffi_run_classifier_init() brings the
+// library back to a usable state afterwards. The DSP arena is per-thread:
+// call this on the thread that ran this tenant's invokes.
+__attribute__((visibility("default"))) void ei_ffi_teardown(void) {
+    ei_ffi_stop_memory_trace();
+    ::run_classifier_deinit();
+    ei_ffi_internal_profiler_release();
+    ei_ffi_threadpool_deinit();
+    ei_ffi_lstm_sequence_deinit();
+    ei_ffi_spectral_cache_deinit();
+    ei_ffi_disable_result_cache();
+    ei_ffi_disable_capture();
+    ei_ffi_frame_delta_disable();
+    ei_ffi_aggregator_destroy();
+    ei_ffi_smoothing_reset();
+    ei_ffi_internal_dsp_arena_release();
+    ei_ffi_build_arena_release();
+}
+
 __attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_init_impulse(ei_impulse_handle_t* handle) {
     return ::init_impulse(handle);
 }
 
 __attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier(signal_t* signal, ei_impulse_result_t* result, int debug) {
-    return ::run_classifier(signal, result, debug);
+    ei_ffi_internal_latency_note_start(signal);
+    if (ei_ffi_internal_result_cache_try(signal, result)) {
+        ei_ffi_internal_latency_note_done(result);
+        return EI_IMPULSE_OK;
+    }
+    ei_ffi_internal_apply_pending_thresholds();
+    ei_ffi_internal_apply_pending_config();
+    ei_ffi_internal_arm_invoke_deadline();
+    EI_IMPULSE_ERROR res = ::run_classifier(signal, result, debug);
+    if (EI_FFI_LIKELY(res == EI_IMPULSE_OK)) {
+        ei_ffi_internal_apply_top_k(result);
+        ei_ffi_internal_capture_note(signal, result);
+        ei_ffi_internal_result_cache_store(result);
+        ei_ffi_internal_stats_ring_note(result);
+        ei_ffi_internal_aggregator_note(result);
+        ei_ffi_internal_latency_note_done(result);
+    }
+    else if (ei_ffi_internal_invoke_timed_out()) {
+        res = EI_IMPULSE_CANCELED;
+        ei_ffi_internal_note_error(res, EI_FFI_STAGE_INFERENCE, 0, 0,
+                                   "invoke deadline tripped");
+    }
+    else {
+        ei_ffi_internal_note_error(res, EI_FFI_STAGE_INFERENCE, 0, 0,
+                                   "run_classifier (default impulse)");
+    }
+    return res;
 }
 
-__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous(signal_t* signal, ei_impulse_result_t* result, int debug, int enable_maf_unused) {
-    return ::run_classifier_continuous(signal, result, debug, enable_maf_unused);
+// ---------------------------------------------------------------------------
+// Bound signals: validate once, classify many
+//
+// Fixed-pipeline deployments call classify at sensor rate with the same
+// handle and the same reusable signal every time; re-checking pointers
+// and the frame length 200 times a second buys nothing after the first
+// call. ei_ffi_signal_bind runs the full validation once and stamps a
+// token; the bound classify path checks nothing but the stamp (one
+// integer compare) before invoking. The instrumentation hooks (threshold
+// drain, invoke deadline, capture and aggregator notes) stay -- they are relaxed loads,
+// not validation -- but the bound path deliberately skips the result
+// cache, whose per-call signal hash is exactly the kind of steady-state
+// work being shaved here.
+
+namespace {
+
+constexpr uint32_t kBoundSignalMagic = 0x444e4245; // "EBND"
+
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_bind(ei_impulse_handle_t* handle, signal_t* signal, ei_ffi_bound_signal_t* token) {
+    if (signal == nullptr || token == nullptr || signal->get_data == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (signal->total_length != (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    token->handle = handle != nullptr ? handle : &ei_default_impulse;
+    token->signal = signal;
+    token->magic = kBoundSignalMagic;
+    return EI_IMPULSE_OK;
 }
 
-__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_inference(ei_impulse_handle_t* handle, ei_feature_t* fmatrix, ei_impulse_result_t* result, int debug) {
-    return ::run_inference(handle, fmatrix, result, debug);
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_bound(ei_ffi_bound_signal_t* token, ei_impulse_result_t* result, int debug) {
+    if (EI_FFI_UNLIKELY(token == nullptr || token->magic != kBoundSignalMagic)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    ei_ffi_internal_apply_pending_thresholds();
+    ei_ffi_internal_apply_pending_config();
+    ei_ffi_internal_arm_invoke_deadline();
+    EI_IMPULSE_ERROR res = ::run_classifier(token->handle, token->signal, result, debug);
+    if (EI_FFI_LIKELY(res == EI_IMPULSE_OK)) {
+        ei_ffi_internal_apply_top_k(result);
+        ei_ffi_internal_capture_note(token->signal, result);
+        ei_ffi_internal_aggregator_note(result);
+    }
+    else if (ei_ffi_internal_invoke_timed_out()) {
+        res = EI_IMPULSE_CANCELED;
+    }
+    return res;
 }
 
-// Helper function to create signal from buffer (like EIM binary)
-__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_buffer(const float* data, size_t data_size, signal_t* signal) {
-    return static_cast<EI_IMPULSE_ERROR>(ei::numpy::signal_from_buffer(data, data_size, signal));
+// ---------------------------------------------------------------------------
+// Distributed tracing
+//
+// One thread-local trace id follows a frame through whatever runs on the
+// invoke thread -- DSP, inference, postprocessing, the capture note, and
+// any completion callback -- so correlating a slow frame across
+// capture -> inference -> publish is a join on the id, not guesswork. The
+// hot path pays a thread-local store and restore, nothing else; 0 means
+// untraced. Engines that move invokes to worker threads (the async
+// engine) carry the submitter's id across and install it around the run.
+// ---------------------------------------------------------------------------
+
+static thread_local uint64_t s_trace_id = 0;
+
+// Cross-TU hooks for the capture log and the worker-thread engines; not
+// part of the public surface.
+__attribute__((visibility("default"))) uint64_t ei_ffi_internal_current_trace(void) {
+    return s_trace_id;
 }
 
-// Threshold setting functions - Updated for current SDK structure
-__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_object_detection_threshold(uint32_t block_id, float min_score) {
-    // Find the postprocessing block with the specified block_id
-    for (size_t i = 0; i < ei_default_impulse.impulse->postprocessing_blocks_size; i++) {
-        const ei_postprocessing_block_t& block = ei_default_impulse.impulse->postprocessing_blocks[i];
-        if (block.block_id == block_id) {
-            // Check if this is an object detection block
-            if (block.config != nullptr && block.type == EI_CLASSIFIER_MODE_OBJECT_DETECTION) {
-                // For object detection, the threshold is typically stored in the config
-                // The exact structure depends on the postprocessing type
-                // For now, we'll return success as the threshold is usually set at model generation time
-                return EI_IMPULSE_OK;
+__attribute__((visibility("default"))) void ei_ffi_internal_set_trace(uint64_t trace_id) {
+    s_trace_id = trace_id;
+}
+
+// The calling thread's current trace id; valid inside completion and
+// telemetry callbacks, which fire on the thread that ran the invoke.
+__attribute__((visibility("default"))) uint64_t ei_ffi_trace_id(void) {
+    return s_trace_id;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_traced(signal_t* signal, ei_impulse_result_t* result, uint64_t trace_id, int debug) {
+    uint64_t prev = s_trace_id;
+    s_trace_id = trace_id;
+    EI_IMPULSE_ERROR res = ei_ffi_run_classifier(signal, result, debug);
+    s_trace_id = prev;
+    return res;
+}
+
+// ---------------------------------------------------------------------------
+// Anomaly-gated cascade
+//
+// For deployments that cascade an anomaly stage in front of a classifier:
+// run the gate impulse first and skip the main impulse entirely while the
+// anomaly score stays below the gate, so the ~95% of normal frames never
+// pay for the full classifier invoke. run_classifier itself always executes
+// every learn block of an impulse, which is why the gate is a separate
+// (cheaper) impulse handle rather than a flag on one impulse.
+// ---------------------------------------------------------------------------
+
+// `gate_handle` / `main_handle` may be NULL to use the default impulse.
+// When the gate score is below `anomaly_gate`, `result` holds the gate
+// stage's result and `gated_out` (optional) is set to 1; otherwise the main
+// impulse runs on the same signal and `gated_out` is 0.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_gated(ei_impulse_handle_t* gate_handle, ei_impulse_handle_t* main_handle, signal_t* signal, ei_impulse_result_t* result, float anomaly_gate, int* gated_out, int debug) {
+    if (signal == nullptr || result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (gate_handle == nullptr) {
+        gate_handle = &ei_default_impulse;
+    }
+    if (main_handle == nullptr) {
+        main_handle = &ei_default_impulse;
+    }
+
+    EI_IMPULSE_ERROR res = ::run_classifier(gate_handle, signal, result, debug);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    if (result->anomaly < anomaly_gate) {
+        if (gated_out != nullptr) {
+            *gated_out = 1;
+        }
+        return EI_IMPULSE_OK;
+    }
+
+    if (gated_out != nullptr) {
+        *gated_out = 0;
+    }
+    return ::run_classifier(main_handle, signal, result, debug);
+}
+
+// ---------------------------------------------------------------------------
+// Multi-model cascades
+//
+// Generalizes the two-stage gate above to N impulses in one process: each
+// stage classifies the same signal (no copies, no IPC hop) and the cascade
+// early-exits when a stage's top classification score stays below its gate
+// threshold. The classic shape is a cheap "anything there?" gate in front
+// of an expensive detector.
+// ---------------------------------------------------------------------------
+
+struct ei_ffi_cascade {
+    std::vector<ei_impulse_handle_t*> stages;
+    std::vector<float> gates;
+};
+
+// `handles[i]` may be NULL for the default impulse. `gate_thresholds[i]` is
+// the minimum top classification score required to run stage i+1; a value
+// <= 0 always continues, and the last stage's threshold is ignored.
+// `gate_thresholds` itself may be NULL (no gating, plain sequence).
+__attribute__((visibility("default"))) ei_ffi_cascade* ei_ffi_cascade_create(ei_impulse_handle_t* const* handles, size_t n_stages, const float* gate_thresholds) {
+    if (handles == nullptr || n_stages == 0) {
+        return nullptr;
+    }
+    ei_ffi_cascade* cascade = new (std::nothrow) ei_ffi_cascade();
+    if (cascade == nullptr) {
+        return nullptr;
+    }
+    for (size_t ix = 0; ix < n_stages; ix++) {
+        cascade->stages.push_back(handles[ix] != nullptr ? handles[ix] : &ei_default_impulse);
+        cascade->gates.push_back(gate_thresholds != nullptr ? gate_thresholds[ix] : 0.0f);
+    }
+    return cascade;
+}
+
+// Runs stages in order over the same signal. `results` must have room for
+// one ei_impulse_result_t per stage; `stages_run` (optional) reports how
+// many stages actually executed before a gate stopped the cascade.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_cascade_run(ei_ffi_cascade* cascade, signal_t* signal, ei_impulse_result_t* results, size_t* stages_run, int debug) {
+    if (cascade == nullptr || signal == nullptr || results == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (stages_run != nullptr) {
+        *stages_run = 0;
+    }
+
+    for (size_t ix = 0; ix < cascade->stages.size(); ix++) {
+        ei_impulse_handle_t* handle = cascade->stages[ix];
+        results[ix] = {};
+        EI_IMPULSE_ERROR res = ::run_classifier(handle, signal, &results[ix], debug);
+        if (res != EI_IMPULSE_OK) {
+            return res;
+        }
+        if (stages_run != nullptr) {
+            *stages_run = ix + 1;
+        }
+
+        if (ix + 1 >= cascade->stages.size() || cascade->gates[ix] <= 0.0f) {
+            continue;
+        }
+        float top_score = 0.0f;
+        for (uint32_t cls = 0; cls < handle->impulse->label_count; cls++) {
+            if (results[ix].classification[cls].value > top_score) {
+                top_score = results[ix].classification[cls].value;
             }
         }
+        if (top_score < cascade->gates[ix]) {
+            break;
+        }
     }
-    return EI_IMPULSE_INFERENCE_ERROR;
+    return EI_IMPULSE_OK;
 }
 
-__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_anomaly_threshold(uint32_t block_id, float min_anomaly_score) {
-    // Find the postprocessing block with the specified block_id
-    for (size_t i = 0; i < ei_default_impulse.impulse->postprocessing_blocks_size; i++) {
-        const ei_postprocessing_block_t& block = ei_default_impulse.impulse->postprocessing_blocks[i];
-        if (block.block_id == block_id) {
-            // Check if this is a visual anomaly detection block
-            if (block.config != nullptr && block.type == EI_CLASSIFIER_MODE_VISUAL_ANOMALY) {
-                // For visual anomaly detection, update the threshold in the config
-                ei_fill_result_visual_ad_f32_config_t* config =
-                    static_cast<ei_fill_result_visual_ad_f32_config_t*>(block.config);
-                config->threshold = min_anomaly_score;
-                return EI_IMPULSE_OK;
+__attribute__((visibility("default"))) void ei_ffi_cascade_destroy(ei_ffi_cascade* cascade) {
+    delete cascade;
+}
+
+// ---------------------------------------------------------------------------
+// Sliding-window inference over long buffers
+//
+// Classifies every window of EI_CLASSIFIER_RAW_SAMPLE_COUNT samples in a
+// long recording, advancing by `stride` samples. Windows borrow sub-spans
+// of the caller's buffer (no copies). When the stride equals the model's
+// slice size the continuous pipeline is used, so overlapping windows reuse
+// the rolling MFE/MFCC feature buffer instead of recomputing shared
+// columns; for any other stride each window runs standalone.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_sliding(const float* samples, size_t sample_count, size_t stride, ei_ffi_window_result_cb callback, void* user_data, int debug) {
+    if (samples == nullptr || callback == nullptr || stride == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const size_t window = EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+    if (sample_count < window) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    const size_t slice = EI_CLASSIFIER_SLICE_SIZE;
+    if (stride == slice) {
+        // Continuous path: feed slices, features roll through the window.
+        ::run_classifier_init();
+        for (size_t offset = 0; offset + slice <= sample_count; offset += slice) {
+            signal_t signal;
+            ei::numpy::signal_from_buffer(samples + offset, slice, &signal);
+            ei_impulse_result_t result = {};
+            EI_IMPULSE_ERROR res = ::run_classifier_continuous(&signal, &result, debug, 1);
+            if (res != EI_IMPULSE_OK) {
+                ::run_classifier_deinit();
+                return res;
+            }
+            // The first full window of slices only warms the feature buffer.
+            if (offset + slice >= window) {
+                callback(offset + slice - window, EI_IMPULSE_OK, &result, user_data);
             }
         }
+        ::run_classifier_deinit();
+        return EI_IMPULSE_OK;
     }
-    return EI_IMPULSE_INFERENCE_ERROR;
+
+    for (size_t offset = 0; offset + window <= sample_count; offset += stride) {
+        signal_t signal;
+        ei::numpy::signal_from_buffer(samples + offset, window, &signal);
+        ei_impulse_result_t result = {};
+        EI_IMPULSE_ERROR res = ::run_classifier(&signal, &result, debug);
+        if (res != EI_IMPULSE_OK) {
+            return res;
+        }
+        callback(offset, EI_IMPULSE_OK, &result, user_data);
+    }
+    return EI_IMPULSE_OK;
 }
 
-__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_object_tracking_threshold(uint32_t block_id, float threshold, uint32_t keep_grace, uint16_t max_observations) {
-    // Find the postprocessing block with the specified block_id
-    for (size_t i = 0; i < ei_default_impulse.impulse->postprocessing_blocks_size; i++) {
-        const ei_postprocessing_block_t& block = ei_default_impulse.impulse->postprocessing_blocks[i];
-        if (block.block_id == block_id) {
-            // Check if this is an object tracking block (object tracking is typically a postprocessing feature)
-            if (block.config != nullptr) {
-                // Try to cast to object tracking config - this will work if it's the right type
-                ei_object_tracking_config_t* config =
-                    static_cast<ei_object_tracking_config_t*>(block.config);
+// ---------------------------------------------------------------------------
+// Warm-up
+//
+// The first invoke pays for tensor arena allocation, delegate weight
+// packing (XNNPACK repacks on first use) and the soft page faults of
+// touching the arena. Running a few zero-input inferences up front moves
+// that cost out of the first real frame.
+// ---------------------------------------------------------------------------
 
-                config->threshold = threshold;
-                config->keep_grace = keep_grace;
-                config->max_observations = max_observations;
-                return EI_IMPULSE_OK;
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_warmup_on(ei_impulse_handle_t* handle, int iterations) {
+    if (handle == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    size_t frame_size = handle->impulse->nn_input_frame_size;
+    std::vector<float> zeros(frame_size, 0.0f);
+    ei::matrix_t features(1, frame_size, zeros.data());
+    ei_feature_t fmatrix;
+    fmatrix.matrix = &features;
+    fmatrix.blocks_processed = true;
+
+    ei_impulse_result_t result = {};
+    for (int ix = 0; ix < iterations; ix++) {
+        EI_IMPULSE_ERROR res = ::run_inference(handle, &fmatrix, &result, false);
+        if (res != EI_IMPULSE_OK) {
+            return res;
+        }
+    }
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_warmup(int iterations) {
+    return ei_ffi_warmup_on(&ei_default_impulse, iterations);
+}
+
+// Asynchronous variant for startup paths: interpreter construction,
+// flatbuffer verification, delegate planning and weight packing all
+// happen on a background thread while the application finishes its own
+// init, and the first real inference only waits for whatever is left.
+// A true snapshot/restore of prepared interpreter state is not possible
+// against the runtime (its plan is a web of internal pointers with no
+// serialization hooks), so overlapping the preparation is the lever
+// that exists.
+
+namespace {
+struct warmup_job {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+    bool running = false;
+    bool done = false;
+    EI_IMPULSE_ERROR result = EI_IMPULSE_OK;
+    uint64_t elapsed_us = 0;
+};
+static warmup_job s_warmup;
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_warmup_async(int iterations) {
+    std::lock_guard<std::mutex> lock(s_warmup.mutex);
+    if (s_warmup.running) {
+        return EI_IMPULSE_INFERENCE_ERROR; // one in flight at a time
+    }
+    if (s_warmup.worker.joinable()) {
+        s_warmup.worker.join();
+    }
+    s_warmup.running = true;
+    s_warmup.done = false;
+    s_warmup.worker = std::thread([iterations] {
+        auto started = std::chrono::steady_clock::now();
+#if defined(__linux__) || defined(__APPLE__)
+        // Overlap weight readahead with the warm-up invokes (and any
+        // delegate planning they trigger); harmless no-op when the model
+        // is embedded rather than mapped.
+        ei_ffi_prefetch_weights();
+#endif
+        EI_IMPULSE_ERROR res = ei_ffi_warmup(iterations);
+        uint64_t elapsed = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+        {
+            std::lock_guard<std::mutex> lock(s_warmup.mutex);
+            s_warmup.result = res;
+            s_warmup.elapsed_us = elapsed;
+            s_warmup.running = false;
+            s_warmup.done = true;
+        }
+        s_warmup.cv.notify_all();
+    });
+    return EI_IMPULSE_OK;
+}
+
+// Block until the background warm-up finishes and return its result.
+// `elapsed_us_out` (optional) reports how long the preparation took.
+// Calling without a pending warm-up returns the last result, or an error
+// if none was ever started.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_warmup_wait(uint64_t* elapsed_us_out) {
+    std::unique_lock<std::mutex> lock(s_warmup.mutex);
+    if (!s_warmup.running && !s_warmup.done) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_warmup.cv.wait(lock, [] { return s_warmup.done; });
+    if (s_warmup.worker.joinable()) {
+        s_warmup.worker.join();
+    }
+    if (elapsed_us_out != nullptr) {
+        *elapsed_us_out = s_warmup.elapsed_us;
+    }
+    return s_warmup.result;
+}
+
+// ---------------------------------------------------------------------------
+// Memory-mapped model weights
+//
+// The embedded (INCBIN) model lives in .rodata and is already shared
+// between processes running the same binary via the page cache. For
+// deployments that ship weights as a separate .tflite file,
+// ei_ffi_map_model_weights maps that file read-only/MAP_SHARED and points
+// the learn block's graph config at the mapping, so N processes share one
+// physical copy of the weights. Only works for non-EON (flatbuffer) models;
+// compiled models have no graph to swap. Callers must re-run
+// ei_ffi_run_classifier_init (or init their handles) afterwards so the
+// interpreter rebuilds against the new buffer.
+// ---------------------------------------------------------------------------
+
+#if defined(__linux__) || defined(__APPLE__)
+
+namespace {
+static void* s_mapped_model = nullptr;
+static size_t s_mapped_model_size = 0;
+
+// Background weight prefetcher (see ei_ffi_prefetch_weights below).
+std::thread s_prefetch_thread;
+std::atomic<bool> s_prefetch_running{false};
+
+// A prefetch walking a mapping that is about to be munmap'd is a
+// use-after-free; remaps wait for it instead.
+void join_weight_prefetch() {
+    while (s_prefetch_running.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    if (s_prefetch_thread.joinable()) {
+        s_prefetch_thread.join();
+    }
+}
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_map_model_weights(uint32_t learn_block_index, const char* path) {
+    if (path == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+    if (learn_block_index >= impulse->learning_blocks_size) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        ei_ffi_internal_note_error(EI_IMPULSE_INFERENCE_ERROR, EI_FFI_STAGE_IO,
+                                   learn_block_index, errno, "open weights file");
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ei_ffi_internal_note_error(EI_IMPULSE_INFERENCE_ERROR, EI_FFI_STAGE_IO,
+                                   learn_block_index, errno, "stat weights file");
+        close(fd);
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    void* mapping = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps its own reference
+    if (mapping == MAP_FAILED) {
+        ei_ffi_internal_note_error(EI_IMPULSE_OUT_OF_MEMORY, EI_FFI_STAGE_IO,
+                                   learn_block_index, errno, "mmap weights file");
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE) && defined(EI_FFI_TRUSTED_MODEL)
+    // Trusted-model builds skip verification for the embedded blob, but a
+    // file loaded at runtime is not covered by the firmware signature --
+    // run the full flatbuffer verifier on it before wiring it in.
+    {
+        flatbuffers::Verifier verifier((const uint8_t*)mapping, (size_t)st.st_size);
+        if (!tflite::VerifyModelBuffer(verifier)) {
+            munmap(mapping, (size_t)st.st_size);
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+#endif
+
+    ei_learning_block_config_tflite_graph_t* block_config =
+        (ei_learning_block_config_tflite_graph_t*)impulse->learning_blocks[learn_block_index].config;
+    ei_config_tflite_graph_t* graph_config =
+        (ei_config_tflite_graph_t*)block_config->graph_config;
+
+    // Drop a previous mapping only after the new one is wired in.
+    void* old_mapping = s_mapped_model;
+    size_t old_size = s_mapped_model_size;
+
+    graph_config->model = (const unsigned char*)mapping;
+    graph_config->model_size = (size_t)st.st_size;
+    s_mapped_model = mapping;
+    s_mapped_model_size = (size_t)st.st_size;
+
+    if (old_mapping != nullptr) {
+        join_weight_prefetch();
+        munmap(old_mapping, old_size);
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Hot model swap: map new weights and rebuild the default impulse's
+// interpreter state in place, without a process restart. The graph topology
+// must match what the impulse was generated for — this is for swapping
+// retrained weights, not for loading arbitrary models. The caller must
+// quiesce in-flight inference (and recreate any instances/pools) around the
+// swap; results produced concurrently with it are undefined.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_hot_swap_model(uint32_t learn_block_index, const char* path) {
+    EI_IMPULSE_ERROR res = ei_ffi_map_model_weights(learn_block_index, path);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    ::run_classifier_deinit();
+    ::run_classifier_init();
+    return EI_IMPULSE_OK;
+}
+
+// Background weight prefetcher for cold-start smoothing. With mmap'd
+// weights the first invoke otherwise eats major page faults scattered
+// across the whole run. This walks the mapping front to back -- flatbuffer
+// serialization keeps tensor buffers in roughly graph order, which is the
+// closest execution-order approximation available without patching the
+// vendored interpreter -- issuing chunked MADV_WILLNEED and then touching
+// one byte per page so the data is actually resident, not merely queued
+// for readahead. Non-blocking; ei_ffi_warmup_async starts it
+// automatically so disk I/O overlaps delegate planning. A no-op error
+// with embedded (INCBIN) weights, which fault in at exec.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_prefetch_weights(void) {
+    if (s_mapped_model == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    bool expected = false;
+    if (!s_prefetch_running.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        return EI_IMPULSE_OK; // already in flight
+    }
+    if (s_prefetch_thread.joinable()) {
+        s_prefetch_thread.join();
+    }
+    uint8_t* base = (uint8_t*)s_mapped_model;
+    size_t size = s_mapped_model_size;
+    s_prefetch_thread = std::thread([base, size] {
+        constexpr size_t kChunk = 1 << 20;
+        constexpr size_t kPage = 4096;
+        volatile uint8_t sink = 0;
+        for (size_t off = 0; off < size; off += kChunk) {
+            size_t len = size - off < kChunk ? size - off : kChunk;
+            madvise(base + off, len, MADV_WILLNEED);
+            for (size_t page = 0; page < len; page += kPage) {
+                sink = sink + base[off + page];
+            }
+        }
+        (void)sink;
+        s_prefetch_running.store(false, std::memory_order_release);
+    });
+    return EI_IMPULSE_OK;
+}
+
+#endif // __linux__ || __APPLE__
+
+// ---------------------------------------------------------------------------
+// TensorRT engine cache location (Jetson builds)
+//
+// The SDK's TensorRT engine serializes its built plan under /tmp, which is
+// tmpfs on stock Jetson images — so every boot pays the multi-minute engine
+// build again. build.rs patches the engine path in tensorrt.h to go through
+// ei_ffi_tensorrt_cache_dir(), letting deployments point the cache at
+// persistent storage. Set the directory before the first inference.
+// ---------------------------------------------------------------------------
+
+namespace {
+static char s_tensorrt_cache_dir[256] = "/tmp";
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_tensorrt_cache_path(const char* dir) {
+    if (dir == nullptr || dir[0] == '\0' || strlen(dir) >= sizeof(s_tensorrt_cache_dir)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+#if defined(__linux__) || defined(__APPLE__)
+    struct stat st;
+    if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+#endif
+    snprintf(s_tensorrt_cache_dir, sizeof(s_tensorrt_cache_dir), "%s", dir);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) const char* ei_ffi_tensorrt_cache_dir(void) {
+    return s_tensorrt_cache_dir;
+}
+
+// ---------------------------------------------------------------------------
+// Concurrent inference via an instance pool
+//
+// run_classifier on a single handle is not thread-safe (the interpreter and
+// tensor arena are mutable state), so concurrent callers each need their own
+// instance. The pool below owns N instances behind a mutex-guarded
+// free-list; ei_ffi_run_classifier_pooled checks one out, runs on it, and
+// returns it, blocking while all instances are busy. Weights stay shared —
+// only interpreter state is replicated per pool slot.
+//
+// On multi-socket boxes a slot can additionally be given a cpuset
+// (ei_ffi_pool_set_affinity): pooled callers are pinned to it for the
+// duration of their run, and slots with a cpuset configured before pool
+// init have their instance constructed on a pinned thread, so first-touch
+// places the slot's arena pages on the local node. The read-only weights
+// remain one shared mapping; the per-slot mutable state is where the
+// memory traffic goes, and that is what gets node-local placement.
+// ---------------------------------------------------------------------------
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+struct instance_pool {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<ei_impulse_handle_t*> free_list;
+    std::vector<ei_impulse_handle_t*> all;
+    // Per-slot cpusets (indexed like `all`); empty = no pinning.
+    std::vector<std::vector<uint32_t>> cpusets;
+
+    // Autoscaling (ei_ffi_pool_set_autoscale). Shrunk slots are parked,
+    // not destroyed: the instance keeps its allocated arena, so regrowing
+    // under load is a list move instead of re-paying AllocateTensors.
+    // Parked slots only give their memory back after the deep-idle window.
+    bool autoscale = false;
+    size_t min_instances = 1;
+    size_t max_instances = 1;
+    uint64_t target_wait_us = 0;
+    std::vector<ei_impulse_handle_t*> parked;
+    uint64_t waits_us[64] = {};
+    size_t wait_count = 0;
+    std::chrono::steady_clock::time_point last_contention =
+        std::chrono::steady_clock::now();
+
+    static constexpr std::chrono::seconds kIdleTimeout{30};
+    static constexpr std::chrono::seconds kDeepIdleTimeout{300};
+
+    // Caller holds the mutex. p95 over the recent-wait ring; 0 until the
+    // ring has enough samples to be meaningful.
+    uint64_t wait_p95_us() {
+        size_t n = wait_count < 64 ? wait_count : 64;
+        if (n < 8) {
+            return 0;
+        }
+        uint64_t sorted[64];
+        memcpy(sorted, waits_us, n * sizeof(uint64_t));
+        size_t rank = (n * 95) / 100;
+        std::nth_element(sorted, sorted + rank, sorted + n);
+        return sorted[rank];
+    }
+
+    // Caller holds the mutex (released across instance creation). Unpark
+    // first -- free regrow -- and only create when nothing is parked.
+    void grow(std::unique_lock<std::mutex>& lock) {
+        if (!parked.empty()) {
+            free_list.push_back(parked.back());
+            parked.pop_back();
+            return;
+        }
+        if (all.size() >= max_instances) {
+            return;
+        }
+        lock.unlock();
+        ei_impulse_handle_t* handle = ei_ffi_create_instance();
+        lock.lock();
+        if (handle != nullptr) {
+            all.push_back(handle);
+            free_list.push_back(handle);
+        }
+    }
+
+    ei_impulse_handle_t* acquire() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (free_list.empty()) {
+            last_contention = std::chrono::steady_clock::now();
+            // Grow on contention once the measured p95 wait is over the
+            // configured bound (or immediately on a free regrow).
+            if (autoscale &&
+                (!parked.empty() || wait_p95_us() > target_wait_us)) {
+                grow(lock);
+            }
+        }
+        if (free_list.empty()) {
+            auto started = std::chrono::steady_clock::now();
+            cv.wait(lock, [this] { return !free_list.empty(); });
+            uint64_t waited =
+                (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - started)
+                    .count();
+            waits_us[wait_count++ % 64] = waited;
+            last_contention = std::chrono::steady_clock::now();
+        }
+        ei_impulse_handle_t* handle = free_list.back();
+        free_list.pop_back();
+        return handle;
+    }
+
+    void release(ei_impulse_handle_t* handle) {
+        std::vector<ei_impulse_handle_t*> retire;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            free_list.push_back(handle);
+            if (autoscale) {
+                auto idle = std::chrono::steady_clock::now() - last_contention;
+                size_t active = all.size() - parked.size();
+                if (idle > kIdleTimeout && active > min_instances && !free_list.empty()) {
+                    parked.push_back(free_list.back());
+                    free_list.pop_back();
+                }
+                if (idle > kDeepIdleTimeout && !parked.empty()) {
+                    // Long quiet: give the parked arenas back; the next
+                    // growth past min re-pays AllocateTensors once.
+                    retire.swap(parked);
+                    for (ei_impulse_handle_t* h : retire) {
+                        all.erase(std::remove(all.begin(), all.end(), h), all.end());
+                    }
+                }
+            }
+        }
+        cv.notify_one();
+        for (ei_impulse_handle_t* h : retire) {
+            ei_ffi_destroy_instance(h);
+        }
+    }
+
+    // Caller holds the mutex.
+    std::vector<uint32_t> cpuset_for(ei_impulse_handle_t* handle) {
+        for (size_t ix = 0; ix < all.size(); ix++) {
+            if (all[ix] == handle && ix < cpusets.size()) {
+                return cpusets[ix];
             }
         }
+        return {};
+    }
+};
+
+static instance_pool s_pool;
+
+#if defined(__linux__)
+bool apply_cpuset(const std::vector<uint32_t>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+#endif
+
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_instance_pool_init(size_t num_instances) {
+    std::lock_guard<std::mutex> lock(s_pool.mtx);
+    if (!s_pool.all.empty()) {
+        // Already initialized; re-init requires an explicit deinit first so
+        // we never yank instances out from under a running caller.
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t ix = 0; ix < num_instances; ix++) {
+        ei_impulse_handle_t* handle = nullptr;
+#if defined(__linux__)
+        if (ix < s_pool.cpusets.size() && !s_pool.cpusets[ix].empty()) {
+            // Construct the instance on a thread pinned to the slot's
+            // cpuset: first-touch allocation then places the arena and any
+            // per-instance tensors on that cpuset's NUMA node.
+            std::thread([&] {
+                apply_cpuset(s_pool.cpusets[ix]);
+                handle = ei_ffi_create_instance();
+            }).join();
+        }
+        else
+#endif
+        {
+            handle = ei_ffi_create_instance();
+        }
+        if (handle == nullptr) {
+            for (ei_impulse_handle_t* h : s_pool.all) {
+                ei_ffi_destroy_instance(h);
+            }
+            s_pool.all.clear();
+            s_pool.free_list.clear();
+            return EI_IMPULSE_OUT_OF_MEMORY;
+        }
+        s_pool.all.push_back(handle);
+        s_pool.free_list.push_back(handle);
+    }
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_instance_pool_deinit(void) {
+    std::unique_lock<std::mutex> lock(s_pool.mtx);
+    // Wait until every non-parked instance is back in the free-list.
+    s_pool.cv.wait(lock, [] {
+        return s_pool.free_list.size() + s_pool.parked.size() == s_pool.all.size();
+    });
+    for (ei_impulse_handle_t* handle : s_pool.all) {
+        lock.unlock();
+        ei_ffi_destroy_instance(handle);
+        lock.lock();
+    }
+    s_pool.all.clear();
+    s_pool.free_list.clear();
+    s_pool.parked.clear();
+    s_pool.autoscale = false;
+}
+
+// Autoscaling policy for the instance pool: grow toward `max_instances`
+// when the p95 acquire wait (measured over the last 64 contended
+// acquires) exceeds `target_wait_us`, park slots back toward
+// `min_instances` after 30 s without contention, and only destroy parked
+// slots -- giving their arenas back -- after five quiet minutes. Parked
+// slots regrow for free (no AllocateTensors). May be called before or
+// after pool init; min/max are clamped to at least one slot. Slot cpusets
+// are position-based, so pair them with a fixed-size pool rather than an
+// autoscaled one.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pool_set_autoscale(size_t min_instances, size_t max_instances, uint64_t target_wait_us) {
+    if (min_instances == 0 || max_instances < min_instances) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_pool.mtx);
+    s_pool.autoscale = true;
+    s_pool.min_instances = min_instances;
+    s_pool.max_instances = max_instances;
+    s_pool.target_wait_us = target_wait_us;
+    return EI_IMPULSE_OK;
+}
+
+// Pin pool slot `slot` to a cpuset (cpu indices as in /proc/cpuinfo).
+// Callers holding that slot run pinned to it, and slots configured before
+// ei_ffi_instance_pool_init get first-touch NUMA placement of their
+// instance state. n_cpus == 0 clears the pinning. Linux only; elsewhere
+// returns EI_IMPULSE_INFERENCE_ERROR.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pool_set_affinity(size_t slot, const uint32_t* cpus, size_t n_cpus) {
+#if defined(__linux__)
+    if (n_cpus > 0 && cpus == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_pool.mtx);
+    if (slot >= s_pool.cpusets.size()) {
+        s_pool.cpusets.resize(slot + 1);
     }
+    s_pool.cpusets[slot].assign(cpus, cpus + n_cpus);
+    return EI_IMPULSE_OK;
+#else
+    (void)slot;
+    (void)cpus;
+    (void)n_cpus;
     return EI_IMPULSE_INFERENCE_ERROR;
+#endif
+}
+
+// Bandwidth governor: on LPDDR-class boards, pooled throughput peaks
+// below the slot count -- the extra worker just queues behind saturated
+// memory controllers and slows everyone down. The governor caps how many
+// pooled invokes run concurrently, independent of pool size, so the
+// remaining slots stay warm (arena allocated, NUMA-placed) without
+// adding bus traffic. ei_ffi_pool_autotune_concurrency finds the knee
+// empirically, timing each cap level and sampling per-invoke DDR bytes
+// through the perf-counter surface.
+namespace {
+
+struct bandwidth_governor {
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t cap = 0; // 0 = uncapped
+    size_t running = 0;
+    uint64_t bytes_per_invoke = 0; // last autotune measurement
+
+    void enter() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this] { return cap == 0 || running < cap; });
+        running++;
+    }
+
+    void exit() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            running--;
+        }
+        cv.notify_one();
+    }
+};
+
+static bandwidth_governor s_governor;
+
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_pooled(signal_t* signal, ei_impulse_result_t* result, int debug) {
+    {
+        std::lock_guard<std::mutex> lock(s_pool.mtx);
+        if (s_pool.all.empty()) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+    ei_impulse_handle_t* handle = s_pool.acquire();
+    s_governor.enter();
+
+#if defined(__linux__)
+    // Pin the calling thread to the slot's cpuset for the run so the
+    // interpreter executes next to the slot's first-touched memory; restore
+    // the caller's own mask afterwards.
+    std::vector<uint32_t> cpuset;
+    {
+        std::lock_guard<std::mutex> lock(s_pool.mtx);
+        cpuset = s_pool.cpuset_for(handle);
+    }
+    cpu_set_t saved;
+    bool pinned = false;
+    if (!cpuset.empty() &&
+        pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0) {
+        pinned = apply_cpuset(cpuset);
+    }
+#endif
+
+    EI_IMPULSE_ERROR res = ::run_classifier(handle, signal, result, debug);
+
+#if defined(__linux__)
+    if (pinned) {
+        pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+    }
+#endif
+
+    s_governor.exit();
+    s_pool.release(handle);
+    return res;
+}
+
+// Cap concurrent pooled invokes at `max_concurrent` without shrinking the
+// pool; 0 lifts the cap. Use when total throughput peaks below the slot
+// count because memory bandwidth, not cores, is the bound.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pool_set_max_concurrency(size_t max_concurrent) {
+    {
+        std::lock_guard<std::mutex> lock(s_governor.mtx);
+        s_governor.cap = max_concurrent;
+    }
+    s_governor.cv.notify_all();
+    return EI_IMPULSE_OK;
+}
+
+// Find the throughput knee empirically: for each cap from 1 to the pool
+// size, run `iterations_per_level` pooled invokes of `signal` from that
+// many threads and time them; install the fastest cap and report it.
+// One worker per level additionally samples LLC-miss bytes per invoke
+// through the perf-counter surface (zero where the PMU is unavailable),
+// surfaced via `bytes_per_invoke_out` for the winning level -- the
+// saturation diagnosis, not just the verdict. Run at startup or in a
+// maintenance window; the sweep occupies the pool.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pool_autotune_concurrency(signal_t* signal, uint32_t iterations_per_level, size_t* best_out, uint64_t* bytes_per_invoke_out) {
+    if (signal == nullptr || iterations_per_level == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    size_t pool_size;
+    {
+        std::lock_guard<std::mutex> lock(s_pool.mtx);
+        pool_size = s_pool.all.size();
+    }
+    if (pool_size == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t best_cap = 0;
+    double best_rate = 0.0;
+    uint64_t best_bytes = 0;
+    for (size_t cap = 1; cap <= pool_size; cap++) {
+        ei_ffi_pool_set_max_concurrency(cap);
+        std::atomic<uint64_t> miss_bytes{0};
+        std::atomic<uint32_t> sampled{0};
+        auto started = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < cap; w++) {
+            workers.emplace_back([&, w] {
+                uint32_t n = iterations_per_level / (uint32_t)cap;
+                if (n == 0) {
+                    n = 1;
+                }
+                for (uint32_t ix = 0; ix < n; ix++) {
+                    ei_impulse_result_t result = {};
+                    bool measure = w == 0 &&
+                        ei_ffi_perf_begin(EI_FFI_PERF_CACHE_MISSES) == EI_IMPULSE_OK;
+                    ei_ffi_run_classifier_pooled(signal, &result, 0);
+                    if (measure) {
+                        ei_ffi_perf_counters_t counters = {};
+                        if (ei_ffi_perf_end(&counters) == EI_IMPULSE_OK) {
+                            // 64-byte lines: misses are what actually hit DDR.
+                            miss_bytes.fetch_add(counters.cache_misses * 64,
+                                                 std::memory_order_relaxed);
+                            sampled.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        double secs = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - started).count();
+        uint32_t per_worker = iterations_per_level / (uint32_t)cap;
+        uint64_t total = (uint64_t)(per_worker > 0 ? per_worker : 1) * cap;
+        double rate = secs > 0.0 ? (double)total / secs : 0.0;
+        uint32_t samples = sampled.load(std::memory_order_relaxed);
+        uint64_t bytes = samples > 0 ? miss_bytes.load(std::memory_order_relaxed) / samples : 0;
+        if (rate > best_rate) {
+            best_rate = rate;
+            best_cap = cap;
+            best_bytes = bytes;
+        }
+    }
+
+    ei_ffi_pool_set_max_concurrency(best_cap);
+    {
+        std::lock_guard<std::mutex> lock(s_governor.mtx);
+        s_governor.bytes_per_invoke = best_bytes;
+    }
+    if (best_out != nullptr) {
+        *best_out = best_cap;
+    }
+    if (bytes_per_invoke_out != nullptr) {
+        *bytes_per_invoke_out = best_bytes;
+    }
+    return EI_IMPULSE_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Image resize/crop kernels
+//
+// Thin wrappers over the SDK's ei::image::processing routines so callers can
+// do their preprocessing in-process on packed RGB888 (or grayscale,
+// pixel_size_B = 1) buffers instead of pulling in an image library on the
+// other side of the FFI.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_image_resize(const uint8_t* src, int src_width, int src_height, uint8_t* dst, int dst_width, int dst_height, int pixel_size_B) {
+    if (src == nullptr || dst == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    int res = ei::image::processing::resize_image(src, src_width, src_height, dst, dst_width, dst_height, pixel_size_B);
+    return res == EIDSP_OK ? EI_IMPULSE_OK : EI_IMPULSE_DSP_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_image_crop(const uint8_t* src, int src_width, int src_height, int start_x, int start_y, uint8_t* dst, int dst_width, int dst_height) {
+    if (src == nullptr || dst == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (start_x < 0 || start_y < 0 ||
+        start_x + dst_width > src_width || start_y + dst_height > src_height) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    int res = ei::image::processing::crop_image_rgb888_packed(src, src_width, src_height, start_x, start_y, dst, dst_width, dst_height);
+    return res == EIDSP_OK ? EI_IMPULSE_OK : EI_IMPULSE_DSP_ERROR;
+}
+
+// Resize-then-center-crop in one call (aspect-preserving), matching the
+// "fit shortest axis" behaviour the examples implement on the Rust side
+// today. Works in place when src == dst and the destination is smaller.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_image_crop_and_interpolate_rgb888(const uint8_t* src, int src_width, int src_height, uint8_t* dst, int dst_width, int dst_height) {
+    if (src == nullptr || dst == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    int res = ei::image::processing::crop_and_interpolate_rgb888(src, src_width, src_height, dst, dst_width, dst_height);
+    return res == EIDSP_OK ? EI_IMPULSE_OK : EI_IMPULSE_DSP_ERROR;
+}
+
+// Specialized one-pass image input preparation for this model's fixed
+// geometry. EI_CLASSIFIER_INPUT_WIDTH/HEIGHT are compile-time constants
+// here, so the resize target, the scratch buffer and the packing loop trip
+// count are all fixed at build time and the compiler can unroll and
+// vectorize against them — no generic runtime-dimension paths. Takes packed
+// RGB888 at any source size, resizes (squash) when needed, and emits the
+// model's packed float features.
+#if EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_CAMERA
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_prepare_image_input(const uint8_t* rgb, int src_width, int src_height, float* out_features) {
+    if (rgb == nullptr || out_features == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    constexpr int kWidth = EI_CLASSIFIER_INPUT_WIDTH;
+    constexpr int kHeight = EI_CLASSIFIER_INPUT_HEIGHT;
+    constexpr size_t kPixels = (size_t)kWidth * kHeight;
+
+    if (src_width == kWidth && src_height == kHeight) {
+        return ei_ffi_pack_rgb888_features(rgb, kPixels, out_features);
+    }
+
+    // Fixed-size scratch for the resized frame; thread_local so pooled /
+    // async instances don't race on it.
+    static thread_local uint8_t resized[kPixels * 3];
+    int res = ei::image::processing::resize_image(rgb, src_width, src_height, resized, kWidth, kHeight, 3);
+    if (res != EIDSP_OK) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    return ei_ffi_pack_rgb888_features(resized, kPixels, out_features);
+}
+
+// Quantized-input variant for callers preparing the NN tensor directly
+// (the ei_ffi_run_nn_only path): resize if needed, then the fused
+// normalize + quantize + pack kernel in one pass over the frame instead
+// of three. Normalization (1/255) and the input tensor's quantization
+// parameters come from model-parameters, so the fused affine is fixed at
+// build time; `out` must hold input-width * input-height * 3 bytes. Fails
+// on models whose NN input is not int8-quantized.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_prepare_image_input_quantized(const uint8_t* rgb, int src_width, int src_height, int8_t* out) {
+#if defined(EI_CLASSIFIER_TFLITE_INPUT_QUANTIZED) && (EI_CLASSIFIER_TFLITE_INPUT_QUANTIZED == 1)
+    if (rgb == nullptr || out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    constexpr int kWidth = EI_CLASSIFIER_INPUT_WIDTH;
+    constexpr int kHeight = EI_CLASSIFIER_INPUT_HEIGHT;
+    constexpr size_t kPixels = (size_t)kWidth * kHeight;
+    constexpr float kNorm = 1.0f / 255.0f;
+
+    if (src_width == kWidth && src_height == kHeight) {
+        return ei_ffi_pack_rgb888_quantized_i8(rgb, kPixels, kNorm, 0.0f,
+                                               EI_CLASSIFIER_TFLITE_INPUT_SCALE,
+                                               EI_CLASSIFIER_TFLITE_INPUT_ZEROPOINT, out);
+    }
+
+    static thread_local uint8_t resized[kPixels * 3];
+    int res = ei::image::processing::resize_image(rgb, src_width, src_height, resized, kWidth, kHeight, 3);
+    if (res != EIDSP_OK) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    return ei_ffi_pack_rgb888_quantized_i8(resized, kPixels, kNorm, 0.0f,
+                                           EI_CLASSIFIER_TFLITE_INPUT_SCALE,
+                                           EI_CLASSIFIER_TFLITE_INPUT_ZEROPOINT, out);
+#else
+    (void)rgb;
+    (void)src_width;
+    (void)src_height;
+    (void)out;
+    return EI_IMPULSE_INFERENCE_ERROR;
+#endif
+}
+
+// Region-of-interest classification: crop, resize and feature packing fused
+// into one sampling pass over the source frame. Each model-input pixel is
+// sampled (nearest-neighbour, 16.16 fixed-point steps through the ROI)
+// straight from the full RGB888 frame and packed as a 0xRRGGBB float -- the
+// DSP stage only ever touches ROI pixels and no cropped intermediate is
+// materialized. Returned bounding boxes (and visual-anomaly grid cells) are
+// mapped back to full-frame coordinates, so downstream tracking keeps
+// working unchanged.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_roi(const uint8_t* rgb, int src_width, int src_height, int x, int y, int w, int h, ei_impulse_result_t* result, int debug) {
+    if (rgb == nullptr || result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > src_width || y + h > src_height) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    constexpr int kWidth = EI_CLASSIFIER_INPUT_WIDTH;
+    constexpr int kHeight = EI_CLASSIFIER_INPUT_HEIGHT;
+    constexpr size_t kPixels = (size_t)kWidth * kHeight;
+
+    // Fixed-size feature scratch; thread_local so pooled / async instances
+    // don't race on it.
+    static thread_local float features[kPixels];
+    uint32_t x_step = ((uint32_t)w << 16) / (uint32_t)kWidth;
+    uint32_t y_step = ((uint32_t)h << 16) / (uint32_t)kHeight;
+    for (int dy = 0; dy < kHeight; dy++) {
+        int sy = y + (int)(((uint32_t)dy * y_step + y_step / 2) >> 16);
+        const uint8_t* row = rgb + ((size_t)sy * src_width + x) * 3;
+        float* out = features + (size_t)dy * kWidth;
+        uint32_t sx = x_step / 2;
+        for (int dx = 0; dx < kWidth; dx++, sx += x_step) {
+            const uint8_t* px = row + (sx >> 16) * 3;
+            out[dx] = (float)((uint32_t)px[0] << 16 | (uint32_t)px[1] << 8 | px[2]);
+        }
+    }
+
+    signal_t signal;
+    ei::numpy::signal_from_buffer(features, kPixels, &signal);
+    EI_IMPULSE_ERROR res = ::run_classifier(&signal, result, debug);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    // Box coordinates come back on the model-input grid; map through the
+    // same scale/offset the sampler applied so they land in frame space.
+    float scale_x = (float)w / (float)kWidth;
+    float scale_y = (float)h / (float)kHeight;
+    for (uint32_t ix = 0; ix < result->bounding_boxes_count; ix++) {
+        ei_impulse_result_bounding_box_t& bb = result->bounding_boxes[ix];
+        bb.x = (uint32_t)(x + (int)((float)bb.x * scale_x + 0.5f));
+        bb.y = (uint32_t)(y + (int)((float)bb.y * scale_y + 0.5f));
+        bb.width = (uint32_t)((float)bb.width * scale_x + 0.5f);
+        bb.height = (uint32_t)((float)bb.height * scale_y + 0.5f);
+    }
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    for (uint32_t ix = 0; ix < result->visual_ad_count; ix++) {
+        ei_impulse_result_bounding_box_t& cell = result->visual_ad_grid_cells[ix];
+        cell.x = (uint32_t)(x + (int)((float)cell.x * scale_x + 0.5f));
+        cell.y = (uint32_t)(y + (int)((float)cell.y * scale_y + 0.5f));
+        cell.width = (uint32_t)((float)cell.width * scale_x + 0.5f);
+        cell.height = (uint32_t)((float)cell.height * scale_y + 0.5f);
+    }
+#endif
+    return EI_IMPULSE_OK;
+}
+
+// Strip-based streaming preprocessing for sources too large to hold
+// decoded in memory (multi-megapixel stills in small containers). The
+// caller supplies decoded RGB888 rows on demand through `read_rows`;
+// each model-input row samples exactly one source row
+// (nearest-neighbour, the same 16.16 fixed-point stepping as the ROI
+// path), so the working set is one source row plus the fixed feature
+// buffer -- independent of source image size. Rows are requested in
+// strictly increasing order, which lets progressive decoders stream the
+// file top to bottom and discard rows behind the cursor. `read_rows`
+// returns 0 on success.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_preprocess_image_streamed(ei_ffi_row_reader_t read_rows, void* ctx, int src_width, int src_height, float* out_features) {
+    if (read_rows == nullptr || out_features == nullptr || src_width <= 0 || src_height <= 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    constexpr int kWidth = EI_CLASSIFIER_INPUT_WIDTH;
+    constexpr int kHeight = EI_CLASSIFIER_INPUT_HEIGHT;
+
+    // One decoded source row; thread_local so pooled / async instances
+    // don't race on it, sized for the largest source seen on the thread.
+    static thread_local std::vector<uint8_t> row;
+    row.resize((size_t)src_width * 3);
+
+    uint32_t x_step = ((uint32_t)src_width << 16) / (uint32_t)kWidth;
+    uint32_t y_step = ((uint32_t)src_height << 16) / (uint32_t)kHeight;
+    int fetched = -1;
+    for (int dy = 0; dy < kHeight; dy++) {
+        int sy = (int)(((uint32_t)dy * y_step + y_step / 2) >> 16);
+        if (sy != fetched) {
+            if (read_rows(ctx, (uint32_t)sy, 1, row.data()) != 0) {
+                return EI_IMPULSE_DSP_ERROR;
+            }
+            fetched = sy;
+        }
+        float* out = out_features + (size_t)dy * kWidth;
+        uint32_t sx = x_step / 2;
+        for (int dx = 0; dx < kWidth; dx++, sx += x_step) {
+            const uint8_t* px = row.data() + (sx >> 16) * 3;
+            out[dx] = (float)((uint32_t)px[0] << 16 | (uint32_t)px[1] << 8 | px[2]);
+        }
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Streamed preprocessing plus the invoke in one call: the packed feature
+// buffer is lent to the DSP through a buffer-backed signal, so peak
+// memory is the source row, the feature buffer and the interpreter's own
+// arena regardless of how large the still is.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_streamed(ei_ffi_row_reader_t read_rows, void* ctx, int src_width, int src_height, ei_impulse_result_t* result, int debug) {
+    if (result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    constexpr size_t kPixels = (size_t)EI_CLASSIFIER_INPUT_WIDTH * EI_CLASSIFIER_INPUT_HEIGHT;
+
+    static thread_local float features[kPixels];
+    EI_IMPULSE_ERROR res = ei_ffi_preprocess_image_streamed(read_rows, ctx, src_width, src_height, features);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    signal_t signal;
+    ei::numpy::signal_from_buffer(features, kPixels, &signal);
+    return ::run_classifier(&signal, result, debug);
+}
+#endif // EI_CLASSIFIER_SENSOR_CAMERA
+
+// ---------------------------------------------------------------------------
+// Per-instance continuous (sliced) classification
+//
+// Continuous mode keeps rolling DSP state (MFE/MFCC slice buffers, the
+// moving-average filter) between calls. The handle variants below keep that
+// state inside the instance instead of the process-wide singleton, so
+// several audio streams can be sliced independently. Feed slices of
+// EI_CLASSIFIER_SLICE_SIZE samples; the first full window of slices warms
+// the feature buffer before results become meaningful.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) void ei_ffi_run_classifier_init_on(ei_impulse_handle_t* handle) {
+    if (handle == nullptr) {
+        return;
+    }
+    ::run_classifier_init(handle);
+}
+
+__attribute__((visibility("default"))) void ei_ffi_run_classifier_deinit_on(ei_impulse_handle_t* handle) {
+    if (handle == nullptr) {
+        return;
+    }
+    ::run_classifier_deinit(handle);
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous_on(ei_impulse_handle_t* handle, signal_t* signal, ei_impulse_result_t* result, int debug, int enable_maf) {
+    if (handle == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    return ::run_classifier_continuous(handle, signal, result, debug, enable_maf);
+}
+
+// ---------------------------------------------------------------------------
+// XNNPACK / interpreter threading control (full TFLite builds)
+//
+// tflite_full.h is patched by build.rs to route its SetNumThreads() call
+// through ei_ffi_get_xnnpack_threads(), so the value set here takes effect
+// the next time an interpreter is constructed (i.e. set it before the first
+// inference, or re-init afterwards). 0 means "keep the SDK default".
+// Whether the XNNPACK delegate is linked at all is a build-time decision
+// (DISABLE_XNNPACK=1), since the delegate rewrites the graph at
+// interpreter-build time and cannot be detached afterwards.
+// ---------------------------------------------------------------------------
+
+#if defined(EI_FFI_SEALED)
+
+// Sealed build: the thread count is baked in (EI_SEALED_THREADS, or the SDK
+// default when unset), so the getter is a constant expression and the
+// setter a no-op.
+#if !defined(EI_FFI_SEALED_THREADS)
+#define EI_FFI_SEALED_THREADS 0
+#endif
+
+__attribute__((visibility("default"))) void ei_ffi_set_xnnpack_threads(int) {}
+
+__attribute__((visibility("default"))) int ei_ffi_get_xnnpack_threads(int sdk_default) {
+    return EI_FFI_SEALED_THREADS > 0 ? EI_FFI_SEALED_THREADS : sdk_default;
+}
+
+#else // !EI_FFI_SEALED
+
+static std::atomic<int> s_xnnpack_num_threads{0};
+
+__attribute__((visibility("default"))) void ei_ffi_set_xnnpack_threads(int num_threads) {
+    s_xnnpack_num_threads.store(num_threads < 0 ? 0 : num_threads);
+}
+
+// Called from the patched tflite_full.h; returns the override if one is set,
+// otherwise whatever the SDK would have used.
+__attribute__((visibility("default"))) int ei_ffi_get_xnnpack_threads(int sdk_default) {
+    int n = s_xnnpack_num_threads.load();
+    return n > 0 ? n : sdk_default;
+}
+
+#endif // EI_FFI_SEALED
+
+// Batched inference: classify `n` signals in one FFI crossing. The
+// interpreter (and its input tensor binding) stays hot across the whole
+// batch because run_classifier reuses the persistent per-impulse state; the
+// per-call cost left is just signal setup and result population. Results are
+// written in order; on error the failing index's result is left untouched
+// and the error is returned after the remaining entries are skipped.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_batch(signal_t* signals, size_t n, ei_impulse_result_t* results, int debug) {
+    if (signals == nullptr || results == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t ix = 0; ix < n; ix++) {
+        EI_IMPULSE_ERROR res = ::run_classifier(&signals[ix], &results[ix], debug);
+        if (res != EI_IMPULSE_OK) {
+            return res;
+        }
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Parallel multi-impulse execution: classify `n` independent
+// handle/signal pairs concurrently and return when all are done. Each
+// handle owns its own interpreter state, so the runs share nothing but
+// read-only weights; entry 0 runs on the caller's thread and the rest
+// fan out onto short-lived workers (thread spawn is microseconds against
+// a multi-millisecond invoke, and N tracks the sensor-channel count).
+// Every entry runs to completion; the first failure is returned.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_multi(ei_impulse_handle_t* const* handles, signal_t* const* signals, ei_impulse_result_t* const* results, size_t n, int debug) {
+    if (handles == nullptr || signals == nullptr || results == nullptr || n == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t ix = 0; ix < n; ix++) {
+        if (handles[ix] == nullptr || signals[ix] == nullptr || results[ix] == nullptr) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+
+    std::vector<EI_IMPULSE_ERROR> statuses(n, EI_IMPULSE_OK);
+    std::vector<std::thread> workers;
+    workers.reserve(n - 1);
+    for (size_t ix = 1; ix < n; ix++) {
+        workers.emplace_back([&, ix] {
+            statuses[ix] = ::run_classifier(handles[ix], signals[ix], results[ix], debug);
+        });
+    }
+    statuses[0] = ::run_classifier(handles[0], signals[0], results[0], debug);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (size_t ix = 0; ix < n; ix++) {
+        if (statuses[ix] != EI_IMPULSE_OK) {
+            return statuses[ix];
+        }
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Speculative dual-engine racing: dispatch the same signal to two handles
+// (typically an accelerator-backed one that is fast once warm but has a
+// multi-minute or contended warm-up, and a CPU one with a flat latency
+// profile) and take whichever finishes first. The loser is cancelled
+// cooperatively: each run sees a wrapped signal whose get_data fails once a
+// winner exists, so the losing invoke unwinds at its next data fetch -- the
+// per-handle interpreters expose no node-boundary cancellation hook (that
+// slot belongs to the default impulse), so DSP reads are the preemption
+// points here. Both runs are joined before returning: the caller's signal
+// and result buffers must not outlive the call, and the loser's abort
+// bounds that wait to one data fetch. The winning result may reference
+// buffers owned by its handle's postprocessing state; as with
+// ei_ffi_run_classifier_on, they stay valid until that handle's next invoke.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_racing(ei_impulse_handle_t* handle_a, ei_impulse_handle_t* handle_b, signal_t* signal, ei_impulse_result_t* result, int debug) {
+    if (handle_a == nullptr || handle_b == nullptr || signal == nullptr || result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    std::atomic<int> winner{-1};
+    ei_impulse_handle_t* handles[2] = { handle_a, handle_b };
+    ei_impulse_result_t local_results[2] = {};
+    EI_IMPULSE_ERROR statuses[2] = { EI_IMPULSE_OK, EI_IMPULSE_OK };
+
+    auto race_one = [&](int me) {
+        signal_t wrapped;
+        wrapped.total_length = signal->total_length;
+        wrapped.get_data = [signal, &winner, me](size_t offset, size_t length, float* out_ptr) -> int {
+            int w = winner.load(std::memory_order_acquire);
+            if (w != -1 && w != me) {
+                return -1; // lost the race: unwind instead of fetching data
+            }
+            return signal->get_data(offset, length, out_ptr);
+        };
+        EI_IMPULSE_ERROR res = ::run_classifier(handles[me], &wrapped, &local_results[me], debug);
+        if (res == EI_IMPULSE_OK) {
+            int expected = -1;
+            winner.compare_exchange_strong(expected, me, std::memory_order_acq_rel);
+        }
+        statuses[me] = res;
+    };
+
+    // Same fan-out shape as ei_ffi_run_multi: entry 1 on a short-lived
+    // worker, entry 0 on the caller's thread.
+    std::thread worker([&] { race_one(1); });
+    race_one(0);
+    worker.join();
+
+    int w = winner.load(std::memory_order_acquire);
+    if (w != -1) {
+        *result = local_results[w];
+        return EI_IMPULSE_OK;
+    }
+    // Both failed; the accelerator-side status is the interesting one.
+    return statuses[0] != EI_IMPULSE_OK ? statuses[0] : statuses[1];
+}
+
+// ---------------------------------------------------------------------------
+// Continuous-mode score smoothing
+//
+// The SDK's own moving-average filter behind the enable_maf parameter is
+// vestigial (the flag is ignored upstream), so hosts that want smoothed
+// slice scores were re-averaging in Rust with a full score copy per
+// slice. This reinstates the stage natively: a ring of the last `window`
+// class-score vectors, folded into the result in-place before it crosses
+// the FFI boundary, with optional per-slice weights (weights[0] applies
+// to the newest slice; normalized internally, so any positive scale
+// works). Uniform windows keep running per-class sums -- O(labels) per
+// slice; weighted windows rescan the ring, O(window x labels), which at
+// continuous-mode window lengths is noise. State follows the default
+// impulse's continuous state: one smoother per process, applied only on
+// the default-impulse path.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct score_smoother {
+    uint32_t window = 0; // 0: disabled
+    bool uniform = true;
+    std::vector<float> weights; // newest first; normalized on configure
+    std::vector<float> ring;    // window x label_count, circular
+    std::vector<float> sums;    // running per-class sums (uniform path)
+    size_t next = 0;
+    uint64_t slices = 0;
+};
+
+std::mutex s_smoother_mutex;
+score_smoother s_smoother;
+
+void smoother_apply(ei_impulse_result_t* result) {
+    std::lock_guard<std::mutex> lock(s_smoother_mutex);
+    score_smoother& sm = s_smoother;
+    if (sm.window < 2) {
+        return;
+    }
+    constexpr size_t labels = EI_CLASSIFIER_LABEL_COUNT;
+    float* slot = &sm.ring[sm.next * labels];
+    if (sm.uniform && sm.slices >= sm.window) {
+        for (size_t ix = 0; ix < labels; ix++) {
+            sm.sums[ix] -= slot[ix];
+        }
+    }
+    for (size_t ix = 0; ix < labels; ix++) {
+        slot[ix] = result->classification[ix].value;
+        if (sm.uniform) {
+            sm.sums[ix] += slot[ix];
+        }
+    }
+    sm.next = (sm.next + 1) % sm.window;
+    sm.slices++;
+    const size_t fill = sm.slices < sm.window ? (size_t)sm.slices : sm.window;
+
+    if (sm.uniform) {
+        const float inv = 1.0f / (float)fill;
+        for (size_t ix = 0; ix < labels; ix++) {
+            result->classification[ix].value = sm.sums[ix] * inv;
+        }
+        return;
+    }
+    // Weighted: walk newest to oldest, renormalizing over the filled part
+    // of the window during warm-up.
+    float weight_sum = 0.0f;
+    for (size_t w = 0; w < fill; w++) {
+        weight_sum += sm.weights[w];
+    }
+    for (size_t ix = 0; ix < labels; ix++) {
+        float acc = 0.0f;
+        for (size_t w = 0; w < fill; w++) {
+            const size_t pos = (sm.next + sm.window - 1 - w) % sm.window;
+            acc += sm.weights[w] * sm.ring[pos * labels + ix];
+        }
+        result->classification[ix].value = acc / weight_sum;
+    }
+}
+
+} // namespace
+
+// Configure the continuous-mode smoothing stage. `window` is the number
+// of slices averaged (0 or 1 disables); `weights`, when non-NULL, holds
+// `window` per-slice weights with weights[0] applying to the newest
+// slice. Resets the smoothing history.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_smoothing_configure(uint32_t window, const float* weights) {
+    if (window > 1024) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_smoother_mutex);
+    score_smoother& sm = s_smoother;
+    sm.window = window < 2 ? 0 : window;
+    sm.uniform = weights == nullptr;
+    sm.weights.clear();
+    sm.ring.assign((size_t)sm.window * EI_CLASSIFIER_LABEL_COUNT, 0.0f);
+    sm.sums.assign(EI_CLASSIFIER_LABEL_COUNT, 0.0f);
+    sm.next = 0;
+    sm.slices = 0;
+    if (!sm.uniform && sm.window != 0) {
+        float sum = 0.0f;
+        for (uint32_t ix = 0; ix < window; ix++) {
+            if (weights[ix] < 0.0f) {
+                sm.window = 0;
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+            sum += weights[ix];
+        }
+        if (sum <= 0.0f) {
+            sm.window = 0;
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        sm.weights.assign(weights, weights + window);
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Drop the smoothing history (e.g. after the signal source restarts)
+// without touching the configuration.
+__attribute__((visibility("default"))) void ei_ffi_smoothing_reset(void) {
+    std::lock_guard<std::mutex> lock(s_smoother_mutex);
+    std::fill(s_smoother.ring.begin(), s_smoother.ring.end(), 0.0f);
+    std::fill(s_smoother.sums.begin(), s_smoother.sums.end(), 0.0f);
+    s_smoother.next = 0;
+    s_smoother.slices = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Stream health (slice-level watchdog)
+//
+// A continuous pipeline fails in real time before it fails functionally:
+// slices start taking longer than the interval of signal they represent,
+// the caller falls behind its source, and the first symptom is a
+// downstream audio glitch with no error code attached. Every continuous
+// slice is timed here against that real-time budget -- relaxed atomics
+// only on the slice path, so the bookkeeping is a rounding error next to
+// the inference itself.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Wall-clock time one slice of signal represents; processing must finish
+// inside it to keep up with the source.
+const uint32_t kSliceBudgetUs =
+    (uint32_t)((double)EI_CLASSIFIER_SLICE_SIZE * 1000000.0 / (double)EI_CLASSIFIER_FREQUENCY);
+
+std::atomic<uint64_t> s_health_slices{0};
+std::atomic<uint64_t> s_health_overruns{0};
+std::atomic<uint64_t> s_health_streak{0};
+std::atomic<uint32_t> s_health_last_us{0};
+std::atomic<uint32_t> s_health_worst_us{0};
+std::atomic<uint64_t> s_health_hist[8] = {};
+
+void stream_health_note(uint64_t elapsed_us) {
+    s_health_slices.fetch_add(1, std::memory_order_relaxed);
+    s_health_last_us.store((uint32_t)elapsed_us, std::memory_order_relaxed);
+    uint32_t worst = s_health_worst_us.load(std::memory_order_relaxed);
+    while (elapsed_us > worst &&
+           !s_health_worst_us.compare_exchange_weak(worst, (uint32_t)elapsed_us,
+                                                    std::memory_order_relaxed)) {
+    }
+    size_t bucket = (size_t)(elapsed_us * 8 / kSliceBudgetUs);
+    s_health_hist[bucket > 7 ? 7 : bucket].fetch_add(1, std::memory_order_relaxed);
+    if (elapsed_us > kSliceBudgetUs) {
+        s_health_overruns.fetch_add(1, std::memory_order_relaxed);
+        s_health_streak.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        s_health_streak.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous(signal_t* signal, ei_impulse_result_t* result, int debug, int enable_maf_unused) {
+    auto started = std::chrono::steady_clock::now();
+    EI_IMPULSE_ERROR res = ::run_classifier_continuous(signal, result, debug, enable_maf_unused);
+    if (EI_FFI_LIKELY(res == EI_IMPULSE_OK)) {
+        smoother_apply(result);
+        stream_health_note((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - started)
+                               .count());
+    }
+    return res;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_stream_health(ei_stream_health_t* health) {
+    if (health == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    health->slices = s_health_slices.load(std::memory_order_relaxed);
+    health->overruns = s_health_overruns.load(std::memory_order_relaxed);
+    health->overrun_streak = s_health_streak.load(std::memory_order_relaxed);
+    health->budget_us = kSliceBudgetUs;
+    health->last_us = s_health_last_us.load(std::memory_order_relaxed);
+    health->worst_us = s_health_worst_us.load(std::memory_order_relaxed);
+    for (size_t ix = 0; ix < 8; ix++) {
+        health->load_hist[ix] = s_health_hist[ix].load(std::memory_order_relaxed);
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Clear the counters (e.g. after a deploy, so the histogram describes the
+// new build). The budget is model metadata and survives the reset.
+__attribute__((visibility("default"))) void ei_ffi_stream_health_reset(void) {
+    s_health_slices.store(0, std::memory_order_relaxed);
+    s_health_overruns.store(0, std::memory_order_relaxed);
+    s_health_streak.store(0, std::memory_order_relaxed);
+    s_health_last_us.store(0, std::memory_order_relaxed);
+    s_health_worst_us.store(0, std::memory_order_relaxed);
+    for (size_t ix = 0; ix < 8; ix++) {
+        s_health_hist[ix].store(0, std::memory_order_relaxed);
+    }
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_inference(ei_impulse_handle_t* handle, ei_feature_t* fmatrix, ei_impulse_result_t* result, int debug) {
+    return ::run_inference(handle, fmatrix, result, debug);
+}
+
+// ---------------------------------------------------------------------------
+// Split NN / postprocess stages
+//
+// Inside run_classifier the postprocessing blocks (detection decode is part
+// of the learn block's fill_result, but tracking and friends are not) run
+// serially after the invoke on the same thread, eating a fixed slice of the
+// frame budget. Splitting them out lets the application postprocess frame N
+// on one thread while the NN runs frame N+1: ei_ffi_run_nn_only does DSP +
+// run_inference and leaves the postprocessing blocks untouched;
+// ei_ffi_postprocess runs exactly those blocks over a result. The
+// postprocessing blocks keep per-block state (the tracker), so keep all
+// ei_ffi_postprocess calls on one thread and in frame order.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_nn_only(signal_t* signal, ei_impulse_result_t* result, int debug) {
+    if (signal == nullptr || result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+
+    std::vector<std::unique_ptr<ei::matrix_t>> matrices;
+    std::vector<ei_feature_t> features(impulse->dsp_blocks_size, ei_feature_t());
+    ei_ffi_dsp_arena_begin();
+    for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
+        ei_model_dsp_t block = impulse->dsp_blocks[ix];
+        matrices.emplace_back(new (std::nothrow) ei::matrix_t(1, block.n_output_features));
+        if (matrices[ix] == nullptr || matrices[ix]->buffer == nullptr) {
+            ei_ffi_dsp_arena_end();
+            return EI_IMPULSE_OUT_OF_MEMORY;
+        }
+        int ret = ei_ffi_internal_extract_block(&block, signal, matrices[ix].get(), impulse->frequency);
+        if (ret != EIDSP_OK) {
+            ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+            ei_ffi_dsp_arena_end();
+            return EI_IMPULSE_DSP_ERROR;
+        }
+        features[ix].matrix = matrices[ix].get();
+        features[ix].blocks_processed = true;
+    }
+    ei_ffi_dsp_arena_end();
+
+    return ::run_inference(&ei_default_impulse, features.data(), result, debug);
+}
+
+#if defined(EI_FFI_STATIC_POSTPROCESS)
+namespace {
+
+// Per-block state lives on the handle in SDK drops that have it; detect
+// the member instead of hard-coding it so the generated chain compiles
+// against drops either way.
+template <typename H, typename = void>
+struct pp_state_access {
+    static void* at(H*, size_t) { return nullptr; }
+};
+template <typename H>
+struct pp_state_access<H, std::void_t<decltype(std::declval<H&>().post_processing_state)>> {
+    static void* at(H* handle, size_t ix) {
+        return handle->post_processing_state == nullptr ? nullptr
+                                                        : handle->post_processing_state[ix];
+    }
+};
+
+} // namespace
+
+#define EI_FFI_PP_STATE(handle, ix) (pp_state_access<ei_impulse_handle_t>::at((handle), (ix)))
+#endif // EI_FFI_STATIC_POSTPROCESS
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_postprocess(ei_impulse_result_t* result) {
+    if (result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+#if defined(EI_FFI_STATIC_POSTPROCESS)
+    // Direct-call chain generated for this deployment's block table. The
+    // count check catches a hot-swapped model whose chain differs from
+    // the one the library was built for; it falls back to the walk.
+    if (EI_FFI_LIKELY(ei_default_impulse.impulse->postprocessing_blocks_size ==
+                      EI_FFI_POSTPROCESS_CHAIN_SIZE)) {
+        EI_IMPULSE_ERROR status = EI_IMPULSE_OK;
+        EI_FFI_POSTPROCESS_CHAIN(&ei_default_impulse, result, status);
+        return status;
+    }
+#endif
+    return ::run_postprocessing(&ei_default_impulse, result);
+}
+
+// Raw feature-matrix injection. Callers with precomputed features (cached
+// across retries, replayed from disk, computed off-process) can hand
+// run_inference a flat float buffer directly instead of going through a
+// signal_t and paying the get_data callback per chunk.
+//
+// Ownership contract: the matrix BORROWS `data` -- keep the buffer alive and
+// unmodified until the inference call that consumes the feature returns.
+// Pair every successful call with ei_ffi_feature_matrix_free, which releases
+// only the matrix wrapper, never the caller's buffer.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_feature_matrix_from_buffer(const float* data, uint32_t rows, uint32_t cols, ei_feature_t* feature) {
+    if (data == nullptr || feature == nullptr || rows == 0 || cols == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    ei::matrix_t* matrix = new (std::nothrow) ei::matrix_t(rows, cols, const_cast<float*>(data));
+    if (matrix == nullptr) {
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+    feature->matrix = matrix;
+    feature->blocks_processed = true;
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_feature_matrix_free(ei_feature_t* feature) {
+    if (feature == nullptr || feature->matrix == nullptr) {
+        return;
+    }
+    delete feature->matrix;
+    feature->matrix = nullptr;
+    feature->blocks_processed = false;
+}
+
+// Helper function to create signal from buffer (like EIM binary)
+//
+// Ownership contract: the signal BORROWS `data`; nothing is copied here. The
+// caller must keep the buffer alive and unmodified until the classifier call
+// that consumes the signal has returned. The signal never outlives the call.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_buffer(const float* data, size_t data_size, signal_t* signal) {
+    return static_cast<EI_IMPULSE_ERROR>(ei::numpy::signal_from_buffer(data, data_size, signal));
+}
+
+// Quantized input signals. The caller keeps its int8/uint8 sensor data as-is
+// and we dequantize lazily, chunk-by-chunk, inside get_data() as the DSP
+// pulls samples. No full-frame float buffer is ever materialized on the
+// caller side. Same ownership contract as ei_ffi_signal_from_buffer: the
+// signal borrows `data` until the classifier call returns.
+// (EIDSP_SIGNAL_C_FN_POINTER is 0 in this build, so get_data is a
+// std::function and may carry the capture.)
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_buffer_i8(const int8_t* data, size_t data_size, float scale, int32_t zero_point, signal_t* signal) {
+    if (data == nullptr || signal == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    signal->total_length = data_size;
+    signal->get_data = [data, scale, zero_point](size_t offset, size_t length, float* out_ptr) -> int {
+        for (size_t ix = 0; ix < length; ix++) {
+            out_ptr[ix] = (float)((int32_t)data[offset + ix] - zero_point) * scale;
+        }
+        return EIDSP_OK;
+    };
+    return EI_IMPULSE_OK;
+}
+
+// Disk-backed signals with read-ahead. Large scans (tens of MB of float32
+// samples) stall the DSP loop on page faults when each get_data chunk is
+// first touched. This maps the file and, on every chunk read, advises the
+// kernel to fault in the next few chunks (MADV_WILLNEED) while the current
+// one is being processed -- I/O overlaps FFT compute instead of serializing
+// with it. `fd` must stay open only through this call (the mapping keeps
+// its own reference); the mapping itself lives as long as the signal's
+// get_data does and is released when the signal_t is destroyed or
+// reassigned. `offset_bytes` skips container headers; samples are raw
+// little-endian float32 as with ei_ffi_signal_from_buffer.
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_file(int fd, uint64_t offset_bytes, size_t sample_count, signal_t* signal) {
+    if (fd < 0 || signal == nullptr || sample_count == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (uint64_t)st.st_size < offset_bytes + sample_count * sizeof(float)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    struct file_signal {
+        uint8_t* map_base;
+        size_t map_size;
+        const float* samples;
+        size_t sample_count;
+        ~file_signal() { munmap(map_base, map_size); }
+    };
+
+    void* mapping = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, (off_t)offset_bytes, (off_t)(sample_count * sizeof(float)), POSIX_FADV_SEQUENTIAL);
+#endif
+
+    auto ctx = std::make_shared<file_signal>();
+    ctx->map_base = (uint8_t*)mapping;
+    ctx->map_size = (size_t)st.st_size;
+    ctx->samples = (const float*)(ctx->map_base + offset_bytes);
+    ctx->sample_count = sample_count;
+
+    // Prime the first window so even the first chunk doesn't fault cold.
+    madvise(ctx->map_base, std::min(ctx->map_size, (size_t)(1 << 20)), MADV_WILLNEED);
+
+    signal->total_length = sample_count;
+    signal->get_data = [ctx](size_t offset, size_t length, float* out_ptr) -> int {
+        if (offset + length > ctx->sample_count) {
+            return -1;
+        }
+        memcpy(out_ptr, ctx->samples + offset, length * sizeof(float));
+
+        // Ask for the next few chunks while this one is being processed.
+        size_t next = offset + length;
+        if (next < ctx->sample_count) {
+            size_t ahead = std::min(length * 4, ctx->sample_count - next);
+            uintptr_t start = (uintptr_t)(ctx->samples + next);
+            uintptr_t page = start & ~((uintptr_t)sysconf(_SC_PAGESIZE) - 1);
+            madvise((void*)page, (start - page) + ahead * sizeof(float), MADV_WILLNEED);
+        }
+        return EIDSP_OK;
+    };
+    return EI_IMPULSE_OK;
+}
+#endif // __linux__ || __APPLE__
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_buffer_u8(const uint8_t* data, size_t data_size, float scale, int32_t zero_point, signal_t* signal) {
+    if (data == nullptr || signal == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    signal->total_length = data_size;
+    signal->get_data = [data, scale, zero_point](size_t offset, size_t length, float* out_ptr) -> int {
+        for (size_t ix = 0; ix < length; ix++) {
+            out_ptr[ix] = (float)((int32_t)data[offset + ix] - zero_point) * scale;
+        }
+        return EIDSP_OK;
+    };
+    return EI_IMPULSE_OK;
+}
+
+// Scatter-gather signals over sensor-DMA chunk lists. IMU drivers deliver
+// a window as N discontiguous DMA chunks; compacting them into one buffer
+// before signal_from_buffer is a full extra copy of every sample. Here
+// get_data reads straight from the chunks: chunk starts (in samples) are
+// prefix-summed once at construction, each read binary-searches its first
+// chunk and memcpys span by span across boundaries. Same borrow contract
+// as the other signal constructors -- every chunk must stay alive and
+// unmodified until the classifier call returns.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_from_iovec(const ei_ffi_iovec_t* iov, size_t n_iov, signal_t* signal) {
+    if (iov == nullptr || n_iov == 0 || signal == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    struct iovec_signal {
+        std::vector<const float*> chunks;
+        std::vector<size_t> starts; // chunk start offsets in samples; back() is the total
+    };
+
+    auto ctx = std::make_shared<iovec_signal>();
+    ctx->chunks.reserve(n_iov);
+    ctx->starts.reserve(n_iov + 1);
+    size_t total = 0;
+    for (size_t ix = 0; ix < n_iov; ix++) {
+        if (iov[ix].iov_base == nullptr || iov[ix].iov_len % sizeof(float) != 0) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        if (iov[ix].iov_len == 0) {
+            continue; // a drained descriptor; skip rather than index it
+        }
+        ctx->chunks.push_back((const float*)iov[ix].iov_base);
+        ctx->starts.push_back(total);
+        total += iov[ix].iov_len / sizeof(float);
+    }
+    if (total == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    ctx->starts.push_back(total);
+
+    signal->total_length = total;
+    signal->get_data = [ctx](size_t offset, size_t length, float* out_ptr) -> int {
+        if (EI_FFI_UNLIKELY(offset + length > ctx->starts.back())) {
+            return -1;
+        }
+        // First chunk containing `offset`: the last start <= offset.
+        size_t chunk = (size_t)(std::upper_bound(ctx->starts.begin(), ctx->starts.end(), offset)
+                                - ctx->starts.begin()) - 1;
+        while (length > 0) {
+            size_t within = offset - ctx->starts[chunk];
+            size_t span = std::min(length, ctx->starts[chunk + 1] - offset);
+            memcpy(out_ptr, ctx->chunks[chunk] + within, span * sizeof(float));
+            out_ptr += span;
+            offset += span;
+            length -= span;
+            chunk++;
+        }
+        return EIDSP_OK;
+    };
+    return EI_IMPULSE_OK;
+}
+
+// Zero-copy inference path. The signal_t contract forces get_data() to copy
+// chunks into DSP-owned storage, so for models whose features are the raw
+// input (image / raw blocks) we skip the signal machinery entirely and lend
+// the caller's buffer to the feature matrix handed to run_inference().
+//
+// `data` must hold exactly the model's input frame and stay valid until this
+// function returns; it is never written to and never retained.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_zero_copy(const float* data, size_t data_size, ei_impulse_result_t* result, int debug) {
+    if (data == nullptr || result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (data_size != ei_default_impulse.impulse->nn_input_frame_size) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    // A matrix_t constructed over a caller-provided backing store performs no
+    // allocation and no copy; run_inference() reads straight from it.
+    ei::matrix_t features(1, data_size, const_cast<float*>(data));
+    ei_feature_t fmatrix;
+    fmatrix.matrix = &features;
+    fmatrix.blocks_processed = true;
+
+    return ::run_inference(&ei_default_impulse, &fmatrix, result, debug);
+}
+
+// Detach a result into caller-owned storage. The struct itself is copied by
+// value; the bounding-box and visual-anomaly arrays, which alias state the
+// next inference will overwrite, are copied into the arena and re-pointed.
+// Nothing is heap-allocated here, so callers can recycle one arena per
+// stream for the lifetime of the process.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_detach_result(const ei_impulse_result_t* src, ei_impulse_result_t* dst, ei_ffi_result_arena_t* arena) {
+    if (src == nullptr || dst == nullptr || arena == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    *dst = *src;
+    bool truncated = false;
+
+    uint32_t bb_count = src->bounding_boxes_count;
+    if (bb_count > arena->bounding_boxes_capacity) {
+        bb_count = arena->bounding_boxes_capacity;
+        truncated = true;
+    }
+    if (bb_count > 0 && src->bounding_boxes != nullptr) {
+        memcpy(arena->bounding_boxes, src->bounding_boxes, bb_count * sizeof(ei_impulse_result_bounding_box_t));
+    }
+    dst->bounding_boxes = arena->bounding_boxes;
+    dst->bounding_boxes_count = bb_count;
+
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    uint32_t grid_count = src->visual_ad_count;
+    if (grid_count > arena->visual_ad_grid_cells_capacity) {
+        grid_count = arena->visual_ad_grid_cells_capacity;
+        truncated = true;
+    }
+    if (grid_count > 0 && src->visual_ad_grid_cells != nullptr) {
+        memcpy(arena->visual_ad_grid_cells, src->visual_ad_grid_cells, grid_count * sizeof(ei_impulse_result_bounding_box_t));
+    }
+    dst->visual_ad_grid_cells = arena->visual_ad_grid_cells;
+    dst->visual_ad_count = grid_count;
+#endif
+
+    return truncated ? EI_IMPULSE_OUT_OF_MEMORY : EI_IMPULSE_OK;
+}
+
+// Copy the SDK's timing fields into the stable FFI layout. The SDK only has
+// microsecond resolution for dsp/classification/anomaly; sampling is
+// reported in milliseconds and converted here.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_timing(const ei_impulse_result_t* result, ei_ffi_timing_t* timing_out) {
+    if (result == nullptr || timing_out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    timing_out->sampling_us = (uint64_t)result->timing.sampling * 1000u;
+    timing_out->dsp_us = (uint64_t)result->timing.dsp_us;
+    timing_out->classification_us = (uint64_t)result->timing.classification_us;
+    timing_out->anomaly_us = (uint64_t)result->timing.anomaly_us;
+    timing_out->total_us = timing_out->sampling_us + timing_out->dsp_us +
+        timing_out->classification_us + timing_out->anomaly_us;
+    return EI_IMPULSE_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Small-result mode for plain classifiers
+//
+// When the block census in build.rs shows no object detection and no
+// visual anomaly grid, the interesting part of ei_impulse_result_t is a
+// fixed score-per-label vector plus timing -- it fits in a couple hundred
+// bytes and never needs the heap-backed box/grid arrays. The small result
+// is fully inline and value-typed (one memcpy moves it across the FFI),
+// and the internal scratch ei_impulse_result_t is thread_local, so the
+// call itself allocates nothing. Pair with ei_ffi_set_dsp_arena to keep
+// the DSP stage allocation-free as well. The symbol exists on every build
+// for binding stability; without EI_FFI_SMALL_RESULT it fails, since a
+// box-producing model would silently lose its detections here.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_small(signal_t* signal, ei_ffi_small_result_t* out, int debug) {
+#if defined(EI_FFI_SMALL_RESULT)
+    if (signal == nullptr || out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    static thread_local ei_impulse_result_t scratch;
+    memset(&scratch, 0, sizeof(scratch));
+    EI_IMPULSE_ERROR res = ei_ffi_run_classifier(signal, &scratch, debug);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    out->label_count = EI_CLASSIFIER_LABEL_COUNT;
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        out->value[ix] = scratch.classification[ix].value;
+    }
+#if EI_CLASSIFIER_HAS_ANOMALY
+    out->anomaly = scratch.anomaly;
+#else
+    out->anomaly = 0.0f;
+#endif
+    ei_ffi_get_timing(&scratch, &out->timing);
+    return EI_IMPULSE_OK;
+#else
+    (void)signal;
+    (void)out;
+    (void)debug;
+    return EI_IMPULSE_INFERENCE_ERROR;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Top-k result mode for large label sets
+//
+// A 1,200-class model materializes 1,200 classification entries per frame
+// while callers read the top handful. The selection below is one scan with
+// a k-slot insertion buffer -- at the k values this is for (<= 16) that
+// beats a heap on branch predictability, and it never touches the heap.
+// With top-k configured, ei_ffi_serialize_result also emits only the k
+// selected class records, shrinking the FFI copy by the same ratio. The
+// SDK still fills its own array; what this removes is every marshalling
+// step after it.
+// ---------------------------------------------------------------------------
+
+static std::atomic<uint32_t> s_topk{0};
+
+// k = 0 restores full-result marshalling.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_topk(uint32_t k) {
+    s_topk.store(k, std::memory_order_relaxed);
+    return EI_IMPULSE_OK;
+}
+
+// Partial selection over the classification array; entries come back sorted
+// by value, descending. `cap` bounds the selection when smaller than the
+// configured k (or when no k is configured). Returns the number written,
+// -1 on invalid arguments.
+__attribute__((visibility("default"))) int ei_ffi_get_topk(const ei_impulse_result_t* result, ei_ffi_topk_entry_t* out, size_t cap) {
+    if (result == nullptr || out == nullptr || cap == 0) {
+        return -1;
+    }
+    size_t label_count = ei_default_impulse.impulse->label_count;
+    uint32_t configured = s_topk.load(std::memory_order_relaxed);
+    size_t k = configured == 0 || (size_t)configured > cap ? cap : (size_t)configured;
+    if (k > label_count) {
+        k = label_count;
+    }
+    size_t filled = 0;
+    for (size_t ix = 0; ix < label_count; ix++) {
+        float v = result->classification[ix].value;
+        // Once the heap is full, the common case for a large label set is
+        // a score below the current cut -- keep that the fall-through.
+        if (EI_FFI_LIKELY(filled == k && v <= out[k - 1].value)) {
+            continue;
+        }
+        size_t pos = filled < k ? filled++ : k - 1;
+        while (pos > 0 && out[pos - 1].value < v) {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        out[pos].index = (uint32_t)ix;
+        out[pos].value = v;
+    }
+    return (int)filled;
+}
+
+// ---------------------------------------------------------------------------
+// Flat binary result serialization
+//
+// Layout: header, classification records, bounding-box records, visual-AD
+// grid records, interned label table. Records are fixed-stride and labels
+// are deduplicated table offsets, so a 100-box frame costs one buffer copy
+// instead of 100 FFI round trips plus string marshalling.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) int ei_ffi_serialize_result(const ei_impulse_result_t* result, uint8_t* buf, size_t cap) {
+    if (EI_FFI_UNLIKELY(result == nullptr)) {
+        return -1;
+    }
+
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+    uint32_t class_count = (uint32_t)impulse->label_count;
+    uint32_t box_count = result->bounding_boxes_count;
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    uint32_t grid_count = result->visual_ad_count;
+#else
+    uint32_t grid_count = 0;
+#endif
+
+    // Intern the labels first so record offsets and the table size are
+    // known before any byte is written.
+    std::vector<const char*> labels;
+    auto intern = [&labels](const char* label) -> uint32_t {
+        if (EI_FFI_UNLIKELY(label == nullptr)) {
+            label = "";
+        }
+        uint32_t offset = 0;
+        for (const char* known : labels) {
+            // Labels are pointers into the model's static label table, so a
+            // repeat is almost always the same pointer -- compare identity
+            // before paying for the strcmp.
+            if (known == label || strcmp(known, label) == 0) {
+                return offset;
+            }
+            offset += (uint32_t)strlen(known) + 1;
+        }
+        labels.push_back(label);
+        return offset;
+    };
+
+    std::vector<ei_ffi_serialized_class_t> classes;
+    uint32_t topk = s_topk.load(std::memory_order_relaxed);
+    if (topk != 0 && topk < class_count) {
+        // Top-k mode: emit only the selected class records (rank order).
+        std::vector<ei_ffi_topk_entry_t> top(topk);
+        int selected = ei_ffi_get_topk(result, top.data(), topk);
+        class_count = selected < 0 ? 0 : (uint32_t)selected;
+        classes.resize(class_count);
+        for (uint32_t ix = 0; ix < class_count; ix++) {
+            classes[ix].label_offset = intern(result->classification[top[ix].index].label);
+            classes[ix].value = top[ix].value;
+        }
+    }
+    else {
+        classes.resize(class_count);
+        for (uint32_t ix = 0; ix < class_count; ix++) {
+            classes[ix].label_offset = intern(result->classification[ix].label);
+            classes[ix].value = result->classification[ix].value;
+        }
+    }
+    std::vector<ei_ffi_serialized_box_t> boxes(box_count + grid_count);
+    for (uint32_t ix = 0; ix < box_count; ix++) {
+        const ei_impulse_result_bounding_box_t& bb = result->bounding_boxes[ix];
+        boxes[ix].label_offset = intern(bb.label);
+        boxes[ix].value = bb.value;
+        boxes[ix].x = bb.x;
+        boxes[ix].y = bb.y;
+        boxes[ix].width = bb.width;
+        boxes[ix].height = bb.height;
+    }
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    for (uint32_t ix = 0; ix < grid_count; ix++) {
+        const ei_impulse_result_bounding_box_t& cell = result->visual_ad_grid_cells[ix];
+        ei_ffi_serialized_box_t& rec = boxes[box_count + ix];
+        rec.label_offset = intern(cell.label);
+        rec.value = cell.value;
+        rec.x = cell.x;
+        rec.y = cell.y;
+        rec.width = cell.width;
+        rec.height = cell.height;
+    }
+#endif
+
+    uint32_t table_bytes = 0;
+    for (const char* label : labels) {
+        table_bytes += (uint32_t)strlen(label) + 1;
+    }
+
+    uint32_t table_offset = (uint32_t)(sizeof(ei_ffi_serialized_header_t)
+        + class_count * sizeof(ei_ffi_serialized_class_t)
+        + (box_count + grid_count) * sizeof(ei_ffi_serialized_box_t));
+    uint32_t total = table_offset + table_bytes;
+
+    if (buf == nullptr || cap < total) {
+        // Sizing call: report the exact allocation needed.
+        return (int)total;
+    }
+
+    ei_ffi_serialized_header_t header = {};
+    header.magic = 0x30524945; // "EIR0"
+    header.version = EI_FFI_SERIALIZED_RESULT_VERSION;
+    header.total_bytes = total;
+    header.classification_count = class_count;
+    header.bounding_box_count = box_count;
+    header.grid_cell_count = grid_count;
+    header.anomaly = result->anomaly;
+    header.dsp_us = (uint64_t)result->timing.dsp_us;
+    header.classification_us = (uint64_t)result->timing.classification_us;
+    header.anomaly_us = (uint64_t)result->timing.anomaly_us;
+    header.label_table_offset = table_offset;
+    header.label_table_bytes = table_bytes;
+
+    uint8_t* cursor = buf;
+    memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    if (class_count > 0) {
+        memcpy(cursor, classes.data(), class_count * sizeof(ei_ffi_serialized_class_t));
+        cursor += class_count * sizeof(ei_ffi_serialized_class_t);
+    }
+    if (box_count + grid_count > 0) {
+        memcpy(cursor, boxes.data(), (box_count + grid_count) * sizeof(ei_ffi_serialized_box_t));
+        cursor += (box_count + grid_count) * sizeof(ei_ffi_serialized_box_t);
+    }
+    for (const char* label : labels) {
+        size_t len = strlen(label) + 1;
+        memcpy(cursor, label, len);
+        cursor += len;
+    }
+
+    return (int)total;
+}
+
+// ---------------------------------------------------------------------------
+// JSON result encoder
+//
+// Structured logging of results used to go through the debug print path:
+// printf per field, stdio locking, and formatting cost proportional to
+// terminal output nobody reads in production. This encoder emits one
+// JSON document straight into the caller's buffer -- single pass, no
+// allocation, no locks -- in the same shape the HTTP server's /classify
+// response uses (classification as a label->value object, bounding_boxes,
+// anomaly, timing), so one log schema covers both surfaces. Usual sizing
+// contract: bytes written on success, -1 when `cap` is too small, never
+// a truncated document.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct json_out {
+    char* buf;
+    size_t cap;
+    size_t used;
+    bool overflow;
+};
+
+void json_raw(json_out& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+void json_raw(json_out& out, const char* fmt, ...) {
+    if (out.overflow) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(out.buf + out.used, out.cap - out.used, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= out.cap - out.used) {
+        out.overflow = true;
+        return;
+    }
+    out.used += (size_t)n;
+}
+
+// JSON string literal with escaping; labels are project-author text and
+// may legally contain quotes.
+void json_string(json_out& out, const char* text) {
+    json_raw(out, "\"");
+    for (const char* p = text != nullptr ? text : ""; *p != '\0' && !out.overflow; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            json_raw(out, "\\%c", c);
+        }
+        else if (c < 0x20) {
+            json_raw(out, "\\u%04x", c);
+        }
+        else {
+            json_raw(out, "%c", c);
+        }
+    }
+    json_raw(out, "\"");
+}
+
+void json_box(json_out& out, const ei_impulse_result_bounding_box_t& bb, bool first) {
+    json_raw(out, "%s{\"label\":", first ? "" : ",");
+    json_string(out, bb.label);
+    json_raw(out, ",\"value\":%.6g,\"x\":%u,\"y\":%u,\"width\":%u,\"height\":%u}",
+             bb.value, bb.x, bb.y, bb.width, bb.height);
+}
+
+} // namespace
+
+__attribute__((visibility("default"))) int ei_ffi_result_to_json(const ei_impulse_result_t* result, char* buf, size_t cap) {
+    if (EI_FFI_UNLIKELY(result == nullptr || buf == nullptr || cap == 0)) {
+        return -1;
+    }
+    json_out out = {buf, cap, 0, false};
+
+    // With top-k configured the object carries only the selected labels,
+    // mirroring ei_ffi_serialize_result.
+    json_raw(out, "{\"classification\":{");
+    uint32_t class_count = (uint32_t)ei_default_impulse.impulse->label_count;
+    uint32_t topk = s_topk.load(std::memory_order_relaxed);
+    if (topk != 0 && topk < class_count) {
+        ei_ffi_topk_entry_t top[EI_CLASSIFIER_LABEL_COUNT];
+        int selected = ei_ffi_get_topk(result, top, topk);
+        class_count = selected < 0 ? 0 : (uint32_t)selected;
+        for (uint32_t ix = 0; ix < class_count; ix++) {
+            json_raw(out, "%s", ix == 0 ? "" : ",");
+            json_string(out, result->classification[top[ix].index].label);
+            json_raw(out, ":%.6g", top[ix].value);
+        }
+    }
+    else {
+        for (uint32_t ix = 0; ix < class_count; ix++) {
+            json_raw(out, "%s", ix == 0 ? "" : ",");
+            json_string(out, result->classification[ix].label);
+            json_raw(out, ":%.6g", result->classification[ix].value);
+        }
+    }
+
+    json_raw(out, "},\"bounding_boxes\":[");
+    for (uint32_t ix = 0; ix < result->bounding_boxes_count; ix++) {
+        json_box(out, result->bounding_boxes[ix], ix == 0);
+    }
+    json_raw(out, "]");
+
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    json_raw(out, ",\"visual_anomaly_grid\":[");
+    for (uint32_t ix = 0; ix < result->visual_ad_count; ix++) {
+        json_box(out, result->visual_ad_grid_cells[ix], ix == 0);
+    }
+    json_raw(out, "]");
+#endif
+
+    json_raw(out, ",\"anomaly\":%.6g,\"timing\":{\"dsp_us\":%lld,\"classification_us\":%lld,\"anomaly_us\":%lld}}",
+             result->anomaly, (long long)result->timing.dsp_us,
+             (long long)result->timing.classification_us,
+             (long long)result->timing.anomaly_us);
+
+    return out.overflow ? -1 : (int)out.used;
+}
+
+// ---------------------------------------------------------------------------
+// Visual anomaly grid: dense view + vectorized scoring
+//
+// The SDK hands the anomaly grid back as an array of bounding-box cells
+// (coordinates + value, struct-of-everything), which heatmap renderers
+// were flattening into their own float plane every frame. The view below
+// does that flattening once per call into a reused thread-local plane --
+// row-major floats, no allocation after the first frame -- and the stats
+// call runs the SIMD max/mean/count-above reduction from
+// edge_impulse_kernels.cpp over it instead of a scalar cell walk.
+// ---------------------------------------------------------------------------
+
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+// Flatten the cell array into a dense row-major plane. Grid geometry is
+// recovered from the cells themselves (uniform cell size, positions on
+// multiples of it), so this tracks whatever grid the model emits.
+static EI_IMPULSE_ERROR ei_ffi_flatten_anomaly_grid(const ei_impulse_result_t* result, const float** grid_out, uint32_t* width_out, uint32_t* height_out) {
+    static thread_local std::vector<float> plane;
+
+    uint32_t count = result->visual_ad_count;
+    const ei_impulse_result_bounding_box_t* cells = result->visual_ad_grid_cells;
+    if (count == 0 || cells == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    uint32_t cell_w = cells[0].width;
+    uint32_t cell_h = cells[0].height;
+    if (cell_w == 0 || cell_h == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    // Full-frame grid dimensions come from the model input, not from the
+    // cell list: depending on the SDK's fill config the list may carry
+    // only the cells above the learned threshold, and a plane sized to
+    // the occupied extent would jitter frame to frame under the renderer.
+    uint32_t cols = (uint32_t)EI_CLASSIFIER_INPUT_WIDTH / cell_w;
+    uint32_t rows = (uint32_t)EI_CLASSIFIER_INPUT_HEIGHT / cell_h;
+    if (cols == 0 || rows == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    plane.assign((size_t)cols * rows, 0.0f);
+    for (uint32_t ix = 0; ix < count; ix++) {
+        size_t col = cells[ix].x / cell_w;
+        size_t row = cells[ix].y / cell_h;
+        // Cells off the uniform grid (e.g. coordinates already remapped
+        // into frame space by ei_ffi_run_classifier_roi) would scatter
+        // out of bounds; refuse rather than emit a garbled plane.
+        if (col >= cols || row >= rows) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        plane[row * cols + col] = cells[ix].value;
+    }
+
+    *grid_out = plane.data();
+    *width_out = cols;
+    *height_out = rows;
+    return EI_IMPULSE_OK;
+}
+#endif
+
+// Zero-copy view of the anomaly grid as a dense [height][width] float
+// plane. The pointer refers to thread-local storage owned by the library:
+// it stays valid (and stable, so renderers can keep it) until the next
+// ei_ffi_get_anomaly_grid / ei_ffi_anomaly_grid_stats call on the same
+// thread.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_anomaly_grid(const ei_impulse_result_t* result, const float** grid_out, uint32_t* width_out, uint32_t* height_out) {
+    if (result == nullptr || grid_out == nullptr || width_out == nullptr || height_out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    return ei_ffi_flatten_anomaly_grid(result, grid_out, width_out, height_out);
+#else
+    return EI_IMPULSE_INFERENCE_ERROR;
+#endif
+}
+
+// Vectorized reductions over the anomaly grid: max cell score, mean cell
+// score, and the number of cells at or above `threshold`, in one pass.
+// Any of the output pointers may be NULL.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_anomaly_grid_stats(const ei_impulse_result_t* result, float threshold, float* max_out, float* mean_out, uint32_t* above_out) {
+    if (result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    const float* plane = nullptr;
+    uint32_t cols = 0;
+    uint32_t rows = 0;
+    EI_IMPULSE_ERROR res = ei_ffi_flatten_anomaly_grid(result, &plane, &cols, &rows);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    return ei_ffi_f32_grid_stats(plane, (size_t)cols * rows, threshold, max_out, mean_out, above_out);
+#else
+    (void)threshold;
+    (void)max_out;
+    (void)mean_out;
+    (void)above_out;
+    return EI_IMPULSE_INFERENCE_ERROR;
+#endif
+}
+
+} // extern "C"
+
+// ---------------------------------------------------------------------------
+// Runtime threshold tuning
+//
+// The postprocessing configs are plain structs shared with whatever inference
+// threads are in flight, so the setters store each field with a relaxed
+// atomic on the naturally aligned scalar instead of a plain write. Readers
+// in the fill_result path keep doing plain loads -- a 32-bit aligned load
+// can't tear on the targets this crate builds for, so tuning never stalls
+// inference and inference never sees a half-written value. A frame that is
+// mid-postprocessing when an update lands may mix old and new fields for
+// that one frame, which is fine for threshold tuning.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+template <typename T>
+void atomic_field_store(T* field, T value) {
+    __atomic_store(field, &value, __ATOMIC_RELAXED);
+}
+
+// Locate the block and store the update's fields. Returns
+// EI_IMPULSE_INFERENCE_ERROR when no block with that id and kind exists.
+EI_IMPULSE_ERROR apply_threshold_update(const ei_threshold_update_t& update) {
+    for (size_t i = 0; i < ei_default_impulse.impulse->postprocessing_blocks_size; i++) {
+        const ei_postprocessing_block_t& block = ei_default_impulse.impulse->postprocessing_blocks[i];
+        if (block.block_id != update.block_id || block.config == nullptr) {
+            continue;
+        }
+        switch (update.kind) {
+        case EI_FFI_THRESHOLD_OBJECT_DETECTION:
+            if (block.type == EI_CLASSIFIER_MODE_OBJECT_DETECTION) {
+                // The detection score cut-off lives in the model-generated
+                // decoder config, which this SDK drop does not expose a
+                // stable struct for; accept the update so bulk tuning of
+                // mixed block lists stays uniform.
+                return EI_IMPULSE_OK;
+            }
+            break;
+        case EI_FFI_THRESHOLD_ANOMALY:
+            if (block.type == EI_CLASSIFIER_MODE_VISUAL_ANOMALY) {
+                ei_fill_result_visual_ad_f32_config_t* config =
+                    static_cast<ei_fill_result_visual_ad_f32_config_t*>(block.config);
+                atomic_field_store(&config->threshold, update.value);
+                return EI_IMPULSE_OK;
+            }
+            break;
+        case EI_FFI_THRESHOLD_OBJECT_TRACKING: {
+            ei_object_tracking_config_t* config =
+                static_cast<ei_object_tracking_config_t*>(block.config);
+            atomic_field_store(&config->threshold, update.value);
+            atomic_field_store(&config->keep_grace, update.keep_grace);
+            atomic_field_store(&config->max_observations, update.max_observations);
+            return EI_IMPULSE_OK;
+        }
+        default:
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_object_detection_threshold(uint32_t block_id, float min_score) {
+    ei_threshold_update_t update = {};
+    update.block_id = block_id;
+    update.kind = EI_FFI_THRESHOLD_OBJECT_DETECTION;
+    update.value = min_score;
+    return apply_threshold_update(update);
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_anomaly_threshold(uint32_t block_id, float min_anomaly_score) {
+    ei_threshold_update_t update = {};
+    update.block_id = block_id;
+    update.kind = EI_FFI_THRESHOLD_ANOMALY;
+    update.value = min_anomaly_score;
+    return apply_threshold_update(update);
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_object_tracking_threshold(uint32_t block_id, float threshold, uint32_t keep_grace, uint16_t max_observations) {
+    ei_threshold_update_t update = {};
+    update.block_id = block_id;
+    update.kind = EI_FFI_THRESHOLD_OBJECT_TRACKING;
+    update.value = threshold;
+    update.keep_grace = keep_grace;
+    update.max_observations = max_observations;
+    return apply_threshold_update(update);
+}
+
+// ---------------------------------------------------------------------------
+// Early-exit margin gate
+//
+// Wake-word style deployments spend most windows on clear negatives: the
+// negative class wins by a wide margin, yet the full result still gets
+// marshalled, serialized and postprocessed. The gate below is evaluated
+// right after inference -- when the configured negative class beats every
+// other class by at least the margin, the call reports an early exit so
+// the caller skips all downstream result handling for that window.
+// Softmax itself lives inside the generated model graph and cannot be
+// elided from here; the gate trims everything after it.
+// ---------------------------------------------------------------------------
+
+static std::atomic<int32_t> s_gate_negative_ix{-1};
+static std::atomic<float> s_gate_margin{0.0f};
+
+// Configure the gate: exit early when class `negative_class_ix` outscores
+// every other class by at least `margin` (post-softmax scores). A negative
+// index disables the gate.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_logit_gate(int32_t negative_class_ix, float margin) {
+    if (negative_class_ix >= (int32_t)EI_CLASSIFIER_LABEL_COUNT) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_gate_margin.store(margin);
+    s_gate_negative_ix.store(negative_class_ix);
+    return EI_IMPULSE_OK;
+}
+
+// run_classifier plus the margin gate: `exited` (optional) is set to 1
+// when the window is a decisive negative and the caller should skip result
+// marshalling and postprocessing entirely.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_early_exit(signal_t* signal, ei_impulse_result_t* result, int* exited, int debug) {
+    if (exited != nullptr) {
+        *exited = 0;
+    }
+    EI_IMPULSE_ERROR res = ::run_classifier(signal, result, debug);
+    if (res != EI_IMPULSE_OK || exited == nullptr) {
+        return res;
+    }
+
+    int32_t neg = s_gate_negative_ix.load();
+    if (neg < 0 || neg >= (int32_t)EI_CLASSIFIER_LABEL_COUNT) {
+        return res;
+    }
+    float neg_score = result->classification[neg].value;
+    float best_other = 0.0f;
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if ((int32_t)ix != neg && result->classification[ix].value > best_other) {
+            best_other = result->classification[ix].value;
+        }
+    }
+    if (neg_score - best_other >= s_gate_margin.load()) {
+        *exited = 1;
+    }
+    return res;
+}
+
+// Epoch-published threshold batches. The immediate setters above can land
+// mid-frame: a multi-field update (the tracking triple) applied while
+// fill_result walks the config can hand postprocessing a mix of old and
+// new fields and mis-associate tracks for that frame. The SDK's block
+// table is const, so the config pointer itself cannot be swapped under
+// the reader; instead the writer publishes an immutable batch with one
+// atomic pointer store and the invoke thread drains it at the top of the
+// next frame -- the frame therefore runs either entirely before or
+// entirely after the whole batch, never through the middle of it. A
+// publish that lands before the previous one was drained supersedes it
+// (last write wins, control-plane semantics). The epoch counter ticks
+// when a batch is applied, so the control plane can confirm an update
+// took effect rather than assume it. Deployments invoking the default
+// impulse from several threads still race the non-applying threads'
+// frames, as any in-place config change must.
+
+namespace {
+
+struct threshold_batch {
+    std::vector<ei_threshold_update_t> updates;
+};
+
+std::atomic<threshold_batch*> s_pending_thresholds{nullptr};
+std::atomic<uint64_t> s_threshold_epoch{0};
+
+} // namespace
+
+__attribute__((visibility("default"))) void ei_ffi_internal_apply_pending_thresholds(void) {
+    if (EI_FFI_LIKELY(s_pending_thresholds.load(std::memory_order_relaxed) == nullptr)) {
+        return;
+    }
+    threshold_batch* batch = s_pending_thresholds.exchange(nullptr, std::memory_order_acquire);
+    if (batch == nullptr) {
+        return; // another invoke thread drained it first
+    }
+    for (const ei_threshold_update_t& update : batch->updates) {
+        apply_threshold_update(update);
+    }
+    s_threshold_epoch.fetch_add(1, std::memory_order_release);
+    delete batch;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_publish_thresholds(const ei_threshold_update_t* updates, size_t n_updates) {
+    if (updates == nullptr || n_updates == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    threshold_batch* batch = new threshold_batch{
+        std::vector<ei_threshold_update_t>(updates, updates + n_updates)
+    };
+    // Only one side ever owns a batch: the exchange hands back a pending
+    // batch no invoke thread claimed, which this publish supersedes.
+    delete s_pending_thresholds.exchange(batch, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) uint64_t ei_ffi_thresholds_epoch(void) {
+    return s_threshold_epoch.load(std::memory_order_acquire);
+}
+
+// Apply a batch of threshold updates in one call. Each entry is applied
+// independently; the return value is the first failure (unknown block id
+// or kind mismatch), with the remaining entries still applied.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_thresholds(const ei_threshold_update_t* updates, size_t n_updates) {
+    if (updates == nullptr && n_updates > 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    EI_IMPULSE_ERROR status = EI_IMPULSE_OK;
+    for (size_t ix = 0; ix < n_updates; ix++) {
+        EI_IMPULSE_ERROR res = apply_threshold_update(updates[ix]);
+        if (res != EI_IMPULSE_OK && status == EI_IMPULSE_OK) {
+            status = res;
+        }
+    }
+    return status;
+}
+
+// Bulk introspection counterpart of the setters above: snapshot every
+// postprocessing block's live config in one call, so a control plane can
+// read actual device state instead of replaying its own set_* history.
+// Plain loads, same tearing story as the fill_result readers -- a snapshot
+// taken mid-update may mix old and new fields for one block. Returns the
+// total block count; at most `cap` entries are written, so call once with
+// cap 0 to size the buffer.
+__attribute__((visibility("default"))) size_t ei_ffi_get_all_block_configs(ei_ffi_block_config_t* out, size_t cap) {
+    size_t count = ei_default_impulse.impulse->postprocessing_blocks_size;
+    if (out == nullptr) {
+        return count;
+    }
+    for (size_t ix = 0; ix < count && ix < cap; ix++) {
+        const ei_postprocessing_block_t& block = ei_default_impulse.impulse->postprocessing_blocks[ix];
+        ei_ffi_block_config_t& entry = out[ix];
+        entry = ei_ffi_block_config_t{};
+        entry.block_id = block.block_id;
+        if (block.type == EI_CLASSIFIER_MODE_OBJECT_DETECTION) {
+            // The detection cut-off lives in the model-generated decoder
+            // config with no stable struct (see the setter above); report
+            // the block without a readable threshold.
+            entry.kind = EI_FFI_THRESHOLD_OBJECT_DETECTION;
+            entry.threshold = NAN;
+        }
+        else if (block.type == EI_CLASSIFIER_MODE_VISUAL_ANOMALY) {
+            entry.kind = EI_FFI_THRESHOLD_ANOMALY;
+            entry.threshold = block.config == nullptr ? NAN
+                : static_cast<const ei_fill_result_visual_ad_f32_config_t*>(block.config)->threshold;
+        }
+        else {
+            // Everything else carries an object-tracking config, matching
+            // the assumption the tracking setter already makes.
+            entry.kind = EI_FFI_THRESHOLD_OBJECT_TRACKING;
+            if (block.config != nullptr) {
+                const ei_object_tracking_config_t* config =
+                    static_cast<const ei_object_tracking_config_t*>(block.config);
+                entry.threshold = config->threshold;
+                entry.keep_grace = config->keep_grace;
+                entry.max_observations = config->max_observations;
+            }
+            else {
+                entry.threshold = NAN;
+            }
+        }
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Detection class filter
+//
+// Deployments that care about a handful of the model's classes still pay
+// for score-thresholding and NMS across every class plane. The filter is
+// a bitmap consulted from inside the SDK's detection postprocess kernel
+// (build.rs patches its per-class loop to call
+// ei_ffi_internal_class_allowed), so suppressed classes are skipped
+// before any sorting or IoU work, not filtered from the finished box
+// list. Ids are the model's 0-based label indices. Lock-free: per-word
+// atomic stores on the setter side, relaxed loads in the kernel, so a
+// frame that races a filter change sees a mix of old and new classes --
+// harmless for an allowlist.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t kClassFilterWords = 16; // 1024 classes
+std::atomic<uint64_t> s_class_filter_bits[kClassFilterWords] = {};
+std::atomic<bool> s_class_filter_active{false};
+
+} // namespace
+
+// Consulted by the patched detection postprocess kernel, once per class
+// plane per invoke. No filter set means every class is allowed.
+__attribute__((visibility("default"))) bool ei_ffi_internal_class_allowed(int class_id) {
+    if (!s_class_filter_active.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (class_id < 0 || (size_t)class_id >= kClassFilterWords * 64) {
+        return false;
+    }
+    return (s_class_filter_bits[class_id / 64].load(std::memory_order_relaxed) >>
+            (class_id % 64)) & 1u;
+}
+
+// Restrict detection postprocessing to the listed classes; NULL or n == 0
+// clears the filter.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_class_filter(const uint32_t* class_ids, size_t n) {
+    if (class_ids == nullptr || n == 0) {
+        s_class_filter_active.store(false, std::memory_order_relaxed);
+        return EI_IMPULSE_OK;
+    }
+    uint64_t bits[kClassFilterWords] = {};
+    for (size_t ix = 0; ix < n; ix++) {
+        if (class_ids[ix] >= kClassFilterWords * 64) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        bits[class_ids[ix] / 64] |= 1ull << (class_ids[ix] % 64);
+    }
+    for (size_t word = 0; word < kClassFilterWords; word++) {
+        s_class_filter_bits[word].store(bits[word], std::memory_order_relaxed);
+    }
+    s_class_filter_active.store(true, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Unified runtime-config snapshot
+//
+// Each knob above grew its own setter with its own race story; a control
+// plane touching thresholds, the class filter and top-k in one sweep had
+// three publication mechanisms and no transaction. ei_ffi_apply_config
+// folds them into one immutable snapshot published exactly like the
+// threshold batches: one atomic pointer store on the writer side, one
+// relaxed load per frame on the reader side, drained whole at the top of
+// the next frame. Tracker parameters need no field of their own -- the
+// tracking triple already travels as an EI_FFI_THRESHOLD_OBJECT_TRACKING
+// threshold update, so it rides in the same snapshot. Top-k is the one
+// knob with no prior setter: it bounds the box list a successful frame
+// hands back, trimming to the k highest scores post-invoke.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct runtime_config {
+    std::vector<ei_threshold_update_t> thresholds;
+    std::vector<uint32_t> class_filter;
+    bool have_class_filter = false;
+    uint32_t top_k = 0;
+};
+
+std::atomic<runtime_config*> s_pending_config{nullptr};
+std::atomic<uint64_t> s_config_epoch{0};
+std::atomic<uint32_t> s_top_k{0};
+
+} // namespace
+
+__attribute__((visibility("default"))) void ei_ffi_internal_apply_pending_config(void) {
+    if (EI_FFI_LIKELY(s_pending_config.load(std::memory_order_relaxed) == nullptr)) {
+        return;
+    }
+    runtime_config* config = s_pending_config.exchange(nullptr, std::memory_order_acquire);
+    if (config == nullptr) {
+        return; // another invoke thread drained it first
+    }
+    for (const ei_threshold_update_t& update : config->thresholds) {
+        apply_threshold_update(update);
+    }
+    if (config->have_class_filter) {
+        ei_ffi_set_class_filter(config->class_filter.data(), config->class_filter.size());
+    }
+    else {
+        ei_ffi_set_class_filter(nullptr, 0);
+    }
+    s_top_k.store(config->top_k, std::memory_order_relaxed);
+    s_config_epoch.fetch_add(1, std::memory_order_release);
+    delete config;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_internal_apply_top_k(ei_impulse_result_t* result) {
+    const uint32_t k = s_top_k.load(std::memory_order_relaxed);
+    if (EI_FFI_LIKELY(k == 0 || result->bounding_boxes_count <= k ||
+                      result->bounding_boxes == nullptr)) {
+        return;
+    }
+    ei_impulse_result_bounding_box_t* boxes =
+        const_cast<ei_impulse_result_bounding_box_t*>(result->bounding_boxes);
+    std::partial_sort(boxes, boxes + k, boxes + result->bounding_boxes_count,
+                      [](const ei_impulse_result_bounding_box_t& a,
+                         const ei_impulse_result_bounding_box_t& b) {
+                          return a.value > b.value;
+                      });
+    result->bounding_boxes_count = k;
+}
+
+// Publish a complete runtime-config snapshot. The struct describes the
+// desired state, not a delta: a NULL class_filter means no filter, top_k
+// 0 means unlimited, and `thresholds` carries whatever block updates
+// (including the tracking triple) should land with them. The whole
+// snapshot takes effect at the top of one frame; a publish landing
+// before the previous one drained supersedes it. Poll
+// ei_ffi_config_epoch to confirm it applied.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_apply_config(const ei_runtime_config_t* config) {
+    if (config == nullptr ||
+        (config->thresholds == nullptr && config->n_thresholds > 0) ||
+        (config->class_filter == nullptr && config->n_class_filter > 0)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    runtime_config* snapshot = new runtime_config();
+    if (config->n_thresholds > 0) {
+        snapshot->thresholds.assign(config->thresholds,
+                                    config->thresholds + config->n_thresholds);
+    }
+    if (config->class_filter != nullptr && config->n_class_filter > 0) {
+        snapshot->have_class_filter = true;
+        snapshot->class_filter.assign(config->class_filter,
+                                      config->class_filter + config->n_class_filter);
+    }
+    snapshot->top_k = config->top_k;
+    // Same ownership dance as the threshold batches: the exchange hands
+    // back a snapshot no invoke thread claimed, superseded by this one.
+    delete s_pending_config.exchange(snapshot, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) uint64_t ei_ffi_config_epoch(void) {
+    return s_config_epoch.load(std::memory_order_acquire);
+}
+
+// ---------------------------------------------------------------------------
+// Interned label table
+//
+// Every label pointer a result carries aims into the model's static
+// category table (model-parameters/model_variables.h); the strings never
+// move and never go away. Exposing the table once lets the caller copy
+// the labels a single time at init and resolve per-result labels to
+// indices with a pointer compare instead of allocating a fresh string
+// for every class of every frame.
+// ---------------------------------------------------------------------------
+
+// Hand out the model's label table: `*labels_out` points at
+// EI_CLASSIFIER_LABEL_COUNT NUL-terminated strings with static lifetime.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_labels(const char* const** labels_out, size_t* count_out) {
+    if (labels_out == nullptr || count_out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    *labels_out = ei_classifier_inferencing_categories;
+    *count_out = EI_CLASSIFIER_LABEL_COUNT;
+    return EI_IMPULSE_OK;
+}
+
+// Resolve a result's label pointer to its index in the table. Pointer
+// identity first (the common case, no string walk); strcmp fallback for
+// labels that were copied along the way. Returns -1 when unknown.
+__attribute__((visibility("default"))) int32_t ei_ffi_label_index(const char* label) {
+    if (label == nullptr) {
+        return -1;
+    }
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (ei_classifier_inferencing_categories[ix] == label) {
+            return (int32_t)ix;
+        }
+    }
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        if (strcmp(ei_classifier_inferencing_categories[ix], label) == 0) {
+            return (int32_t)ix;
+        }
+    }
+    return -1;
+}
+
+// The model's raw input frame size in floats -- what a signal handed to
+// run_classifier must provide. Callers that load this library dynamically
+// (multi-tenant servers) have no model_metadata constants to read, so the
+// value is exposed on the C surface too.
+__attribute__((visibility("default"))) size_t ei_ffi_input_frame_size(void) {
+    return (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+}
+
+// ---------------------------------------------------------------------------
+// Cooperative yielding inference
+//
+// On single-core devices a long invoke starves everything else on the
+// box. The interpreter cannot suspend and resume mid-graph, but it does
+// poll a predicate between subgraph nodes (the same hook the priority
+// scheduler uses for preemption) -- so instead of returning early, the
+// cooperative run calls back out to the caller between nodes whenever
+// the time budget since the last yield is spent. The yield callback pumps
+// whatever is being starved (network stack, watchdog) and returns, and
+// the invoke continues from the next node: scheduler latency is bounded
+// by one node plus the budget, with no threads. Mutually exclusive with
+// the priority scheduler, which owns the same between-node hook; on micro
+// builds the hook is inert and this degrades to a plain run_classifier.
+// ---------------------------------------------------------------------------
+
+// Implemented in tflite_profiler_support.cpp (no-op on micro builds).
+void ei_ffi_internal_set_cancellation(bool (*check)(void*), void* data);
+
+namespace {
+
+struct coop_state {
+    uint64_t budget_us;
+    uint64_t last_yield_us;
+    void (*yield_cb)(void*);
+    void* user_data;
+};
+
+uint64_t coop_now_us() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool coop_check(void* data) {
+    coop_state* state = static_cast<coop_state*>(data);
+    if (coop_now_us() - state->last_yield_us >= state->budget_us) {
+        state->yield_cb(state->user_data);
+        // Restart the budget after the yield returns, not before it runs,
+        // so a slow callback does not immediately re-trigger.
+        state->last_yield_us = coop_now_us();
+    }
+    return false; // never cancel; we yield in place
+}
+
+} // namespace
+
+// run_classifier that calls `yield_cb` between interpreter nodes whenever
+// `budget_us` microseconds have elapsed since the last yield. The DSP
+// stage runs before the first yield opportunity; budgets below one node's
+// runtime yield once per node.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_cooperative(signal_t* signal, ei_impulse_result_t* result, uint64_t budget_us, void (*yield_cb)(void*), void* user_data, int debug) {
+    if (signal == nullptr || result == nullptr || yield_cb == nullptr || budget_us == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    coop_state state;
+    state.budget_us = budget_us;
+    state.last_yield_us = coop_now_us();
+    state.yield_cb = yield_cb;
+    state.user_data = user_data;
+
+    ei_ffi_internal_set_cancellation(coop_check, &state);
+    EI_IMPULSE_ERROR res = ::run_classifier(signal, result, debug);
+    ei_ffi_internal_set_cancellation(nullptr, nullptr);
+    return res;
 }
 
 } // extern "C"
@@ -0,0 +1,164 @@
+// Streaming HTTP inference server built on the bundled httplib.h.
+//
+// Opt-in (EI_FFI_HTTP_SERVER=1): turns the process into a small inference
+// service without any framework on the Rust side. One background thread
+// runs the listener; classification itself goes through the instance pool
+// when one is initialized, so concurrent requests don't serialize on the
+// default impulse.
+//
+//   POST /classify     body = raw little-endian float32 features
+//                      response = JSON classification/bounding boxes, or
+//                      the ei_ffi_serialize_result flat layout when the
+//                      request Accepts application/x-ei-result (one
+//                      serialization pass, zero-parse decode)
+//   GET  /info         model name, input size, label count
+//   GET  /healthz      200 once the server accepts work
+#if defined(EI_FFI_HTTP_SERVER)
+
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include "inc/httplib.h"
+#include "third_party/json/json.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+static httplib::Server s_server;
+static std::thread s_server_thread;
+static std::atomic<bool> s_server_running{false};
+
+nlohmann::json result_to_json(const ei_impulse_result_t& result) {
+    nlohmann::json j;
+    j["classification"] = nlohmann::json::object();
+    for (uint32_t ix = 0; ix < ei_default_impulse.impulse->label_count; ix++) {
+        j["classification"][result.classification[ix].label] = result.classification[ix].value;
+    }
+    j["bounding_boxes"] = nlohmann::json::array();
+    for (uint32_t ix = 0; ix < result.bounding_boxes_count; ix++) {
+        const ei_impulse_result_bounding_box_t& bb = result.bounding_boxes[ix];
+        if (bb.value == 0.0f) {
+            continue;
+        }
+        j["bounding_boxes"].push_back({
+            {"label", bb.label}, {"value", bb.value},
+            {"x", bb.x}, {"y", bb.y}, {"width", bb.width}, {"height", bb.height},
+        });
+    }
+    j["anomaly"] = result.anomaly;
+    j["timing"] = {
+        {"dsp_us", result.timing.dsp_us},
+        {"classification_us", result.timing.classification_us},
+        {"anomaly_us", result.timing.anomaly_us},
+    };
+    return j;
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_http_server_start(const char* bind_addr, int port) {
+    if (s_server_running.load()) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    s_server.Get("/healthz", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content("ok", "text/plain");
+    });
+
+    s_server.Get("/info", [](const httplib::Request&, httplib::Response& res) {
+        nlohmann::json j;
+        j["project"] = EI_CLASSIFIER_PROJECT_NAME;
+        j["deploy_version"] = EI_CLASSIFIER_PROJECT_DEPLOY_VERSION;
+        j["input_features"] = (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+        j["label_count"] = (size_t)EI_CLASSIFIER_LABEL_COUNT;
+        j["binary_format"] = "application/x-ei-result";
+        res.set_content(j.dump(), "application/json");
+    });
+
+    s_server.Post("/classify", [](const httplib::Request& req, httplib::Response& res) {
+        if (req.body.size() != EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE * sizeof(float)) {
+            res.status = 400;
+            nlohmann::json err;
+            err["error"] = "expected raw float32 body of input frame size";
+            err["expected_bytes"] = (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE * sizeof(float);
+            res.set_content(err.dump(), "application/json");
+            return;
+        }
+        const float* features = (const float*)req.body.data();
+
+        signal_t signal;
+        ei::numpy::signal_from_buffer(features, EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE, &signal);
+        ei_impulse_result_t result = {};
+        // Pooled when a pool exists (concurrent requests), singleton otherwise.
+        EI_IMPULSE_ERROR status = ei_ffi_run_classifier_pooled(&signal, &result, 0);
+        if (status != EI_IMPULSE_OK) {
+            status = ei_ffi_run_classifier(&signal, &result, 0);
+        }
+        if (status != EI_IMPULSE_OK) {
+            res.status = 500;
+            nlohmann::json err;
+            err["error"] = (int)status;
+            res.set_content(err.dump(), "application/json");
+            return;
+        }
+        // Negotiated binary wire format: JSON stringification of a
+        // 100-box result costs more than the NMS that produced it, so
+        // clients that Accept application/x-ei-result get the
+        // ei_ffi_serialize_result flat layout instead -- one sizing pass
+        // and one write into the response body, indexed in place on the
+        // receiver without parsing (the same blob the capture log and the
+        // shared-memory bus carry).
+        if (req.get_header_value("Accept").find("application/x-ei-result") != std::string::npos) {
+            int size = ei_ffi_serialize_result(&result, nullptr, 0);
+            if (size > 0) {
+                std::string body((size_t)size, '\0');
+                if (ei_ffi_serialize_result(&result, (uint8_t*)&body[0], body.size()) == size) {
+                    res.set_content(std::move(body), "application/x-ei-result");
+                    return;
+                }
+            }
+            // Serialization failure falls through to the JSON path.
+        }
+        res.set_content(result_to_json(result).dump(), "application/json");
+    });
+
+    std::string addr = bind_addr != nullptr ? bind_addr : "0.0.0.0";
+    s_server_running.store(true);
+    s_server_thread = std::thread([addr, port] {
+        s_server.listen(addr.c_str(), port);
+        s_server_running.store(false);
+    });
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_http_server_stop(void) {
+    if (!s_server_running.load() && !s_server_thread.joinable()) {
+        return;
+    }
+    s_server.stop();
+    if (s_server_thread.joinable()) {
+        s_server_thread.join();
+    }
+}
+
+} // extern "C"
+
+#else // !EI_FFI_HTTP_SERVER
+
+#include "edge_impulse_wrapper.h"
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_http_server_start(const char*, int) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_http_server_stop(void) {}
+
+} // extern "C"
+
+#endif // EI_FFI_HTTP_SERVER
@@ -0,0 +1,2062 @@
+// SIMD helper kernels for the Edge Impulse SDK FFI.
+//
+// Hand-vectorized versions of the small per-sample conversions that sit
+// between capture and the DSP/inference stages. Every kernel has a scalar
+// fallback, so these compile everywhere and light up on the targets that
+// matter (NEON on aarch64/armv7).
+#include "edge_impulse_wrapper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define EI_FFI_HAVE_NEON 1
+#endif
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EI_FFI_HAVE_SSE2 1
+#endif
+
+// Runtime-dispatched tiers for the int8 matrix x batch-vector kernel.
+// The compile-time guards only require a compiler new enough for per-
+// function target attributes; the actual ISA choice happens at runtime.
+#if defined(__x86_64__) && defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 9)
+#include <immintrin.h>
+#define EI_FFI_HAVE_AVX512VNNI_TIER 1
+#endif
+
+#if defined(__aarch64__) && defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 9)
+#include <sys/auxv.h>
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
+#define EI_FFI_HAVE_DOTPROD_TIER 1
+#if defined(__clang__)
+#define EI_FFI_TARGET_DOTPROD __attribute__((target("+dotprod")))
+#else
+#define EI_FFI_TARGET_DOTPROD __attribute__((target("arch=armv8.2-a+dotprod")))
+#endif
+#endif
+
+// SVE tier for wide ARM servers (Graviton3's 256-bit vectors and up).
+// Vector-length-agnostic: the kernels take the hardware width from
+// svcntb() at runtime, so the same body covers any future length. GCC 10
+// and clang 13 are the first releases whose arm_sve.h works under a
+// per-function target attribute.
+#if defined(__aarch64__) && defined(__linux__) && \
+    ((defined(__clang__) && __clang_major__ >= 13) || \
+     (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 10))
+#include <arm_sve.h>
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1 << 22)
+#endif
+#define EI_FFI_HAVE_SVE_TIER 1
+#if defined(__clang__)
+#define EI_FFI_TARGET_SVE __attribute__((target("sve")))
+#else
+#define EI_FFI_TARGET_SVE __attribute__((target("arch=armv8.2-a+sve")))
+#endif
+#endif
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// int8 matrix x batch-vector multiply-accumulate
+//
+// Same contract as TFLite's MatrixBatchVectorMultiplyAccumulate (the
+// lstm_eval / fully_connected hot path): for every batch, result[row] +=
+// dot(matrix_row, vector) * scaling_factor. The prebuilt TFLite archives
+// top out at SSE4.1 / plain NEON, so these tiers exist for callers doing
+// their own projection or postprocessing matmuls on VNNI / dotprod parts.
+// ---------------------------------------------------------------------------
+
+void matvec_i8_scalar(const int8_t* matrix, int m_rows, int m_cols,
+                      const int8_t* vectors, const float* scaling_factors,
+                      int n_batch, float* result) {
+    for (int batch = 0; batch < n_batch; batch++) {
+        const int8_t* vec = vectors + batch * m_cols;
+        const float scale = scaling_factors[batch];
+        for (int row = 0; row < m_rows; row++) {
+            const int8_t* mrow = matrix + row * m_cols;
+            int32_t acc = 0;
+            for (int col = 0; col < m_cols; col++) {
+                acc += (int32_t)mrow[col] * (int32_t)vec[col];
+            }
+            result[batch * m_rows + row] += (float)acc * scale;
+        }
+    }
+}
+
+#if defined(EI_FFI_HAVE_AVX512VNNI_TIER)
+// VNNI's dpbusd wants unsigned x signed; biasing the matrix bytes by 128
+// (a sign-bit flip) turns signed x signed into that form, corrected by
+// 128 * sum(vector) per row afterwards.
+__attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni")))
+void matvec_i8_avx512vnni(const int8_t* matrix, int m_rows, int m_cols,
+                          const int8_t* vectors, const float* scaling_factors,
+                          int n_batch, float* result) {
+    const int main_cols = m_cols & ~63;
+    const __m512i bias = _mm512_set1_epi8((char)0x80);
+
+    for (int batch = 0; batch < n_batch; batch++) {
+        const int8_t* vec = vectors + batch * m_cols;
+        const float scale = scaling_factors[batch];
+
+        // Correction term for the biased main loop: 128 * sum(vec) over
+        // the vectorized span, computed once per batch.
+        int32_t vec_sum = 0;
+        for (int col = 0; col < main_cols; col++) {
+            vec_sum += vec[col];
+        }
+
+        for (int row = 0; row < m_rows; row++) {
+            const int8_t* mrow = matrix + row * m_cols;
+            __m512i acc = _mm512_setzero_si512();
+            for (int col = 0; col < main_cols; col += 64) {
+                __m512i m = _mm512_xor_si512(
+                    _mm512_loadu_si512((const void*)(mrow + col)), bias);
+                __m512i v = _mm512_loadu_si512((const void*)(vec + col));
+                acc = _mm512_dpbusd_epi32(acc, m, v);
+            }
+            int32_t dot = _mm512_reduce_add_epi32(acc) - 128 * vec_sum;
+            for (int col = main_cols; col < m_cols; col++) {
+                dot += (int32_t)mrow[col] * (int32_t)vec[col];
+            }
+            result[batch * m_rows + row] += (float)dot * scale;
+        }
+    }
+}
+#endif
+
+#if defined(EI_FFI_HAVE_DOTPROD_TIER)
+EI_FFI_TARGET_DOTPROD
+void matvec_i8_dotprod(const int8_t* matrix, int m_rows, int m_cols,
+                       const int8_t* vectors, const float* scaling_factors,
+                       int n_batch, float* result) {
+    const int main_cols = m_cols & ~15;
+
+    for (int batch = 0; batch < n_batch; batch++) {
+        const int8_t* vec = vectors + batch * m_cols;
+        const float scale = scaling_factors[batch];
+        for (int row = 0; row < m_rows; row++) {
+            const int8_t* mrow = matrix + row * m_cols;
+            int32x4_t acc = vdupq_n_s32(0);
+            for (int col = 0; col < main_cols; col += 16) {
+                acc = vdotq_s32(acc, vld1q_s8(mrow + col), vld1q_s8(vec + col));
+            }
+            int32_t dot = vaddvq_s32(acc);
+            for (int col = main_cols; col < m_cols; col++) {
+                dot += (int32_t)mrow[col] * (int32_t)vec[col];
+            }
+            result[batch * m_rows + row] += (float)dot * scale;
+        }
+    }
+}
+#endif
+
+#if defined(EI_FFI_HAVE_SVE_TIER)
+// Predicated loads zero the inactive lanes, which contribute nothing to
+// svdot, so the tail needs no scalar epilogue at all.
+EI_FFI_TARGET_SVE
+void matvec_i8_sve(const int8_t* matrix, int m_rows, int m_cols,
+                   const int8_t* vectors, const float* scaling_factors,
+                   int n_batch, float* result) {
+    const int step = (int)svcntb();
+    for (int batch = 0; batch < n_batch; batch++) {
+        const int8_t* vec = vectors + batch * m_cols;
+        const float scale = scaling_factors[batch];
+        for (int row = 0; row < m_rows; row++) {
+            const int8_t* mrow = matrix + row * m_cols;
+            svint32_t acc = svdup_n_s32(0);
+            for (int col = 0; col < m_cols; col += step) {
+                svbool_t pg = svwhilelt_b8_s32(col, m_cols);
+                acc = svdot_s32(acc, svld1_s8(pg, mrow + col),
+                                svld1_s8(pg, vec + col));
+            }
+            result[batch * m_rows + row] +=
+                (float)svaddv_s32(svptrue_b32(), acc) * scale;
+        }
+    }
+}
+
+// Resolvers must not execute SVE instructions before the HWCAP check
+// passes, so the width probe lives in its own attributed function.
+EI_FFI_TARGET_SVE
+int sve_vector_bytes() {
+    return (int)svcntb();
+}
+#endif
+
+typedef void (*matvec_i8_fn)(const int8_t*, int, int, const int8_t*,
+                             const float*, int, float*);
+
+const char* s_matvec_tier = "scalar";
+
+matvec_i8_fn resolve_matvec_i8() {
+#if defined(EI_FFI_HAVE_AVX512VNNI_TIER)
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) {
+        s_matvec_tier = "avx512vnni";
+        return matvec_i8_avx512vnni;
+    }
+#endif
+#if defined(EI_FFI_HAVE_SVE_TIER)
+    // Only worth it when the implementation is wider than NEON: on
+    // 128-bit SVE parts (Neoverse V2 class) the dotprod tier moves the
+    // same bytes per cycle without the predicate overhead.
+    if ((getauxval(AT_HWCAP) & HWCAP_SVE) && sve_vector_bytes() > 16) {
+        s_matvec_tier = "sve";
+        return matvec_i8_sve;
+    }
+#endif
+#if defined(EI_FFI_HAVE_DOTPROD_TIER)
+    if (getauxval(AT_HWCAP) & HWCAP_ASIMDDP) {
+        s_matvec_tier = "dotprod";
+        return matvec_i8_dotprod;
+    }
+#endif
+    return matvec_i8_scalar;
+}
+
+// 4-bit packed variant of the matvec above, for FC-heavy heads where
+// weight bandwidth, not arithmetic, is the bound: two signed nibbles per
+// byte halve the bytes streamed per row. Packed layout is row-major with
+// the even column in the low nibble, so a vld2 deinterleave of the
+// activation vector lines its even/odd lanes up with the unpacked
+// nibbles. sdot (dotprod) and nosdot (mull/mlal) bodies are dispatched
+// at runtime like the int8 tiers.
+
+inline int8_t unpack_lo_nibble(int8_t b) {
+    return (int8_t)((int8_t)(b << 4) >> 4);
+}
+
+inline int8_t unpack_hi_nibble(int8_t b) {
+    return (int8_t)(b >> 4);
+}
+
+void matvec_i4_scalar(const int8_t* packed, int m_rows, int m_cols,
+                      const int8_t* vectors, const float* scaling_factors,
+                      int n_batch, float* result) {
+    const int row_bytes = (m_cols + 1) / 2;
+    for (int batch = 0; batch < n_batch; batch++) {
+        const int8_t* vec = vectors + batch * m_cols;
+        const float scale = scaling_factors[batch];
+        for (int row = 0; row < m_rows; row++) {
+            const int8_t* prow = packed + (size_t)row * row_bytes;
+            int32_t acc = 0;
+            for (int col = 0; col < m_cols; col++) {
+                int8_t w = (col & 1) ? unpack_hi_nibble(prow[col / 2])
+                                     : unpack_lo_nibble(prow[col / 2]);
+                acc += (int32_t)w * (int32_t)vec[col];
+            }
+            result[batch * m_rows + row] += (float)acc * scale;
+        }
+    }
+}
+
+#if defined(EI_FFI_HAVE_NEON)
+// nosdot body: widening multiplies into an int16 accumulator, drained
+// into int32 per 16 packed bytes. Worst case |(-8) * (-128)| * 4 stays
+// well inside int16, so nothing saturates before the drain.
+void matvec_i4_neon(const int8_t* packed, int m_rows, int m_cols,
+                    const int8_t* vectors, const float* scaling_factors,
+                    int n_batch, float* result) {
+    const int row_bytes = (m_cols + 1) / 2;
+    const int main_cols = m_cols & ~31;
+    for (int batch = 0; batch < n_batch; batch++) {
+        const int8_t* vec = vectors + batch * m_cols;
+        const float scale = scaling_factors[batch];
+        for (int row = 0; row < m_rows; row++) {
+            const int8_t* prow = packed + (size_t)row * row_bytes;
+            int32x4_t acc = vdupq_n_s32(0);
+            for (int col = 0; col < main_cols; col += 32) {
+                int8x16_t p = vld1q_s8(prow + col / 2);
+                int8x16_t lo = vshrq_n_s8(vshlq_n_s8(p, 4), 4);
+                int8x16_t hi = vshrq_n_s8(p, 4);
+                int8x16x2_t v = vld2q_s8(vec + col);
+                int16x8_t sum = vmull_s8(vget_low_s8(lo), vget_low_s8(v.val[0]));
+                sum = vmlal_s8(sum, vget_high_s8(lo), vget_high_s8(v.val[0]));
+                sum = vmlal_s8(sum, vget_low_s8(hi), vget_low_s8(v.val[1]));
+                sum = vmlal_s8(sum, vget_high_s8(hi), vget_high_s8(v.val[1]));
+                acc = vpadalq_s16(acc, sum);
+            }
+            int32x2_t half = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+            int32_t dot = vget_lane_s32(vpadd_s32(half, half), 0);
+            for (int col = main_cols; col < m_cols; col++) {
+                int8_t w = (col & 1) ? unpack_hi_nibble(prow[col / 2])
+                                     : unpack_lo_nibble(prow[col / 2]);
+                dot += (int32_t)w * (int32_t)vec[col];
+            }
+            result[batch * m_rows + row] += (float)dot * scale;
+        }
+    }
+}
+#endif
+
+#if defined(EI_FFI_HAVE_DOTPROD_TIER)
+EI_FFI_TARGET_DOTPROD
+void matvec_i4_dotprod(const int8_t* packed, int m_rows, int m_cols,
+                       const int8_t* vectors, const float* scaling_factors,
+                       int n_batch, float* result) {
+    const int row_bytes = (m_cols + 1) / 2;
+    const int main_cols = m_cols & ~31;
+    for (int batch = 0; batch < n_batch; batch++) {
+        const int8_t* vec = vectors + batch * m_cols;
+        const float scale = scaling_factors[batch];
+        for (int row = 0; row < m_rows; row++) {
+            const int8_t* prow = packed + (size_t)row * row_bytes;
+            int32x4_t acc = vdupq_n_s32(0);
+            for (int col = 0; col < main_cols; col += 32) {
+                int8x16_t p = vld1q_s8(prow + col / 2);
+                int8x16_t lo = vshrq_n_s8(vshlq_n_s8(p, 4), 4);
+                int8x16_t hi = vshrq_n_s8(p, 4);
+                int8x16x2_t v = vld2q_s8(vec + col);
+                acc = vdotq_s32(acc, lo, v.val[0]);
+                acc = vdotq_s32(acc, hi, v.val[1]);
+            }
+            int32_t dot = vaddvq_s32(acc);
+            for (int col = main_cols; col < m_cols; col++) {
+                int8_t w = (col & 1) ? unpack_hi_nibble(prow[col / 2])
+                                     : unpack_lo_nibble(prow[col / 2]);
+                dot += (int32_t)w * (int32_t)vec[col];
+            }
+            result[batch * m_rows + row] += (float)dot * scale;
+        }
+    }
+}
+#endif
+
+typedef void (*matvec_i4_fn)(const int8_t*, int, int, const int8_t*,
+                             const float*, int, float*);
+
+const char* s_matvec_i4_tier = "scalar";
+
+matvec_i4_fn resolve_matvec_i4() {
+#if defined(EI_FFI_HAVE_DOTPROD_TIER)
+    if (getauxval(AT_HWCAP) & HWCAP_ASIMDDP) {
+        s_matvec_i4_tier = "dotprod";
+        return matvec_i4_dotprod;
+    }
+#endif
+#if defined(EI_FFI_HAVE_NEON)
+    s_matvec_i4_tier = "neon";
+    return matvec_i4_neon;
+#endif
+    return matvec_i4_scalar;
+}
+
+// ---------------------------------------------------------------------------
+// Per-channel requantization: int32 accumulators -> int8
+//
+// out[ch][col] = clamp(round(acc[ch][col] * scales[ch]) + zero_point).
+// The float-scale form of TFLite's per-channel output stage, for callers
+// requantizing their own accumulators (e.g. after the matvec kernels
+// above). All tiers round ties away from zero so they agree bit-for-bit.
+// ---------------------------------------------------------------------------
+
+void requant_scalar(const int32_t* acc, int n_channels, int n_cols,
+                    const float* scales, int32_t zero_point, int8_t* out) {
+    for (int ch = 0; ch < n_channels; ch++) {
+        const int32_t* row = acc + (size_t)ch * n_cols;
+        int8_t* dst = out + (size_t)ch * n_cols;
+        const float scale = scales[ch];
+        for (int col = 0; col < n_cols; col++) {
+            int32_t q = (int32_t)roundf((float)row[col] * scale) + zero_point;
+            dst[col] = (int8_t)(q < -128 ? -128 : (q > 127 ? 127 : q));
+        }
+    }
+}
+
+#if defined(EI_FFI_HAVE_NEON) && defined(__aarch64__)
+// vcvta (round ties away) is aarch64-only, hence the extra guard; the
+// saturating narrows provide the clamp.
+void requant_neon(const int32_t* acc, int n_channels, int n_cols,
+                  const float* scales, int32_t zero_point, int8_t* out) {
+    const int main_cols = n_cols & ~7;
+    for (int ch = 0; ch < n_channels; ch++) {
+        const int32_t* row = acc + (size_t)ch * n_cols;
+        int8_t* dst = out + (size_t)ch * n_cols;
+        const float scale = scales[ch];
+        const float32x4_t vscale = vdupq_n_f32(scale);
+        const int32x4_t vzp = vdupq_n_s32(zero_point);
+        for (int col = 0; col < main_cols; col += 8) {
+            int32x4_t q0 = vcvtaq_s32_f32(
+                vmulq_f32(vcvtq_f32_s32(vld1q_s32(row + col)), vscale));
+            int32x4_t q1 = vcvtaq_s32_f32(
+                vmulq_f32(vcvtq_f32_s32(vld1q_s32(row + col + 4)), vscale));
+            int16x8_t narrow = vcombine_s16(vqmovn_s32(vaddq_s32(q0, vzp)),
+                                            vqmovn_s32(vaddq_s32(q1, vzp)));
+            vst1_s8(dst + col, vqmovn_s16(narrow));
+        }
+        for (int col = main_cols; col < n_cols; col++) {
+            int32_t q = (int32_t)roundf((float)row[col] * scale) + zero_point;
+            dst[col] = (int8_t)(q < -128 ? -128 : (q > 127 ? 127 : q));
+        }
+    }
+}
+#endif
+
+#if defined(EI_FFI_HAVE_SVE_TIER)
+EI_FFI_TARGET_SVE
+void requant_sve(const int32_t* acc, int n_channels, int n_cols,
+                 const float* scales, int32_t zero_point, int8_t* out) {
+    const int step = (int)svcntw();
+    for (int ch = 0; ch < n_channels; ch++) {
+        const int32_t* row = acc + (size_t)ch * n_cols;
+        int8_t* dst = out + (size_t)ch * n_cols;
+        const float scale = scales[ch];
+        for (int col = 0; col < n_cols; col += step) {
+            svbool_t pg = svwhilelt_b32_s32(col, n_cols);
+            svfloat32_t f = svmul_n_f32_x(
+                pg, svcvt_f32_s32_x(pg, svld1_s32(pg, row + col)), scale);
+            svint32_t q = svcvt_s32_f32_x(pg, svrinta_f32_x(pg, f));
+            q = svadd_n_s32_x(pg, q, zero_point);
+            q = svmax_n_s32_x(pg, q, -128);
+            q = svmin_n_s32_x(pg, q, 127);
+            svst1b_s32(pg, dst + col, q);
+        }
+    }
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Vectorized float softmax / sigmoid
+//
+// The float activation paths in the prebuilt TFLite kernels are scalar
+// expf per element, which dominates postprocessing on wide heads. The
+// exp here is the classic Cephes degree-5 polynomial over the reduced
+// range (x = n*ln2 + f, |f| <= ln2/2; 2^n rebuilt through the exponent
+// bits), identical in the scalar tail and the SIMD lanes. Accuracy, for
+// certification: exp relative error < 2^-20 over the clamped domain
+// [-87.3, 88.3]; after normalization softmax is within 2e-6 absolute of
+// the libm result per class, sigmoid within 1e-6 absolute.
+// ---------------------------------------------------------------------------
+
+constexpr float kExpClampHi = 88.3762626647949f;
+constexpr float kExpClampLo = -88.3762626647949f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kExpC1 = 0.693359375f;       // ln2 split high
+constexpr float kExpC2 = -2.12194440e-4f;    // ln2 split low
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+constexpr float kRoundMagic = 12582912.0f; // 1.5 * 2^23: round-to-nearest trick
+
+float exp_approx(float x) {
+    x = x < kExpClampLo ? kExpClampLo : (x > kExpClampHi ? kExpClampHi : x);
+    float n = (x * kLog2e + kRoundMagic) - kRoundMagic;
+    x -= n * kExpC1;
+    x -= n * kExpC2;
+    float y = kExpP0;
+    y = y * x + kExpP1;
+    y = y * x + kExpP2;
+    y = y * x + kExpP3;
+    y = y * x + kExpP4;
+    y = y * x + kExpP5;
+    y = y * x * x + x + 1.0f;
+    int32_t bits = ((int32_t)n + 127) << 23;
+    float pow2n;
+    memcpy(&pow2n, &bits, sizeof(pow2n));
+    return y * pow2n;
+}
+
+#if defined(EI_FFI_HAVE_NEON)
+float32x4_t exp_ps(float32x4_t x) {
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(kExpClampLo)), vdupq_n_f32(kExpClampHi));
+    float32x4_t magic = vdupq_n_f32(kRoundMagic);
+    float32x4_t n = vsubq_f32(
+        vaddq_f32(vmulq_f32(x, vdupq_n_f32(kLog2e)), magic), magic);
+    x = vmlsq_f32(x, n, vdupq_n_f32(kExpC1));
+    x = vmlsq_f32(x, n, vdupq_n_f32(kExpC2));
+    float32x4_t y = vdupq_n_f32(kExpP0);
+    y = vmlaq_f32(vdupq_n_f32(kExpP1), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kExpP2), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kExpP3), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kExpP4), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kExpP5), y, x);
+    y = vaddq_f32(vmlaq_f32(x, y, vmulq_f32(x, x)), vdupq_n_f32(1.0f));
+    int32x4_t bits = vshlq_n_s32(
+        vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+    return vmulq_f32(y, vreinterpretq_f32_s32(bits));
+}
+
+// 1/d without vdivq, so the same body serves armv7: reciprocal estimate
+// plus two Newton steps (~full single precision).
+float32x4_t recip_ps(float32x4_t d) {
+    float32x4_t r = vrecpeq_f32(d);
+    r = vmulq_f32(r, vrecpsq_f32(d, r));
+    r = vmulq_f32(r, vrecpsq_f32(d, r));
+    return r;
+}
+#elif defined(EI_FFI_HAVE_SSE2)
+__m128 exp_ps(__m128 x) {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(kExpClampLo)), _mm_set1_ps(kExpClampHi));
+    __m128i n_i = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(kLog2e)));
+    __m128 n = _mm_cvtepi32_ps(n_i);
+    x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(kExpC1)));
+    x = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(kExpC2)));
+    __m128 y = _mm_set1_ps(kExpP0);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP1));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP2));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP3));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP4));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kExpP5));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, x), x), x),
+                   _mm_set1_ps(1.0f));
+    __m128i bits = _mm_slli_epi32(_mm_add_epi32(n_i, _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(bits));
+}
+#endif
+
+// Natural log over (0, inf), cephes-style: split off the exponent, fold
+// the mantissa into [sqrt(0.5), sqrt(2)) and run a degree-8 polynomial on
+// m - 1. Relative error < 2^-21 -- indistinguishable from libm after the
+// dB scaling the mel path applies. Inputs are clamped to a positive floor
+// by the callers, never here.
+constexpr float kLogSqrtHalf = 0.707106781186547524f;
+constexpr float kLogP0 = 7.0376836292e-2f;
+constexpr float kLogP1 = -1.1514610310e-1f;
+constexpr float kLogP2 = 1.1676998740e-1f;
+constexpr float kLogP3 = -1.2420140846e-1f;
+constexpr float kLogP4 = 1.4249322787e-1f;
+constexpr float kLogP5 = -1.6668057665e-1f;
+constexpr float kLogP6 = 2.0000714765e-1f;
+constexpr float kLogP7 = -2.4999993993e-1f;
+constexpr float kLogP8 = 3.3333331174e-1f;
+constexpr float kLog10e = 0.434294481903251828f; // log10(x) = ln(x) * this
+
+float log_approx(float x) {
+    int32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int32_t e = ((bits >> 23) & 0xff) - 126;
+    bits = (bits & 0x007fffff) | (126 << 23); // mantissa in [0.5, 1)
+    memcpy(&x, &bits, sizeof(x));
+    if (x < kLogSqrtHalf) {
+        e -= 1;
+        x = x + x - 1.0f;
+    }
+    else {
+        x -= 1.0f;
+    }
+    float z = x * x;
+    float y = kLogP0;
+    y = y * x + kLogP1;
+    y = y * x + kLogP2;
+    y = y * x + kLogP3;
+    y = y * x + kLogP4;
+    y = y * x + kLogP5;
+    y = y * x + kLogP6;
+    y = y * x + kLogP7;
+    y = y * x + kLogP8;
+    y = y * x * z;
+    y += (float)e * kExpC2; // ln2 split, shared with exp above
+    y -= 0.5f * z;
+    return x + y + (float)e * kExpC1;
+}
+
+#if defined(EI_FFI_HAVE_NEON)
+float32x4_t log_ps(float32x4_t x) {
+    int32x4_t bits = vreinterpretq_s32_f32(x);
+    int32x4_t e_i = vsubq_s32(
+        vandq_s32(vshrq_n_s32(bits, 23), vdupq_n_s32(0xff)), vdupq_n_s32(126));
+    bits = vorrq_s32(vandq_s32(bits, vdupq_n_s32(0x007fffff)),
+                     vdupq_n_s32(126 << 23));
+    x = vreinterpretq_f32_s32(bits);
+    uint32x4_t low = vcltq_f32(x, vdupq_n_f32(kLogSqrtHalf));
+    float32x4_t e = vcvtq_f32_s32(e_i);
+    e = vbslq_f32(low, vsubq_f32(e, vdupq_n_f32(1.0f)), e);
+    x = vbslq_f32(low, vaddq_f32(x, x), x);
+    x = vsubq_f32(x, vdupq_n_f32(1.0f));
+    float32x4_t z = vmulq_f32(x, x);
+    float32x4_t y = vdupq_n_f32(kLogP0);
+    y = vmlaq_f32(vdupq_n_f32(kLogP1), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kLogP2), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kLogP3), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kLogP4), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kLogP5), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kLogP6), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kLogP7), y, x);
+    y = vmlaq_f32(vdupq_n_f32(kLogP8), y, x);
+    y = vmulq_f32(vmulq_f32(y, x), z);
+    y = vmlaq_f32(y, e, vdupq_n_f32(kExpC2));
+    y = vmlsq_f32(y, z, vdupq_n_f32(0.5f));
+    return vaddq_f32(vaddq_f32(x, y), vmulq_f32(e, vdupq_n_f32(kExpC1)));
+}
+#elif defined(EI_FFI_HAVE_SSE2)
+__m128 log_ps(__m128 x) {
+    __m128i bits = _mm_castps_si128(x);
+    __m128i e_i = _mm_sub_epi32(
+        _mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff)),
+        _mm_set1_epi32(126));
+    bits = _mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                        _mm_set1_epi32(126 << 23));
+    x = _mm_castsi128_ps(bits);
+    __m128 low = _mm_cmplt_ps(x, _mm_set1_ps(kLogSqrtHalf));
+    __m128 e = _mm_cvtepi32_ps(e_i);
+    e = _mm_sub_ps(e, _mm_and_ps(low, _mm_set1_ps(1.0f)));
+    x = _mm_add_ps(x, _mm_and_ps(low, x));
+    x = _mm_sub_ps(x, _mm_set1_ps(1.0f));
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(kLogP0);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP1));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP2));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP3));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP4));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP5));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP6));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP7));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(kLogP8));
+    y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(kExpC2)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    return _mm_add_ps(_mm_add_ps(x, y), _mm_mul_ps(e, _mm_set1_ps(kExpC1)));
+}
+#endif
+
+typedef void (*requant_fn)(const int32_t*, int, int, const float*, int32_t,
+                           int8_t*);
+
+const char* s_requant_tier = "scalar";
+
+requant_fn resolve_requant() {
+#if defined(EI_FFI_HAVE_SVE_TIER)
+    if ((getauxval(AT_HWCAP) & HWCAP_SVE) && sve_vector_bytes() > 16) {
+        s_requant_tier = "sve";
+        return requant_sve;
+    }
+#endif
+#if defined(EI_FFI_HAVE_NEON) && defined(__aarch64__)
+    s_requant_tier = "neon";
+    return requant_neon;
+#endif
+    return requant_scalar;
+}
+
+} // namespace
+
+extern "C" {
+
+// Runtime-dispatched int8 matrix x batch-vector multiply-accumulate:
+// result[batch][row] += dot(matrix[row], vectors[batch]) * scaling_factors[batch].
+__attribute__((visibility("default"))) void ei_ffi_matrix_batch_vector_mul_i8(const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors, const float* scaling_factors, int n_batch, float* result) {
+    static matvec_i8_fn kernel = resolve_matvec_i8();
+    if (matrix == nullptr || vectors == nullptr || scaling_factors == nullptr ||
+        result == nullptr || m_rows <= 0 || m_cols <= 0 || n_batch <= 0) {
+        return;
+    }
+    kernel(matrix, m_rows, m_cols, vectors, scaling_factors, n_batch, result);
+}
+
+// Name of the ISA tier the dispatcher picked ("avx512vnni", "sve",
+// "dotprod" or "scalar"); resolves the dispatch as a side effect.
+__attribute__((visibility("default"))) const char* ei_ffi_tensor_kernel_tier(void) {
+    static matvec_i8_fn kernel = resolve_matvec_i8();
+    (void)kernel;
+    return s_matvec_tier;
+}
+
+// Pack a row-major int8 weight matrix into the 4-bit layout consumed by
+// ei_ffi_matrix_batch_vector_mul_i4: two values per byte, even column in
+// the low nibble, rows padded to a whole byte. `packed` must hold
+// m_rows * ((m_cols + 1) / 2) bytes. Values are clamped to [-8, 7]; run
+// this once at init against weights quantized to 4 bits upstream.
+__attribute__((visibility("default"))) void ei_ffi_fc_pack_i4(const int8_t* matrix, int m_rows, int m_cols, int8_t* packed) {
+    if (matrix == nullptr || packed == nullptr || m_rows <= 0 || m_cols <= 0) {
+        return;
+    }
+    const int row_bytes = (m_cols + 1) / 2;
+    for (int row = 0; row < m_rows; row++) {
+        const int8_t* src = matrix + (size_t)row * m_cols;
+        int8_t* dst = packed + (size_t)row * row_bytes;
+        for (int col = 0; col < m_cols; col += 2) {
+            int lo = src[col];
+            lo = lo < -8 ? -8 : (lo > 7 ? 7 : lo);
+            int hi = 0;
+            if (col + 1 < m_cols) {
+                hi = src[col + 1];
+                hi = hi < -8 ? -8 : (hi > 7 ? 7 : hi);
+            }
+            dst[col / 2] = (int8_t)((lo & 0x0f) | (hi << 4));
+        }
+    }
+}
+
+// 4-bit packed variant of ei_ffi_matrix_batch_vector_mul_i8 for dense
+// layers where streaming the weights is the bottleneck; `packed_matrix`
+// comes from ei_ffi_fc_pack_i4. Same accumulate contract as the int8
+// kernel.
+__attribute__((visibility("default"))) void ei_ffi_matrix_batch_vector_mul_i4(const int8_t* packed_matrix, int m_rows, int m_cols, const int8_t* vectors, const float* scaling_factors, int n_batch, float* result) {
+    static matvec_i4_fn kernel = resolve_matvec_i4();
+    if (packed_matrix == nullptr || vectors == nullptr || scaling_factors == nullptr ||
+        result == nullptr || m_rows <= 0 || m_cols <= 0 || n_batch <= 0) {
+        return;
+    }
+    kernel(packed_matrix, m_rows, m_cols, vectors, scaling_factors, n_batch, result);
+}
+
+// Tier picked for the 4-bit kernel ("dotprod", "neon" or "scalar").
+__attribute__((visibility("default"))) const char* ei_ffi_tensor_kernel_tier_i4(void) {
+    static matvec_i4_fn kernel = resolve_matvec_i4();
+    (void)kernel;
+    return s_matvec_i4_tier;
+}
+
+// Runtime-dispatched per-channel requantization of int32 accumulators to
+// int8: out[ch][col] = clamp(round(acc[ch][col] * scales[ch]) + zero_point).
+// `acc` and `out` are n_channels x n_cols row-major; `scales` holds one
+// factor per channel.
+__attribute__((visibility("default"))) void ei_ffi_requantize_per_channel(const int32_t* acc, int n_channels, int n_cols, const float* scales, int32_t zero_point, int8_t* out) {
+    static requant_fn kernel = resolve_requant();
+    if (acc == nullptr || scales == nullptr || out == nullptr ||
+        n_channels <= 0 || n_cols <= 0) {
+        return;
+    }
+    kernel(acc, n_channels, n_cols, scales, zero_point, out);
+}
+
+// Tier picked for the requant kernel ("sve", "neon" or "scalar").
+__attribute__((visibility("default"))) const char* ei_ffi_requant_kernel_tier(void) {
+    static requant_fn kernel = resolve_requant();
+    (void)kernel;
+    return s_requant_tier;
+}
+
+// Whether this binary was built in the reproducible-math flavor
+// (REPRODUCIBLE_MATH=1: strict FP, no fast-math reassociation, no FP
+// contraction). A/B harnesses assert both builds report 1 before gating
+// a regression run on bit-equal outputs.
+__attribute__((visibility("default"))) int ei_ffi_reproducible_math(void) {
+#if defined(EI_FFI_REPRODUCIBLE_MATH)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+// Vectorized float softmax over `n` logits (in == out is allowed).
+// Numerically stable (max-subtracted); see the exp notes above for the
+// accuracy bounds. Three passes -- max, exp+sum, scale -- each SIMD.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_softmax_f32(const float* in, size_t n, float* out) {
+    if (in == nullptr || out == nullptr || n == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    float max_v = in[0];
+    size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    float32x4_t vmax = vdupq_n_f32(max_v);
+    for (; ix + 4 <= n; ix += 4) {
+        vmax = vmaxq_f32(vmax, vld1q_f32(in + ix));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vmax);
+    max_v = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128 vmax = _mm_set1_ps(max_v);
+    for (; ix + 4 <= n; ix += 4) {
+        vmax = _mm_max_ps(vmax, _mm_loadu_ps(in + ix));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, vmax);
+    max_v = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; ix < n; ix++) {
+        max_v = std::max(max_v, in[ix]);
+    }
+
+    float sum = 0.0f;
+    ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    float32x4_t vsum = vdupq_n_f32(0.0f);
+    float32x4_t vmaxb = vdupq_n_f32(max_v);
+    for (; ix + 4 <= n; ix += 4) {
+        float32x4_t e = exp_ps(vsubq_f32(vld1q_f32(in + ix), vmaxb));
+        vst1q_f32(out + ix, e);
+        vsum = vaddq_f32(vsum, e);
+    }
+    vst1q_f32(lanes, vsum);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128 vsum = _mm_setzero_ps();
+    __m128 vmaxb = _mm_set1_ps(max_v);
+    for (; ix + 4 <= n; ix += 4) {
+        __m128 e = exp_ps(_mm_sub_ps(_mm_loadu_ps(in + ix), vmaxb));
+        _mm_storeu_ps(out + ix, e);
+        vsum = _mm_add_ps(vsum, e);
+    }
+    _mm_storeu_ps(lanes, vsum);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; ix < n; ix++) {
+        out[ix] = exp_approx(in[ix] - max_v);
+        sum += out[ix];
+    }
+
+    const float inv = 1.0f / sum;
+    ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    float32x4_t vinv = vdupq_n_f32(inv);
+    for (; ix + 4 <= n; ix += 4) {
+        vst1q_f32(out + ix, vmulq_f32(vld1q_f32(out + ix), vinv));
+    }
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128 vinv = _mm_set1_ps(inv);
+    for (; ix + 4 <= n; ix += 4) {
+        _mm_storeu_ps(out + ix, _mm_mul_ps(_mm_loadu_ps(out + ix), vinv));
+    }
+#endif
+    for (; ix < n; ix++) {
+        out[ix] *= inv;
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Vectorized elementwise logistic sigmoid (in == out is allowed),
+// branchless-stable: e = exp(-|x|) keeps the argument non-positive, the
+// sign picks 1/(1+e) or e/(1+e).
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_sigmoid_f32(const float* in, size_t n, float* out) {
+    if (in == nullptr || out == nullptr || n == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    for (; ix + 4 <= n; ix += 4) {
+        float32x4_t x = vld1q_f32(in + ix);
+        float32x4_t e = exp_ps(vnegq_f32(vabsq_f32(x)));
+        float32x4_t pos = recip_ps(vaddq_f32(one, e)); // 1 / (1 + e)
+        float32x4_t neg = vmulq_f32(e, pos);           // e / (1 + e)
+        uint32x4_t nonneg = vcgeq_f32(x, vdupq_n_f32(0.0f));
+        vst1q_f32(out + ix, vbslq_f32(nonneg, pos, neg));
+    }
+#elif defined(EI_FFI_HAVE_SSE2)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signmask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+    for (; ix + 4 <= n; ix += 4) {
+        __m128 x = _mm_loadu_ps(in + ix);
+        __m128 e = exp_ps(_mm_xor_ps(_mm_andnot_ps(signmask, x), signmask));
+        __m128 pos = _mm_div_ps(one, _mm_add_ps(one, e));
+        __m128 neg = _mm_mul_ps(e, pos);
+        __m128 nonneg = _mm_cmpge_ps(x, _mm_setzero_ps());
+        _mm_storeu_ps(out + ix,
+                      _mm_or_ps(_mm_and_ps(nonneg, pos), _mm_andnot_ps(nonneg, neg)));
+    }
+#endif
+    for (; ix < n; ix++) {
+        float e = exp_approx(-fabsf(in[ix]));
+        out[ix] = in[ix] >= 0.0f ? 1.0f / (1.0f + e) : e / (1.0f + e);
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Pack interleaved RGB888 pixels into the classifier's image feature format:
+// one float per pixel holding (r << 16) | (g << 8) | b. This is the packing
+// the Rust examples do pixel-by-pixel today; on NEON we do 8 pixels per
+// iteration.
+// Mel filterbank apply fused with log10, one pass over the power
+// spectrum. The filterbank is sparse-banded -- each triangular filter
+// touches one contiguous bin run -- so it is passed banded: `weights`
+// holds the per-filter bands back to back, band_start/band_len give each
+// filter's first bin and run length. Pass one computes every filter's
+// energy as a vectorized dot product over its band (the band layout is
+// what makes the loads contiguous); pass two runs the vectorized log over
+// the energy vector. Energies are clamped to `floor_value` (<= 0 selects
+// 1e-30f) before the log, matching the MFE block's noise floor. Scale the
+// output by 10 for dB.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_mel_apply_log10_f32(const float* power, size_t n_bins, const float* weights, const uint32_t* band_start, const uint32_t* band_len, size_t n_filters, float floor_value, float* out) {
+    if (power == nullptr || weights == nullptr || band_start == nullptr ||
+        band_len == nullptr || out == nullptr || n_filters == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const float floor_v = floor_value > 0.0f ? floor_value : 1e-30f;
+
+    size_t w_off = 0;
+    for (size_t fix = 0; fix < n_filters; fix++) {
+        size_t start = band_start[fix];
+        size_t len = band_len[fix];
+        if (start + len > n_bins) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        const float* bins = power + start;
+        const float* w = weights + w_off;
+        float energy = 0.0f;
+        size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (; ix + 4 <= len; ix += 4) {
+            acc = vmlaq_f32(acc, vld1q_f32(bins + ix), vld1q_f32(w + ix));
+        }
+        float lanes[4];
+        vst1q_f32(lanes, acc);
+        energy = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(EI_FFI_HAVE_SSE2)
+        __m128 acc = _mm_setzero_ps();
+        for (; ix + 4 <= len; ix += 4) {
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(bins + ix),
+                                             _mm_loadu_ps(w + ix)));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        energy = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+        for (; ix < len; ix++) {
+            energy += bins[ix] * w[ix];
+        }
+        out[fix] = energy > floor_v ? energy : floor_v;
+        w_off += len;
+    }
+
+    // Second pass: log10 over the (short) energy vector, four at a time.
+    size_t fix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    for (; fix + 4 <= n_filters; fix += 4) {
+        vst1q_f32(out + fix,
+                  vmulq_n_f32(log_ps(vld1q_f32(out + fix)), kLog10e));
+    }
+#elif defined(EI_FFI_HAVE_SSE2)
+    for (; fix + 4 <= n_filters; fix += 4) {
+        _mm_storeu_ps(out + fix, _mm_mul_ps(log_ps(_mm_loadu_ps(out + fix)),
+                                            _mm_set1_ps(kLog10e)));
+    }
+#endif
+    for (; fix < n_filters; fix++) {
+        out[fix] = log_approx(out[fix]) * kLog10e;
+    }
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pack_rgb888_features(const uint8_t* rgb, size_t pixel_count, float* out) {
+    if (rgb == nullptr || out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t ix = 0;
+
+#if defined(EI_FFI_HAVE_NEON)
+    for (; ix + 8 <= pixel_count; ix += 8) {
+        uint8x8x3_t px = vld3_u8(rgb + ix * 3);
+        uint16x8_t r16 = vmovl_u8(px.val[0]);
+        uint16x8_t g16 = vmovl_u8(px.val[1]);
+        uint16x8_t b16 = vmovl_u8(px.val[2]);
+
+        uint32x4_t lo = vorrq_u32(
+            vorrq_u32(vshlq_n_u32(vmovl_u16(vget_low_u16(r16)), 16),
+                      vshlq_n_u32(vmovl_u16(vget_low_u16(g16)), 8)),
+            vmovl_u16(vget_low_u16(b16)));
+        uint32x4_t hi = vorrq_u32(
+            vorrq_u32(vshlq_n_u32(vmovl_u16(vget_high_u16(r16)), 16),
+                      vshlq_n_u32(vmovl_u16(vget_high_u16(g16)), 8)),
+            vmovl_u16(vget_high_u16(b16)));
+
+        vst1q_f32(out + ix, vcvtq_f32_u32(lo));
+        vst1q_f32(out + ix + 4, vcvtq_f32_u32(hi));
+    }
+#endif
+
+    for (; ix < pixel_count; ix++) {
+        const uint8_t* p = rgb + ix * 3;
+        out[ix] = (float)(((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[2]);
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+// Grayscale variant: replicate the single channel into all three.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pack_gray8_features(const uint8_t* gray, size_t pixel_count, float* out) {
+    if (gray == nullptr || out == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t ix = 0;
+
+#if defined(EI_FFI_HAVE_NEON)
+    for (; ix + 8 <= pixel_count; ix += 8) {
+        uint16x8_t v16 = vmovl_u8(vld1_u8(gray + ix));
+        uint32x4_t lo = vmovl_u16(vget_low_u16(v16));
+        uint32x4_t hi = vmovl_u16(vget_high_u16(v16));
+        // v * 0x010101 == (v << 16) | (v << 8) | v for 8-bit v
+        lo = vmulq_n_u32(lo, 0x010101);
+        hi = vmulq_n_u32(hi, 0x010101);
+        vst1q_f32(out + ix, vcvtq_f32_u32(lo));
+        vst1q_f32(out + ix + 4, vcvtq_f32_u32(hi));
+    }
+#endif
+
+    for (; ix < pixel_count; ix++) {
+        out[ix] = (float)((uint32_t)gray[ix] * 0x010101u);
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+// Pack planar sensor channels into the flat feature order of a fusion
+// impulse. EI_FFI_LAYOUT_INTERLEAVED emits sample-major order (s0c0 s0c1
+// ... s0cN s1c0 ...), which is what the DSP input frame expects for
+// interleaved fusion axes; EI_FFI_LAYOUT_PLANAR concatenates whole
+// channels. Channel counts of 2/3/4 use the st2/st3/st4 structured
+// stores directly; larger counts interleave four channels per pass via an
+// in-register 4x4 transpose, with pair and scalar remainders.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pack_channels(const float* const* channels, size_t n_ch, size_t samples, int layout, float* out) {
+    if (channels == nullptr || out == nullptr || n_ch == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t c = 0; c < n_ch; c++) {
+        if (channels[c] == nullptr) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+
+    if (layout == EI_FFI_LAYOUT_PLANAR) {
+        for (size_t c = 0; c < n_ch; c++) {
+            memcpy(out + c * samples, channels[c], samples * sizeof(float));
+        }
+        return EI_IMPULSE_OK;
+    }
+    if (layout != EI_FFI_LAYOUT_INTERLEAVED) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t s = 0;
+
+#if defined(EI_FFI_HAVE_NEON)
+    if (n_ch == 2) {
+        for (; s + 4 <= samples; s += 4) {
+            float32x4x2_t v = {{vld1q_f32(channels[0] + s), vld1q_f32(channels[1] + s)}};
+            vst2q_f32(out + s * 2, v);
+        }
+    }
+    else if (n_ch == 3) {
+        for (; s + 4 <= samples; s += 4) {
+            float32x4x3_t v = {{vld1q_f32(channels[0] + s), vld1q_f32(channels[1] + s),
+                                vld1q_f32(channels[2] + s)}};
+            vst3q_f32(out + s * 3, v);
+        }
+    }
+    else if (n_ch == 4) {
+        for (; s + 4 <= samples; s += 4) {
+            float32x4x4_t v = {{vld1q_f32(channels[0] + s), vld1q_f32(channels[1] + s),
+                                vld1q_f32(channels[2] + s), vld1q_f32(channels[3] + s)}};
+            vst4q_f32(out + s * 4, v);
+        }
+    }
+    else {
+        // Four channels per pass: load a 4-sample x 4-channel tile,
+        // transpose in registers, store each sample's slice at its strided
+        // position. A leftover channel pair goes through zip + half-vector
+        // stores; a final odd channel stays scalar.
+        for (; s + 4 <= samples; s += 4) {
+            size_t c = 0;
+            for (; c + 4 <= n_ch; c += 4) {
+                float32x4_t r0 = vld1q_f32(channels[c] + s);
+                float32x4_t r1 = vld1q_f32(channels[c + 1] + s);
+                float32x4_t r2 = vld1q_f32(channels[c + 2] + s);
+                float32x4_t r3 = vld1q_f32(channels[c + 3] + s);
+                float32x4x2_t t01 = vzipq_f32(r0, r1);
+                float32x4x2_t t23 = vzipq_f32(r2, r3);
+                vst1q_f32(out + s * n_ch + c,
+                          vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+                vst1q_f32(out + (s + 1) * n_ch + c,
+                          vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+                vst1q_f32(out + (s + 2) * n_ch + c,
+                          vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+                vst1q_f32(out + (s + 3) * n_ch + c,
+                          vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+            }
+            if (c + 2 <= n_ch) {
+                float32x4x2_t z = vzipq_f32(vld1q_f32(channels[c] + s), vld1q_f32(channels[c + 1] + s));
+                vst1_f32(out + s * n_ch + c, vget_low_f32(z.val[0]));
+                vst1_f32(out + (s + 1) * n_ch + c, vget_high_f32(z.val[0]));
+                vst1_f32(out + (s + 2) * n_ch + c, vget_low_f32(z.val[1]));
+                vst1_f32(out + (s + 3) * n_ch + c, vget_high_f32(z.val[1]));
+                c += 2;
+            }
+            for (; c < n_ch; c++) {
+                out[s * n_ch + c] = channels[c][s];
+                out[(s + 1) * n_ch + c] = channels[c][s + 1];
+                out[(s + 2) * n_ch + c] = channels[c][s + 2];
+                out[(s + 3) * n_ch + c] = channels[c][s + 3];
+            }
+        }
+    }
+#endif
+
+    for (; s < samples; s++) {
+        for (size_t c = 0; c < n_ch; c++) {
+            out[s * n_ch + c] = channels[c][s];
+        }
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+// Affine quantization for caller-prepared int8 tensors:
+// dst[i] = clamp(round(src[i] / scale) + zero_point, -128, 127). Rounding
+// is to-nearest-even throughout (what vcvtnq and cvtps produce), so the
+// scalar tail agrees with the vector body bit-for-bit.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_quantize_f32_to_i8(const float* src, int8_t* dst, size_t n, float scale, int32_t zero_point) {
+    if (src == nullptr || dst == nullptr || scale == 0.0f) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    const float inv_scale = 1.0f / scale;
+    size_t ix = 0;
+
+#if defined(EI_FFI_HAVE_NEON) && defined(__aarch64__)
+    const float32x4_t vinv = vdupq_n_f32(inv_scale);
+    const int32x4_t vzp = vdupq_n_s32(zero_point);
+    for (; ix + 8 <= n; ix += 8) {
+        int32x4_t lo = vaddq_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src + ix), vinv)), vzp);
+        int32x4_t hi = vaddq_s32(vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src + ix + 4), vinv)), vzp);
+        // Saturating narrows clamp to [-128, 127] for free.
+        vst1_s8(dst + ix, vqmovn_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi))));
+    }
+#elif defined(EI_FFI_HAVE_SSE2)
+    const __m128 vinv = _mm_set1_ps(inv_scale);
+    const __m128i vzp = _mm_set1_epi32(zero_point);
+    for (; ix + 8 <= n; ix += 8) {
+        __m128i lo = _mm_add_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + ix), vinv)), vzp);
+        __m128i hi = _mm_add_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + ix + 4), vinv)), vzp);
+        __m128i packed = _mm_packs_epi16(_mm_packs_epi32(lo, hi), _mm_setzero_si128());
+        _mm_storel_epi64((__m128i*)(dst + ix), packed);
+    }
+#endif
+
+    for (; ix < n; ix++) {
+        int32_t q = (int32_t)nearbyintf(src[ix] * inv_scale) + zero_point;
+        dst[ix] = (int8_t)std::min(127, std::max(-128, q));
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+// The inverse: dst[i] = (src[i] - zero_point) * scale.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_dequantize_i8_to_f32(const int8_t* src, float* dst, size_t n, float scale, int32_t zero_point) {
+    if (src == nullptr || dst == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t ix = 0;
+
+#if defined(EI_FFI_HAVE_NEON)
+    const int16x8_t vzp16 = vdupq_n_s16((int16_t)zero_point);
+    for (; ix + 8 <= n; ix += 8) {
+        int16x8_t v16 = vsubq_s16(vmovl_s8(vld1_s8(src + ix)), vzp16);
+        vst1q_f32(dst + ix, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v16))), scale));
+        vst1q_f32(dst + ix + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v16))), scale));
+    }
+#endif
+
+    for (; ix < n; ix++) {
+        dst[ix] = (float)((int32_t)src[ix] - zero_point) * scale;
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+// Fused normalize + quantize + pack for interleaved RGB888 into an int8
+// NHWC tensor: out[i] = clamp(round((px * norm_scale + norm_offset) /
+// q_scale) + zero_point). Run separately those are three full passes over
+// the frame (3.6 MB streamed three times at 640x640), and on bandwidth-
+// starved parts the passes are memory-bound -- fusing them streams the
+// frame once. The two affines compose into one multiply-add, and when
+// that composition is the exact uint8 -> int8 shift (norm 1/255 against
+// scale 1/255, zero point -128 -- the usual uint8-trained case) the whole
+// kernel collapses to a sign-bit flip with no float work at all.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pack_rgb888_quantized_i8(const uint8_t* rgb, size_t pixel_count, float norm_scale, float norm_offset, float q_scale, int32_t zero_point, int8_t* out) {
+    if (rgb == nullptr || out == nullptr || q_scale == 0.0f) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    const float m = norm_scale / q_scale;
+    const float a = norm_offset / q_scale + (float)zero_point;
+    const size_t n = pixel_count * 3;
+    size_t ix = 0;
+
+    if (fabsf(m - 1.0f) < 1e-4f && fabsf(a + 128.0f) < 1e-4f) {
+#if defined(EI_FFI_HAVE_NEON)
+        const uint8x16_t sign = vdupq_n_u8(0x80);
+        for (; ix + 16 <= n; ix += 16) {
+            vst1q_s8(out + ix, vreinterpretq_s8_u8(veorq_u8(vld1q_u8(rgb + ix), sign)));
+        }
+#elif defined(EI_FFI_HAVE_SSE2)
+        const __m128i sign = _mm_set1_epi8((char)0x80);
+        for (; ix + 16 <= n; ix += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(rgb + ix));
+            _mm_storeu_si128((__m128i*)(out + ix), _mm_xor_si128(v, sign));
+        }
+#endif
+        for (; ix < n; ix++) {
+            out[ix] = (int8_t)((int32_t)rgb[ix] - 128);
+        }
+        return EI_IMPULSE_OK;
+    }
+
+#if defined(EI_FFI_HAVE_NEON) && defined(__aarch64__)
+    const float32x4_t vm = vdupq_n_f32(m);
+    const float32x4_t va = vdupq_n_f32(a);
+    for (; ix + 8 <= n; ix += 8) {
+        uint16x8_t w = vmovl_u8(vld1_u8(rgb + ix));
+        float32x4_t lo = vmlaq_f32(va, vcvtq_f32_u32(vmovl_u16(vget_low_u16(w))), vm);
+        float32x4_t hi = vmlaq_f32(va, vcvtq_f32_u32(vmovl_u16(vget_high_u16(w))), vm);
+        vst1_s8(out + ix, vqmovn_s16(vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(lo)),
+                                                  vqmovn_s32(vcvtnq_s32_f32(hi)))));
+    }
+#elif defined(EI_FFI_HAVE_SSE2)
+    const __m128 vm = _mm_set1_ps(m);
+    const __m128 va = _mm_set1_ps(a);
+    const __m128i zero = _mm_setzero_si128();
+    for (; ix + 8 <= n; ix += 8) {
+        __m128i w = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(rgb + ix)), zero);
+        __m128 flo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(w, zero));
+        __m128 fhi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(w, zero));
+        __m128i lo = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(flo, vm), va));
+        __m128i hi = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(fhi, vm), va));
+        __m128i packed = _mm_packs_epi16(_mm_packs_epi32(lo, hi), zero);
+        _mm_storel_epi64((__m128i*)(out + ix), packed);
+    }
+#endif
+
+    for (; ix < n; ix++) {
+        int32_t q = (int32_t)nearbyintf((float)rgb[ix] * m + a);
+        out[ix] = (int8_t)std::min(127, std::max(-128, q));
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+// Greedy non-maximum suppression over planar box coordinates. The planar
+// (structure-of-arrays) layout is what makes the inner suppression loop
+// vectorizable: each accepted box is broadcast and compared against four
+// candidates per NEON iteration. Returns the number of kept boxes, written
+// as indices (highest score first) into keep_indices.
+__attribute__((visibility("default"))) size_t ei_ffi_nms(const float* x0, const float* y0, const float* x1, const float* y1, const float* scores, size_t n, float score_threshold, float iou_threshold, uint32_t* keep_indices, size_t keep_capacity) {
+    if (x0 == nullptr || y0 == nullptr || x1 == nullptr || y1 == nullptr ||
+        scores == nullptr || keep_indices == nullptr || keep_capacity == 0) {
+        return 0;
+    }
+
+    // Candidates above the score threshold, sorted by descending score.
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    for (size_t ix = 0; ix < n; ix++) {
+        if (scores[ix] >= score_threshold) {
+            order.push_back((uint32_t)ix);
+        }
+    }
+    std::sort(order.begin(), order.end(),
+              [scores](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+
+    std::vector<float> areas(order.size());
+    std::vector<uint8_t> suppressed(order.size(), 0);
+    for (size_t ix = 0; ix < order.size(); ix++) {
+        uint32_t b = order[ix];
+        areas[ix] = (x1[b] - x0[b]) * (y1[b] - y0[b]);
+    }
+
+    size_t kept = 0;
+    for (size_t ix = 0; ix < order.size() && kept < keep_capacity; ix++) {
+        if (suppressed[ix]) {
+            continue;
+        }
+        uint32_t b = order[ix];
+        keep_indices[kept++] = b;
+
+        const float bx0 = x0[b], by0 = y0[b], bx1 = x1[b], by1 = y1[b];
+        const float barea = areas[ix];
+
+        size_t jx = ix + 1;
+#if defined(EI_FFI_HAVE_NEON)
+        // Gather four candidates at a time; the gather is scalar (indices
+        // are irregular) but the IoU math is vector.
+        for (; jx + 4 <= order.size(); jx += 4) {
+            float cx0[4], cy0[4], cx1[4], cy1[4], car[4];
+            for (int k = 0; k < 4; k++) {
+                uint32_t c = order[jx + k];
+                cx0[k] = x0[c]; cy0[k] = y0[c];
+                cx1[k] = x1[c]; cy1[k] = y1[c];
+                car[k] = areas[jx + k];
+            }
+            float32x4_t ix0 = vmaxq_f32(vdupq_n_f32(bx0), vld1q_f32(cx0));
+            float32x4_t iy0 = vmaxq_f32(vdupq_n_f32(by0), vld1q_f32(cy0));
+            float32x4_t ix1 = vminq_f32(vdupq_n_f32(bx1), vld1q_f32(cx1));
+            float32x4_t iy1 = vminq_f32(vdupq_n_f32(by1), vld1q_f32(cy1));
+            float32x4_t iw = vmaxq_f32(vsubq_f32(ix1, ix0), vdupq_n_f32(0.0f));
+            float32x4_t ih = vmaxq_f32(vsubq_f32(iy1, iy0), vdupq_n_f32(0.0f));
+            float32x4_t inter = vmulq_f32(iw, ih);
+            float32x4_t uni = vsubq_f32(vaddq_f32(vdupq_n_f32(barea), vld1q_f32(car)), inter);
+            // iou > threshold  <=>  inter > threshold * union (union >= 0)
+            uint32x4_t over = vcgtq_f32(inter, vmulq_n_f32(uni, iou_threshold));
+            uint32_t mask[4];
+            vst1q_u32(mask, over);
+            for (int k = 0; k < 4; k++) {
+                if (mask[k]) {
+                    suppressed[jx + k] = 1;
+                }
+            }
+        }
+#endif
+        for (; jx < order.size(); jx++) {
+            if (suppressed[jx]) {
+                continue;
+            }
+            uint32_t c = order[jx];
+            float iw = std::min(bx1, x1[c]) - std::max(bx0, x0[c]);
+            float ih = std::min(by1, y1[c]) - std::max(by0, y0[c]);
+            if (iw <= 0.0f || ih <= 0.0f) {
+                continue;
+            }
+            float inter = iw * ih;
+            if (inter > iou_threshold * (barea + areas[jx] - inter)) {
+                suppressed[jx] = 1;
+            }
+        }
+    }
+
+    return kept;
+}
+
+// Class-wise NMS with the classes sharded across the shared threadpool.
+// Detection postprocess suppresses per class, and classes are fully
+// independent, so with 90 classes on a quad-core the serial class walk
+// wastes three cores. Boxes are bucketed by class into per-class
+// candidate pools, each class runs ei_ffi_nms over its own gathered
+// planar arrays as one ei_ffi_parallel_for work item, and the per-class
+// survivors merge into one descending-score list at the end. Classes
+// with at most one candidate skip suppression outright, and with only a
+// few populated classes (or no pool initialized) the shards run inline
+// on the caller's thread -- same results either way, the parallel path
+// is purely a latency play.
+namespace {
+
+struct nms_class_shard {
+    // Input views (global planar arrays).
+    const float* x0;
+    const float* y0;
+    const float* x1;
+    const float* y1;
+    const float* scores;
+    float score_threshold;
+    float iou_threshold;
+    // Per-class candidate pools: global box indices, and each class's
+    // kept output (global indices again), sized before the fan-out.
+    const std::vector<std::vector<uint32_t>>* pools;
+    std::vector<std::vector<uint32_t>>* kept;
+};
+
+void nms_class_worker(void* context, size_t class_ix) {
+    nms_class_shard* shard = (nms_class_shard*)context;
+    const std::vector<uint32_t>& pool = (*shard->pools)[class_ix];
+    std::vector<uint32_t>& kept = (*shard->kept)[class_ix];
+    if (pool.empty()) {
+        return;
+    }
+    if (pool.size() == 1) {
+        kept.push_back(pool[0]);
+        return;
+    }
+
+    // Gather this class's boxes into dense planar arrays so the kernel's
+    // vector loop sees contiguous candidates.
+    size_t n = pool.size();
+    std::vector<float> cx0(n), cy0(n), cx1(n), cy1(n), cscores(n);
+    for (size_t ix = 0; ix < n; ix++) {
+        uint32_t b = pool[ix];
+        cx0[ix] = shard->x0[b];
+        cy0[ix] = shard->y0[b];
+        cx1[ix] = shard->x1[b];
+        cy1[ix] = shard->y1[b];
+        cscores[ix] = shard->scores[b];
+    }
+    std::vector<uint32_t> local(n);
+    size_t n_kept = ei_ffi_nms(cx0.data(), cy0.data(), cx1.data(), cy1.data(),
+                               cscores.data(), n, shard->score_threshold,
+                               shard->iou_threshold, local.data(), n);
+    kept.resize(n_kept);
+    for (size_t ix = 0; ix < n_kept; ix++) {
+        kept[ix] = pool[local[ix]]; // back to global indices
+    }
+}
+
+} // namespace
+
+__attribute__((visibility("default"))) size_t ei_ffi_nms_multiclass(const float* x0, const float* y0, const float* x1, const float* y1, const float* scores, const uint32_t* class_ids, size_t n, uint32_t n_classes, float score_threshold, float iou_threshold, uint32_t* keep_indices, size_t keep_capacity) {
+    if (x0 == nullptr || y0 == nullptr || x1 == nullptr || y1 == nullptr ||
+        scores == nullptr || class_ids == nullptr || n_classes == 0 ||
+        keep_indices == nullptr || keep_capacity == 0) {
+        return 0;
+    }
+
+    std::vector<std::vector<uint32_t>> pools(n_classes);
+    std::vector<std::vector<uint32_t>> kept(n_classes);
+    size_t populated = 0;
+    for (size_t ix = 0; ix < n; ix++) {
+        if (scores[ix] < score_threshold || class_ids[ix] >= n_classes) {
+            continue;
+        }
+        if (pools[class_ids[ix]].empty()) {
+            populated++;
+        }
+        pools[class_ids[ix]].push_back((uint32_t)ix);
+    }
+
+    nms_class_shard shard;
+    shard.x0 = x0;
+    shard.y0 = y0;
+    shard.x1 = x1;
+    shard.y1 = y1;
+    shard.scores = scores;
+    shard.score_threshold = score_threshold;
+    shard.iou_threshold = iou_threshold;
+    shard.pools = &pools;
+    shard.kept = &kept;
+
+    // Below a handful of populated classes the fan-out costs more than
+    // the suppression; run the shards inline.
+    if (populated < 4 || ei_ffi_threadpool_handle() == nullptr) {
+        for (size_t class_ix = 0; class_ix < n_classes; class_ix++) {
+            nms_class_worker(&shard, class_ix);
+        }
+    }
+    else {
+        ei_ffi_parallel_for(nms_class_worker, &shard, n_classes);
+    }
+
+    // Merge: one descending-score list across classes, like the serial
+    // kernel emits.
+    std::vector<uint32_t> merged;
+    for (const std::vector<uint32_t>& class_kept : kept) {
+        merged.insert(merged.end(), class_kept.begin(), class_kept.end());
+    }
+    std::sort(merged.begin(), merged.end(),
+              [scores](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+    size_t out = merged.size() < keep_capacity ? merged.size() : keep_capacity;
+    for (size_t ix = 0; ix < out; ix++) {
+        keep_indices[ix] = merged[ix];
+    }
+    return out;
+}
+
+// Sparse FOMO centroid-grid decode. The score plane is laid out
+// [grid_h][grid_w][n_classes] with class 0 = background, and in a typical
+// deployment >99% of cells are background, so walking every (cell, class)
+// pair scalar-wise wastes the frame. The scan below tests blocks of four
+// cells at a time -- deinterleaved NEON loads or SSE shuffles pull the
+// foreground channels out, one compare + movemask rejects the whole block
+// -- and only hit cells fall through to the scalar emit. Outputs are
+// planar (cell coordinates, label id, score), one entry per (cell, class)
+// at or above the threshold; scale cell coords by image size / grid size
+// for pixel boxes. Returns the number of entries written.
+__attribute__((visibility("default"))) size_t ei_ffi_fomo_decode(const float* scores, uint32_t grid_h, uint32_t grid_w, uint32_t n_classes, float threshold, uint32_t* cell_x, uint32_t* cell_y, uint32_t* label_ids, float* out_scores, size_t capacity) {
+    if (scores == nullptr || cell_x == nullptr || cell_y == nullptr ||
+        label_ids == nullptr || out_scores == nullptr || n_classes < 2) {
+        return 0;
+    }
+
+    const size_t n_cells = (size_t)grid_h * grid_w;
+    size_t written = 0;
+
+    // Scalar emit for one cell, shared by every path below.
+    auto emit_cell = [&](size_t cell) {
+        const float* p = scores + cell * n_classes;
+        for (uint32_t cls = 1; cls < n_classes && written < capacity; cls++) {
+            if (p[cls] >= threshold) {
+                cell_x[written] = (uint32_t)(cell % grid_w);
+                cell_y[written] = (uint32_t)(cell / grid_w);
+                label_ids[written] = cls - 1;
+                out_scores[written] = p[cls];
+                written++;
+            }
+        }
+    };
+
+    size_t cell = 0;
+
+#if defined(EI_FFI_HAVE_NEON)
+    if (n_classes == 2) {
+        const float32x4_t thr = vdupq_n_f32(threshold);
+        for (; cell + 4 <= n_cells && written < capacity; cell += 4) {
+            float32x4x2_t v = vld2q_f32(scores + cell * 2);
+            if (vmaxvq_u32(vcgeq_f32(v.val[1], thr)) == 0) {
+                continue;
+            }
+            for (size_t k = 0; k < 4; k++) {
+                emit_cell(cell + k);
+            }
+        }
+    }
+    else if (n_classes == 3) {
+        const float32x4_t thr = vdupq_n_f32(threshold);
+        for (; cell + 4 <= n_cells && written < capacity; cell += 4) {
+            float32x4x3_t v = vld3q_f32(scores + cell * 3);
+            uint32x4_t hit = vorrq_u32(vcgeq_f32(v.val[1], thr), vcgeq_f32(v.val[2], thr));
+            if (vmaxvq_u32(hit) == 0) {
+                continue;
+            }
+            for (size_t k = 0; k < 4; k++) {
+                emit_cell(cell + k);
+            }
+        }
+    }
+    else if (n_classes == 4) {
+        const float32x4_t thr = vdupq_n_f32(threshold);
+        for (; cell + 4 <= n_cells && written < capacity; cell += 4) {
+            float32x4x4_t v = vld4q_f32(scores + cell * 4);
+            uint32x4_t hit = vorrq_u32(
+                vorrq_u32(vcgeq_f32(v.val[1], thr), vcgeq_f32(v.val[2], thr)),
+                vcgeq_f32(v.val[3], thr));
+            if (vmaxvq_u32(hit) == 0) {
+                continue;
+            }
+            for (size_t k = 0; k < 4; k++) {
+                emit_cell(cell + k);
+            }
+        }
+    }
+#elif defined(EI_FFI_HAVE_SSE2)
+    if (n_classes == 2) {
+        const __m128 thr = _mm_set1_ps(threshold);
+        for (; cell + 4 <= n_cells && written < capacity; cell += 4) {
+            // Cells are (bg, fg) pairs; pick lanes 1 and 3 of each load to
+            // gather the four foreground scores.
+            __m128 a = _mm_loadu_ps(scores + cell * 2);
+            __m128 b = _mm_loadu_ps(scores + cell * 2 + 4);
+            __m128 fg = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            int mask = _mm_movemask_ps(_mm_cmpge_ps(fg, thr));
+            if (mask == 0) {
+                continue;
+            }
+            for (size_t k = 0; k < 4; k++) {
+                if (mask & (1 << k)) {
+                    emit_cell(cell + k);
+                }
+            }
+        }
+    }
+#endif
+
+    for (; cell < n_cells && written < capacity; cell++) {
+        emit_cell(cell);
+    }
+
+    return written;
+}
+
+// Single-pass max / mean / count-above-threshold over a dense float plane
+// (the visual-anomaly grid being the motivating caller: 96x96 cells per
+// frame at camera rate). Four parallel accumulators each for max and sum
+// hide the FP add latency; the threshold count rides the same loads as a
+// compare whose all-ones mask lanes are subtracted from a u32 counter.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_f32_grid_stats(const float* values, size_t n, float threshold, float* max_out, float* mean_out, uint32_t* above_out) {
+    if (values == nullptr || n == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    float max_v = values[0];
+    float sum = 0.0f;
+    uint32_t above = 0;
+    size_t i = 0;
+
+#if defined(EI_FFI_HAVE_NEON)
+    if (n >= 16) {
+        float32x4_t vmax0 = vdupq_n_f32(values[0]);
+        float32x4_t vmax1 = vmax0;
+        float32x4_t vsum0 = vdupq_n_f32(0.0f);
+        float32x4_t vsum1 = vsum0;
+        uint32x4_t vcnt = vdupq_n_u32(0);
+        const float32x4_t thr = vdupq_n_f32(threshold);
+        for (; i + 8 <= n; i += 8) {
+            float32x4_t a = vld1q_f32(values + i);
+            float32x4_t b = vld1q_f32(values + i + 4);
+            vmax0 = vmaxq_f32(vmax0, a);
+            vmax1 = vmaxq_f32(vmax1, b);
+            vsum0 = vaddq_f32(vsum0, a);
+            vsum1 = vaddq_f32(vsum1, b);
+            // cmpge lanes are 0xffffffff (= -1 as u32) on hit.
+            vcnt = vsubq_u32(vcnt, vcgeq_f32(a, thr));
+            vcnt = vsubq_u32(vcnt, vcgeq_f32(b, thr));
+        }
+        vmax0 = vmaxq_f32(vmax0, vmax1);
+        vsum0 = vaddq_f32(vsum0, vsum1);
+#if defined(__aarch64__)
+        max_v = vmaxvq_f32(vmax0);
+        sum = vaddvq_f32(vsum0);
+        above = vaddvq_u32(vcnt);
+#else
+        float32x2_t m2 = vpmax_f32(vget_low_f32(vmax0), vget_high_f32(vmax0));
+        max_v = vget_lane_f32(vpmax_f32(m2, m2), 0);
+        float32x2_t s2 = vadd_f32(vget_low_f32(vsum0), vget_high_f32(vsum0));
+        sum = vget_lane_f32(vpadd_f32(s2, s2), 0);
+        uint32x2_t c2 = vadd_u32(vget_low_u32(vcnt), vget_high_u32(vcnt));
+        above = vget_lane_u32(vpadd_u32(c2, c2), 0);
+#endif
+    }
+#elif defined(EI_FFI_HAVE_SSE2)
+    if (n >= 16) {
+        __m128 vmax0 = _mm_set1_ps(values[0]);
+        __m128 vmax1 = vmax0;
+        __m128 vsum0 = _mm_setzero_ps();
+        __m128 vsum1 = vsum0;
+        __m128i vcnt = _mm_setzero_si128();
+        const __m128 thr = _mm_set1_ps(threshold);
+        for (; i + 8 <= n; i += 8) {
+            __m128 a = _mm_loadu_ps(values + i);
+            __m128 b = _mm_loadu_ps(values + i + 4);
+            vmax0 = _mm_max_ps(vmax0, a);
+            vmax1 = _mm_max_ps(vmax1, b);
+            vsum0 = _mm_add_ps(vsum0, a);
+            vsum1 = _mm_add_ps(vsum1, b);
+            vcnt = _mm_sub_epi32(vcnt, _mm_castps_si128(_mm_cmpge_ps(a, thr)));
+            vcnt = _mm_sub_epi32(vcnt, _mm_castps_si128(_mm_cmpge_ps(b, thr)));
+        }
+        vmax0 = _mm_max_ps(vmax0, vmax1);
+        vsum0 = _mm_add_ps(vsum0, vsum1);
+        float lanes[4];
+        _mm_storeu_ps(lanes, vmax0);
+        max_v = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+        _mm_storeu_ps(lanes, vsum0);
+        sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        uint32_t counts[4];
+        _mm_storeu_si128((__m128i*)counts, vcnt);
+        above = counts[0] + counts[1] + counts[2] + counts[3];
+    }
+#endif
+
+    for (; i < n; i++) {
+        float v = values[i];
+        if (v > max_v) {
+            max_v = v;
+        }
+        sum += v;
+        if (v >= threshold) {
+            above++;
+        }
+    }
+
+    if (max_out != nullptr) {
+        *max_out = max_v;
+    }
+    if (mean_out != nullptr) {
+        *mean_out = sum / (float)n;
+    }
+    if (above_out != nullptr) {
+        *above_out = above;
+    }
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
+
+// ---------------------------------------------------------------------------
+// Cache-blocked sequence LSTM
+//
+// The stock LSTM kernel walks all four gate weight matrices once per
+// timestep; at long windows the working set falls out of L2 between
+// steps and every step re-streams cold weights. This runner splits the
+// work: the input-to-gate contribution has no recurrence, so it is
+// computed weight-stationary -- each row block of the input weights is
+// loaded once and applied to every timestep while it is hot -- leaving
+// the sequential time loop with only the (much smaller) recurrent
+// matrix plus the elementwise gate math. Scratch is allocated once at
+// init and reused across steps and across calls.
+//
+// Gate order and layouts match TFLite's LSTM: input, forget, cell,
+// output; weights row-major [4][n_cell][n_input] / [4][n_cell][n_cell],
+// bias [4][n_cell]. Cell and hidden state persist across run calls for
+// streaming; reset clears them between windows.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Row block sized so one block of input weights stays resident while it
+// is swept across the whole sequence.
+constexpr size_t kLstmRowBlockBytes = 32 * 1024;
+
+struct lstm_context {
+    uint32_t n_input = 0;
+    uint32_t n_cell = 0;
+    uint32_t max_steps = 0;
+    std::vector<float> preact; // [max_steps][4][n_cell]
+    std::vector<float> cell_state;
+    std::vector<float> hidden_state;
+};
+
+static lstm_context s_lstm;
+
+inline float lstm_sigmoid(float x) {
+    return 1.0f / (1.0f + expf(-x));
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_lstm_sequence_init(uint32_t n_input, uint32_t n_cell, uint32_t max_steps) {
+    if (n_input == 0 || n_cell == 0 || max_steps == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_lstm.n_input = n_input;
+    s_lstm.n_cell = n_cell;
+    s_lstm.max_steps = max_steps;
+    s_lstm.preact.assign((size_t)max_steps * 4 * n_cell, 0.0f);
+    s_lstm.cell_state.assign(n_cell, 0.0f);
+    s_lstm.hidden_state.assign(n_cell, 0.0f);
+    return EI_IMPULSE_OK;
+}
+
+// Run `n_steps` timesteps. `input` is [n_steps][n_input]; `hidden_out`
+// (optional per-step trace, [n_steps][n_cell]) may be NULL when only the
+// persistent state matters; `final_hidden` (optional, [n_cell]) receives
+// the last hidden vector.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_lstm_sequence_run(const float* input_weights, const float* recurrent_weights, const float* bias, const float* input, uint32_t n_steps, float* hidden_out, float* final_hidden) {
+    if (input_weights == nullptr || recurrent_weights == nullptr || bias == nullptr ||
+        input == nullptr || n_steps == 0 || n_steps > s_lstm.max_steps ||
+        s_lstm.n_cell == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    const size_t n_input = s_lstm.n_input;
+    const size_t n_cell = s_lstm.n_cell;
+    const size_t n_rows = 4 * n_cell; // all four gates, stacked
+    float* preact = s_lstm.preact.data();
+    float* c = s_lstm.cell_state.data();
+    float* h = s_lstm.hidden_state.data();
+
+    // Phase 1: input contributions, weight-stationary. Each row block of
+    // the stacked gate matrix is loaded once and swept across the whole
+    // sequence while hot; preact[t][row] = bias[row] + dot(W_x[row], x_t).
+    size_t block_rows = kLstmRowBlockBytes / (n_input * sizeof(float));
+    if (block_rows == 0) {
+        block_rows = 1;
+    }
+    for (size_t row0 = 0; row0 < n_rows; row0 += block_rows) {
+        const size_t row1 = std::min(row0 + block_rows, n_rows);
+        for (size_t t = 0; t < n_steps; t++) {
+            const float* x = input + t * n_input;
+            float* out = preact + t * n_rows;
+            for (size_t row = row0; row < row1; row++) {
+                const float* w = input_weights + row * n_input;
+                float acc = bias[row];
+                for (size_t k = 0; k < n_input; k++) {
+                    acc += w[k] * x[k];
+                }
+                out[row] = acc;
+            }
+        }
+    }
+
+    // Phase 2: the sequential part. Only the recurrent matrix (a quarter
+    // of the weight bytes per gate row) and the gate math remain inside
+    // the time loop.
+    for (size_t t = 0; t < n_steps; t++) {
+        float* pre = preact + t * n_rows;
+        for (size_t ix = 0; ix < n_cell; ix++) {
+            float gates[4];
+            for (size_t g = 0; g < 4; g++) {
+                const size_t row = g * n_cell + ix;
+                const float* w = recurrent_weights + row * n_cell;
+                float acc = pre[row];
+                for (size_t k = 0; k < n_cell; k++) {
+                    acc += w[k] * h[k];
+                }
+                gates[g] = acc;
+            }
+            const float in_gate = lstm_sigmoid(gates[0]);
+            const float forget_gate = lstm_sigmoid(gates[1]);
+            const float cell_in = tanhf(gates[2]);
+            const float out_gate = lstm_sigmoid(gates[3]);
+            c[ix] = forget_gate * c[ix] + in_gate * cell_in;
+            // h is still read by the remaining cells' recurrent matvecs,
+            // so stage the new hidden value in the consumed gate-0 preact
+            // slot and commit after the step.
+            pre[ix] = out_gate * tanhf(c[ix]);
+        }
+        memcpy(h, pre, n_cell * sizeof(float));
+        if (hidden_out != nullptr) {
+            memcpy(hidden_out + t * n_cell, h, n_cell * sizeof(float));
+        }
+    }
+
+    if (final_hidden != nullptr) {
+        memcpy(final_hidden, h, n_cell * sizeof(float));
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Clear the persistent cell/hidden state between independent windows.
+__attribute__((visibility("default"))) void ei_ffi_lstm_sequence_reset(void) {
+    std::fill(s_lstm.cell_state.begin(), s_lstm.cell_state.end(), 0.0f);
+    std::fill(s_lstm.hidden_state.begin(), s_lstm.hidden_state.end(), 0.0f);
+}
+
+__attribute__((visibility("default"))) void ei_ffi_lstm_sequence_deinit(void) {
+    s_lstm = lstm_context();
+}
+
+} // extern "C"
+
+// ---------------------------------------------------------------------------
+// Indirect (im2col-free) convolution
+//
+// TFLite's reference conv materializes an im2col buffer of
+// [out_h*out_w][k_h*k_w*in_c] floats -- a ~70 MB transient at 640x640 --
+// and GEMMs against it. Graph convs dodge that through the XNNPACK
+// delegate, whose indirect-convolution path is selected internally; this
+// kernel gives callers doing conv work outside the graph (custom pre/post
+// stages) the same trick. An indirection table of input-pixel pointers
+// replaces the patch copies -- the only transient is k_h*k_w pointers per
+// output pixel of one tile, and padding resolves to a shared zero pixel --
+// and the implicit GEMM keeps a block of filter rows cache-resident while
+// it sweeps a tile of output pixels.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Output pixels per indirection tile; 64 keeps the pointer table and the
+// touched input rows inside L1 alongside the active weight block on a
+// middle-of-the-road core. Both knobs are runtime tunables because the
+// right values vary with the part's L1/L2 split (A55s want smaller
+// tiles than the default); ei_ffi_conv_autotune sweeps them against the
+// caller's actual layer shapes and a tuning file carries the result
+// across boots.
+constexpr uint32_t kConvTilePixelsDefault = 64;
+
+// Filter row block sized to stay resident while it is swept across a tile.
+constexpr uint32_t kConvBlockBytesDefault = 32 * 1024;
+
+std::atomic<uint32_t> s_conv_tile_pixels{kConvTilePixelsDefault};
+std::atomic<uint32_t> s_conv_block_bytes{kConvBlockBytesDefault};
+
+inline float conv_dot(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; ix + 4 <= n; ix += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(a + ix), vld1q_f32(b + ix));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; ix + 4 <= n; ix += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + ix), _mm_loadu_ps(b + ix)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; ix < n; ix++) {
+        sum += a[ix] * b[ix];
+    }
+    return sum;
+}
+
+} // namespace
+
+extern "C" {
+
+// NHWC float convolution without an im2col buffer. `input` is
+// [in_h][in_w][in_c], `weights` [out_c][k_h][k_w][in_c], `bias` (optional)
+// [out_c], `output` [out_h][out_w][out_c] with out_h/out_w derived from
+// stride and symmetric zero padding `pad`.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_conv2d_f32(const float* input, uint32_t in_h, uint32_t in_w, uint32_t in_c, const float* weights, uint32_t k_h, uint32_t k_w, uint32_t out_c, uint32_t stride, uint32_t pad, const float* bias, float* output) {
+    if (input == nullptr || weights == nullptr || output == nullptr ||
+        in_h == 0 || in_w == 0 || in_c == 0 || k_h == 0 || k_w == 0 ||
+        out_c == 0 || stride == 0 ||
+        in_h + 2 * pad < k_h || in_w + 2 * pad < k_w) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    size_t out_h = (in_h + 2 * pad - k_h) / stride + 1;
+    size_t out_w = (in_w + 2 * pad - k_w) / stride + 1;
+    size_t patch = (size_t)k_h * k_w; // pointers per output pixel
+    size_t filter_len = patch * in_c;
+
+    const size_t tile_pixels = s_conv_tile_pixels.load(std::memory_order_relaxed);
+    const size_t block_bytes = s_conv_block_bytes.load(std::memory_order_relaxed);
+
+    // Every out-of-bounds tap points here instead of at copied zeros.
+    std::vector<float> zero_pixel(in_c, 0.0f);
+
+    size_t block_filters = block_bytes / (filter_len * sizeof(float));
+    if (block_filters == 0) {
+        block_filters = 1;
+    }
+
+    std::vector<const float*> indirection(tile_pixels * patch);
+
+    for (size_t tile_start = 0; tile_start < out_h * out_w; tile_start += tile_pixels) {
+        size_t tile = out_h * out_w - tile_start < tile_pixels
+            ? out_h * out_w - tile_start
+            : tile_pixels;
+
+        // Build the pointer table for this tile once; every filter block
+        // below reuses it.
+        for (size_t p = 0; p < tile; p++) {
+            size_t oy = (tile_start + p) / out_w;
+            size_t ox = (tile_start + p) % out_w;
+            const float** ptrs = &indirection[p * patch];
+            for (uint32_t ky = 0; ky < k_h; ky++) {
+                int64_t iy = (int64_t)oy * stride + ky - pad;
+                for (uint32_t kx = 0; kx < k_w; kx++) {
+                    int64_t ix = (int64_t)ox * stride + kx - pad;
+                    ptrs[ky * k_w + kx] =
+                        (iy < 0 || iy >= (int64_t)in_h || ix < 0 || ix >= (int64_t)in_w)
+                        ? zero_pixel.data()
+                        : input + ((size_t)iy * in_w + (size_t)ix) * in_c;
+                }
+            }
+        }
+
+        for (uint32_t oc0 = 0; oc0 < out_c; oc0 += (uint32_t)block_filters) {
+            uint32_t oc1 = oc0 + (uint32_t)block_filters < out_c
+                ? oc0 + (uint32_t)block_filters
+                : out_c;
+            for (size_t p = 0; p < tile; p++) {
+                const float** ptrs = &indirection[p * patch];
+                float* out_pixel = output + (tile_start + p) * out_c;
+                for (uint32_t oc = oc0; oc < oc1; oc++) {
+                    const float* filter = weights + (size_t)oc * filter_len;
+                    float acc = bias != nullptr ? bias[oc] : 0.0f;
+                    for (size_t k = 0; k < patch; k++) {
+                        acc += conv_dot(ptrs[k], filter + k * in_c, in_c);
+                    }
+                    out_pixel[oc] = acc;
+                }
+            }
+        }
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Override the conv tiling (0 restores a knob's default). Takes effect on
+// the next ei_ffi_conv2d_f32 call; normally set by the autotuner or a
+// loaded tuning file rather than by hand.
+__attribute__((visibility("default"))) void ei_ffi_conv_set_tiling(uint32_t tile_pixels, uint32_t block_kbytes) {
+    s_conv_tile_pixels.store(tile_pixels > 0 ? tile_pixels : kConvTilePixelsDefault,
+                             std::memory_order_relaxed);
+    s_conv_block_bytes.store(block_kbytes > 0 ? block_kbytes * 1024 : kConvBlockBytesDefault,
+                             std::memory_order_relaxed);
+}
+
+// Sweep tile/block candidates against one layer shape on this device and
+// install the fastest pair. Heuristic tile sizes picked for a generic L1
+// routinely leave half the cache idle on small-L1 parts; measuring on the
+// target with the model's real shapes is the only selection that holds
+// up. Scratch tensors are allocated and filled here, each candidate gets
+// one warmup run plus `iterations` timed runs (best-of to shed scheduler
+// noise), and the winner is written to the live knobs -- call once per
+// dominant layer shape at provisioning, then ei_ffi_conv_tuning_save.
+// Output pointers (optional) receive the chosen pair.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_conv_autotune(uint32_t in_h, uint32_t in_w, uint32_t in_c, uint32_t k_h, uint32_t k_w, uint32_t out_c, uint32_t stride, uint32_t pad, uint32_t iterations, uint32_t* tile_pixels_out, uint32_t* block_kbytes_out) {
+    if (in_h == 0 || in_w == 0 || in_c == 0 || k_h == 0 || k_w == 0 ||
+        out_c == 0 || stride == 0 || iterations == 0 ||
+        in_h + 2 * pad < k_h || in_w + 2 * pad < k_w) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t out_h = (in_h + 2 * pad - k_h) / stride + 1;
+    size_t out_w = (in_w + 2 * pad - k_w) / stride + 1;
+    std::vector<float> input((size_t)in_h * in_w * in_c);
+    std::vector<float> weights((size_t)out_c * k_h * k_w * in_c);
+    std::vector<float> bias(out_c, 0.125f);
+    std::vector<float> output(out_h * out_w * out_c);
+    for (size_t ix = 0; ix < input.size(); ix++) {
+        input[ix] = (float)(ix & 0xff) * (1.0f / 255.0f);
+    }
+    for (size_t ix = 0; ix < weights.size(); ix++) {
+        weights[ix] = (float)((ix * 7) & 0xff) * (1.0f / 255.0f) - 0.5f;
+    }
+
+    constexpr uint32_t kTiles[] = { 16, 32, 64, 128, 256 };
+    constexpr uint32_t kBlocksKb[] = { 8, 16, 32, 64, 128 };
+
+    uint32_t best_tile = s_conv_tile_pixels.load(std::memory_order_relaxed);
+    uint32_t best_block_kb = s_conv_block_bytes.load(std::memory_order_relaxed) / 1024;
+    int64_t best_ns = INT64_MAX;
+
+    for (uint32_t tile : kTiles) {
+        for (uint32_t block_kb : kBlocksKb) {
+            s_conv_tile_pixels.store(tile, std::memory_order_relaxed);
+            s_conv_block_bytes.store(block_kb * 1024, std::memory_order_relaxed);
+            ei_ffi_conv2d_f32(input.data(), in_h, in_w, in_c, weights.data(),
+                              k_h, k_w, out_c, stride, pad, bias.data(), output.data());
+            int64_t candidate_ns = INT64_MAX;
+            for (uint32_t it = 0; it < iterations; it++) {
+                auto t0 = std::chrono::steady_clock::now();
+                ei_ffi_conv2d_f32(input.data(), in_h, in_w, in_c, weights.data(),
+                                  k_h, k_w, out_c, stride, pad, bias.data(), output.data());
+                auto t1 = std::chrono::steady_clock::now();
+                int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+                if (ns < candidate_ns) {
+                    candidate_ns = ns;
+                }
+            }
+            if (candidate_ns < best_ns) {
+                best_ns = candidate_ns;
+                best_tile = tile;
+                best_block_kb = block_kb;
+            }
+        }
+    }
+
+    s_conv_tile_pixels.store(best_tile, std::memory_order_relaxed);
+    s_conv_block_bytes.store(best_block_kb * 1024, std::memory_order_relaxed);
+    if (tile_pixels_out != nullptr) {
+        *tile_pixels_out = best_tile;
+    }
+    if (block_kbytes_out != nullptr) {
+        *block_kbytes_out = best_block_kb;
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Persist / restore the tuned pair. One text line ("EICT1 <tile_pixels>
+// <block_kbytes>") so provisioning scripts can read and diff it; load at
+// init, before the first conv call.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_conv_tuning_save(const char* path) {
+    if (path == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    FILE* f = fopen(path, "w");
+    if (f == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    int res = fprintf(f, "EICT1 %u %u\n",
+                      s_conv_tile_pixels.load(std::memory_order_relaxed),
+                      s_conv_block_bytes.load(std::memory_order_relaxed) / 1024);
+    fclose(f);
+    return res > 0 ? EI_IMPULSE_OK : EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_conv_tuning_load(const char* path) {
+    if (path == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    char magic[8] = { 0 };
+    unsigned int tile = 0;
+    unsigned int block_kb = 0;
+    int fields = fscanf(f, "%7s %u %u", magic, &tile, &block_kb);
+    fclose(f);
+    if (fields != 3 || strcmp(magic, "EICT1") != 0 || tile == 0 || block_kb == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    ei_ffi_conv_set_tiling(tile, block_kb);
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
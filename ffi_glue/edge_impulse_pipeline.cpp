@@ -0,0 +1,270 @@
+// Double-buffered DSP / inference pipeline.
+//
+// run_classifier() runs feature extraction and the interpreter invoke
+// back to back on one thread, but the two stages use disjoint resources:
+// DSP is memory-bound, the conv stage is compute-bound. This pipeline
+// overlaps frame N's invoke with frame N+1's feature extraction on a
+// second thread, double-buffering the ei_feature_t matrices so neither
+// stage waits on the other's storage.
+//
+// Usage: ei_ffi_pipeline_init() once, then alternate submit/collect.
+// Submit copies the raw signal frame and returns as soon as a slot is
+// free (it blocks when both slots are in flight); collect blocks until
+// the oldest submitted frame has a result and returns frames strictly
+// in submission order.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/dsp/numpy.hpp"
+
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Forward declaration of the default impulse (C++ linkage)
+extern ei_impulse_handle_t& ei_default_impulse;
+
+// Defined in dsp_parallel_support.cpp: run one DSP block's extractor,
+// fanning a multi-axis spectral-analysis block out per axis across the
+// shared pthreadpool when one is live; serial otherwise.
+extern "C" int ei_ffi_internal_extract_block(const ei_model_dsp_t* block, signal_t* signal, ei::matrix_t* output, float frequency);
+
+namespace {
+
+enum class slot_state {
+    EMPTY,
+    RAW_READY,
+    IN_DSP,
+    FEATURES_READY,
+    IN_INFERENCE,
+    RESULT_READY,
+};
+
+struct pipeline_slot {
+    slot_state state = slot_state::EMPTY;
+    uint64_t sequence = 0;
+    std::vector<float> raw;
+    std::vector<std::unique_ptr<ei::matrix_t>> matrices;
+    std::vector<ei_feature_t> features;
+    ei_impulse_result_t result = {};
+    EI_IMPULSE_ERROR status = EI_IMPULSE_OK;
+};
+
+// Two slots: one in the DSP stage, one in the interpreter. Deeper queues
+// only add latency here since each stage is a single thread.
+constexpr size_t kPipelineDepth = 2;
+
+struct pipeline {
+    std::mutex mutex;
+    std::condition_variable cv;
+    pipeline_slot slots[kPipelineDepth];
+    std::thread dsp_thread;
+    std::thread inference_thread;
+    bool running = false;
+    bool debug = false;
+    uint64_t next_submit_seq = 0;
+    uint64_t next_collect_seq = 0;
+};
+
+static pipeline s_pipeline;
+
+// Find the slot in `from` state with the lowest sequence number, so frames
+// move through the stages in submission order. Caller holds the mutex.
+pipeline_slot* oldest_slot_in(slot_state from) {
+    pipeline_slot* found = nullptr;
+    for (size_t ix = 0; ix < kPipelineDepth; ix++) {
+        pipeline_slot& slot = s_pipeline.slots[ix];
+        if (slot.state == from && (found == nullptr || slot.sequence < found->sequence)) {
+            found = &slot;
+        }
+    }
+    return found;
+}
+
+// Stage 1: raw signal frame -> feature matrices, one per DSP block.
+void run_dsp_stage(pipeline_slot* slot) {
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+
+    ei::signal_t signal;
+    ei::numpy::signal_from_buffer(slot->raw.data(), slot->raw.size(), &signal);
+
+    slot->status = EI_IMPULSE_OK;
+    // One window's worth of DSP temporaries per scope (no-op unless an
+    // arena size has been configured via ei_ffi_set_dsp_arena).
+    ei_ffi_dsp_arena_begin();
+    for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
+        ei_model_dsp_t block = impulse->dsp_blocks[ix];
+        int ret = ei_ffi_internal_extract_block(&block, &signal, slot->matrices[ix].get(), impulse->frequency);
+        if (ret != EIDSP_OK) {
+            ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+            slot->status = EI_IMPULSE_DSP_ERROR;
+            break;
+        }
+        slot->features[ix].matrix = slot->matrices[ix].get();
+        slot->features[ix].blocks_processed = true;
+    }
+    ei_ffi_dsp_arena_end();
+}
+
+void dsp_worker() {
+    std::unique_lock<std::mutex> lock(s_pipeline.mutex);
+    while (s_pipeline.running) {
+        pipeline_slot* slot = oldest_slot_in(slot_state::RAW_READY);
+        if (slot == nullptr) {
+            s_pipeline.cv.wait(lock);
+            continue;
+        }
+        slot->state = slot_state::IN_DSP;
+        lock.unlock();
+
+        run_dsp_stage(slot);
+
+        lock.lock();
+        // A failed DSP stage skips inference and surfaces at collect.
+        slot->state = slot->status == EI_IMPULSE_OK ? slot_state::FEATURES_READY
+                                                    : slot_state::RESULT_READY;
+        s_pipeline.cv.notify_all();
+    }
+}
+
+void inference_worker() {
+    std::unique_lock<std::mutex> lock(s_pipeline.mutex);
+    while (s_pipeline.running) {
+        pipeline_slot* slot = oldest_slot_in(slot_state::FEATURES_READY);
+        if (slot == nullptr) {
+            s_pipeline.cv.wait(lock);
+            continue;
+        }
+        slot->state = slot_state::IN_INFERENCE;
+        bool debug = s_pipeline.debug;
+        lock.unlock();
+
+        slot->result = {};
+        slot->status = ::run_inference(&ei_default_impulse, slot->features.data(), &slot->result, debug);
+
+        lock.lock();
+        slot->state = slot_state::RESULT_READY;
+        s_pipeline.cv.notify_all();
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pipeline_init(int debug) {
+    std::lock_guard<std::mutex> lock(s_pipeline.mutex);
+    if (s_pipeline.running) {
+        return EI_IMPULSE_OK;
+    }
+
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+    for (size_t ix = 0; ix < kPipelineDepth; ix++) {
+        pipeline_slot& slot = s_pipeline.slots[ix];
+        slot.state = slot_state::EMPTY;
+        slot.raw.assign(EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE, 0.0f);
+        slot.matrices.clear();
+        slot.features.assign(impulse->dsp_blocks_size, ei_feature_t());
+        for (size_t block_ix = 0; block_ix < impulse->dsp_blocks_size; block_ix++) {
+            slot.matrices.emplace_back(
+                new ei::matrix_t(1, impulse->dsp_blocks[block_ix].n_output_features));
+        }
+    }
+    s_pipeline.next_submit_seq = 0;
+    s_pipeline.next_collect_seq = 0;
+    s_pipeline.debug = debug != 0;
+    s_pipeline.running = true;
+    s_pipeline.dsp_thread = std::thread(dsp_worker);
+    s_pipeline.inference_thread = std::thread(inference_worker);
+    return EI_IMPULSE_OK;
+}
+
+// Copy one raw signal frame (EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE floats)
+// into the pipeline. Blocks while both slots are in flight, i.e. at most
+// one frame ahead of collect.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pipeline_submit(const float* data, size_t data_size) {
+    if (data == nullptr || data_size != (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    std::unique_lock<std::mutex> lock(s_pipeline.mutex);
+    if (!s_pipeline.running) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    pipeline_slot* slot = nullptr;
+    s_pipeline.cv.wait(lock, [&] {
+        if (!s_pipeline.running) {
+            return true;
+        }
+        slot = oldest_slot_in(slot_state::EMPTY);
+        return slot != nullptr;
+    });
+    if (!s_pipeline.running || slot == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    memcpy(slot->raw.data(), data, data_size * sizeof(float));
+    slot->sequence = s_pipeline.next_submit_seq++;
+    slot->state = slot_state::RAW_READY;
+    s_pipeline.cv.notify_all();
+    return EI_IMPULSE_OK;
+}
+
+// Block until the oldest submitted frame has finished both stages and copy
+// its result out. Results come back strictly in submission order.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pipeline_collect(ei_impulse_result_t* result) {
+    if (result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    std::unique_lock<std::mutex> lock(s_pipeline.mutex);
+    if (!s_pipeline.running || s_pipeline.next_collect_seq >= s_pipeline.next_submit_seq) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    uint64_t want = s_pipeline.next_collect_seq;
+    pipeline_slot* slot = nullptr;
+    s_pipeline.cv.wait(lock, [&] {
+        if (!s_pipeline.running) {
+            return true;
+        }
+        slot = oldest_slot_in(slot_state::RESULT_READY);
+        return slot != nullptr && slot->sequence == want;
+    });
+    if (!s_pipeline.running || slot == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    EI_IMPULSE_ERROR status = slot->status;
+    *result = slot->result;
+    slot->state = slot_state::EMPTY;
+    s_pipeline.next_collect_seq++;
+    s_pipeline.cv.notify_all();
+    return status;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_pipeline_deinit(void) {
+    {
+        std::lock_guard<std::mutex> lock(s_pipeline.mutex);
+        if (!s_pipeline.running) {
+            return;
+        }
+        s_pipeline.running = false;
+    }
+    s_pipeline.cv.notify_all();
+    if (s_pipeline.dsp_thread.joinable()) {
+        s_pipeline.dsp_thread.join();
+    }
+    if (s_pipeline.inference_thread.joinable()) {
+        s_pipeline.inference_thread.join();
+    }
+    for (size_t ix = 0; ix < kPipelineDepth; ix++) {
+        s_pipeline.slots[ix].matrices.clear();
+        s_pipeline.slots[ix].features.clear();
+        s_pipeline.slots[ix].raw.clear();
+        s_pipeline.slots[ix].state = slot_state::EMPTY;
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,216 @@
+// Two-lane priority scheduler for mixed-criticality deployments.
+//
+// When a safety-critical impulse and a best-effort one share a process,
+// FIFO submission lets a best-effort invoke delay the critical one by a
+// full invoke. The scheduler runs all frames on one worker thread with two
+// lanes: the high lane is always drained first, and on full-TFLite builds
+// a high submission cancels a running low-lane invoke via the interpreter's
+// cancellation hook -- TFLite checks it between subgraph nodes, so the
+// critical frame waits at most one node, not one invoke. The cancelled
+// low frame is requeued and re-run from the start once the high lane is
+// empty. On micro builds (no cancellation support) the high lane still
+// jumps the queue, bounding its delay to one full low invoke.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/dsp/numpy.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Defined in tflite_profiler_support.cpp; no-op on micro builds.
+extern "C" void ei_ffi_internal_set_cancellation(bool (*check)(void*), void* data);
+
+// Defined in power_hint_support.cpp: lets ei_ffi_power_hint clamp the
+// worker's frequency during bursts.
+extern "C" void ei_ffi_internal_power_register_thread(void);
+
+namespace {
+
+struct sched_job {
+    uint64_t id = 0;
+    int lane = EI_FFI_LANE_LOW;
+    std::vector<float> raw;
+    ei_impulse_result_t result = {};
+    EI_IMPULSE_ERROR status = EI_IMPULSE_OK;
+    bool done = false;
+};
+
+struct scheduler {
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Jobs are shared between the queue, the worker and a possible waiter,
+    // any of which can be the last one standing when the scheduler stops.
+    std::deque<std::shared_ptr<sched_job>> lanes[2];
+    std::map<uint64_t, std::shared_ptr<sched_job>> jobs;
+    std::thread worker;
+    bool running = false;
+    bool debug = false;
+    uint64_t next_id = 1;
+};
+
+static scheduler s_sched;
+
+// Read by the cancellation predicate from the invoke thread with no lock
+// held, hence atomics rather than the scheduler mutex.
+static std::atomic<int> s_high_pending{0};
+static std::atomic<bool> s_low_running{false};
+
+// TFLite polls this between subgraph nodes: abort the in-flight invoke iff
+// it is a low-lane frame and a high-lane frame is waiting.
+bool preempt_check(void*) {
+    return s_low_running.load(std::memory_order_relaxed) &&
+           s_high_pending.load(std::memory_order_relaxed) > 0;
+}
+
+void run_job(sched_job* job) {
+    ei::signal_t signal;
+    ei::numpy::signal_from_buffer(job->raw.data(), job->raw.size(), &signal);
+    job->result = {};
+    job->status = ::run_classifier(&signal, &job->result, s_sched.debug);
+}
+
+void scheduler_worker() {
+    ei_ffi_internal_power_register_thread();
+    std::unique_lock<std::mutex> lock(s_sched.mutex);
+    while (s_sched.running) {
+        std::shared_ptr<sched_job> job;
+        if (!s_sched.lanes[EI_FFI_LANE_HIGH].empty()) {
+            job = s_sched.lanes[EI_FFI_LANE_HIGH].front();
+            s_sched.lanes[EI_FFI_LANE_HIGH].pop_front();
+        }
+        else if (!s_sched.lanes[EI_FFI_LANE_LOW].empty()) {
+            job = s_sched.lanes[EI_FFI_LANE_LOW].front();
+            s_sched.lanes[EI_FFI_LANE_LOW].pop_front();
+        }
+        if (job == nullptr) {
+            s_sched.cv.wait(lock);
+            continue;
+        }
+        lock.unlock();
+
+        if (job->lane == EI_FFI_LANE_LOW) {
+            s_low_running.store(true, std::memory_order_relaxed);
+        }
+        run_job(job.get());
+        if (job->lane == EI_FFI_LANE_LOW) {
+            s_low_running.store(false, std::memory_order_relaxed);
+        }
+
+        lock.lock();
+        if (job->lane == EI_FFI_LANE_HIGH) {
+            s_high_pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (job->lane == EI_FFI_LANE_LOW && job->status != EI_IMPULSE_OK &&
+            s_high_pending.load(std::memory_order_relaxed) > 0) {
+            // The invoke was (or may have been) cancelled by a high-lane
+            // arrival; re-run it from scratch after the high lane drains. A
+            // genuine failure retries once here and surfaces on the retry.
+            s_sched.lanes[EI_FFI_LANE_LOW].push_front(job);
+            continue;
+        }
+        job->done = true;
+        s_sched.cv.notify_all();
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_scheduler_start(int debug) {
+    std::lock_guard<std::mutex> lock(s_sched.mutex);
+    if (s_sched.running) {
+        return EI_IMPULSE_OK;
+    }
+    s_sched.debug = debug != 0;
+    s_sched.running = true;
+    s_high_pending.store(0);
+    s_low_running.store(false);
+    ei_ffi_internal_set_cancellation(preempt_check, nullptr);
+    s_sched.worker = std::thread(scheduler_worker);
+    return EI_IMPULSE_OK;
+}
+
+// Queue one raw signal frame (EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE floats) on
+// a lane. Returns a job id to pass to ei_ffi_scheduler_wait, or -1 on
+// invalid arguments / stopped scheduler. Never blocks.
+__attribute__((visibility("default"))) int64_t ei_ffi_scheduler_submit(int lane, const float* data, size_t data_size) {
+    if (data == nullptr || data_size != (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+        return -1;
+    }
+    if (lane != EI_FFI_LANE_HIGH && lane != EI_FFI_LANE_LOW) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(s_sched.mutex);
+    if (!s_sched.running) {
+        return -1;
+    }
+    std::shared_ptr<sched_job> job(new sched_job());
+    job->id = s_sched.next_id++;
+    job->lane = lane;
+    job->raw.assign(data, data + data_size);
+    s_sched.jobs[job->id] = job;
+    s_sched.lanes[lane].push_back(job);
+    if (lane == EI_FFI_LANE_HIGH) {
+        s_high_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_sched.cv.notify_all();
+    return (int64_t)job->id;
+}
+
+// Block until the job finishes and copy its result out. Each id may be
+// waited on exactly once; the job's storage is released here.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_scheduler_wait(int64_t job_id, ei_impulse_result_t* result) {
+    if (result == nullptr || job_id < 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    std::unique_lock<std::mutex> lock(s_sched.mutex);
+    auto it = s_sched.jobs.find((uint64_t)job_id);
+    if (it == s_sched.jobs.end()) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::shared_ptr<sched_job> job = it->second;
+    s_sched.cv.wait(lock, [&] { return job->done || !s_sched.running; });
+    s_sched.jobs.erase((uint64_t)job_id);
+    if (!job->done) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    EI_IMPULSE_ERROR status = job->status;
+    *result = job->result;
+    return status;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_scheduler_stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(s_sched.mutex);
+        if (!s_sched.running) {
+            return;
+        }
+        s_sched.running = false;
+    }
+    s_sched.cv.notify_all();
+    if (s_sched.worker.joinable()) {
+        s_sched.worker.join();
+    }
+    ei_ffi_internal_set_cancellation(nullptr, nullptr);
+    std::lock_guard<std::mutex> lock(s_sched.mutex);
+    // Waiters still blocked in wait() were released by the running flag;
+    // anything never waited on is dropped with its queue entry.
+    s_sched.lanes[EI_FFI_LANE_HIGH].clear();
+    s_sched.lanes[EI_FFI_LANE_LOW].clear();
+    s_sched.jobs.clear();
+    s_high_pending.store(0);
+    s_low_running.store(false);
+}
+
+} // extern "C"
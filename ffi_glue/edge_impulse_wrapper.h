@@ -18,21 +18,1367 @@
 extern "C" {
 #endif
 
+// ============================================================================
+// Thread-safety contract
+// ============================================================================
+// Every exported function falls into one of four classes. Unless a function's
+// own doc comment says otherwise, its class follows from its shape:
+//
+// 1. Lifecycle -- ei_ffi_run_classifier_init/_deinit, ei_ffi_create_instance /
+//    ei_ffi_destroy_instance (for a given handle), and the start/stop pairs of
+//    the streaming, async, scheduler and capture engines. Callers must
+//    externally serialize a lifecycle transition against every other call
+//    that touches the same state: invoking during deinit is undefined
+//    behavior (historically a use-after-free), not an error return. The
+//    stress harness (stress_test.cpp) exercises both the legal pattern and,
+//    under --torture, the illegal one.
+//
+// 2. Invokes -- ei_ffi_run_classifier, _batch, _continuous, _on variants,
+//    ei_ffi_run_multi, ei_ffi_serialize_result. The default-impulse invokes
+//    serialize against each other internally; per-handle invokes on distinct
+//    handles run fully concurrently. A result struct belongs to one call at
+//    a time.
+//
+// 3. Tuning setters -- threshold setters, ei_ffi_set_topk,
+//    ei_ffi_set_invoke_timeout, ei_ffi_set_cancellation, ei_ffi_power_hint.
+//    Stored with atomics (or mutex-protected where noted) on live configs;
+//    safe from any thread while invokes run. An in-flight invoke may observe
+//    either the old or the new value, never a torn one.
+//
+// 4. Counters and getters -- drop/overrun counters, memory and arena stats,
+//    norm stats, ei_ffi_get_topk. Safe from any thread; values are snapshots.
+//
+// Continuous (sliced) state, audio-ring producer calls and capture-note calls
+// are additionally single-thread-affine: one designated thread per stream, as
+// their own sections document.
+
+// Stable per-stage timing breakdown. This struct is part of the FFI contract
+// and is decoupled from ei_impulse_result_timing_t, whose layout follows the
+// SDK; fields may only ever be appended here.
+typedef struct {
+    uint64_t sampling_us;
+    uint64_t dsp_us;
+    uint64_t classification_us;
+    uint64_t anomaly_us;
+    uint64_t total_us;
+} ei_ffi_timing_t;
+
+// Multi-instance classifier handles. Each instance owns its own interpreter
+// state but shares the model weights with every other instance in the process.
+ei_impulse_handle_t* ei_ffi_create_instance(void);
+void ei_ffi_destroy_instance(ei_impulse_handle_t* handle);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_on(ei_impulse_handle_t* handle, signal_t* signal, ei_impulse_result_t* result, int debug);
+
+// Per-instance continuous (sliced) classification. Rolling MFE/MFCC slice
+// state and the moving-average filter live inside the handle, so independent
+// audio streams can be sliced concurrently. Slices are
+// EI_CLASSIFIER_SLICE_SIZE samples each.
+void ei_ffi_run_classifier_init_on(ei_impulse_handle_t* handle);
+void ei_ffi_run_classifier_deinit_on(ei_impulse_handle_t* handle);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous_on(ei_impulse_handle_t* handle, signal_t* signal, ei_impulse_result_t* result, int debug, int enable_maf);
+
 // Function declarations (no type redefinitions!)
 void ei_ffi_run_classifier_init(void);
 void ei_ffi_run_classifier_deinit(void);
+// Full teardown for hosts that dlclose the model library: deinit plus
+// release of every glue-owned allocation (threadpool, caches, capture
+// and aggregation buffers, profiler attachments, DSP arenas). Call on
+// the thread that ran this tenant's invokes; init re-arms afterwards.
+void ei_ffi_teardown(void);
 EI_IMPULSE_ERROR ei_ffi_init_impulse(ei_impulse_handle_t* handle);
 EI_IMPULSE_ERROR ei_ffi_run_classifier(signal_t* signal, ei_impulse_result_t* result, int debug);
+// Classify under a distributed-tracing id: the id is thread-local for the
+// duration of the call, rides into capture-log records, and is readable via
+// ei_ffi_trace_id() inside completion/telemetry callbacks (which fire on the
+// invoke thread). Async submissions carry the submitter's current id onto
+// the worker. 0 means untraced.
+EI_IMPULSE_ERROR ei_ffi_run_classifier_traced(signal_t* signal, ei_impulse_result_t* result, uint64_t trace_id, int debug);
+uint64_t ei_ffi_trace_id(void);
+// End-to-end latency budget: stamp the signal with its capture time
+// (CLOCK_MONOTONIC domain, nanoseconds) before classifying, then read
+// back one structure of absolute per-stage timestamps -- capture, submit,
+// processing start, delivery -- plus the SDK's stage durations, so a
+// capture-to-decision SLA can be argued per frame without external
+// correlation. The stamp is thread-local and consumed by the next
+// classify of that signal on the stamping thread; async submissions
+// carry it to the worker (read the budget inside the completion
+// callback, which fires there). Unstamped frames cost nothing.
+typedef struct {
+    uint64_t capture_ns;        // caller's stamp
+    uint64_t submit_ns;         // handed to the glue (async enqueue or classify entry)
+    uint64_t start_ns;          // processing started
+    uint64_t done_ns;           // result delivered
+    uint64_t queue_us;          // submit -> start
+    uint64_t dsp_us;            // stage durations from the result timing
+    uint64_t classification_us;
+    uint64_t anomaly_us;
+    uint64_t total_us;          // capture -> done
+} ei_ffi_latency_trace_t;
+EI_IMPULSE_ERROR ei_ffi_signal_set_capture_time(signal_t* signal, uint64_t t_ns);
+EI_IMPULSE_ERROR ei_ffi_get_latency_trace(ei_ffi_latency_trace_t* out);
+// Validate once, classify many: ei_ffi_signal_bind checks the handle/signal
+// pair (frame length, callbacks) a single time and stamps a token; the bound
+// classify path verifies nothing but the stamp before invoking, which matters
+// at sensor-rate call frequencies on small cores. NULL handle binds the
+// default impulse. The token is only as valid as what it points at -- rebind
+// after destroying the handle or retargeting the signal. Bound calls skip the
+// result cache (its per-call hash is steady-state work this path exists to
+// avoid); the other instrumentation hooks still run.
+typedef struct {
+    ei_impulse_handle_t* handle;
+    signal_t* signal;
+    uint32_t magic;
+} ei_ffi_bound_signal_t;
+EI_IMPULSE_ERROR ei_ffi_signal_bind(ei_impulse_handle_t* handle, signal_t* signal, ei_ffi_bound_signal_t* token);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_bound(ei_ffi_bound_signal_t* token, ei_impulse_result_t* result, int debug);
+// Classify n signals in a single FFI crossing, keeping the interpreter hot
+// across the batch. results must point at n result structs.
+EI_IMPULSE_ERROR ei_ffi_run_classifier_batch(signal_t* signals, size_t n, ei_impulse_result_t* results, int debug);
+// Classify n independent handle/signal pairs concurrently (one impulse per
+// sensor channel); returns when all are done, with the first failure. Wall
+// time is roughly the slowest single inference.
+EI_IMPULSE_ERROR ei_ffi_run_multi(ei_impulse_handle_t* const* handles, signal_t* const* signals, ei_impulse_result_t* const* results, size_t n, int debug);
+// Dispatch one signal to two handles (fast-but-warming engine vs. flat-latency
+// fallback) and return the first completed result; the loser is cancelled at
+// its next signal read. Returns after both runs have unwound.
+EI_IMPULSE_ERROR ei_ffi_run_racing(ei_impulse_handle_t* handle_a, ei_impulse_handle_t* handle_b, signal_t* signal, ei_impulse_result_t* result, int debug);
 EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous(signal_t* signal, ei_impulse_result_t* result, int debug, int enable_maf_unused);
+// Native score smoothing for the default-impulse continuous path (the
+// SDK ignores enable_maf upstream). Configure a window of slices --
+// uniform when `weights` is NULL, else `window` per-slice weights with
+// weights[0] on the newest slice, normalized internally -- and the
+// smoothed class scores come back inside the same ei_impulse_result_t,
+// maintained incrementally with zero extra FFI traffic. 0 or 1 disables.
+// During warm-up the average covers the slices seen so far.
+EI_IMPULSE_ERROR ei_ffi_smoothing_configure(uint32_t window, const float* weights);
+void ei_ffi_smoothing_reset(void);
+// Slice-level watchdog for the continuous path. Each
+// ei_ffi_run_classifier_continuous call is timed against the real-time
+// budget one slice represents (slice size over sample rate); a slice
+// that takes longer than its budget is an overrun -- the caller is now
+// behind the signal and audible glitches follow. load_hist buckets each
+// slice by processing time as a fraction of the budget (bucket 0 covers
+// [0, 12.5%), bucket 7 everything at or past 87.5%), so a fleet can
+// alert on the distribution drifting right long before overruns start.
+typedef struct {
+    uint64_t slices;        // continuous slices timed since reset
+    uint64_t overruns;      // slices that exceeded the budget
+    uint64_t overrun_streak; // consecutive overruns ending at the newest slice
+    uint32_t budget_us;     // per-slice real-time budget
+    uint32_t last_us;       // processing time of the newest slice
+    uint32_t worst_us;      // worst processing time since reset
+    uint64_t load_hist[8];  // slices bucketed by used fraction of budget
+} ei_stream_health_t;
+EI_IMPULSE_ERROR ei_ffi_get_stream_health(ei_stream_health_t* health);
+void ei_ffi_stream_health_reset(void);
+// Q15 fixed-point continuous classification for quantized audio models
+// (EI_INT16_DSP builds): int16 PCM in, MFE computed in integer math, floats
+// only at the final per-mel-energy dB step. One EI_CLASSIFIER_SLICE_SIZE
+// slice per call, single-MFE-block impulses, no moving-average filter.
+// Stub (always failing) when the build did not select the path.
+EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous_i16(const int16_t* samples, size_t n, ei_impulse_result_t* result, int debug);
+bool ei_ffi_int16_dsp_active(void);
 EI_IMPULSE_ERROR ei_ffi_run_inference(ei_impulse_handle_t* handle, ei_feature_t* fmatrix, ei_impulse_result_t* result, int debug);
-// Helper function to create signal from buffer (like EIM binary)
+// Wrap a flat buffer of precomputed features as an ei_feature_t for
+// ei_ffi_run_inference, skipping the signal_t get_data indirection. The
+// matrix borrows `data` (keep it alive until inference returns); release
+// the wrapper with ei_ffi_feature_matrix_free.
+EI_IMPULSE_ERROR ei_ffi_feature_matrix_from_buffer(const float* data, uint32_t rows, uint32_t cols, ei_feature_t* feature);
+void ei_ffi_feature_matrix_free(ei_feature_t* feature);
+// Split NN / postprocess stages: run_nn_only does DSP + inference and skips
+// the postprocessing blocks; postprocess runs exactly those blocks over a
+// result, so frame N's postprocessing can overlap frame N+1's invoke on
+// another thread. The blocks keep per-frame state (tracking), so call
+// postprocess from one thread, in frame order.
+EI_IMPULSE_ERROR ei_ffi_run_nn_only(signal_t* signal, ei_impulse_result_t* result, int debug);
+EI_IMPULSE_ERROR ei_ffi_postprocess(ei_impulse_result_t* result);
+// Helper function to create signal from buffer (like EIM binary).
+// The signal borrows `data` (no copy); the buffer must outlive the classifier
+// call that consumes the signal.
 EI_IMPULSE_ERROR ei_ffi_signal_from_buffer(const float* data, size_t data_size, signal_t* signal);
+// Quantized input signals: keep int8/uint8 sensor data as-is and dequantize
+// lazily per chunk as the DSP pulls samples (no caller-side float frame).
+EI_IMPULSE_ERROR ei_ffi_signal_from_buffer_i8(const int8_t* data, size_t data_size, float scale, int32_t zero_point, signal_t* signal);
+// Disk-backed signal with kernel read-ahead (Linux/macOS): maps raw
+// float32 samples at offset_bytes and advises the next chunks in on every
+// get_data call, overlapping I/O with DSP compute. The fd may be closed
+// after this returns; the mapping is released with the signal's get_data.
+EI_IMPULSE_ERROR ei_ffi_signal_from_file(int fd, uint64_t offset_bytes, size_t sample_count, signal_t* signal);
+EI_IMPULSE_ERROR ei_ffi_signal_from_buffer_u8(const uint8_t* data, size_t data_size, float scale, int32_t zero_point, signal_t* signal);
+// Scatter-gather signal over N discontiguous float32 chunks (sensor-DMA
+// descriptors) -- get_data spans chunk boundaries through a precomputed
+// offset index, so the chunks are never compacted into one buffer. Layout
+// matches POSIX struct iovec, so a driver's descriptor list casts
+// directly. Chunk byte lengths must be multiples of sizeof(float); the
+// signal borrows every chunk until the classifier call returns.
+typedef struct {
+    const void* iov_base;
+    size_t iov_len; // bytes
+} ei_ffi_iovec_t;
+EI_IMPULSE_ERROR ei_ffi_signal_from_iovec(const ei_ffi_iovec_t* iov, size_t n_iov, signal_t* signal);
+// Zero-copy camera ingestion (Linux): map a V4L2 DMA-buf plane and convert
+// it to packed image features in one fused SIMD pass (YUYV via BT.601,
+// RGB3/GREY via the packing kernels). The signal borrows an internal frame
+// buffer valid until the next call; the fourcc is the V4L2 pixel format
+// code (e.g. V4L2_PIX_FMT_YUYV).
+EI_IMPULSE_ERROR ei_ffi_signal_from_dmabuf(int fd, size_t offset, size_t len, uint32_t fourcc_code, signal_t* signal);
+// Zero-copy inference for models whose features are the raw input: lends the
+// caller's buffer directly to the feature matrix, no intermediate memcpy.
+// `data_size` must equal the model's nn input frame size.
+EI_IMPULSE_ERROR ei_ffi_run_classifier_zero_copy(const float* data, size_t data_size, ei_impulse_result_t* result, int debug);
+
+// Sliding-window inference over a long recording. The callback fires once
+// per window with the window's start offset (in samples); the result is
+// valid only inside the callback. A stride equal to EI_CLASSIFIER_SLICE_SIZE
+// reuses rolling DSP features through the continuous pipeline.
+typedef void (*ei_ffi_window_result_cb)(size_t window_offset, EI_IMPULSE_ERROR status, ei_impulse_result_t* result, void* user_data);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_sliding(const float* samples, size_t sample_count, size_t stride, ei_ffi_window_result_cb callback, void* user_data, int debug);
+
+// Warm-up: run a few zero-input inferences so arena allocation, delegate
+// weight packing and arena page faults are paid before the first real frame.
+EI_IMPULSE_ERROR ei_ffi_warmup(int iterations);
+EI_IMPULSE_ERROR ei_ffi_warmup_on(ei_impulse_handle_t* handle, int iterations);
+
+// Background warm-up for startup paths: kick off interpreter
+// construction, flatbuffer verification, delegate planning and weight
+// packing on a worker thread right after process start, finish your own
+// init, then wait -- the first real inference pays only for whatever is
+// left. One warm-up in flight at a time; `elapsed_us_out` (optional)
+// reports how long preparation took.
+EI_IMPULSE_ERROR ei_ffi_warmup_async(int iterations);
+EI_IMPULSE_ERROR ei_ffi_warmup_wait(uint64_t* elapsed_us_out);
+
+// Asynchronous inference. Callbacks fire on a worker thread; the result
+// pointer is valid only for the duration of the callback (detach it to keep
+// it). The signal must stay valid until the callback has run.
+typedef void (*ei_ffi_completion_cb)(EI_IMPULSE_ERROR status, ei_impulse_result_t* result, void* user_data);
+EI_IMPULSE_ERROR ei_ffi_async_init(size_t num_workers);
+void ei_ffi_async_deinit(void);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_async(signal_t* signal, ei_ffi_completion_cb callback, void* user_data, int debug);
+
+// Shared pthreadpool (full TFLite builds link libpthreadpool for XNNPACK
+// anyway). ei_ffi_parallel_for fans out over it, or runs sequentially when
+// no pool exists; num_threads = 0 sizes the pool to the online CPU count.
+typedef void (*ei_ffi_parallel_fn)(void* ctx, size_t index);
+EI_IMPULSE_ERROR ei_ffi_threadpool_init(size_t num_threads);
+void ei_ffi_threadpool_deinit(void);
+void* ei_ffi_threadpool_handle(void);
+EI_IMPULSE_ERROR ei_ffi_parallel_for(ei_ffi_parallel_fn fn, void* ctx, size_t range);
+// big.LITTLE-aware pool placement. ei_ffi_big_cores classifies online
+// CPUs by cpufreq ceiling (sysfs) and writes the big-cluster cpu indices
+// into `cpus`, returning how many exist (0 on homogeneous parts, -1 when
+// the topology is unreadable; only `cap` entries are written).
+// ei_ffi_threadpool_init_pinned creates the shared pool with its workers
+// bound to a cpuset -- pass the big cluster so pool fan-out never lands
+// on a LITTLE core mid-slice. num_threads = 0 sizes the pool to the
+// cpuset. Linux only; elsewhere it degrades to ei_ffi_threadpool_init.
+int ei_ffi_big_cores(uint32_t* cpus, size_t cap);
+EI_IMPULSE_ERROR ei_ffi_threadpool_init_pinned(size_t num_threads, const uint32_t* cpus, size_t n_cpus);
+
+// Lock-free single-producer/single-consumer frame queue for handing capture
+// frames to an inference thread. push/pop are wait-free; push returns 0 when
+// full, pop returns 0 when empty.
+EI_IMPULSE_ERROR ei_ffi_frame_queue_init(size_t frame_size, size_t capacity);
+void ei_ffi_frame_queue_deinit(void);
+int ei_ffi_frame_queue_push(const float* frame);
+int ei_ffi_frame_queue_pop(float* frame_out);
+size_t ei_ffi_frame_queue_depth(void);
+
+// Latency-bounded frame-skip governor over the frame queue. With a nonzero
+// budget and an invoke-time estimate (feed results to note_result from the
+// consumer loop), pop_fresh discards the oldest frames until the backlog
+// fits in the budget, so result age stays bounded under overload. Budget 0
+// disables dropping; pop_fresh then behaves like ei_ffi_frame_queue_pop.
+EI_IMPULSE_ERROR ei_ffi_set_latency_budget(uint32_t budget_ms);
+void ei_ffi_governor_note_result(const ei_impulse_result_t* result);
+int ei_ffi_frame_queue_pop_fresh(float* frame_out);
+uint64_t ei_ffi_governor_dropped(void);
+
+// Audio ring with fused int16 -> float conversion: push converts, scales to
+// [-1, 1), removes DC offset (slow block-EWMA) and buffers in one SIMD
+// pass; the signal reads converted floats straight from the ring. Single
+// producer / single consumer; push writes what fits and returns the count
+// (drop-not-block). Build the signal over the next `window` samples, run,
+// then consume the slice.
+EI_IMPULSE_ERROR ei_ffi_audio_ring_create(size_t capacity);
+void ei_ffi_audio_ring_destroy(void);
+size_t ei_ffi_audio_push_i16(const int16_t* samples, size_t n);
+size_t ei_ffi_audio_ring_available(void);
+// Built-in sample-rate conversion: with an input rate set (e.g. 48000
+// against a 16 kHz model), pushes carry capture-rate samples and a
+// polyphase FIR decimator (Hamming-windowed sinc, fused with the int16
+// -> float pass) fills the ring at the model rate. Integer factors
+// only; 0 or the model rate disables the stage. Producer-owned state --
+// configure before pushing starts.
+EI_IMPULSE_ERROR ei_ffi_audio_ring_set_input_rate(uint32_t input_rate_hz);
+EI_IMPULSE_ERROR ei_ffi_audio_ring_signal(signal_t* signal, size_t window);
+void ei_ffi_audio_ring_consume(size_t n);
+
+// Incremental window normalization on the ring: the producer maintains
+// running sums over the most recent `window` pushed samples (add the new
+// slice, subtract the expired one -- O(slice) despite the overlap between
+// consecutive windows) and the normalized signal reads samples as
+// (x - mean) * inv_std with the published stats. Enable from the producer
+// thread (or before pushing); `window` must fit in the ring.
+EI_IMPULSE_ERROR ei_ffi_audio_ring_set_norm(size_t window);
+void ei_ffi_audio_ring_norm_stats(float* mean_out, float* std_out);
+EI_IMPULSE_ERROR ei_ffi_audio_ring_signal_normalized(signal_t* signal, size_t window);
+
+// Dedicated DSP/stream thread: owns the continuous-classification loop
+// over the audio ring (one `slice_length`-sample slice per iteration,
+// callback fires on the stream thread) so slice deadlines no longer
+// depend on application thread load. Pinning/priority are applied at
+// start and can be changed live; SCHED_FIFO/RR need CAP_SYS_NICE on
+// Linux, and calling set_sched while running surfaces that as an error.
+#define EI_FFI_SCHED_OTHER 0
+#define EI_FFI_SCHED_FIFO 1
+#define EI_FFI_SCHED_RR 2
+EI_IMPULSE_ERROR ei_ffi_stream_set_sched(int core, int policy, int prio);
+EI_IMPULSE_ERROR ei_ffi_stream_start(size_t slice_length, ei_ffi_completion_cb callback, void* user_data, int debug);
+void ei_ffi_stream_stop(void);
+
+// Capture mode for deterministic replay: every Nth classified signal is
+// appended to `path` together with its serialized result (the
+// ei_ffi_serialize_result flat layout), so a slow frame seen in the field
+// can be re-run offline under a profiler. Records are staged on the
+// classifier thread and written by a background thread with O_DIRECT;
+// when the writer falls behind, records are dropped (and counted), never
+// blocked on. File format: 16-byte file header ("EICP", version, frame
+// sample count), then per record a 16-byte header ("EIC1", signal bytes,
+// result bytes, sequence number) followed by both payloads.
+EI_IMPULSE_ERROR ei_ffi_enable_capture(const char* path, uint32_t sample_every_n);
+void ei_ffi_disable_capture(void);
+uint64_t ei_ffi_capture_dropped(void);
+
+// Result memoization keyed by input content hash, for deployments that
+// re-submit near-duplicate frames: with the cache enabled,
+// ei_ffi_run_classifier hashes the signal (XXH64) and an exact hash +
+// length hit returns a detached copy of the earlier result without
+// touching the DSP or interpreter. Default-impulse path only; an LRU of
+// `entries` results is kept. Timing fields on a hit are the original
+// invoke's. Clear after ei_ffi_hot_swap_model. Stats output pointers may
+// be NULL.
+EI_IMPULSE_ERROR ei_ffi_enable_result_cache(size_t entries);
+void ei_ffi_disable_result_cache(void);
+void ei_ffi_result_cache_clear(void);
+void ei_ffi_result_cache_stats(uint64_t* hits, uint64_t* misses, uint64_t* evictions);
+
+// Map a .tflite file read-only/MAP_SHARED and point the given learn block's
+// graph config at it, so multiple processes share one physical copy of the
+// weights. Non-EON (flatbuffer) models only; re-init the classifier (or your
+// handles) afterwards. Linux/macOS only.
+EI_IMPULSE_ERROR ei_ffi_map_model_weights(uint32_t learn_block_index, const char* path);
+// Fault the mapped weights in on a background thread (chunked
+// MADV_WILLNEED + per-page touch, front to back) so the first invoke's
+// page faults are paid before it runs. Non-blocking; started
+// automatically by ei_ffi_warmup_async. Fails with no mapping in place.
+EI_IMPULSE_ERROR ei_ffi_prefetch_weights(void);
+// Hot-swap retrained weights (same graph topology) and rebuild the default
+// impulse's interpreter state without a process restart. Quiesce in-flight
+// inference around the call. Linux/macOS only.
+EI_IMPULSE_ERROR ei_ffi_hot_swap_model(uint32_t learn_block_index, const char* path);
+// Differential model updates ("EID1" format): retrains change weight
+// bytes, not layout, so the delta between consecutive flatbuffers is a
+// run-length stream of skips and literals -- megabytes instead of the
+// whole file over the air. create diffs new against base (build.rs emits
+// the same format via EI_MODEL_DELTA_BASE); apply reconstructs the new
+// file, verifying the base hash before writing and the output hash
+// before renaming into place; update chains apply with a hot swap (same
+// quiesce contract), leaving the running model untouched on any failure.
+EI_IMPULSE_ERROR ei_ffi_model_delta_create(const char* base_path, const char* new_path, const char* delta_path);
+EI_IMPULSE_ERROR ei_ffi_model_delta_apply(const char* base_path, const char* delta_path, const char* out_path);
+EI_IMPULSE_ERROR ei_ffi_model_delta_update(uint32_t learn_block_index, const char* base_path, const char* delta_path, const char* out_path);
+
+// Degradation ladder: register one handle per impulse variant with its
+// expected invoke time (sorted cheapest-first internally; execution starts
+// on the costliest rung), then route invokes through ei_ffi_ladder_run. An
+// EWMA of the reported invoke time steps the ladder down when it crosses
+// target_ms and back up when the projected time on the costlier rung fits
+// under target_ms * up_margin, with a post-switch cooldown against
+// oscillation. Rungs may take differently-sized signals, so poll
+// ei_ffi_ladder_rung (0 = cheapest, -1 = empty) before preparing each
+// frame. Single invoke thread.
+EI_IMPULSE_ERROR ei_ffi_ladder_add(ei_impulse_handle_t* handle, float est_ms);
+EI_IMPULSE_ERROR ei_ffi_ladder_config(float target_ms, float up_margin, uint32_t cooldown_invokes);
+int ei_ffi_ladder_rung(void);
+EI_IMPULSE_ERROR ei_ffi_ladder_run(signal_t* signal, ei_impulse_result_t* result, int debug);
+void ei_ffi_ladder_reset(void);
+
+// Embedded asset catalogue: every auxiliary data file from the model folder
+// (anomaly cluster data, tracker configs, ...) linked into one page-aligned
+// read-only blob at build time, so init does zero file I/O. Names are paths
+// relative to the model folder with forward slashes; data pointers stay
+// valid for the process lifetime. Empty catalogue when build.rs found no
+// assets.
+EI_IMPULSE_ERROR ei_ffi_asset_lookup(const char* name, const uint8_t** data, size_t* size);
+size_t ei_ffi_asset_count(void);
+const char* ei_ffi_asset_name(size_t ix);
+
+// TensorRT plan cache directory (Jetson builds). Point this at persistent
+// storage before the first inference so the serialized engine survives
+// reboots; defaults to /tmp. The directory must already exist.
+EI_IMPULSE_ERROR ei_ffi_set_tensorrt_cache_path(const char* dir);
+const char* ei_ffi_tensorrt_cache_dir(void);
+
+// Pinned host staging for the TensorRT path (USE_CUDA_PINNED=1 Jetson
+// builds): cudaHostAlloc'd buffers make the engine's H2D copy a straight
+// DMA instead of a bounce-buffer copy plus sync. Point capture DMA at a
+// pinned buffer and wrap it zero-copy with ei_ffi_signal_from_pinned_buffer.
+// ei_ffi_cuda_stream is one process-wide non-blocking stream (cudaStream_t,
+// reused across invokes) for app-side async copies; sync it before handing
+// the buffer to the classifier. Without the flag, alloc degrades to
+// page-aligned heap memory and the stream entry points report unavailability.
+void* ei_ffi_alloc_pinned(size_t bytes);
+void ei_ffi_free_pinned(void* ptr);
+EI_IMPULSE_ERROR ei_ffi_signal_from_pinned_buffer(float* buffer, size_t length, signal_t* signal);
+void* ei_ffi_cuda_stream(void);
+EI_IMPULSE_ERROR ei_ffi_cuda_stream_sync(void);
+
+// Concurrent inference: a pool of N instances behind a free-list. Callers on
+// any thread use ei_ffi_run_classifier_pooled, which blocks while all
+// instances are busy. Weights stay shared; only interpreter state is
+// replicated per slot.
+EI_IMPULSE_ERROR ei_ffi_instance_pool_init(size_t num_instances);
+void ei_ffi_instance_pool_deinit(void);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_pooled(signal_t* signal, ei_impulse_result_t* result, int debug);
+// Pin a pool slot to a cpuset (Linux only). Pooled callers holding the
+// slot run pinned to it; configure before pool init to get first-touch
+// NUMA placement of the slot's instance state. n_cpus == 0 unpins.
+EI_IMPULSE_ERROR ei_ffi_pool_set_affinity(size_t slot, const uint32_t* cpus, size_t n_cpus);
+// Bandwidth governor: cap concurrent pooled invokes below the slot count
+// when memory bandwidth, not cores, is the bound (LPDDR boards often peak
+// at N-1 workers). Capped-out slots stay warm; 0 lifts the cap. The
+// autotune sweep times every cap level with real invokes of `signal`,
+// samples per-invoke LLC-miss bytes through the perf-counter surface,
+// and installs the fastest level (reported via the out parameters, which
+// may be NULL). The sweep occupies the pool; run it at startup.
+EI_IMPULSE_ERROR ei_ffi_pool_set_max_concurrency(size_t max_concurrent);
+EI_IMPULSE_ERROR ei_ffi_pool_autotune_concurrency(signal_t* signal, uint32_t iterations_per_level, size_t* best_out, uint64_t* bytes_per_invoke_out);
+// Elastic pool sizing: grow toward max_instances when the p95 acquire wait
+// exceeds target_wait_us, park idle slots back toward min_instances (parked
+// slots keep their arenas, so regrowing skips AllocateTensors), and free
+// parked arenas only after a long quiet period. Best with a fixed-size pool
+// left unpinned (slot cpusets are position-based).
+EI_IMPULSE_ERROR ei_ffi_pool_set_autoscale(size_t min_instances, size_t max_instances, uint64_t target_wait_us);
+
+// One-pass image input preparation specialized at compile time for this
+// model's input geometry (camera models only): resize if needed + feature
+// packing with fixed trip counts. Source is packed RGB888.
+EI_IMPULSE_ERROR ei_ffi_prepare_image_input(const uint8_t* rgb, int src_width, int src_height, float* out_features);
+// Quantized-input variant for direct NN-tensor preparation: resize plus
+// the fused normalize + quantize + pack kernel, one pass over the frame.
+// `out` holds input-width * input-height * 3 int8 values. Fails on models
+// whose NN input is not int8-quantized.
+EI_IMPULSE_ERROR ei_ffi_prepare_image_input_quantized(const uint8_t* rgb, int src_width, int src_height, int8_t* out);
+
+// Cross-frame temporal reuse for fixed cameras (camera models only).
+// ei_ffi_run_classifier_video resizes + packs + classifies a packed
+// RGB888 frame; once configured, frames are diffed tile-wise (16x16,
+// SIMD SAD) against the frame behind the last real invoke, and when the
+// dirty-tile fraction stays at or under `dirty_fraction` the invoke is
+// skipped and the prior result returned with `stale_out` counting the
+// consecutive reuses (0 = fresh). `tile_threshold` is the mean absolute
+// pixel difference (0..255) that makes a tile dirty; `max_stale` forces
+// a real invoke after that many skips, bounding staleness in frames.
+// Diffing against the last invoked frame (not the last seen one) makes
+// slow drift accumulate until it trips the threshold.
+EI_IMPULSE_ERROR ei_ffi_frame_delta_configure(float tile_threshold, float dirty_fraction, uint32_t max_stale);
+void ei_ffi_frame_delta_disable(void);
+void ei_ffi_frame_delta_stats(uint64_t* invokes, uint64_t* skips);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_video(const uint8_t* rgb, int src_width, int src_height, ei_impulse_result_t* result, int* stale_out, int debug);
+
+// Classify a region of interest of a packed RGB888 frame: crop + resize +
+// feature packing fused into one sampling pass (only ROI pixels are
+// touched), then box coordinates in the result are mapped back to
+// full-frame space. Camera models only.
+EI_IMPULSE_ERROR ei_ffi_run_classifier_roi(const uint8_t* rgb, int src_width, int src_height, int x, int y, int w, int h, ei_impulse_result_t* result, int debug);
+
+// Strip-based streaming preprocessing: the callback supplies decoded
+// RGB888 rows on demand (`rgb_out` holds n_rows * src_width * 3 bytes,
+// return 0 on success), and rows are requested in strictly increasing
+// order so progressive decoders can stream the file and discard rows
+// behind the cursor. Working set is one source row plus the fixed
+// feature buffer -- peak memory is independent of source image size.
+// The _streamed invoke variant lends the packed features straight to the
+// DSP through a buffer-backed signal.
+typedef int (*ei_ffi_row_reader_t)(void* ctx, uint32_t row, uint32_t n_rows, uint8_t* rgb_out);
+EI_IMPULSE_ERROR ei_ffi_preprocess_image_streamed(ei_ffi_row_reader_t read_rows, void* ctx, int src_width, int src_height, float* out_features);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_streamed(ei_ffi_row_reader_t read_rows, void* ctx, int src_width, int src_height, ei_impulse_result_t* result, int debug);
+
+// SIMD-accelerated feature packing (NEON where available, scalar
+// otherwise): convert capture-format pixels into the classifier's packed
+// 0xRRGGBB float features.
+EI_IMPULSE_ERROR ei_ffi_pack_rgb888_features(const uint8_t* rgb, size_t pixel_count, float* out);
+EI_IMPULSE_ERROR ei_ffi_pack_gray8_features(const uint8_t* gray, size_t pixel_count, float* out);
+
+// Pack planar sensor channels (one float array per channel) into the flat
+// feature order of a sensor-fusion impulse: INTERLEAVED is sample-major
+// (s0c0 s0c1 ... s1c0 ...), PLANAR concatenates channels. Structured
+// NEON stores for 2-4 channels, in-register transpose above that. `out`
+// must hold n_ch * samples floats.
+#define EI_FFI_LAYOUT_INTERLEAVED 0
+#define EI_FFI_LAYOUT_PLANAR 1
+EI_IMPULSE_ERROR ei_ffi_pack_channels(const float* const* channels, size_t n_ch, size_t samples, int layout, float* out);
+
+// Vectorized affine quantization for caller-side tensor prep:
+// quantize is dst[i] = clamp(round(src[i] / scale) + zero_point, -128, 127)
+// (round to nearest even), dequantize the inverse. src and dst must not
+// overlap.
+EI_IMPULSE_ERROR ei_ffi_quantize_f32_to_i8(const float* src, int8_t* dst, size_t n, float scale, int32_t zero_point);
+EI_IMPULSE_ERROR ei_ffi_dequantize_i8_to_f32(const int8_t* src, float* dst, size_t n, float scale, int32_t zero_point);
+
+// Fused normalize + quantize + pack for interleaved RGB888 into an int8
+// NHWC tensor, one pass over the frame instead of three:
+// out[i] = clamp(round((px * norm_scale + norm_offset) / q_scale) + zp).
+// When the composed affine is the exact uint8 -> int8 shift the kernel
+// reduces to a vectorized sign-bit flip. `out` holds pixel_count * 3.
+EI_IMPULSE_ERROR ei_ffi_pack_rgb888_quantized_i8(const uint8_t* rgb, size_t pixel_count, float norm_scale, float norm_offset, float q_scale, int32_t zero_point, int8_t* out);
+
+// Cache-blocked sequence LSTM for long windows: input-to-gate
+// contributions are computed weight-stationary across the whole sequence
+// (each weight row block loaded once), leaving only the recurrent matrix
+// in the sequential time loop. Layouts match TFLite's LSTM: gate order
+// input/forget/cell/output, weights row-major [4][n_cell][n_input] and
+// [4][n_cell][n_cell], bias [4][n_cell]. Cell/hidden state persists
+// across run calls for streaming; reset clears it between windows.
+// `hidden_out` ([n_steps][n_cell]) and `final_hidden` ([n_cell]) may be
+// NULL.
+// Indirect (im2col-free) NHWC float convolution: an indirection table of
+// input-pixel pointers replaces the im2col patch buffer, so the transient
+// footprint is k_h*k_w pointers per tile pixel instead of the full
+// [out_pixels][patch] matrix. For conv work outside the graph; in-graph
+// convs already avoid im2col through the XNNPACK delegate. `weights` is
+// [out_c][k_h][k_w][in_c], `bias` optional, symmetric zero padding.
+EI_IMPULSE_ERROR ei_ffi_conv2d_f32(const float* input, uint32_t in_h, uint32_t in_w, uint32_t in_c, const float* weights, uint32_t k_h, uint32_t k_w, uint32_t out_c, uint32_t stride, uint32_t pad, const float* bias, float* output);
+
+// On-device autotuning for the conv kernel's tile/block knobs: sweep the
+// candidate grid against one layer shape (scratch tensors, best-of
+// `iterations` timed runs per candidate), install the fastest pair, and
+// optionally report it. Persist the result with _tuning_save and restore
+// it at init with _tuning_load (one text line: "EICT1 <tile_pixels>
+// <block_kbytes>"); set_tiling overrides by hand, 0 restoring a knob's
+// default.
+EI_IMPULSE_ERROR ei_ffi_conv_autotune(uint32_t in_h, uint32_t in_w, uint32_t in_c, uint32_t k_h, uint32_t k_w, uint32_t out_c, uint32_t stride, uint32_t pad, uint32_t iterations, uint32_t* tile_pixels_out, uint32_t* block_kbytes_out);
+void ei_ffi_conv_set_tiling(uint32_t tile_pixels, uint32_t block_kbytes);
+EI_IMPULSE_ERROR ei_ffi_conv_tuning_save(const char* path);
+EI_IMPULSE_ERROR ei_ffi_conv_tuning_load(const char* path);
+
+EI_IMPULSE_ERROR ei_ffi_lstm_sequence_init(uint32_t n_input, uint32_t n_cell, uint32_t max_steps);
+EI_IMPULSE_ERROR ei_ffi_lstm_sequence_run(const float* input_weights, const float* recurrent_weights, const float* bias, const float* input, uint32_t n_steps, float* hidden_out, float* final_hidden);
+void ei_ffi_lstm_sequence_reset(void);
+void ei_ffi_lstm_sequence_deinit(void);
+
+// Greedy non-maximum suppression over planar (structure-of-arrays) box
+// coordinates, vectorized on NEON. Returns the number of kept boxes and
+// writes their indices, highest score first, into keep_indices.
+size_t ei_ffi_nms(const float* x0, const float* y0, const float* x1, const float* y1, const float* scores, size_t n, float score_threshold, float iou_threshold, uint32_t* keep_indices, size_t keep_capacity);
+// Class-wise NMS, classes sharded across the shared threadpool (after
+// ei_ffi_threadpool_init; inline on the caller's thread otherwise or for
+// few populated classes). class_ids holds one class per box; suppression
+// runs within each class only, and the merged keep list is
+// descending-score across classes, like ei_ffi_nms emits.
+size_t ei_ffi_nms_multiclass(const float* x0, const float* y0, const float* x1, const float* y1, const float* scores, const uint32_t* class_ids, size_t n, uint32_t n_classes, float score_threshold, float iou_threshold, uint32_t* keep_indices, size_t keep_capacity);
+
+// Sparse FOMO centroid-grid decode: SIMD-scan the [grid_h][grid_w][classes]
+// score plane (class 0 = background) and emit planar entries only for
+// cells with a foreground class at or above the threshold. label_ids are
+// zero-based foreground class indices; scale cell coordinates by
+// image size / grid size for pixel boxes. Returns the entry count.
+size_t ei_ffi_fomo_decode(const float* scores, uint32_t grid_h, uint32_t grid_w, uint32_t n_classes, float threshold, uint32_t* cell_x, uint32_t* cell_y, uint32_t* label_ids, float* out_scores, size_t capacity);
+
+// Single-pass SIMD reductions over a dense float plane: max, mean, and
+// count of values >= threshold. Output pointers may be NULL. Used by the
+// anomaly-grid stats call but generic over any score plane.
+EI_IMPULSE_ERROR ei_ffi_f32_grid_stats(const float* values, size_t n, float threshold, float* max_out, float* mean_out, uint32_t* above_out);
+
+// Object tracking with spatially-indexed association: detections are
+// bucketed into a centroid hash grid and each track scores IoU only
+// against its 3x3 cell neighborhood, so per-frame cost stays linear in
+// tracks + detections. Takes the same planar box layout as ei_ffi_nms;
+// `label_ids` may be NULL to track across labels. Update returns the
+// number of live tracks written into tracks_out.
+typedef struct {
+    uint32_t track_id;
+    uint32_t label_id;
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    float score;
+    uint32_t age;    // frames since the track opened
+    uint32_t missed; // consecutive frames without a match
+} ei_ffi_track_t;
+EI_IMPULSE_ERROR ei_ffi_tracker_init(float iou_threshold, uint32_t keep_grace, uint16_t max_observations);
+size_t ei_ffi_tracker_update(const float* x0, const float* y0, const float* x1, const float* y1, const float* scores, const uint32_t* label_ids, size_t n, ei_ffi_track_t* tracks_out, size_t tracks_capacity);
+void ei_ffi_tracker_reset(void);
+
+// Frame-delta view of the tracker: after an update, returns only tracks
+// that are new, moved by at least `min_move` on any box coordinate, or
+// lost since the previous delta call -- unchanged tracks are omitted, so
+// steady scenes publish near-empty payloads. Deltas that do not fit stay
+// pending for the next call.
+#define EI_FFI_TRACK_NEW 0
+#define EI_FFI_TRACK_MOVED 1
+#define EI_FFI_TRACK_LOST 2
+typedef struct {
+    uint8_t change;      // EI_FFI_TRACK_*
+    ei_ffi_track_t track; // for LOST, the last reported geometry
+} ei_ffi_track_delta_t;
+size_t ei_ffi_get_result_delta(ei_ffi_track_delta_t* deltas_out, size_t deltas_capacity, float min_move);
+
+// In-process image preprocessing on packed RGB888 (or grayscale,
+// pixel_size_B = 1) buffers, wrapping the SDK's ei::image::processing
+// kernels so callers don't need an image library of their own.
+EI_IMPULSE_ERROR ei_ffi_image_resize(const uint8_t* src, int src_width, int src_height, uint8_t* dst, int dst_width, int dst_height, int pixel_size_B);
+EI_IMPULSE_ERROR ei_ffi_image_crop(const uint8_t* src, int src_width, int src_height, int start_x, int start_y, uint8_t* dst, int dst_width, int dst_height);
+EI_IMPULSE_ERROR ei_ffi_image_crop_and_interpolate_rgb888(const uint8_t* src, int src_width, int src_height, uint8_t* dst, int dst_width, int dst_height);
+
+// Direct output tensor access for custom postprocessing (full TFLite builds
+// only; stubs elsewhere). Pointers stay valid until the next invoke or
+// re-init. ei_ffi_output_tensor_count returns -1 before the first inference.
+int ei_ffi_output_tensor_count(void);
+EI_IMPULSE_ERROR ei_ffi_get_output_tensor(int index, const float** data, size_t* len);
+EI_IMPULSE_ERROR ei_ffi_get_output_tensor_quantized(int index, const int8_t** data, size_t* len, float* scale, int32_t* zero_point);
+
+// Named output access for multi-head models: output tensor names ride in
+// the flatbuffer and survive re-export, unlike head order. Resolve the
+// name to its output position once at init with ei_ffi_output_index_by_name
+// (-1 when absent) and use the indexed accessors per invoke -- the hot
+// path stays lookup-free. The by-name getters are conveniences with the
+// same pointer-validity rules; the name map rebuilds automatically after
+// re-init or a hot swap.
+int ei_ffi_output_index_by_name(const char* name);
+EI_IMPULSE_ERROR ei_ffi_get_output_by_name(const char* name, const float** data, size_t* len);
+EI_IMPULSE_ERROR ei_ffi_get_output_by_name_quantized(const char* name, const int8_t** data, size_t* len, float* scale, int32_t* zero_point);
+// Integer-domain thresholding over a quantized output tensor: the float
+// threshold is translated into the tensor's int8 domain once at config
+// time, and classify_quantized then compares raw scores with no
+// dequantize pass. Returns the number of classes at or above threshold
+// (pass capacity 0 to size buffers) or -1 when unconfigured. Configure
+// after init and again after a hot swap. Full-TFLite builds only.
+EI_IMPULSE_ERROR ei_ffi_set_quantized_threshold(int index, float threshold);
+int ei_ffi_classify_quantized(int index, uint32_t* indices_out, size_t capacity);
+
+// Per-op TFLite profiling (full TFLite builds only; stubs elsewhere).
+// Start/stop bracket the invokes to profile; the summary is the same
+// per-op table the TFLite benchmark tool prints. ei_ffi_profiling_summary
+// returns bytes written (truncating if needed) or -1 without profile data.
+EI_IMPULSE_ERROR ei_ffi_profiling_start(void);
+EI_IMPULSE_ERROR ei_ffi_profiling_stop(void);
+int ei_ffi_profiling_summary(char* out, size_t out_len);
+
+// Static model introspection (full TFLite builds): walk the loaded graph
+// and write a JSON description -- per-node op name, builtin code, output
+// shape, constant parameter bytes and an analytic MAC estimate (exact
+// for conv / depthwise / fully-connected, 0 for ops without constant
+// weights) plus model-level totals -- so capacity planning can predict
+// latency and memory from the model alone. Returns bytes written
+// excluding the NUL, or -1 when no interpreter is loaded or `cap` is
+// too small (the output is never truncated mid-document).
+int ei_ffi_describe_model(char* json, size_t cap);
+
+// Hardware perf counters around an invoke: begin opens a per-thread
+// perf_event group for the requested counters, end reads the whole group
+// with one syscall and tears it down. Wall clock cannot distinguish a
+// DRAM-bound device from a compute-bound one; cache-miss and backend-
+// stall ratios can. Unprivileged per-thread events, cheap enough to wrap
+// one invoke every few hundred in production. time_enabled/time_running
+// expose PMU multiplexing (scale counts by enabled/running when they
+// differ). Stalled-cycles is unsupported on many PMUs; begin fails clean
+// rather than returning a partial group. Linux only.
+#define EI_FFI_PERF_CYCLES (1u << 0)
+#define EI_FFI_PERF_INSTRUCTIONS (1u << 1)
+#define EI_FFI_PERF_CACHE_REFS (1u << 2)
+#define EI_FFI_PERF_CACHE_MISSES (1u << 3)
+#define EI_FFI_PERF_STALLS (1u << 4)
+typedef struct {
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cache_references;
+    uint64_t cache_misses;
+    uint64_t stalled_cycles_backend;
+    uint64_t time_enabled_ns;
+    uint64_t time_running_ns;
+} ei_ffi_perf_counters_t;
+EI_IMPULSE_ERROR ei_ffi_perf_begin(uint32_t counters);
+EI_IMPULSE_ERROR ei_ffi_perf_end(ei_ffi_perf_counters_t* out);
+
+// Telemetry event stream. Interpreter profiler events (op invoke
+// begin/end, delegate status) are written into a preallocated lock-free
+// ring on the hot path -- a few nanoseconds per event, never blocking the
+// invoke -- and delivered to the registered callback when the collector
+// calls ei_ffi_telemetry_drain from its own thread. The ring drops events
+// when the collector falls behind (ei_ffi_telemetry_dropped counts them).
+// ei_ffi_telemetry_note injects non-interpreter timings (DSP blocks,
+// postprocessing) into the same stream. Interpreter events need a full
+// TFLite build; note events work everywhere.
+#define EI_TELEMETRY_TAG_LEN 32
+#define EI_TELEMETRY_OP_BEGIN 0  // op invoke started; handle pairs with OP_END
+#define EI_TELEMETRY_OP_END 1    // op invoke finished
+#define EI_TELEMETRY_OP_EVENT 2  // op invoke with built-in elapsed time (metric, usec)
+#define EI_TELEMETRY_RUNTIME 3   // runtime/delegate instrumentation; metric is the status code
+#define EI_TELEMETRY_NOTE 4      // injected via ei_ffi_telemetry_note; metric is elapsed usec
+typedef struct {
+    uint8_t kind;           // EI_TELEMETRY_*
+    uint32_t handle;        // pairs OP_BEGIN with its OP_END
+    int64_t op_idx;         // node index, -1 when not applicable
+    int64_t subgraph_idx;   // subgraph index, -1 when not applicable
+    uint64_t timestamp_us;  // monotonic, common clock across all events
+    uint64_t metric;        // elapsed usec or status code depending on kind
+    char tag[EI_TELEMETRY_TAG_LEN]; // op / event name, truncated
+} ei_telemetry_event_t;
+typedef void (*ei_telemetry_cb_t)(const ei_telemetry_event_t* event, void* user_data);
+void ei_ffi_register_telemetry(ei_telemetry_cb_t cb, void* user_data);
+size_t ei_ffi_telemetry_drain(size_t max_events);
+uint64_t ei_ffi_telemetry_dropped(void);
+void ei_ffi_telemetry_note(const char* tag, uint64_t elapsed_us);
+
+// Tensor watchpoints: sample a named intermediate tensor's min/max/mean
+// every `sample_rate`-th invoke (computed natively; nothing is copied out).
+// The callback fires on the invoking thread right after the owning subgraph
+// finishes, so keep it short. Full TFLite builds only.
+typedef struct {
+    char name[64];
+    int32_t tensor_index;
+    int32_t subgraph_index;
+    uint32_t elements;
+    float min;
+    float max;
+    float mean;
+} ei_ffi_tensor_stats_t;
+typedef void (*ei_ffi_tensor_watch_cb)(const ei_ffi_tensor_stats_t* stats, void* user_data);
+EI_IMPULSE_ERROR ei_ffi_watch_tensor(const char* name, uint32_t sample_rate, ei_ffi_tensor_watch_cb cb, void* user_data);
+EI_IMPULSE_ERROR ei_ffi_unwatch_tensor(const char* name);
+
+// Quantization calibration ranges (full TFLite, float deployments). With
+// collection armed, every invoke folds the min/max of each float
+// activation tensor into a running table; the table call emits per-tensor
+// range plus the int8 asymmetric scale/zero-point as JSON (bytes written,
+// or -1 when `cap` is too small -- never truncated). Replay the capture
+// log between begin/end -- the ei_ffi_calibrate harness (EI_CALIBRATE=1)
+// drives exactly that loop.
+EI_IMPULSE_ERROR ei_ffi_calibration_begin(void);
+void ei_ffi_calibration_end(void);
+int ei_ffi_calibration_table(char* json, size_t cap);
+
+// Peak-memory tracing. Start spawns a 25 ms resident-set sampler; stats
+// report the high-water mark since trace start plus, on full TFLite
+// builds, the interpreter's per-subgraph arena/scratch allocation totals.
+typedef struct {
+    long peak_rss_kb;
+    long current_rss_kb;
+    size_t arena_bytes;
+    size_t arena_persist_bytes;
+    size_t dynamic_bytes;
+    uint32_t subgraph_count;
+} ei_ffi_mem_stats_t;
+
+EI_IMPULSE_ERROR ei_ffi_start_memory_trace(void);
+void ei_ffi_stop_memory_trace(void);
+EI_IMPULSE_ERROR ei_ffi_get_memory_stats(ei_ffi_mem_stats_t* stats);
+
+// Per-inference arena snapshot (full TFLite builds): planner-reserved
+// capacity, bytes of live arena-resident tensors, the high-water mark of
+// that figure across all calls (glue-owned, so it spans interpreter
+// hot-swaps), and the count of tensors that fell back to dynamic heap
+// allocation. Cheap enough to sample every frame.
+typedef struct {
+    size_t capacity_bytes;
+    size_t used_bytes;
+    size_t high_water_bytes;
+    uint32_t heap_fallback_allocs;
+} ei_ffi_arena_stats_t;
+
+EI_IMPULSE_ERROR ei_ffi_get_arena_stats(ei_ffi_arena_stats_t* stats);
+
+// Post-idle latency control. After an idle period the kernel reclaims
+// arena pages and the next invoke faults them back in, which shows up as
+// a one-off latency spike. ei_ffi_pin_arena(true) mlocks the tensor
+// arena so that can't happen (needs RLIMIT_MEMLOCK headroom; fails with
+// a warning otherwise); ei_ffi_pin_arena(false) does a single pre-touch
+// pass instead. The toucher re-touches one byte per arena page on an
+// interval (0 = 1000 ms default) for deployments without mlock
+// privileges. Full TFLite builds only.
+EI_IMPULSE_ERROR ei_ffi_pin_arena(bool use_mlock);
+EI_IMPULSE_ERROR ei_ffi_unpin_arena(void);
+EI_IMPULSE_ERROR ei_ffi_arena_toucher_start(uint32_t interval_ms);
+void ei_ffi_arena_toucher_stop(void);
+
+// Lazy residency for rarely-run subgraphs (a heavyweight auxiliary head
+// invoked 1-in-N frames keeps its whole arena slice resident otherwise).
+// Offload drops the subgraph's non-persistent arena pages back to the
+// kernel; they re-materialize by page fault the next time the subgraph
+// runs, so steady-state RSS only carries the heads that run every frame.
+// Scratch (kTfLiteArenaRw) pages hold nothing between invokes, and
+// persistent arena tensors are never touched. Re-offload after the
+// frames that ran the aux head. Full TFLite on Linux/macOS only; don't
+// combine with ei_ffi_pin_arena over the same region.
+int ei_ffi_subgraph_count(void);
+int64_t ei_ffi_subgraph_arena_bytes(int subgraph_index);
+EI_IMPULSE_ERROR ei_ffi_offload_subgraph(int subgraph_index);
+
+// Crash-safe persistent stats ring: a fixed-size mapped file that gets
+// one 32-byte record appended per successful inference (no fsync on the
+// hot path; the commit counter is published after the record body, so a
+// crash never yields a torn-but-valid record). Open with capacity 0 for
+// the default 4096 records; reopening a file with the same geometry
+// resumes it, which is how the post-mortem read recovers the last
+// `capacity` inferences after a reboot. The queue-depth gauge is
+// app-maintained and sampled into each record.
+typedef struct {
+    uint64_t timestamp_ns; // CLOCK_REALTIME at note time
+    int32_t dsp_ms;
+    int32_t classification_ms;
+    int32_t anomaly_ms;
+    uint32_t queue_depth;
+    uint32_t arena_high_water_kb;
+    uint32_t reserved;
+} ei_ffi_stats_record_t;
+
+EI_IMPULSE_ERROR ei_ffi_stats_ring_open(const char* path, uint32_t capacity);
+void ei_ffi_stats_ring_close(void);
+void ei_ffi_stats_ring_set_queue_depth(uint32_t depth);
+uint32_t ei_ffi_stats_ring_read(ei_ffi_stats_record_t* out, uint32_t max_records);
+
+// XNNPACK / interpreter threading control (full TFLite builds only).
+// Takes effect when the next interpreter is constructed; 0 keeps the SDK
+// default. Disabling the delegate entirely is build-time (DISABLE_XNNPACK=1).
+void ei_ffi_set_xnnpack_threads(int num_threads);
+int ei_ffi_get_xnnpack_threads(int sdk_default);
 
-// Threshold setting functions
+// Caller-owned backing store for detached results. The variable-length
+// arrays inside ei_impulse_result_t alias per-impulse state that is reused
+// by the next inference; detaching into an arena makes a result long-lived
+// without any heap allocation on the inference path.
+typedef struct {
+    ei_impulse_result_bounding_box_t* bounding_boxes;
+    uint32_t bounding_boxes_capacity;
+    ei_impulse_result_bounding_box_t* visual_ad_grid_cells;
+    uint32_t visual_ad_grid_cells_capacity;
+} ei_ffi_result_arena_t;
+
+// Copy `src` into `dst`, re-pointing its variable-length arrays at the
+// caller's arena. Returns EI_IMPULSE_OUT_OF_MEMORY (with the copy truncated
+// to capacity) when the arena is too small.
+EI_IMPULSE_ERROR ei_ffi_detach_result(const ei_impulse_result_t* src, ei_impulse_result_t* dst, ei_ffi_result_arena_t* arena);
+
+// Copy the per-stage timing of a finished inference into the stable
+// ei_ffi_timing_t layout.
+EI_IMPULSE_ERROR ei_ffi_get_timing(const ei_impulse_result_t* result, ei_ffi_timing_t* timing_out);
+
+// Bump-allocator arena for DSP temporaries. Configure a per-thread size,
+// then bracket one window's feature extraction with begin/end: porting-
+// layer allocations inside the scope bump-allocate and are reclaimed
+// wholesale at end (the pipeline's DSP stage does this automatically).
+// Nothing allocated inside a scope may outlive it; stats report arena
+// hits vs. heap spills for sizing.
+EI_IMPULSE_ERROR ei_ffi_set_dsp_arena(size_t size);
+void ei_ffi_dsp_arena_begin(void);
+void ei_ffi_dsp_arena_end(void);
+void ei_ffi_dsp_arena_stats(uint64_t* served, uint64_t* spilled);
+
+// Arena placement options. EI_FFI_ARENA_HUGEPAGES backs porting-layer
+// allocations of 2 MB and up with MADV_HUGEPAGE anonymous mappings,
+// cutting dTLB misses on multi-megabyte working sets (Linux only;
+// falls back to plain malloc when mapping fails). Set before init so
+// the big blocks are placed on allocation.
+#define EI_FFI_ARENA_HUGEPAGES (1 << 0)
+EI_IMPULSE_ERROR ei_ffi_set_arena_options(int options);
+
+// Runtime delegate selection (full TFLite Linux builds compiled with
+// USE_GPU_DELEGATE=1; otherwise only CPU is accepted). Takes effect when
+// the next interpreter is constructed, so call before the first inference
+// or before re-init.
+#define EI_FFI_DELEGATE_CPU 0
+#define EI_FFI_DELEGATE_GPU 1
+EI_IMPULSE_ERROR ei_ffi_set_delegate(int delegate);
+int ei_ffi_get_delegate(void);
+
+// XNNPACK weights cache (opt-in, USE_XNNPACK_CACHE=1): CPU-path
+// interpreters share one process-wide cache of packed conv weights, so
+// only the first interpreter pays XNNPACK's repacking and later ones
+// (pool instances, re-init) map the aligned blocks. Returns how many
+// interpreters found their weights already packed; 0 when not compiled
+// in or only one interpreter has been built.
+uint32_t ei_ffi_xnnpack_cache_hits(void);
+
+// Cold-text isolation (opt-in, USE_COLD_TEXT=1, Linux only): the linker
+// groups the init-only SDK objects (flatbuffer parsing, model/interpreter
+// construction, arena planning) into a page-aligned region away from the
+// hot invoke text. ei_ffi_cold_text_bytes reports the grouped size (0 when
+// not compiled in); ei_ffi_release_cold_text, called after init, advises
+// the kernel to drop the region's residency -- a locality hint only, the
+// pages fault back in from the file if re-init ever runs them again.
+size_t ei_ffi_cold_text_bytes(void);
+EI_IMPULSE_ERROR ei_ffi_release_cold_text(void);
+
+// Build-arena interpreter construction (opt-in, EI_BUILD_ARENA=1):
+// bracket init (or a hot swap + re-init) with begin/end on the calling
+// thread and the tens of thousands of small metadata allocations made
+// during interpreter construction come from a grow-only bump arena
+// instead of the system allocator. release() frees every block
+// wholesale -- call it only after the interpreter built inside the
+// scope has been destroyed (post-deinit), since its metadata lives in
+// the arena. begin fails when the flag was not compiled in.
+EI_IMPULSE_ERROR ei_ffi_build_arena_begin(void);
+void ei_ffi_build_arena_end(void);
+void ei_ffi_build_arena_release(void);
+size_t ei_ffi_build_arena_bytes(void);
+
+// Reduced-precision inference (full TFLite builds compiled with EI_FP16=1;
+// otherwise only fp32 is accepted). FP16 lets XNNPACK run fp32 graphs in
+// half precision on cores with native fp16 arithmetic. Takes effect when
+// the next interpreter is constructed.
+#define EI_PRECISION_FP32 0
+#define EI_PRECISION_FP16 1
+EI_IMPULSE_ERROR ei_ffi_set_precision(int precision);
+int ei_ffi_get_precision(void);
+
+// Multi-model cascade: run N impulses over the same signal in-process,
+// early-exiting when a stage's top classification score is below its gate
+// threshold (<= 0 never gates; the last stage's threshold is ignored).
+// NULL handles mean the default impulse. `results` needs one entry per
+// stage; `stages_run` reports how many stages executed.
+typedef struct ei_ffi_cascade ei_ffi_cascade_t;
+ei_ffi_cascade_t* ei_ffi_cascade_create(ei_impulse_handle_t* const* handles, size_t n_stages, const float* gate_thresholds);
+EI_IMPULSE_ERROR ei_ffi_cascade_run(ei_ffi_cascade_t* cascade, signal_t* signal, ei_impulse_result_t* results, size_t* stages_run, int debug);
+void ei_ffi_cascade_destroy(ei_ffi_cascade_t* cascade);
+
+// Spectral frame cache for overlapping windows: a frame's magnitude
+// spectrum is keyed on its absolute sample offset in the stream, so
+// windows sharing frames transform each frame once. On a cache hit the
+// samples pointer is not read; returned pointers stay valid until the
+// entry ages out (FIFO, `capacity` frames) or the cache is reset.
+EI_IMPULSE_ERROR ei_ffi_spectral_cache_init(size_t frame_length, size_t n_fft, size_t capacity);
+EI_IMPULSE_ERROR ei_ffi_spectral_frame(const float* samples, uint64_t sample_offset, const float** spectrum_out);
+void ei_ffi_spectral_cache_stats(uint64_t* hits, uint64_t* misses);
+void ei_ffi_spectral_cache_reset(void);
+void ei_ffi_spectral_cache_deinit(void);
+
+// Runtime-dispatched int8 matrix x batch-vector multiply-accumulate
+// (the fully-connected / LSTM hot-path shape): result[batch][row] +=
+// dot(matrix[row], vectors[batch]) * scaling_factors[batch]. Picks
+// AVX512-VNNI, SVE (on wider-than-NEON implementations) or ARM dotprod
+// at runtime, scalar otherwise; ei_ffi_tensor_kernel_tier reports which
+// tier won.
+void ei_ffi_matrix_batch_vector_mul_i8(const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors, const float* scaling_factors, int n_batch, float* result);
+const char* ei_ffi_tensor_kernel_tier(void);
+
+// 4-bit packed weights for FC-heavy heads: ei_ffi_fc_pack_i4 packs a
+// row-major int8 matrix (values clamped to [-8, 7]) two-per-byte into
+// m_rows * ((m_cols + 1) / 2) bytes, once at init; the mul then streams
+// half the weight bytes of the int8 kernel, with sdot/nosdot NEON bodies
+// dispatched at runtime. Same accumulate contract as the i8 variant;
+// ei_ffi_tensor_kernel_tier_i4 reports the tier ("dotprod", "neon",
+// "scalar").
+void ei_ffi_fc_pack_i4(const int8_t* matrix, int m_rows, int m_cols, int8_t* packed);
+void ei_ffi_matrix_batch_vector_mul_i4(const int8_t* packed_matrix, int m_rows, int m_cols, const int8_t* vectors, const float* scaling_factors, int n_batch, float* result);
+const char* ei_ffi_tensor_kernel_tier_i4(void);
+
+// Runtime-dispatched per-channel requantization of int32 accumulators to
+// int8 (the float-scale form of TFLite's per-channel output stage):
+// out[ch][col] = clamp(round(acc[ch][col] * scales[ch]) + zero_point),
+// ties away from zero on every tier. `acc`/`out` are n_channels x n_cols
+// row-major; ei_ffi_requant_kernel_tier reports the tier ("sve", "neon",
+// "scalar").
+void ei_ffi_requantize_per_channel(const int32_t* acc, int n_channels, int n_cols, const float* scales, int32_t zero_point, int8_t* out);
+const char* ei_ffi_requant_kernel_tier(void);
+
+// Vectorized float softmax / elementwise sigmoid (in == out is allowed).
+// Both use a shared degree-5 polynomial exp with relative error < 2^-20
+// over the clamped domain [-87.3, 88.3]; after normalization softmax is
+// within 2e-6 absolute of the libm result per class, sigmoid within 1e-6.
+EI_IMPULSE_ERROR ei_ffi_softmax_f32(const float* in, size_t n, float* out);
+EI_IMPULSE_ERROR ei_ffi_sigmoid_f32(const float* in, size_t n, float* out);
+
+// Mel filterbank apply fused with log10 in one pass over a power
+// spectrum: the filterbank is passed banded (per-filter weight runs back
+// to back, band_start/band_len per filter), each filter's energy is a
+// vectorized dot product over its contiguous band, and a vectorized log
+// runs over the energy vector (relative error < 2^-21 vs libm). Energies
+// clamp to floor_value first (<= 0 selects 1e-30); scale the output by 10
+// for dB.
+EI_IMPULSE_ERROR ei_ffi_mel_apply_log10_f32(const float* power, size_t n_bins, const float* weights, const uint32_t* band_start, const uint32_t* band_len, size_t n_filters, float floor_value, float* out);
+
+// 1 when this binary was built with REPRODUCIBLE_MATH=1 (strict FP --
+// no fast-math reassociation, no FP contraction), so two such builds
+// produce bit-identical outputs and A/B harnesses can gate on equality.
+int ei_ffi_reproducible_math(void);
+
+// Anomaly-gated cascade: run the (cheap) gate impulse, and only run the
+// main impulse when its anomaly score reaches `anomaly_gate`. NULL handles
+// mean the default impulse; `gated_out` (optional) reports whether the
+// main stage was skipped.
+EI_IMPULSE_ERROR ei_ffi_run_classifier_gated(ei_impulse_handle_t* gate_handle, ei_impulse_handle_t* main_handle, signal_t* signal, ei_impulse_result_t* result, float anomaly_gate, int* gated_out, int debug);
+
+// Native result aggregation: results are folded into a decision window
+// on the invoke thread, post-invoke, so steady-state frames cross the
+// FFI boundary zero times. Majority keeps a window-length vote over the
+// per-frame top class (confidence = vote fraction); EWMA keeps
+// exponentially weighted class scores with alpha = 2 / (window + 1)
+// (confidence = smoothed top score). Both smooth the anomaly value the
+// same way. The callback fires on the invoke thread only when the
+// aggregated top class changes or the smoothed anomaly crosses the
+// boundary set with ei_ffi_aggregator_set_boundary (disabled by
+// default); ei_ffi_aggregator_read polls the current aggregate at any
+// time. One aggregator exists per process; create replaces it.
+#define EI_FFI_AGG_MAJORITY 0
+#define EI_FFI_AGG_EWMA 1
+typedef struct {
+    uint32_t top_index;    // aggregated winner class
+    float confidence;      // vote fraction (majority) or smoothed score (ewma)
+    float anomaly;         // smoothed anomaly score
+    uint32_t window_count; // frames currently in the window
+} ei_ffi_aggregate_t;
+typedef void (*ei_ffi_aggregate_cb)(const ei_ffi_aggregate_t* aggregate, void* user_data);
+EI_IMPULSE_ERROR ei_ffi_aggregator_create(uint32_t window, int policy);
+EI_IMPULSE_ERROR ei_ffi_aggregator_set_callback(ei_ffi_aggregate_cb cb, void* user_data);
+EI_IMPULSE_ERROR ei_ffi_aggregator_set_boundary(float boundary);
+EI_IMPULSE_ERROR ei_ffi_aggregator_read(ei_ffi_aggregate_t* out);
+void ei_ffi_aggregator_destroy(void);
+
+// ABI surface versioning, negotiated at load time. A multi-tenant loader
+// that dlopens several model libraries asks each one for these before
+// exchanging anything richer than bytes:
+//   - ei_ffi_abi_version: this glue's surface version. Bumped on any
+//     breaking ei_ffi_* signature or struct change.
+//   - ei_ffi_result_layout_fingerprint: hash of the sizes and offsets of
+//     ei_impulse_result_t as this library compiled it. Raw result structs
+//     may only cross library boundaries when fingerprints match.
+//   - ei_ffi_serialized_result_version: version of the flat serialized
+//     result below, which is the stable cross-version contract when
+//     fingerprints differ.
+#define EI_FFI_ABI_VERSION 1
+#define EI_FFI_SERIALIZED_RESULT_VERSION 1
+uint32_t ei_ffi_abi_version(void);
+uint64_t ei_ffi_result_layout_fingerprint(void);
+uint32_t ei_ffi_serialized_result_version(void);
+
+// Flat binary result serialization. One call writes the whole result --
+// header, fixed-stride records, then an interned label table -- so the
+// other side of the FFI deserializes a single buffer instead of one
+// round trip per box. Label fields are byte offsets of NUL-terminated
+// strings inside the label table.
+typedef struct {
+    uint32_t magic;   // "EIR0"
+    uint16_t version; // layout version, currently 1
+    uint16_t reserved;
+    uint32_t total_bytes;
+    uint32_t classification_count;
+    uint32_t bounding_box_count;
+    uint32_t grid_cell_count;
+    float anomaly;
+    uint64_t dsp_us;
+    uint64_t classification_us;
+    uint64_t anomaly_us;
+    uint32_t label_table_offset;
+    uint32_t label_table_bytes;
+} ei_ffi_serialized_header_t;
+
+typedef struct {
+    uint32_t label_offset;
+    float value;
+} ei_ffi_serialized_class_t;
+
+typedef struct {
+    uint32_t label_offset;
+    float value;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} ei_ffi_serialized_box_t;
+
+// Returns the total byte size of the serialized result. The buffer is only
+// written when `cap` is large enough, so a first call with cap 0 sizes an
+// exact allocation. Returns -1 on invalid arguments.
+int ei_ffi_serialize_result(const ei_impulse_result_t* result, uint8_t* buf, size_t cap);
+
+// One-pass JSON encoding of a result into a caller buffer: no
+// allocation, no stdio, same document shape as the HTTP server's
+// /classify response (classification as a label->value object,
+// bounding_boxes, anomaly, timing; the visual-anomaly grid when the
+// model has one). Honors the configured top-k like
+// ei_ffi_serialize_result. Returns the document length (NUL-terminated,
+// NUL not counted), or -1 when `cap` is too small -- never a truncated
+// document.
+int ei_ffi_result_to_json(const ei_impulse_result_t* result, char* buf, size_t cap);
+
+// Dense view of the visual-anomaly grid: the cell array is flattened once
+// into a reused thread-local row-major float plane ([height][width],
+// unoccupied cells zero) so heatmap renderers read it in place instead of
+// copying per frame. The pointer stays valid until the next grid call on
+// the same thread. Fails on models without a visual anomaly block.
+EI_IMPULSE_ERROR ei_ffi_get_anomaly_grid(const ei_impulse_result_t* result, const float** grid_out, uint32_t* width_out, uint32_t* height_out);
+// One vectorized pass over the same plane: max cell score, mean cell
+// score, and the number of cells at or above `threshold` (output pointers
+// may be NULL).
+EI_IMPULSE_ERROR ei_ffi_anomaly_grid_stats(const ei_impulse_result_t* result, float threshold, float* max_out, float* mean_out, uint32_t* above_out);
+
+// Fully inline result for plain classification models: fixed-size score
+// vector, scalar anomaly, timing -- value-typed and memcpy-able across the
+// FFI, populated with zero allocations. Only usable on EI_FFI_SMALL_RESULT
+// builds (build.rs enables the flag when the model's block census shows no
+// object detection and no visual anomaly grid); otherwise the call fails.
+typedef struct {
+    uint32_t label_count;
+    float value[EI_CLASSIFIER_LABEL_COUNT];
+    float anomaly;
+    ei_ffi_timing_t timing;
+} ei_ffi_small_result_t;
+
+EI_IMPULSE_ERROR ei_ffi_run_classifier_small(signal_t* signal, ei_ffi_small_result_t* out, int debug);
+
+// Top-k result mode for large label sets. With k configured,
+// ei_ffi_serialize_result emits only the k highest-scoring class records
+// (rank order), and ei_ffi_get_topk selects them directly from a result --
+// one scan, no allocation. k = 0 restores full-result marshalling.
+typedef struct {
+    uint32_t index;
+    float value;
+} ei_ffi_topk_entry_t;
+
+EI_IMPULSE_ERROR ei_ffi_set_topk(uint32_t k);
+int ei_ffi_get_topk(const ei_impulse_result_t* result, ei_ffi_topk_entry_t* out, size_t cap);
+
+// Shared-memory result bus: the publisher writes each serialized result
+// (ei_ffi_serialize_result layout) once into a seqlock-protected ring in
+// POSIX shared memory (`name` must start with '/'); readers poll with
+// plain loads, no syscalls, so fan-out cost is independent of consumer
+// count. Single publisher thread; publish drops (and counts) results
+// whose serialized form exceeds the fixed 16 KiB slot payload. Linux only.
+EI_IMPULSE_ERROR ei_ffi_results_shm_create(const char* name, size_t depth);
+EI_IMPULSE_ERROR ei_ffi_results_shm_publish(const ei_impulse_result_t* result);
+uint64_t ei_ffi_results_shm_drops(void);
+void ei_ffi_results_shm_destroy(void);
+// Reader side, for consumer processes that link this library. `seen`
+// carries the last publish counter consumed (returns -1 until a newer
+// record exists); pass NULL to always fetch the newest record. Returns
+// the record's byte length or -1.
+EI_IMPULSE_ERROR ei_ffi_results_shm_open(const char* name);
+int ei_ffi_results_shm_read_latest(uint8_t* buf, size_t cap, uint64_t* seen);
+void ei_ffi_results_shm_close(void);
+
+// Double-buffered DSP/inference pipeline. Submit copies one raw signal
+// frame (EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE floats) and overlaps its
+// feature extraction with the previous frame's interpreter invoke;
+// collect blocks for the oldest frame's result, in submission order.
+// Submit blocks when both slots are in flight (one frame of lookahead).
+EI_IMPULSE_ERROR ei_ffi_pipeline_init(int debug);
+EI_IMPULSE_ERROR ei_ffi_pipeline_submit(const float* data, size_t data_size);
+EI_IMPULSE_ERROR ei_ffi_pipeline_collect(ei_impulse_result_t* result);
+void ei_ffi_pipeline_deinit(void);
+
+// Two-lane priority scheduler. High-lane frames always run before queued
+// low-lane frames, and on full-TFLite builds a high submission cancels a
+// running low invoke between subgraph nodes (the low frame is re-run
+// afterwards), bounding the high lane's queue delay to one node. Submit
+// never blocks and returns a job id (-1 on error); wait blocks for that
+// job's result and may be called once per id.
+#define EI_FFI_LANE_HIGH 0
+#define EI_FFI_LANE_LOW 1
+EI_IMPULSE_ERROR ei_ffi_scheduler_start(int debug);
+int64_t ei_ffi_scheduler_submit(int lane, const float* data, size_t data_size);
+EI_IMPULSE_ERROR ei_ffi_scheduler_wait(int64_t job_id, ei_impulse_result_t* result);
+void ei_ffi_scheduler_stop(void);
+
+// Energy-aware DVFS hinting (Linux; INFERENCE_ERROR elsewhere). BURST_BEGIN
+// raises the scheduler utilization clamp on every inference thread (the
+// glue's workers plus the calling thread) so the governor runs the first
+// frame of a burst at steady-state frequency instead of ramping lazily;
+// BURST_END releases it. Falls back to the global cpufreq boost toggle on
+// kernels without uclamp. Bracket bursts, don't leave BEGIN held across
+// idle periods -- the clamp costs battery while active.
+#define EI_HINT_BURST_BEGIN 0
+#define EI_HINT_BURST_END 1
+EI_IMPULSE_ERROR ei_ffi_power_hint(int hint);
+
+// Invoke timeout (full TFLite builds): a classify running longer than `ms`
+// has its invoke cancelled between subgraph nodes and returns
+// EI_IMPULSE_CANCELED, bounding worst-case latency without killing the
+// process. The interpreter stays reusable -- the next classify runs
+// normally. 0 disables; micro builds (no cancellation hook) report
+// INFERENCE_ERROR.
+EI_IMPULSE_ERROR ei_ffi_set_invoke_timeout(uint32_t ms);
+
+// Ethos-U NPU path (build with USE_ETHOS=1 or EI_ENGINE=ethos-u; stubs
+// otherwise). Init loads a Vela-compiled command stream and opens the
+// device; run dispatches raw quantized feature maps. The classifier
+// entry point falls back to the CPU when no network is loaded.
+EI_IMPULSE_ERROR ei_ffi_ethos_u_init(const char* device_path, const char* network_path);
+bool ei_ffi_ethos_u_available(void);
+EI_IMPULSE_ERROR ei_ffi_ethos_u_run(const int8_t* input, size_t input_size, int8_t* output, size_t output_size);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_npu(signal_t* signal, ei_impulse_result_t* result, bool debug);
+void ei_ffi_ethos_u_deinit(void);
+
+// Hybrid partitioned execution for graphs the NPU only partly supports:
+// a Vela-compiled backbone runs on the NPU (loaded via ei_ffi_ethos_u_init)
+// and this build's impulse runs the remainder on the CPU, consuming the
+// backbone's dequantized OFM as its input frame. Stages are pipelined two
+// deep -- submit drives the NPU while a worker thread runs the previous
+// frame's CPU stage -- so throughput approaches max(stage) instead of sum.
+// One submitter thread; every successful submit must be paired with an
+// await. Configure the OFM tensor's dequantization parameters first
+// (identity by default).
+void ei_ffi_hybrid_configure(float ofm_scale, int32_t ofm_zero_point);
+EI_IMPULSE_ERROR ei_ffi_hybrid_submit(const int8_t* ifm, size_t ifm_size, int debug);
+EI_IMPULSE_ERROR ei_ffi_hybrid_await(ei_impulse_result_t* result);
+void ei_ffi_hybrid_deinit(void);
+
+// HTTP inference server mode (build with EI_HTTP_SERVER=1; stubs
+// otherwise). POST raw float32 features to /classify, JSON results back;
+// the listener runs on a background thread until stopped.
+EI_IMPULSE_ERROR ei_ffi_http_server_start(const char* bind_addr, int port);
+void ei_ffi_http_server_stop(void);
+
+// Thread-local extended error detail, populated only on failure paths --
+// the success path stays a bare register return. ei_ffi_last_error
+// copies the calling thread's last recorded failure (stage, block,
+// captured errno, short context string) and returns 1, or 0 when
+// nothing failed on this thread since start or the last clear. The
+// record persists until the next failure or ei_ffi_clear_last_error.
+#define EI_FFI_STAGE_NONE 0
+#define EI_FFI_STAGE_CONFIG 1
+#define EI_FFI_STAGE_DSP 2
+#define EI_FFI_STAGE_INFERENCE 3
+#define EI_FFI_STAGE_IO 4
+
+typedef struct {
+    int code;          // the EI_IMPULSE_ERROR that was returned
+    int stage;         // EI_FFI_STAGE_*
+    uint32_t block_id; // impulse block involved, 0 when not applicable
+    int os_errno;      // captured errno, 0 when not applicable
+    char message[96];  // short static context, NUL-terminated
+} ei_ffi_error_detail_t;
+
+int ei_ffi_last_error(ei_ffi_error_detail_t* out);
+void ei_ffi_clear_last_error(void);
+
+// SDK log output routing. ei_printf is overridden to hand each formatted
+// line (truncated at 512 bytes) to the registered callback; NULL restores
+// stdout. Compile-time stripping is separate: set EI_LOG_LEVEL at build
+// time (none|error|warn|info|debug) to compile EI_LOG* call sites out.
+typedef void (*ei_ffi_log_fn)(const char* line);
+void ei_ffi_set_log_callback(ei_ffi_log_fn callback);
+
+// Bounded-latency variant: lines go into a preallocated lock-free ring
+// (1024 records of 256 bytes) and a background thread delivers them to
+// the sink, so the emitting thread pays a format plus one CAS per line
+// no matter where the sink writes. On overflow records are dropped, not
+// blocked -- ei_ffi_log_sink_dropped counts them. NULL flushes, stops
+// the drain thread and restores the synchronous path. While a sink is
+// active it takes precedence over ei_ffi_set_log_callback.
+void ei_ffi_set_log_sink(ei_ffi_log_fn sink);
+uint64_t ei_ffi_log_sink_dropped(void);
+
+// Threshold setting functions. Updates are stored with relaxed atomics on
+// the live postprocessing configs, so they are safe to call while inference
+// threads run; a frame mid-postprocessing may see a mix of old and new
+// values for that one frame.
 EI_IMPULSE_ERROR ei_ffi_set_object_detection_threshold(uint32_t block_id, float min_score);
 EI_IMPULSE_ERROR ei_ffi_set_anomaly_threshold(uint32_t block_id, float min_anomaly_score);
 EI_IMPULSE_ERROR ei_ffi_set_object_tracking_threshold(uint32_t block_id, float threshold, uint32_t keep_grace, uint16_t max_observations);
 
+// Which threshold an ei_threshold_update_t targets.
+#define EI_FFI_THRESHOLD_OBJECT_DETECTION 1
+#define EI_FFI_THRESHOLD_ANOMALY 2
+#define EI_FFI_THRESHOLD_OBJECT_TRACKING 3
+
+typedef struct {
+    uint32_t block_id;
+    uint32_t kind;             // EI_FFI_THRESHOLD_*
+    float value;               // score / anomaly / tracking threshold
+    uint32_t keep_grace;       // object tracking only
+    uint16_t max_observations; // object tracking only
+} ei_threshold_update_t;
+
+// Apply a batch of threshold updates in one call. Entries are applied
+// independently; returns the first failure with the rest still applied.
+EI_IMPULSE_ERROR ei_ffi_set_thresholds(const ei_threshold_update_t* updates, size_t n_updates);
+
+// Epoch-published variant for multi-field consistency: the batch is
+// published as one immutable block with a single atomic pointer store and
+// drained by the invoke thread at the top of the next frame, so
+// postprocessing runs either entirely before or entirely after the whole
+// batch -- never through the middle of a multi-field update (the tracking
+// triple). A publish landing before the previous one was drained
+// supersedes it. The epoch counter ticks when a batch is applied; poll it
+// to confirm an update took effect.
+EI_IMPULSE_ERROR ei_ffi_publish_thresholds(const ei_threshold_update_t* updates, size_t n_updates);
+uint64_t ei_ffi_thresholds_epoch(void);
+
+// Restrict detection postprocessing to an allowlist of classes (0-based
+// label indices). The filter is consulted inside the SDK's detection
+// postprocess kernel, before score-thresholding and NMS, so skipped class
+// planes cost nothing rather than being trimmed from the finished box
+// list. NULL or n == 0 clears the filter. Lock-free; a frame racing a
+// filter change may mix old and new classes for that one invoke.
+EI_IMPULSE_ERROR ei_ffi_set_class_filter(const uint32_t* class_ids, size_t n);
+
+// Unified runtime-config snapshot: thresholds (including the tracking
+// triple, which travels as a threshold update), class filter and top-k
+// published as one immutable block with a single atomic store and
+// drained whole at the top of the next frame -- multi-knob updates are
+// transactional, and the invoke path pays one relaxed load. The struct
+// describes desired state, not a delta: NULL class_filter clears the
+// filter, top_k 0 means unlimited (otherwise a successful frame's box
+// list is trimmed to the k highest scores). A publish landing before
+// the previous one drained supersedes it; poll ei_ffi_config_epoch to
+// confirm an update took effect.
+typedef struct {
+    const ei_threshold_update_t* thresholds;
+    size_t n_thresholds;
+    const uint32_t* class_filter; // 0-based label indices; NULL = all
+    size_t n_class_filter;
+    uint32_t top_k;               // 0 = unlimited
+} ei_runtime_config_t;
+EI_IMPULSE_ERROR ei_ffi_apply_config(const ei_runtime_config_t* config);
+uint64_t ei_ffi_config_epoch(void);
+
+// One postprocessing block's live config, as read back by
+// ei_ffi_get_all_block_configs. `kind` names the matching setter;
+// `threshold` is NAN when the block does not expose a readable one
+// (detection decoder configs have no stable struct).
+typedef struct {
+    uint32_t block_id;
+    uint32_t kind;             // EI_FFI_THRESHOLD_*
+    float threshold;
+    uint32_t keep_grace;       // object tracking only, else 0
+    uint16_t max_observations; // object tracking only, else 0
+} ei_ffi_block_config_t;
+
+// Snapshot every postprocessing block's live config in one FFI hop.
+// Returns the total block count; at most `cap` entries are written (pass
+// NULL/0 to size the buffer). Safe to call while inference runs, with the
+// same one-frame tearing caveat as the setters.
+size_t ei_ffi_get_all_block_configs(ei_ffi_block_config_t* out, size_t cap);
+
+// Early-exit margin gate for clear-negative windows: when the configured
+// negative class outscores every other class by at least `margin`,
+// ei_ffi_run_classifier_early_exit sets *exited to 1 and the caller skips
+// result marshalling/postprocessing. A negative index disables the gate.
+EI_IMPULSE_ERROR ei_ffi_set_logit_gate(int32_t negative_class_ix, float margin);
+EI_IMPULSE_ERROR ei_ffi_run_classifier_early_exit(signal_t* signal, ei_impulse_result_t* result, int* exited, int debug);
+
+// The model's interned label table: `*labels_out` points at `*count_out`
+// NUL-terminated strings with static lifetime. Result label pointers aim
+// into this table, so ei_ffi_label_index resolves them by pointer
+// identity (strcmp fallback, -1 when unknown) -- copy the table once at
+// init and look labels up by index instead of allocating per frame.
+EI_IMPULSE_ERROR ei_ffi_get_labels(const char* const** labels_out, size_t* count_out);
+int32_t ei_ffi_label_index(const char* label);
+// Raw input frame size in floats; for callers loading this library
+// dynamically, who cannot read the model_metadata constants.
+size_t ei_ffi_input_frame_size(void);
+
+// Cooperative yielding inference for single-core devices: `yield_cb` is
+// called between interpreter nodes whenever `budget_us` microseconds have
+// passed since the last yield, so the caller can pump the network stack
+// or watchdog mid-invoke without threads. Uses the same between-node hook
+// as the priority scheduler (do not combine the two); inert on micro
+// builds, where this is a plain run_classifier.
+EI_IMPULSE_ERROR ei_ffi_run_classifier_cooperative(signal_t* signal, ei_impulse_result_t* result, uint64_t budget_us, void (*yield_cb)(void* user_data), void* user_data, int debug);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,274 @@
+// EIM-protocol compatibility server for drop-in migration.
+//
+// Orchestration stacks built around Edge Impulse's .eim binaries speak a
+// small JSON protocol over a Unix domain socket: the runner is launched
+// with the socket path as its first argument, listens there, and answers
+// hello / classify messages. This binary speaks that protocol but
+// executes through the in-process ei_ffi_* path -- one warm interpreter
+// (or an instance pool with --pool N), no per-classify process spawn or
+// pipe hop, which is where EIM's ~10 ms per call goes.
+//
+//   usage: ei_eim_compat <socket path> [--pool N]
+//
+// Messages are JSON objects terminated by a NUL byte (the Linux SDK's
+// framing); a trailing newline before the NUL is tolerated. Supported
+// requests, each carrying a client-chosen "id" echoed in the response:
+//   {"hello": 1, "id": n}            -> model_parameters + project info
+//   {"classify": [floats], "id": n}  -> classification result
+// Anything else gets {"success": false, "error": ...}. Connections are
+// served sequentially, matching the one-client lifecycle of a real EIM
+// runner.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include "third_party/json/json.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+nlohmann::json result_to_json(const ei_impulse_result_t& result) {
+    nlohmann::json j;
+    j["classification"] = nlohmann::json::object();
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        j["classification"][result.classification[ix].label] =
+            result.classification[ix].value;
+    }
+    j["bounding_boxes"] = nlohmann::json::array();
+    for (uint32_t ix = 0; ix < result.bounding_boxes_count; ix++) {
+        const ei_impulse_result_bounding_box_t& bb = result.bounding_boxes[ix];
+        if (bb.value == 0.0f) {
+            continue;
+        }
+        j["bounding_boxes"].push_back({
+            {"label", bb.label}, {"value", bb.value},
+            {"x", bb.x}, {"y", bb.y}, {"width", bb.width}, {"height", bb.height},
+        });
+    }
+#if EI_CLASSIFIER_HAS_ANOMALY
+    j["anomaly"] = result.anomaly;
+#endif
+    return j;
+}
+
+nlohmann::json hello_response() {
+    nlohmann::json params;
+    params["axis_count"] = (int)EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
+    params["frequency"] = (float)EI_CLASSIFIER_FREQUENCY;
+    params["has_anomaly"] = (int)EI_CLASSIFIER_HAS_ANOMALY;
+    params["input_features_count"] = (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+    params["image_input_width"] = (int)EI_CLASSIFIER_INPUT_WIDTH;
+    params["image_input_height"] = (int)EI_CLASSIFIER_INPUT_HEIGHT;
+    params["interval_ms"] = (float)EI_CLASSIFIER_INTERVAL_MS;
+    params["label_count"] = (size_t)EI_CLASSIFIER_LABEL_COUNT;
+    params["labels"] = nlohmann::json::array();
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        params["labels"].push_back(ei_classifier_inferencing_categories[ix]);
+    }
+    params["sensor"] = (int)EI_CLASSIFIER_SENSOR;
+#if EI_CLASSIFIER_OBJECT_DETECTION
+    params["model_type"] = "object_detection";
+#else
+    params["model_type"] = "classification";
+#endif
+
+    nlohmann::json project;
+    project["id"] = (int)EI_CLASSIFIER_PROJECT_ID;
+    project["name"] = EI_CLASSIFIER_PROJECT_NAME;
+    project["owner"] = EI_CLASSIFIER_PROJECT_OWNER;
+    project["deploy_version"] = (int)EI_CLASSIFIER_PROJECT_DEPLOY_VERSION;
+
+    nlohmann::json j;
+    j["success"] = true;
+    j["model_parameters"] = params;
+    j["project"] = project;
+    return j;
+}
+
+bool send_json(int fd, nlohmann::json j) {
+    std::string body = j.dump();
+    body.push_back('\0');
+    const char* p = body.data();
+    size_t len = body.size();
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+nlohmann::json handle_message(const nlohmann::json& msg) {
+    nlohmann::json response;
+    if (msg.contains("id")) {
+        response["id"] = msg["id"];
+    }
+
+    if (msg.contains("hello")) {
+        nlohmann::json hello = hello_response();
+        if (msg.contains("id")) {
+            hello["id"] = msg["id"];
+        }
+        return hello;
+    }
+
+    if (msg.contains("classify") && msg["classify"].is_array()) {
+        static std::vector<float> features;
+        features.clear();
+        for (const auto& value : msg["classify"]) {
+            if (!value.is_number()) {
+                response["success"] = false;
+                response["error"] = "classify payload must be an array of numbers";
+                return response;
+            }
+            features.push_back(value.get<float>());
+        }
+        if (features.size() != (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+            response["success"] = false;
+            response["error"] = "expected " +
+                std::to_string((size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) +
+                " features, got " + std::to_string(features.size());
+            return response;
+        }
+        signal_t signal;
+        ei::numpy::signal_from_buffer(features.data(), features.size(), &signal);
+        ei_impulse_result_t result = {};
+        // Pooled when a pool exists (concurrent orchestrators), singleton
+        // otherwise -- the same fallback the HTTP server uses.
+        EI_IMPULSE_ERROR status = ei_ffi_run_classifier_pooled(&signal, &result, 0);
+        if (status != EI_IMPULSE_OK) {
+            status = ei_ffi_run_classifier(&signal, &result, 0);
+        }
+        if (status != EI_IMPULSE_OK) {
+            response["success"] = false;
+            response["error"] = "classification failed (" + std::to_string((int)status) + ")";
+            return response;
+        }
+        response["success"] = true;
+        response["result"] = result_to_json(result);
+        response["timing"] = {
+            {"dsp", result.timing.dsp},
+            {"classification", result.timing.classification},
+            {"anomaly", result.timing.anomaly},
+        };
+        return response;
+    }
+
+    response["success"] = false;
+    response["error"] = "unsupported message";
+    return response;
+}
+
+void serve_connection(int fd) {
+    std::string buffer;
+    char chunk[4096];
+    for (;;) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0) {
+            return;
+        }
+        buffer.append(chunk, (size_t)n);
+
+        size_t end;
+        while ((end = buffer.find('\0')) != std::string::npos) {
+            std::string raw = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            // Tolerate newline-terminated senders.
+            while (!raw.empty() && (raw.back() == '\n' || raw.back() == '\r')) {
+                raw.pop_back();
+            }
+            if (raw.empty()) {
+                continue;
+            }
+            nlohmann::json msg = nlohmann::json::parse(raw, nullptr, false);
+            nlohmann::json response;
+            if (msg.is_discarded()) {
+                response["success"] = false;
+                response["error"] = "invalid JSON";
+            }
+            else {
+                response = handle_message(msg);
+            }
+            if (!send_json(fd, response)) {
+                return;
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* socket_path = nullptr;
+    size_t pool_size = 0;
+    for (int ix = 1; ix < argc; ix++) {
+        if (strcmp(argv[ix], "--pool") == 0 && ix + 1 < argc) {
+            pool_size = (size_t)atoi(argv[++ix]);
+        }
+        else if (socket_path == nullptr) {
+            socket_path = argv[ix];
+        }
+        else {
+            fprintf(stderr, "usage: %s <socket path> [--pool N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (socket_path == nullptr) {
+        fprintf(stderr, "usage: %s <socket path> [--pool N]\n", argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    ei_ffi_run_classifier_init();
+    if (pool_size > 0 && ei_ffi_instance_pool_init(pool_size) != EI_IMPULSE_OK) {
+        fprintf(stderr, "WARN: pool init failed, serving on the default impulse\n");
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path);
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 4) < 0) {
+        perror("bind");
+        return 1;
+    }
+    printf("ei_eim_compat: serving the EIM protocol on %s\n", socket_path);
+    fflush(stdout);
+
+    for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        serve_connection(fd);
+        close(fd);
+    }
+}
+
+#else // !(__linux__ || __APPLE__)
+
+int main(void) {
+    fprintf(stderr, "ei_eim_compat requires Unix domain sockets\n");
+    return 1;
+}
+
+#endif // __linux__ || __APPLE__
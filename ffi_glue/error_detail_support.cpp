@@ -0,0 +1,59 @@
+// Thread-local extended error detail, populated only on failure.
+//
+// The EI_IMPULSE_ERROR return tells a fleet *that* an inference failed,
+// not where: which stage, which block, what the OS said. This TU keeps
+// one thread-local detail record that failure paths fill in via
+// ei_ffi_internal_note_error and callers read back with
+// ei_ffi_last_error. The success path touches none of it -- no store, no
+// branch beyond the error checks that already exist -- so the register
+// return stays the whole cost of a passing call.
+//
+// Thread-local by design: the pool and the async engine fail on their
+// own threads, and a shared record would interleave their stories.
+// `message` is a short static-register context string, never a format
+// buffer; anything needing formatting belongs in the log hook instead.
+#include "edge_impulse_wrapper.h"
+
+#include <cstring>
+
+namespace {
+
+thread_local ei_ffi_error_detail_t s_detail;
+thread_local bool s_detail_valid = false;
+
+} // namespace
+
+extern "C" {
+
+// Record detail for a failure on the calling thread. Glue-internal:
+// failure paths call this with the error they are about to return.
+__attribute__((visibility("default"))) void ei_ffi_internal_note_error(int code, int stage, uint32_t block_id, int os_errno, const char* message) {
+    s_detail.code = code;
+    s_detail.stage = stage;
+    s_detail.block_id = block_id;
+    s_detail.os_errno = os_errno;
+    s_detail.message[0] = '\0';
+    if (message != nullptr) {
+        strncpy(s_detail.message, message, sizeof(s_detail.message) - 1);
+        s_detail.message[sizeof(s_detail.message) - 1] = '\0';
+    }
+    s_detail_valid = true;
+}
+
+// Copy the calling thread's last recorded failure detail into `out`.
+// Returns 1 when a detail was available (and leaves it in place for
+// repeated reads), 0 when nothing failed on this thread since start or
+// the last clear.
+__attribute__((visibility("default"))) int ei_ffi_last_error(ei_ffi_error_detail_t* out) {
+    if (out == nullptr || !s_detail_valid) {
+        return 0;
+    }
+    *out = s_detail;
+    return 1;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_clear_last_error(void) {
+    s_detail_valid = false;
+}
+
+} // extern "C"
@@ -0,0 +1,86 @@
+// fp16 inference mode for full-TFLite ARM builds.
+//
+// Opt-in (EI_FP16=1): the build drops DISABLEFLOAT16 so TFLite's half-
+// precision types compile, and ei_ffi_set_precision(EI_PRECISION_FP16)
+// flips the interpreter's allow-fp16-for-fp32 flag as each interpreter is
+// constructed (build.rs patches tflite_full.h to call
+// ei_ffi_internal_apply_precision there, next to the profiler attach).
+// XNNPACK then lowers fp32 convolutions to its fp16 kernels on cores with
+// native half arithmetic (Cortex-A76 and newer), halving weight/activation
+// bandwidth. Accuracy drops slightly versus fp32; keep EI_PRECISION_FP32
+// (the default) where that matters.
+#include "edge_impulse_wrapper.h"
+
+#include <atomic>
+
+namespace {
+
+static std::atomic<int> s_precision{EI_PRECISION_FP32};
+
+} // namespace
+
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE) && defined(EI_FFI_FP16)
+
+#include "tensorflow/lite/interpreter.h"
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_precision(int precision) {
+#if defined(EI_FFI_SEALED)
+    // Sealed build: precision was fixed at build time (fp16, since the fp16
+    // kernels were compiled in). Accept the baked value, reject the rest.
+    return precision == EI_PRECISION_FP16 ? EI_IMPULSE_OK : EI_IMPULSE_INFERENCE_ERROR;
+#else
+    if (precision != EI_PRECISION_FP32 && precision != EI_PRECISION_FP16) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_precision.store(precision);
+    return EI_IMPULSE_OK;
+#endif
+}
+
+__attribute__((visibility("default"))) int ei_ffi_get_precision(void) {
+#if defined(EI_FFI_SEALED)
+    return EI_PRECISION_FP16;
+#else
+    return s_precision.load();
+#endif
+}
+
+// Called from the patched tflite_full.h once per interpreter construction.
+__attribute__((visibility("default"))) void ei_ffi_internal_apply_precision(void* interpreter) {
+    if (interpreter == nullptr) {
+        return;
+    }
+    tflite::Interpreter* interp = static_cast<tflite::Interpreter*>(interpreter);
+#if defined(EI_FFI_SEALED)
+    interp->SetAllowFp16PrecisionForFp32(true);
+#else
+    interp->SetAllowFp16PrecisionForFp32(s_precision.load() == EI_PRECISION_FP16);
+#endif
+}
+
+} // extern "C"
+
+#else // !EI_CLASSIFIER_USE_FULL_TFLITE || !EI_FFI_FP16
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_precision(int precision) {
+    if (precision == EI_PRECISION_FP32) {
+        s_precision.store(precision);
+        return EI_IMPULSE_OK;
+    }
+    // fp16 kernels not compiled in (build with EI_FP16=1).
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_get_precision(void) {
+    return s_precision.load();
+}
+
+__attribute__((visibility("default"))) void ei_ffi_internal_apply_precision(void*) {}
+
+} // extern "C"
+
+#endif // EI_CLASSIFIER_USE_FULL_TFLITE && EI_FFI_FP16
@@ -0,0 +1,302 @@
+// Cross-frame temporal reuse for fixed-camera video deployments.
+//
+// Consecutive frames from a static camera differ in a handful of tiles,
+// yet the plain path pays a full feature pack and a full invoke for every
+// one of them. ei_ffi_run_classifier_video diffs the incoming frame
+// (after the model-geometry resize) against the frame that produced the
+// last real invoke, tile by tile: a 16x16-pixel tile is dirty when its
+// mean absolute pixel difference exceeds the configured threshold, and
+// when the dirty-tile fraction stays under the frame threshold the invoke
+// is skipped and the prior result is returned with a staleness counter.
+//
+// Two deliberate choices bound the error. The diff runs against the last
+// *invoked* frame, not the last *seen* one, so slow drift accumulates
+// until it trips the threshold instead of hiding under per-frame deltas.
+// And `max_stale` forces a real invoke after that many consecutive skips
+// regardless of the diff, so staleness is bounded in frames even if the
+// thresholds are set generously.
+//
+// This differs from the result cache (result_cache_support.cpp), which
+// needs byte-exact repeats: sensor noise defeats exact matching on real
+// cameras, while the tile diff absorbs it.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+#include "edge-impulse-sdk/dsp/numpy.hpp"
+#include "edge-impulse-sdk/dsp/image/processing.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define EI_FFI_HAVE_NEON 1
+#endif
+
+#if defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define EI_FFI_HAVE_SSE2 1
+#endif
+
+#if EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_CAMERA
+
+namespace {
+
+constexpr int kWidth = EI_CLASSIFIER_INPUT_WIDTH;
+constexpr int kHeight = EI_CLASSIFIER_INPUT_HEIGHT;
+constexpr size_t kPixels = (size_t)kWidth * kHeight;
+constexpr size_t kFrameBytes = kPixels * 3;
+constexpr int kTile = 16; // pixels per tile edge
+
+struct frame_delta {
+    bool enabled = false;
+    float tile_threshold = 0.0f;  // mean abs diff (0..255) per dirty tile
+    float dirty_fraction = 0.0f;  // skip when dirty tiles / tiles <= this
+    uint32_t max_stale = 0;       // force an invoke after this many skips
+    uint32_t stale = 0;
+    bool have_baseline = false;
+    std::vector<uint8_t> baseline; // frame behind the cached result
+    // Detached copy of the last real result (same layout handling as the
+    // result cache: box/cell arrays are copied, label pointers reference
+    // model statics and outlive us).
+    ei_impulse_result_t result;
+    std::vector<ei_impulse_result_bounding_box_t> boxes;
+    std::vector<ei_impulse_result_bounding_box_t> cells;
+};
+
+std::mutex s_delta_mutex;
+frame_delta s_delta;
+std::atomic<uint64_t> s_delta_invokes{0};
+std::atomic<uint64_t> s_delta_skips{0};
+
+// Sum of absolute byte differences over one row segment. SSE2 has this as
+// a single instruction (psadbw); NEON widens through vabdl. The scalar
+// tail is shared by both.
+uint64_t row_sad(const uint8_t* a, const uint8_t* b, size_t n) {
+    uint64_t sad = 0;
+    size_t ix = 0;
+#if defined(EI_FFI_HAVE_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; ix + 16 <= n; ix += 16) {
+        uint8x16_t va = vld1q_u8(a + ix);
+        uint8x16_t vb = vld1q_u8(b + ix);
+        uint8x16_t d = vabdq_u8(va, vb);
+        acc = vpadalq_u16(acc, vpaddlq_u8(d));
+    }
+    sad += vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) +
+           vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#elif defined(EI_FFI_HAVE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (; ix + 16 <= n; ix += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + ix));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + ix));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    sad += lanes[0] + lanes[1];
+#endif
+    for (; ix < n; ix++) {
+        sad += a[ix] > b[ix] ? a[ix] - b[ix] : b[ix] - a[ix];
+    }
+    return sad;
+}
+
+// Fraction of 16x16 tiles whose mean abs diff exceeds the threshold.
+// Caller holds s_delta_mutex.
+float dirty_tile_fraction(const uint8_t* frame) {
+    const int tiles_x = (kWidth + kTile - 1) / kTile;
+    const int tiles_y = (kHeight + kTile - 1) / kTile;
+    int dirty = 0;
+    for (int ty = 0; ty < tiles_y; ty++) {
+        const int y0 = ty * kTile;
+        const int rows = y0 + kTile <= kHeight ? kTile : kHeight - y0;
+        for (int tx = 0; tx < tiles_x; tx++) {
+            const int x0 = tx * kTile;
+            const int cols = x0 + kTile <= kWidth ? kTile : kWidth - x0;
+            const size_t row_bytes = (size_t)cols * 3;
+            uint64_t sad = 0;
+            for (int r = 0; r < rows; r++) {
+                const size_t off = ((size_t)(y0 + r) * kWidth + x0) * 3;
+                sad += row_sad(frame + off, s_delta.baseline.data() + off, row_bytes);
+            }
+            if ((float)sad > s_delta.tile_threshold * (float)(rows * row_bytes)) {
+                dirty++;
+            }
+        }
+    }
+    return (float)dirty / (float)(tiles_x * tiles_y);
+}
+
+void fill_from_cached(ei_impulse_result_t* result) {
+    *result = s_delta.result;
+    result->bounding_boxes =
+        const_cast<ei_impulse_result_bounding_box_t*>(s_delta.boxes.data());
+    result->bounding_boxes_count = (uint32_t)s_delta.boxes.size();
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    result->visual_ad_grid_cells =
+        const_cast<ei_impulse_result_bounding_box_t*>(s_delta.cells.data());
+    result->visual_ad_count = (uint32_t)s_delta.cells.size();
+#endif
+}
+
+void store_cached(const uint8_t* frame, const ei_impulse_result_t* result) {
+    memcpy(s_delta.baseline.data(), frame, kFrameBytes);
+    s_delta.result = *result;
+    s_delta.boxes.clear();
+    if (result->bounding_boxes_count > 0 && result->bounding_boxes != nullptr) {
+        s_delta.boxes.assign(result->bounding_boxes,
+                             result->bounding_boxes + result->bounding_boxes_count);
+    }
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    s_delta.cells.clear();
+    if (result->visual_ad_count > 0 && result->visual_ad_grid_cells != nullptr) {
+        s_delta.cells.assign(result->visual_ad_grid_cells,
+                             result->visual_ad_grid_cells + result->visual_ad_count);
+    }
+#endif
+    s_delta.have_baseline = true;
+    s_delta.stale = 0;
+}
+
+} // namespace
+
+extern "C" {
+
+// Enable the dirty-region pipeline. `tile_threshold` is the mean absolute
+// pixel difference (0..255 scale) above which a 16x16 tile counts as
+// dirty; `dirty_fraction` is the fraction of dirty tiles at or below
+// which the invoke is skipped; `max_stale` bounds consecutive skips.
+// Typical fixed-camera settings: threshold 4-8, fraction 0.02-0.1.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_frame_delta_configure(float tile_threshold, float dirty_fraction, uint32_t max_stale) {
+    if (tile_threshold < 0.0f || dirty_fraction < 0.0f || dirty_fraction > 1.0f ||
+        max_stale == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_delta_mutex);
+    s_delta.enabled = true;
+    s_delta.tile_threshold = tile_threshold;
+    s_delta.dirty_fraction = dirty_fraction;
+    s_delta.max_stale = max_stale;
+    s_delta.stale = 0;
+    s_delta.have_baseline = false;
+    s_delta.baseline.assign(kFrameBytes, 0);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_frame_delta_disable(void) {
+    std::lock_guard<std::mutex> lock(s_delta_mutex);
+    s_delta.enabled = false;
+    s_delta.have_baseline = false;
+    s_delta.baseline.clear();
+    s_delta.baseline.shrink_to_fit();
+    s_delta.boxes.clear();
+    s_delta.cells.clear();
+}
+
+// Cumulative real invokes vs. skipped frames since configure. Output
+// pointers may be NULL.
+__attribute__((visibility("default"))) void ei_ffi_frame_delta_stats(uint64_t* invokes, uint64_t* skips) {
+    if (invokes != nullptr) {
+        *invokes = s_delta_invokes.load(std::memory_order_relaxed);
+    }
+    if (skips != nullptr) {
+        *skips = s_delta_skips.load(std::memory_order_relaxed);
+    }
+}
+
+// Classify a packed RGB888 frame with cross-frame reuse. `stale_out`
+// (optional) reports how many consecutive frames the returned result has
+// been reused for; 0 means this frame paid a real invoke. Without a
+// prior configure this is just resize + pack + classify.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_video(const uint8_t* rgb, int src_width, int src_height, ei_impulse_result_t* result, int* stale_out, int debug) {
+    if (rgb == nullptr || result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    // Model-geometry frame, retained per thread like the prepare-input
+    // scratch so pooled instances don't race on it.
+    static thread_local std::vector<uint8_t> frame;
+    frame.resize(kFrameBytes);
+    if (src_width == kWidth && src_height == kHeight) {
+        memcpy(frame.data(), rgb, kFrameBytes);
+    }
+    else {
+        int res = ei::image::processing::resize_image(rgb, src_width, src_height,
+                                                      frame.data(), kWidth, kHeight, 3);
+        if (res != EIDSP_OK) {
+            return EI_IMPULSE_DSP_ERROR;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_delta_mutex);
+        if (s_delta.enabled && s_delta.have_baseline &&
+            s_delta.stale < s_delta.max_stale &&
+            dirty_tile_fraction(frame.data()) <= s_delta.dirty_fraction) {
+            s_delta.stale++;
+            fill_from_cached(result);
+            if (stale_out != nullptr) {
+                *stale_out = (int)s_delta.stale;
+            }
+            s_delta_skips.fetch_add(1, std::memory_order_relaxed);
+            return EI_IMPULSE_OK;
+        }
+    }
+
+    static thread_local std::vector<float> features;
+    features.resize(kPixels);
+    EI_IMPULSE_ERROR res = ei_ffi_pack_rgb888_features(frame.data(), kPixels, features.data());
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    signal_t signal;
+    if (ei::numpy::signal_from_buffer(features.data(), features.size(), &signal) != 0) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    res = ei_ffi_run_classifier(&signal, result, debug);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    std::lock_guard<std::mutex> lock(s_delta_mutex);
+    if (s_delta.enabled) {
+        store_cached(frame.data(), result);
+    }
+    if (stale_out != nullptr) {
+        *stale_out = 0;
+    }
+    s_delta_invokes.fetch_add(1, std::memory_order_relaxed);
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
+
+#else // !camera sensor
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_frame_delta_configure(float, float, uint32_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_frame_delta_disable(void) {
+}
+
+__attribute__((visibility("default"))) void ei_ffi_frame_delta_stats(uint64_t* invokes, uint64_t* skips) {
+    if (invokes != nullptr) {
+        *invokes = 0;
+    }
+    if (skips != nullptr) {
+        *skips = 0;
+    }
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_video(const uint8_t*, int, int, ei_impulse_result_t*, int*, int) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#endif // camera sensor
@@ -0,0 +1,113 @@
+// TFLite GPU delegate selection for Linux full-TFLite builds.
+//
+// Opt-in (USE_GPU_DELEGATE=1): links libtensorflowlite_gpu_delegate and
+// applies it to each interpreter as it is constructed (build.rs patches
+// tflite_full.h to call ei_ffi_internal_apply_delegate there, next to the
+// profiler attach). This is the middle tier between XNNPACK on the CPU and
+// the TensorRT engine: ~3x CPU throughput without TensorRT's multi-minute
+// engine build at startup.
+//
+// Selection is runtime: ei_ffi_set_delegate(EI_FFI_DELEGATE_GPU) before the
+// first inference (or before re-init) routes the next interpreter through
+// the GPU; EI_FFI_DELEGATE_CPU leaves the stock CPU/XNNPACK path untouched.
+#include "edge_impulse_wrapper.h"
+
+#include <atomic>
+#include <cstdio>
+
+// Defined in xnnpack_cache_support.cpp: attaches the weights-cache-backed
+// XNNPACK delegate to interpreters staying on the CPU path (no-op unless
+// built with USE_XNNPACK_CACHE=1).
+extern "C" void ei_ffi_internal_xnnpack_cache_apply(void* interpreter);
+
+namespace {
+
+static std::atomic<int> s_delegate{EI_FFI_DELEGATE_CPU};
+
+} // namespace
+
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE) && defined(EI_FFI_GPU_DELEGATE)
+
+#include "tensorflow/lite/interpreter.h"
+
+// The GPU delegate library's C entry points; its headers are not vendored,
+// but the ABI is stable and NULL options mean defaults.
+extern "C" TfLiteDelegate* TfLiteGpuDelegateV2Create(const void* options);
+extern "C" void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate);
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_delegate(int delegate) {
+#if defined(EI_FFI_SEALED)
+    // Sealed build: the delegate was fixed at build time (GPU, since the
+    // delegate library is linked in). Accept the baked value, reject the rest.
+    return delegate == EI_FFI_DELEGATE_GPU ? EI_IMPULSE_OK : EI_IMPULSE_INFERENCE_ERROR;
+#else
+    if (delegate != EI_FFI_DELEGATE_CPU && delegate != EI_FFI_DELEGATE_GPU) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_delegate.store(delegate);
+    return EI_IMPULSE_OK;
+#endif
+}
+
+__attribute__((visibility("default"))) int ei_ffi_get_delegate(void) {
+#if defined(EI_FFI_SEALED)
+    return EI_FFI_DELEGATE_GPU;
+#else
+    return s_delegate.load();
+#endif
+}
+
+// Called from the patched tflite_full.h once per interpreter construction.
+__attribute__((visibility("default"))) void ei_ffi_internal_apply_delegate(void* interpreter) {
+#if defined(EI_FFI_SEALED)
+    if (interpreter == nullptr) {
+        return;
+    }
+#else
+    if (s_delegate.load() != EI_FFI_DELEGATE_GPU || interpreter == nullptr) {
+        // CPU path: the XNNPACK weights cache (if compiled in) still
+        // wants to see the interpreter.
+        ei_ffi_internal_xnnpack_cache_apply(interpreter);
+        return;
+    }
+#endif
+    // One delegate instance serves every interpreter in the process.
+    static TfLiteDelegate* gpu_delegate = TfLiteGpuDelegateV2Create(nullptr);
+    if (gpu_delegate == nullptr) {
+        fprintf(stderr, "WARN: GPU delegate creation failed, staying on CPU\n");
+        return;
+    }
+    tflite::Interpreter* interp = static_cast<tflite::Interpreter*>(interpreter);
+    if (interp->ModifyGraphWithDelegate(gpu_delegate) != kTfLiteOk) {
+        fprintf(stderr, "WARN: GPU delegate rejected the graph, staying on CPU\n");
+    }
+}
+
+} // extern "C"
+
+#else // !EI_CLASSIFIER_USE_FULL_TFLITE || !EI_FFI_GPU_DELEGATE
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_delegate(int delegate) {
+    if (delegate == EI_FFI_DELEGATE_CPU) {
+        s_delegate.store(delegate);
+        return EI_IMPULSE_OK;
+    }
+    // GPU delegate not compiled in (build with USE_GPU_DELEGATE=1).
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_get_delegate(void) {
+    return s_delegate.load();
+}
+
+__attribute__((visibility("default"))) void ei_ffi_internal_apply_delegate(void* interpreter) {
+    ei_ffi_internal_xnnpack_cache_apply(interpreter);
+}
+
+} // extern "C"
+
+#endif // EI_CLASSIFIER_USE_FULL_TFLITE && EI_FFI_GPU_DELEGATE
@@ -0,0 +1,158 @@
+// One-shot inference client: the cold half of the ei-infer CLI pair.
+//
+// Deliberately links nothing beyond libc -- no TFLite, no model library,
+// no wrapper header -- so process startup is dynamic-loader noise and the
+// total lifetime is connect + send + print. Pair with ei_infer_daemon
+// (infer_daemon.cpp), which holds the warm interpreter and owns the wire
+// protocol; the constants below mirror its header layout.
+//
+// Usage: ei_infer file.f32 [--socket /run/ei-infer.sock] [--rgb WxH]
+//   default: the file is raw little-endian float32 features
+//   --rgb WxH: the file is a packed RGB888 frame of that geometry
+// Prints the daemon's text rendering of the result; exits non-zero on
+// transport or inference failure.
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const uint32_t kRequestMagic = 0x51494945;  /* "EIIQ" */
+static const uint32_t kResponseMagic = 0x52494945; /* "EIIR" */
+static const uint32_t kKindFeatures = 1;
+static const uint32_t kKindRgb888 = 2;
+
+static int read_full(int fd, void* buf, size_t len) {
+    uint8_t* p = (uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const void* buf, size_t len) {
+    const uint8_t* p = (const uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* socket_path = "/tmp/ei-infer.sock";
+    const char* file_path = NULL;
+    uint32_t kind = kKindFeatures;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    for (int ix = 1; ix < argc; ix++) {
+        if (strcmp(argv[ix], "--socket") == 0 && ix + 1 < argc) {
+            socket_path = argv[++ix];
+        }
+        else if (strcmp(argv[ix], "--rgb") == 0 && ix + 1 < argc) {
+            if (sscanf(argv[++ix], "%ux%u", &width, &height) != 2) {
+                fprintf(stderr, "bad --rgb geometry (want WxH)\n");
+                return 1;
+            }
+            kind = kKindRgb888;
+        }
+        else if (file_path == NULL) {
+            file_path = argv[ix];
+        }
+        else {
+            fprintf(stderr, "usage: %s file [--socket path] [--rgb WxH]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (file_path == NULL) {
+        fprintf(stderr, "usage: %s file [--socket path] [--rgb WxH]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* f = fopen(file_path, "rb");
+    if (f == NULL) {
+        perror(file_path);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size <= 0) {
+        fprintf(stderr, "%s: empty file\n", file_path);
+        fclose(f);
+        return 1;
+    }
+    uint8_t* payload = (uint8_t*)malloc((size_t)size);
+    if (payload == NULL || fread(payload, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "%s: read failed\n", file_path);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return 1;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "%s: %s (is ei_infer_daemon running?)\n",
+                socket_path, strerror(errno));
+        return 1;
+    }
+
+    uint32_t header[5] = { kRequestMagic, kind, width, height, (uint32_t)size };
+    if (write_full(fd, header, sizeof(header)) != 0 ||
+        write_full(fd, payload, (size_t)size) != 0) {
+        fprintf(stderr, "send failed\n");
+        return 1;
+    }
+    free(payload);
+
+    uint32_t response[3];
+    if (read_full(fd, response, sizeof(response)) != 0 || response[0] != kResponseMagic) {
+        fprintf(stderr, "bad response\n");
+        return 1;
+    }
+    if (response[2] > 0) {
+        char* text = (char*)malloc(response[2] + 1);
+        if (text == NULL || read_full(fd, text, response[2]) != 0) {
+            fprintf(stderr, "truncated response\n");
+            return 1;
+        }
+        text[response[2]] = '\0';
+        fputs(text, response[1] == 0 ? stdout : stderr);
+        free(text);
+    }
+    close(fd);
+    return response[1] == 0 ? 0 : 1;
+}
+
+#else /* !(__linux__ || __APPLE__) */
+
+int main(void) {
+    fprintf(stderr, "ei_infer requires Unix domain sockets\n");
+    return 1;
+}
+
+#endif /* __linux__ || __APPLE__ */
@@ -0,0 +1,228 @@
+// One-shot inference daemon: the warm half of the ei-infer CLI pair.
+//
+// Batch scripts that shell out per file pay process startup -- dynamic
+// linking, run_classifier_init, interpreter construction -- for every
+// invocation, which dwarfs the inference itself. This daemon does that
+// work once, parks the warm interpreter behind a Unix domain socket, and
+// answers one-shot requests from the tiny ei_infer client (a plain-POSIX
+// binary with no TFLite linkage, see infer_client.cpp). Requests are
+// served sequentially; the batch use case is serial by nature and one
+// accept loop keeps the daemon trivial.
+//
+// Wire protocol (little-endian uint32 fields):
+//   request:  magic "EIIQ", kind (1 = raw float32 features,
+//             2 = packed RGB888 frame), width, height (kind 2 only,
+//             else 0), payload bytes; then the payload.
+//   response: magic "EIIR", status (EI_IMPULSE_ERROR), text bytes; then
+//             a UTF-8 rendering of the result. Text rather than the
+//             serialized flat buffer so the client needs no knowledge of
+//             result layouts; pipelines that want the EIR0 bytes already
+//             have the SHM bus and HTTP server.
+//
+// Usage: ei_infer_daemon [--socket /run/ei-infer.sock] [--warmup N]
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kRequestMagic = 0x51494945;  // "EIIQ"
+constexpr uint32_t kResponseMagic = 0x52494945; // "EIIR"
+constexpr uint32_t kKindFeatures = 1;
+constexpr uint32_t kKindRgb888 = 2;
+constexpr size_t kMaxPayload = 64 * 1024 * 1024;
+
+const char* kDefaultSocket = "/tmp/ei-infer.sock";
+
+bool read_full(int fd, void* buf, size_t len) {
+    uint8_t* p = (uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+bool write_full(int fd, const void* buf, size_t len) {
+    const uint8_t* p = (const uint8_t*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Render the result the way the examples print it; one line per datum so
+// shell pipelines can grep a label without a JSON parser.
+std::string render_result(const ei_impulse_result_t& result) {
+    std::string text;
+    char line[192];
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        snprintf(line, sizeof(line), "%s: %.5f\n",
+                 result.classification[ix].label, result.classification[ix].value);
+        text += line;
+    }
+    for (uint32_t ix = 0; ix < result.bounding_boxes_count; ix++) {
+        const ei_impulse_result_bounding_box_t& bb = result.bounding_boxes[ix];
+        snprintf(line, sizeof(line), "box %s %.5f %u %u %u %u\n",
+                 bb.label, bb.value, bb.x, bb.y, bb.width, bb.height);
+        text += line;
+    }
+#if EI_CLASSIFIER_HAS_ANOMALY
+    snprintf(line, sizeof(line), "anomaly: %.5f\n", result.anomaly);
+    text += line;
+#endif
+    snprintf(line, sizeof(line), "timing: dsp %d ms, classification %d ms, anomaly %d ms\n",
+             result.timing.dsp, result.timing.classification, result.timing.anomaly);
+    text += line;
+    return text;
+}
+
+void respond(int fd, uint32_t status, const std::string& text) {
+    uint32_t header[3] = { kResponseMagic, status, (uint32_t)text.size() };
+    if (write_full(fd, header, sizeof(header)) && !text.empty()) {
+        write_full(fd, text.data(), text.size());
+    }
+}
+
+void serve_one(int fd) {
+    uint32_t header[5];
+    if (!read_full(fd, header, sizeof(header)) || header[0] != kRequestMagic) {
+        return;
+    }
+    uint32_t kind = header[1];
+    uint32_t width = header[2];
+    uint32_t height = header[3];
+    size_t payload_bytes = header[4];
+    if (payload_bytes == 0 || payload_bytes > kMaxPayload) {
+        respond(fd, (uint32_t)EI_IMPULSE_INFERENCE_ERROR, "bad payload size\n");
+        return;
+    }
+    std::vector<uint8_t> payload(payload_bytes);
+    if (!read_full(fd, payload.data(), payload_bytes)) {
+        return;
+    }
+
+    static std::vector<float> features;
+    if (kind == kKindFeatures) {
+        if (payload_bytes % sizeof(float) != 0) {
+            respond(fd, (uint32_t)EI_IMPULSE_DSP_ERROR, "feature payload not float32\n");
+            return;
+        }
+        features.resize(payload_bytes / sizeof(float));
+        memcpy(features.data(), payload.data(), payload_bytes);
+    }
+    else if (kind == kKindRgb888) {
+#if EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_CAMERA
+        if (width == 0 || height == 0 || payload_bytes != (size_t)width * height * 3) {
+            respond(fd, (uint32_t)EI_IMPULSE_DSP_ERROR, "frame size mismatch\n");
+            return;
+        }
+        features.resize((size_t)EI_CLASSIFIER_INPUT_WIDTH * EI_CLASSIFIER_INPUT_HEIGHT);
+        EI_IMPULSE_ERROR prep = ei_ffi_prepare_image_input(payload.data(), (int)width,
+                                                           (int)height, features.data());
+        if (prep != EI_IMPULSE_OK) {
+            respond(fd, (uint32_t)prep, "image preparation failed\n");
+            return;
+        }
+#else
+        respond(fd, (uint32_t)EI_IMPULSE_DSP_ERROR, "model has no camera input\n");
+        return;
+#endif
+    }
+    else {
+        respond(fd, (uint32_t)EI_IMPULSE_INFERENCE_ERROR, "unknown request kind\n");
+        return;
+    }
+
+    signal_t signal;
+    ei::numpy::signal_from_buffer(features.data(), features.size(), &signal);
+    ei_impulse_result_t result = {};
+    EI_IMPULSE_ERROR res = ei_ffi_run_classifier(&signal, &result, 0);
+    if (res != EI_IMPULSE_OK) {
+        respond(fd, (uint32_t)res, "inference failed\n");
+        return;
+    }
+    respond(fd, 0, render_result(result));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* socket_path = kDefaultSocket;
+    int warmup = 3;
+    for (int ix = 1; ix < argc; ix++) {
+        if (strcmp(argv[ix], "--socket") == 0 && ix + 1 < argc) {
+            socket_path = argv[++ix];
+        }
+        else if (strcmp(argv[ix], "--warmup") == 0 && ix + 1 < argc) {
+            warmup = atoi(argv[++ix]);
+        }
+        else {
+            fprintf(stderr, "usage: %s [--socket path] [--warmup N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // A client vanishing mid-response must not kill the daemon.
+    signal(SIGPIPE, SIG_IGN);
+
+    ei_ffi_run_classifier_init();
+    if (warmup > 0) {
+        ei_ffi_warmup(warmup);
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    unlink(socket_path);
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 16) < 0) {
+        perror("bind");
+        return 1;
+    }
+    printf("ei_infer_daemon: warm, serving on %s\n", socket_path);
+    fflush(stdout);
+
+    for (;;) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        serve_one(fd);
+        close(fd);
+    }
+}
+
+#else // !(__linux__ || __APPLE__)
+
+int main(void) {
+    fprintf(stderr, "ei_infer_daemon requires Unix domain sockets\n");
+    return 1;
+}
+
+#endif // __linux__ || __APPLE__
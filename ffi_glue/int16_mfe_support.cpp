@@ -0,0 +1,285 @@
+// Fixed-point (Q15) MFE audio frontend for quantized models.
+//
+// On cores without a dual-issue FPU pipeline (cortex-a7 class) the float
+// MFE dominates the keyword-spotting cycle budget even though the network
+// itself is int8: every sample goes through an f32 FFT and filterbank only
+// to be quantized at the NN input. This path keeps the heavy math in
+// integers -- a Q15 radix-2 FFT with per-stage scaling and a Q15 sparse
+// mel filterbank with 64-bit accumulators -- and touches floats only once
+// per mel energy for the final dB conversion and normalization (tens of
+// values per slice against tens of thousands of samples through the FFT).
+//
+// Selected at build time (EI_INT16_DSP=1); build.rs only enables it when
+// the model's input tensor is quantized. Mirrors the MFE block's
+// parameters from the impulse's own DSP config at first use, so retuned
+// exports keep working, and feeds the rolling feature matrix straight into
+// run_inference -- the same flow as ei_ffi_run_nn_only. Restrictions:
+// int16 PCM input, a single MFE DSP block, and no moving-average filter
+// over the results (frames are rectangular-windowed, matching MFE v3).
+// Single invoke thread, like the float continuous path it replaces.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(EI_FFI_INT16_DSP)
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Q15 radix-2 FFT
+//
+// In-place complex DIT FFT on int32 lanes holding Q15 values. Every stage
+// halves the data (>> 1 on both butterfly legs), so no stage can overflow
+// and the output carries an overall 1/n scale -- folded back in when the
+// mel energies are converted to dB.
+// ---------------------------------------------------------------------------
+
+struct q15_fft {
+    size_t n = 0;
+    std::vector<int16_t> cos_tab; // Q15 twiddles, n/2 entries
+    std::vector<int16_t> sin_tab;
+    std::vector<uint32_t> bitrev;
+};
+
+void fft_init(q15_fft& f, size_t n) {
+    f.n = n;
+    f.cos_tab.resize(n / 2);
+    f.sin_tab.resize(n / 2);
+    for (size_t ix = 0; ix < n / 2; ix++) {
+        double phi = -2.0 * M_PI * (double)ix / (double)n;
+        f.cos_tab[ix] = (int16_t)lrint(cos(phi) * 32767.0);
+        f.sin_tab[ix] = (int16_t)lrint(sin(phi) * 32767.0);
+    }
+    f.bitrev.resize(n);
+    size_t bits = 0;
+    while (((size_t)1 << bits) < n) {
+        bits++;
+    }
+    for (size_t ix = 0; ix < n; ix++) {
+        size_t rev = 0;
+        for (size_t b = 0; b < bits; b++) {
+            rev |= ((ix >> b) & 1) << (bits - 1 - b);
+        }
+        f.bitrev[ix] = (uint32_t)rev;
+    }
+}
+
+void fft_run(const q15_fft& f, int32_t* re, int32_t* im) {
+    for (size_t ix = 0; ix < f.n; ix++) {
+        size_t rev = f.bitrev[ix];
+        if (rev > ix) {
+            int32_t t = re[ix]; re[ix] = re[rev]; re[rev] = t;
+            t = im[ix]; im[ix] = im[rev]; im[rev] = t;
+        }
+    }
+    for (size_t len = 2; len <= f.n; len <<= 1) {
+        size_t half = len >> 1;
+        size_t step = f.n / len;
+        for (size_t base = 0; base < f.n; base += len) {
+            for (size_t k = 0; k < half; k++) {
+                int32_t wr = f.cos_tab[k * step];
+                int32_t wi = f.sin_tab[k * step];
+                int32_t ar = re[base + k] >> 1;
+                int32_t ai = im[base + k] >> 1;
+                int32_t br = re[base + k + half];
+                int32_t bi = im[base + k + half];
+                int32_t tr = (int32_t)(((int64_t)br * wr - (int64_t)bi * wi) >> 16);
+                int32_t ti = (int32_t)(((int64_t)br * wi + (int64_t)bi * wr) >> 16);
+                re[base + k] = ar + tr;
+                im[base + k] = ai + ti;
+                re[base + k + half] = ar - tr;
+                im[base + k + half] = ai - ti;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Mel filterbank and rolling state
+// ---------------------------------------------------------------------------
+
+struct mel_filter {
+    uint32_t start_bin;
+    std::vector<int16_t> w; // Q15 triangular weights
+};
+
+struct mfe_state {
+    bool ready = false;
+    const ei_model_dsp_t* block = nullptr;
+    const ei_dsp_config_mfe_t* cfg = nullptr;
+    size_t frame_len = 0;    // samples
+    size_t frame_stride = 0; // samples
+    size_t n_frames = 0;     // frames across the full window
+    q15_fft fft;
+    std::vector<mel_filter> filters;
+    std::vector<int16_t> window;   // rolling raw window, zero-warmed
+    std::vector<int32_t> re, im;   // FFT scratch
+    std::vector<float> features;   // n_frames x num_filters, rolling
+    float db_scale = 0.0f;         // maps integer energy back to float power
+};
+
+mfe_state s_mfe;
+
+double hz_to_mel(double hz) {
+    return 2595.0 * log10(1.0 + hz / 700.0);
+}
+
+double mel_to_hz(double mel) {
+    return 700.0 * (pow(10.0, mel / 2595.0) - 1.0);
+}
+
+// Mirror the MFE block's parameters out of the impulse's DSP config.
+bool mfe_init(void) {
+    const ei_impulse_t* impulse = ei_default_impulse.impulse;
+    for (size_t ix = 0; ix < impulse->dsp_blocks_size; ix++) {
+        if (impulse->dsp_blocks[ix].extract_fn == &extract_mfe_features) {
+            s_mfe.block = &impulse->dsp_blocks[ix];
+            s_mfe.cfg = (const ei_dsp_config_mfe_t*)impulse->dsp_blocks[ix].config;
+            break;
+        }
+    }
+    if (s_mfe.cfg == nullptr || impulse->dsp_blocks_size != 1) {
+        return false; // single-MFE-block impulses only
+    }
+
+    double freq = impulse->frequency;
+    s_mfe.frame_len = (size_t)lrint(s_mfe.cfg->frame_length * freq);
+    s_mfe.frame_stride = (size_t)lrint(s_mfe.cfg->frame_stride * freq);
+    size_t fft_n = s_mfe.cfg->fft_length;
+    if (s_mfe.frame_len == 0 || s_mfe.frame_stride == 0 || fft_n == 0 ||
+        (fft_n & (fft_n - 1)) != 0 || s_mfe.frame_len > fft_n) {
+        return false;
+    }
+    fft_init(s_mfe.fft, fft_n);
+    s_mfe.re.resize(fft_n);
+    s_mfe.im.resize(fft_n);
+
+    // Triangular mel filters over the one-sided spectrum, Q15 weights.
+    size_t bins = fft_n / 2 + 1;
+    size_t n_filters = s_mfe.cfg->num_filters;
+    double mel_lo = hz_to_mel(s_mfe.cfg->low_frequency);
+    double mel_hi = hz_to_mel(s_mfe.cfg->high_frequency > 0 ? s_mfe.cfg->high_frequency : freq / 2.0);
+    s_mfe.filters.resize(n_filters);
+    for (size_t fix = 0; fix < n_filters; fix++) {
+        double m_left = mel_lo + (mel_hi - mel_lo) * (double)fix / (double)(n_filters + 1);
+        double m_center = mel_lo + (mel_hi - mel_lo) * (double)(fix + 1) / (double)(n_filters + 1);
+        double m_right = mel_lo + (mel_hi - mel_lo) * (double)(fix + 2) / (double)(n_filters + 1);
+        double hz_per_bin = freq / (double)fft_n;
+        uint32_t b_left = (uint32_t)ceil(mel_to_hz(m_left) / hz_per_bin);
+        uint32_t b_right = (uint32_t)floor(mel_to_hz(m_right) / hz_per_bin);
+        if (b_right >= bins) {
+            b_right = (uint32_t)bins - 1;
+        }
+        s_mfe.filters[fix].start_bin = b_left;
+        for (uint32_t b = b_left; b <= b_right; b++) {
+            double hz = b * hz_per_bin;
+            double mel = hz_to_mel(hz);
+            double w = mel <= m_center ? (mel - m_left) / (m_center - m_left)
+                                       : (m_right - mel) / (m_right - m_center);
+            if (w < 0.0) {
+                w = 0.0;
+            }
+            s_mfe.filters[fix].w.push_back((int16_t)lrint(w * 32767.0));
+        }
+    }
+
+    size_t raw = EI_CLASSIFIER_RAW_SAMPLE_COUNT;
+    s_mfe.n_frames = (raw - s_mfe.frame_len) / s_mfe.frame_stride + 1;
+    if (s_mfe.n_frames * n_filters != s_mfe.block->n_output_features) {
+        return false; // mirrored parameters disagree with the export
+    }
+    s_mfe.window.assign(raw, 0);
+    s_mfe.features.assign(s_mfe.n_frames * n_filters, 0.0f);
+
+    // Integer mel energy -> float power-spectrum scale: samples enter as
+    // Q15 (x * 32768), the FFT carries 1/n, power keeps >> 15, and the
+    // filterbank keeps another >> 15; fold all of it back out here.
+    double n = (double)fft_n;
+    s_mfe.db_scale = (float)((n * n) / (32768.0 * 32768.0) * 2.0);
+    s_mfe.ready = true;
+    return true;
+}
+
+// One frame: Q15 FFT, integer power spectrum, integer filterbank, then a
+// float dB conversion + noise-floor normalization per mel energy.
+void mfe_frame(const int16_t* samples, float* out) {
+    size_t fft_n = s_mfe.fft.n;
+    for (size_t ix = 0; ix < fft_n; ix++) {
+        s_mfe.re[ix] = ix < s_mfe.frame_len ? samples[ix] : 0;
+        s_mfe.im[ix] = 0;
+    }
+    fft_run(s_mfe.fft, s_mfe.re.data(), s_mfe.im.data());
+
+    float noise_floor = (float)s_mfe.cfg->noise_floor_db;
+    for (size_t fix = 0; fix < s_mfe.filters.size(); fix++) {
+        const mel_filter& filt = s_mfe.filters[fix];
+        int64_t acc = 0;
+        for (size_t k = 0; k < filt.w.size(); k++) {
+            size_t b = filt.start_bin + k;
+            int64_t p = ((int64_t)s_mfe.re[b] * s_mfe.re[b] +
+                         (int64_t)s_mfe.im[b] * s_mfe.im[b]) >> 15;
+            acc += (p * filt.w[k]) >> 15;
+        }
+        float energy = (float)acc * s_mfe.db_scale;
+        float db = 10.0f * log10f(energy > 1e-30f ? energy : 1e-30f);
+        float feat = (db - noise_floor) / (-noise_floor + 12.0f);
+        out[fix] = feat < 0.0f ? 0.0f : (feat > 1.0f ? 1.0f : feat);
+    }
+}
+
+} // namespace
+
+// True when this build routes audio DSP through the Q15 path.
+__attribute__((visibility("default"))) bool ei_ffi_int16_dsp_active(void) {
+    return true;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous_i16(const int16_t* samples, size_t n, ei_impulse_result_t* result, int debug) {
+    if (samples == nullptr || result == nullptr || n != EI_CLASSIFIER_SLICE_SIZE) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (!s_mfe.ready && !mfe_init()) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    // Roll the raw window (zero-warmed, so early slices classify against
+    // silence like the float continuous path) and the feature matrix.
+    size_t raw = s_mfe.window.size();
+    memmove(s_mfe.window.data(), s_mfe.window.data() + n, (raw - n) * sizeof(int16_t));
+    memcpy(s_mfe.window.data() + raw - n, samples, n * sizeof(int16_t));
+
+    size_t n_filters = s_mfe.filters.size();
+    size_t new_frames = n / s_mfe.frame_stride;
+    if (new_frames > s_mfe.n_frames) {
+        new_frames = s_mfe.n_frames;
+    }
+    size_t keep = s_mfe.n_frames - new_frames;
+    memmove(s_mfe.features.data(), s_mfe.features.data() + new_frames * n_filters,
+            keep * n_filters * sizeof(float));
+    for (size_t fx = keep; fx < s_mfe.n_frames; fx++) {
+        mfe_frame(s_mfe.window.data() + fx * s_mfe.frame_stride,
+                  s_mfe.features.data() + fx * n_filters);
+    }
+
+    // Borrow the rolling matrix and run the NN, same flow as run_nn_only.
+    ei::matrix_t matrix(1, (uint32_t)s_mfe.features.size(), s_mfe.features.data());
+    ei_feature_t feature = {};
+    feature.matrix = &matrix;
+    feature.blocks_processed = true;
+    return ::run_inference(&ei_default_impulse, &feature, result, debug);
+}
+
+#else // !EI_FFI_INT16_DSP
+
+__attribute__((visibility("default"))) bool ei_ffi_int16_dsp_active(void) {
+    return false;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_run_classifier_continuous_i16(const int16_t*, size_t, ei_impulse_result_t*, int) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+#endif // EI_FFI_INT16_DSP
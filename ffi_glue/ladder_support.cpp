@@ -0,0 +1,174 @@
+// Graceful degradation ladder across impulse variants.
+//
+// Under thermal throttling a fixed model either holds accuracy and lets
+// the frame rate collapse, or the application restarts with a cheaper
+// export. This controller keeps N multi-instance handles -- one per
+// variant, ordered by cost -- and steps between them automatically: it
+// tracks an exponentially-weighted moving average of the invoke time
+// reported in result timing and moves one rung down (cheaper) when the
+// average crosses the frame budget, one rung up when the *projected* time
+// on the costlier rung fits comfortably. Hysteresis comes from the
+// projection margin plus a cooldown after every switch, so the ladder does
+// not oscillate at a threshold.
+//
+// The variants are the caller's business: typically the same impulse
+// hot-swapped or exported at several input resolutions, each behind its
+// own handle. Because rungs may take differently-sized signals, the
+// controller never switches mid-call -- poll ei_ffi_ladder_rung() before
+// preparing each frame's signal. Single invoke thread, like the
+// continuous-mode state it resembles.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct ladder_rung {
+    ei_impulse_handle_t* handle;
+    float est_ms;
+};
+
+struct ladder_state {
+    std::mutex mutex;
+    std::vector<ladder_rung> rungs; // sorted cheapest first
+    size_t current = 0;
+    float ewma_ms = 0.0f;
+    bool primed = false;
+    uint32_t cooldown_left = 0;
+
+    // Tunables; see ei_ffi_ladder_config.
+    float target_ms = 33.3f;
+    float up_margin = 0.8f;
+    uint32_t cooldown = 30;
+};
+
+ladder_state s_ladder;
+
+// Smoothing factor for the invoke-time average. Small enough to ride out
+// single slow frames, large enough to react to throttling within ~a second
+// at camera rates.
+constexpr float kEwmaAlpha = 0.2f;
+
+} // namespace
+
+// Register a variant with its expected invoke time. Rungs are kept sorted
+// cheapest-first regardless of registration order; the ladder starts on
+// the most expensive (most accurate) rung.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_ladder_add(ei_impulse_handle_t* handle, float est_ms) {
+    if (handle == nullptr || est_ms <= 0.0f) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_ladder.mutex);
+    size_t pos = 0;
+    while (pos < s_ladder.rungs.size() && s_ladder.rungs[pos].est_ms < est_ms) {
+        pos++;
+    }
+    s_ladder.rungs.insert(s_ladder.rungs.begin() + pos, ladder_rung{ handle, est_ms });
+    s_ladder.current = s_ladder.rungs.size() - 1;
+    s_ladder.ewma_ms = 0.0f;
+    s_ladder.primed = false;
+    s_ladder.cooldown_left = 0;
+    return EI_IMPULSE_OK;
+}
+
+// target_ms: the frame budget the ladder defends. up_margin: step up only
+// when the projected time on the costlier rung stays under
+// target_ms * up_margin (default 0.8, the hysteresis band).
+// cooldown_invokes: invokes to wait after any switch before switching
+// again (default 30), so one decision settles before the next.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_ladder_config(float target_ms, float up_margin, uint32_t cooldown_invokes) {
+    if (target_ms <= 0.0f || up_margin <= 0.0f || up_margin >= 1.0f) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_ladder.mutex);
+    s_ladder.target_ms = target_ms;
+    s_ladder.up_margin = up_margin;
+    s_ladder.cooldown = cooldown_invokes;
+    return EI_IMPULSE_OK;
+}
+
+// The rung the next ei_ffi_ladder_run call will use (0 = cheapest), or -1
+// with no rungs registered. Poll before preparing the frame's signal:
+// rungs may take differently-sized inputs.
+__attribute__((visibility("default"))) int ei_ffi_ladder_rung(void) {
+    std::lock_guard<std::mutex> lock(s_ladder.mutex);
+    if (s_ladder.rungs.empty()) {
+        return -1;
+    }
+    return (int)s_ladder.current;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_ladder_run(signal_t* signal, ei_impulse_result_t* result, int debug) {
+    if (signal == nullptr || result == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    ei_impulse_handle_t* handle;
+    {
+        std::lock_guard<std::mutex> lock(s_ladder.mutex);
+        if (s_ladder.rungs.empty()) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        handle = s_ladder.rungs[s_ladder.current].handle;
+    }
+
+    EI_IMPULSE_ERROR res = ei_ffi_run_classifier_on(handle, signal, result, debug);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+
+    float invoke_ms = (float)(result->timing.dsp_us + result->timing.classification_us +
+                              result->timing.anomaly_us) / 1000.0f;
+
+    std::lock_guard<std::mutex> lock(s_ladder.mutex);
+    if (!s_ladder.primed) {
+        s_ladder.ewma_ms = invoke_ms;
+        s_ladder.primed = true;
+    }
+    else {
+        s_ladder.ewma_ms += kEwmaAlpha * (invoke_ms - s_ladder.ewma_ms);
+    }
+
+    if (s_ladder.cooldown_left > 0) {
+        s_ladder.cooldown_left--;
+        return res;
+    }
+
+    const ladder_rung& cur = s_ladder.rungs[s_ladder.current];
+    if (s_ladder.ewma_ms > s_ladder.target_ms && s_ladder.current > 0) {
+        // Over budget: step down to the next cheaper variant.
+        s_ladder.current--;
+        s_ladder.cooldown_left = s_ladder.cooldown;
+        // Scale the average by the cost ratio so the new rung is not judged
+        // on the old rung's numbers while the EWMA refills.
+        s_ladder.ewma_ms *= s_ladder.rungs[s_ladder.current].est_ms / cur.est_ms;
+    }
+    else if (s_ladder.current + 1 < s_ladder.rungs.size()) {
+        // Project the measured average onto the costlier rung via the
+        // registered cost ratio; step up only when it fits with margin.
+        const ladder_rung& up = s_ladder.rungs[s_ladder.current + 1];
+        float projected_ms = s_ladder.ewma_ms * (up.est_ms / cur.est_ms);
+        if (projected_ms < s_ladder.target_ms * s_ladder.up_margin) {
+            s_ladder.current++;
+            s_ladder.cooldown_left = s_ladder.cooldown;
+            s_ladder.ewma_ms = projected_ms;
+        }
+    }
+    return res;
+}
+
+// Forget all rungs and tunables. Does not destroy the handles; they belong
+// to the caller.
+__attribute__((visibility("default"))) void ei_ffi_ladder_reset(void) {
+    std::lock_guard<std::mutex> lock(s_ladder.mutex);
+    s_ladder.rungs.clear();
+    s_ladder.current = 0;
+    s_ladder.ewma_ms = 0.0f;
+    s_ladder.primed = false;
+    s_ladder.cooldown_left = 0;
+    s_ladder.target_ms = 33.3f;
+    s_ladder.up_margin = 0.8f;
+    s_ladder.cooldown = 30;
+}
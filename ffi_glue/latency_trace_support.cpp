@@ -0,0 +1,124 @@
+// End-to-end latency budget trace.
+//
+// result->timing says how long the stages took; an SLA is argued in
+// absolute terms -- capture happened at T, the decision left at
+// T + 100 ms, where did the time go? The caller stamps the signal with
+// its capture time, the classify wrappers note when the frame was
+// submitted, when processing started and when the result was delivered,
+// and the SDK's per-stage durations pin DSP/NN/anomaly inside that span.
+//
+// Everything rides thread-local state, same scheme as ei_ffi_last_error:
+// the pending stamp is consumed by the next classify of that signal on
+// the stamping thread (async submissions hand it to the worker alongside
+// the trace id), and the finished budget is read back on the thread that
+// delivered the result -- the callback thread for async. Frames without
+// a stamp pay one thread-local pointer compare and nothing else.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+struct pending_stamp {
+    const void* signal = nullptr;
+    uint64_t capture_ns = 0;
+    uint64_t submit_ns = 0;
+};
+
+thread_local pending_stamp t_pending;
+thread_local uint64_t t_start_ns = 0; // in-flight frame; 0 when unstamped
+thread_local ei_ffi_latency_trace_t t_budget;
+thread_local bool t_budget_valid = false;
+
+uint64_t now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+extern "C" {
+
+// Stamp a signal with its capture time (CLOCK_MONOTONIC domain -- the
+// same clock the glue reads). One stamp is pending per thread; classify
+// the stamped signal next on this thread, or submit it async.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_signal_set_capture_time(signal_t* signal, uint64_t t_ns) {
+    if (signal == nullptr || t_ns == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    t_pending.signal = signal;
+    t_pending.capture_ns = t_ns;
+    t_pending.submit_ns = 0;
+    return EI_IMPULSE_OK;
+}
+
+// Budget of the last stamped frame delivered on this thread.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_latency_trace(ei_ffi_latency_trace_t* out) {
+    if (out == nullptr || !t_budget_valid) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    memcpy(out, &t_budget, sizeof(*out));
+    return EI_IMPULSE_OK;
+}
+
+// Called from the classify wrappers at entry. Processing of an unstamped
+// (or different) signal leaves the in-flight mark clear, so note_done
+// becomes a no-op for it.
+__attribute__((visibility("default"))) void ei_ffi_internal_latency_note_start(const void* signal) {
+    if (t_pending.signal != signal || signal == nullptr) {
+        t_start_ns = 0;
+        return;
+    }
+    t_start_ns = now_ns();
+    if (t_pending.submit_ns == 0) {
+        // Synchronous path: handed to the glue the moment it started.
+        t_pending.submit_ns = t_start_ns;
+    }
+}
+
+// Called after a successful classify with the delivered result; folds the
+// SDK's stage durations into the absolute span and publishes the budget.
+__attribute__((visibility("default"))) void ei_ffi_internal_latency_note_done(const ei_impulse_result_t* result) {
+    if (t_start_ns == 0) {
+        return;
+    }
+    uint64_t done = now_ns();
+    t_budget.capture_ns = t_pending.capture_ns;
+    t_budget.submit_ns = t_pending.submit_ns;
+    t_budget.start_ns = t_start_ns;
+    t_budget.done_ns = done;
+    t_budget.queue_us = (t_start_ns - t_pending.submit_ns) / 1000;
+    t_budget.dsp_us = (uint64_t)result->timing.dsp_us;
+    t_budget.classification_us = (uint64_t)result->timing.classification_us;
+    t_budget.anomaly_us = (uint64_t)result->timing.anomaly_us;
+    t_budget.total_us = done > t_budget.capture_ns ? (done - t_budget.capture_ns) / 1000 : 0;
+    t_budget_valid = true;
+    t_pending = pending_stamp{};
+    t_start_ns = 0;
+}
+
+// Async handoff, submitter side: if this signal is stamped on the calling
+// thread, consume the stamp (submit time = now, i.e. enqueue) and return
+// 1 with both times written; 0 leaves the outputs untouched.
+__attribute__((visibility("default"))) int ei_ffi_internal_latency_depart(const void* signal, uint64_t* capture_ns, uint64_t* submit_ns) {
+    if (signal == nullptr || t_pending.signal != signal) {
+        return 0;
+    }
+    *capture_ns = t_pending.capture_ns;
+    *submit_ns = now_ns();
+    t_pending = pending_stamp{};
+    return 1;
+}
+
+// Async handoff, worker side: re-arm the stamp on the worker thread
+// before the classify runs there.
+__attribute__((visibility("default"))) void ei_ffi_internal_latency_adopt(const void* signal, uint64_t capture_ns, uint64_t submit_ns) {
+    t_pending.signal = signal;
+    t_pending.capture_ns = capture_ns;
+    t_pending.submit_ns = submit_ns;
+}
+
+} // extern "C"
@@ -0,0 +1,29 @@
+// Lean operator resolver for full TensorFlow Lite builds.
+//
+// The stock BuiltinOpResolver registers every builtin kernel, which costs
+// binary size and registration time. With EI_FFI_LEAN_OPS defined, build.rs
+// patches tflite_full.h to build the interpreter from a MutableOpResolver
+// populated here, from the X-macro op list in model/model_ops.inc:
+//
+//     EI_FFI_TFLITE_OP(FULLY_CONNECTED, Register_FULLY_CONNECTED)
+//     EI_FFI_TFLITE_OP(SOFTMAX, Register_SOFTMAX)
+//     ...
+//
+// The list is the model's actual op census (read it off the deployment's
+// .tflite with any flatbuffer viewer). A missing op fails fast at
+// AllocateTensors() with a clear "op not found" error, not a silent
+// misprediction.
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE) && defined(EI_FFI_LEAN_OPS)
+
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/mutable_op_resolver.h"
+
+void ei_ffi_register_selected_ops(tflite::MutableOpResolver* resolver) {
+#define EI_FFI_TFLITE_OP(op_enum, registration)                                \
+    resolver->AddBuiltin(::tflite::BuiltinOperator_##op_enum,                  \
+                         ::tflite::ops::builtin::registration());
+#include "model_ops.inc"
+#undef EI_FFI_TFLITE_OP
+}
+
+#endif // EI_CLASSIFIER_USE_FULL_TFLITE && EI_FFI_LEAN_OPS
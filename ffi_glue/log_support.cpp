@@ -0,0 +1,199 @@
+// Log routing for the porting layer's ei_printf.
+//
+// Compile-time stripping is handled separately: build.rs maps
+// EI_LOG_LEVEL=none|error|warn|info|debug onto the SDK's EI_LOG_LEVEL
+// macro, which compiles EI_LOGE/W/I/D call sites down to nothing below the
+// chosen level. Whatever still prints funnels through ei_printf, which is a
+// weak symbol on POSIX targets; the strong definition here hands each
+// formatted line to a registered callback so hosts can route SDK output
+// into their own logger instead of stdout.
+//
+// Two delivery modes. ei_ffi_set_log_callback is synchronous: the callback
+// runs on the emitting thread, inside the frame. ei_ffi_set_log_sink is
+// the bounded-latency variant for production: lines go into a preallocated
+// lock-free MPSC ring and a background thread hands them to the sink, so a
+// burst of SDK warnings costs the hot path a format plus one CAS per line
+// -- never a stdio lock, never a blocked frame. On overflow records are
+// dropped, not blocked; ei_ffi_log_sink_dropped counts them.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Long enough for any line the SDK emits; longer lines are truncated.
+constexpr size_t kLogLineMax = 512;
+
+std::atomic<ei_ffi_log_fn> s_log_callback{nullptr};
+
+// ---------------------------------------------------------------------------
+// Buffered sink: bounded MPSC ring (Vyukov-style sequence cells).
+//
+// Producers claim a slot with one CAS on the head counter and stamp the
+// cell's sequence when the text is written; the single consumer (the drain
+// thread) advances the tail only past stamped cells, so a producer that is
+// mid-write never blocks the drain of earlier records. A full ring fails
+// the claim immediately -- the record is counted and dropped, keeping the
+// hot-path cost bounded regardless of how far the sink has fallen behind.
+
+constexpr size_t kSinkRingSize = 1024; // records; power of two
+constexpr size_t kSinkLineMax = 256;   // ring records are shorter than the
+                                       // sync path; warnings fit, dumps wrap
+
+struct log_cell {
+    std::atomic<size_t> seq;
+    char line[kSinkLineMax];
+};
+
+struct log_sink {
+    std::atomic<ei_ffi_log_fn> fn{nullptr}; // drainer reads, swaps race it
+    log_cell* ring = nullptr;
+    std::atomic<size_t> head{0};
+    size_t tail = 0; // consumer-owned
+    std::thread drainer;
+    std::atomic<bool> running{false};
+};
+
+log_sink s_sink;
+std::mutex s_sink_mutex; // control plane only (set/clear)
+std::atomic<bool> s_sink_active{false};
+std::atomic<uint64_t> s_sink_dropped{0};
+
+// Producer side: claim, copy, stamp. Returns false on overflow.
+bool sink_enqueue(const char* line) {
+    size_t pos = s_sink.head.load(std::memory_order_relaxed);
+    for (;;) {
+        log_cell* cell = &s_sink.ring[pos & (kSinkRingSize - 1)];
+        const size_t seq = cell->seq.load(std::memory_order_acquire);
+        const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (s_sink.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                strncpy(cell->line, line, kSinkLineMax - 1);
+                cell->line[kSinkLineMax - 1] = '\0';
+                cell->seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+            // CAS failure reloaded pos; retry against the new slot.
+        }
+        else if (dif < 0) {
+            return false; // ring full: drop, never block
+        }
+        else {
+            pos = s_sink.head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Consumer side: drain every stamped record. Only the drain thread (and
+// the final flush under the control mutex) calls this.
+void sink_drain(ei_ffi_log_fn fn) {
+    for (;;) {
+        log_cell* cell = &s_sink.ring[s_sink.tail & (kSinkRingSize - 1)];
+        const size_t seq = cell->seq.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(s_sink.tail + 1) != 0) {
+            return; // empty, or the next producer hasn't stamped yet
+        }
+        fn(cell->line);
+        cell->seq.store(s_sink.tail + kSinkRingSize, std::memory_order_release);
+        s_sink.tail++;
+    }
+}
+
+void sink_thread_main() {
+    while (s_sink.running.load(std::memory_order_acquire)) {
+        sink_drain(s_sink.fn.load(std::memory_order_acquire));
+        // Plain polling: a producer-side notify would reintroduce a lock
+        // on the hot path, and 1 ms of delivery latency is irrelevant for
+        // log lines.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    sink_drain(s_sink.fn.load(std::memory_order_acquire)); // final flush
+}
+
+} // namespace
+
+// Strong override of the porting layer's weak ei_printf. Without a callback
+// this matches the default implementation (vprintf to stdout), so behavior
+// only changes once a host registers one.
+void ei_printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (s_sink_active.load(std::memory_order_acquire)) {
+        char line[kLogLineMax];
+        vsnprintf(line, sizeof(line), format, args);
+        if (!sink_enqueue(line)) {
+            s_sink_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    else {
+        ei_ffi_log_fn callback = s_log_callback.load(std::memory_order_acquire);
+        if (callback != nullptr) {
+            char line[kLogLineMax];
+            vsnprintf(line, sizeof(line), format, args);
+            callback(line);
+        }
+        else {
+            vprintf(format, args);
+        }
+    }
+    va_end(args);
+}
+
+extern "C" {
+
+// Register a sink for SDK log output; NULL restores stdout. Safe to call
+// while inference threads run. The callback runs synchronously on the
+// emitting thread; use ei_ffi_set_log_sink when that thread's latency
+// matters.
+__attribute__((visibility("default"))) void ei_ffi_set_log_callback(ei_ffi_log_fn callback) {
+    s_log_callback.store(callback, std::memory_order_release);
+}
+
+// Register a buffered sink: lines are queued into a preallocated ring and
+// delivered on a background thread, so the emitting thread pays a bounded
+// cost per line regardless of where the sink writes. NULL stops the drain
+// thread (flushing what is queued) and restores the synchronous path.
+// Takes precedence over ei_ffi_set_log_callback while active.
+__attribute__((visibility("default"))) void ei_ffi_set_log_sink(ei_ffi_log_fn sink) {
+    std::lock_guard<std::mutex> lock(s_sink_mutex);
+    if (s_sink.running.load(std::memory_order_acquire)) {
+        // Producers keep queueing through the swap; only delivery moves.
+        if (sink != nullptr) {
+            s_sink.fn.store(sink, std::memory_order_release);
+            return;
+        }
+        s_sink_active.store(false, std::memory_order_release);
+        s_sink.running.store(false, std::memory_order_release);
+        s_sink.drainer.join();
+        return;
+    }
+    if (sink == nullptr) {
+        return;
+    }
+    if (s_sink.ring == nullptr) {
+        s_sink.ring = new log_cell[kSinkRingSize];
+        for (size_t ix = 0; ix < kSinkRingSize; ix++) {
+            s_sink.ring[ix].seq.store(ix, std::memory_order_relaxed);
+        }
+    }
+    s_sink.fn.store(sink, std::memory_order_release);
+    s_sink.running.store(true, std::memory_order_release);
+    s_sink.drainer = std::thread(sink_thread_main);
+    s_sink_active.store(true, std::memory_order_release);
+}
+
+// Records dropped because the ring was full (cumulative). A nonzero value
+// means the sink can't keep up with burst rate; it never means a frame
+// was delayed.
+__attribute__((visibility("default"))) uint64_t ei_ffi_log_sink_dropped(void) {
+    return s_sink_dropped.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
@@ -0,0 +1,280 @@
+// Differential model updates for OTA weight deployment.
+//
+// Retrains change weight values, not topology, and the flatbuffer
+// serializer lays an unchanged graph out identically -- so the byte
+// ranges that differ between consecutive model files are the retrained
+// tensor buffers, a small fraction of the file. The delta format encodes
+// exactly that: a run-length stream of "same as base" skips and literal
+// replacements at matching offsets, no window search needed.
+//
+// Format "EID1" (all little-endian):
+//   header: magic u32, base_size u64, new_size u64,
+//           base_hash u64, new_hash u64           (FNV-1a 64)
+//   ops:    { kind u32 (0 = copy from base, 1 = literal), length u32,
+//             [literal bytes] } until the output reaches new_size
+//
+// ei_ffi_model_delta_create and the build.rs emitter write the same
+// format; keeping a generator in the glue means a device can also diff
+// locally (e.g. against its running copy) without the host toolchain.
+// The applier verifies the base hash before writing and the output hash
+// before renaming into place, so a corrupted download or wrong base can
+// never become the file the hot-swap path maps.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kDeltaMagic = 0x31444945; // "EID1"
+constexpr uint32_t kOpCopy = 0;
+constexpr uint32_t kOpLiteral = 1;
+
+// Matching runs shorter than this are folded into the surrounding
+// literals: two op headers cost more than 16 raw bytes.
+constexpr size_t kMinCopyRun = 16;
+
+uint64_t fnv1a64(const uint8_t* data, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t ix = 0; ix < len; ix++) {
+        hash ^= data[ix];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool read_file(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(f);
+        return false;
+    }
+    out.resize((size_t)size);
+    bool ok = size == 0 || fread(out.data(), 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+
+// Write to <path>.tmp and rename into place, so a power cut mid-write
+// never leaves a truncated file under the final name.
+bool write_file_atomic(const char* path, const uint8_t* data, size_t len) {
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (f == nullptr) {
+        return false;
+    }
+    bool ok = len == 0 || fwrite(data, 1, len, f) == len;
+    ok = fflush(f) == 0 && ok;
+    ok = fsync(fileno(f)) == 0 && ok;
+    fclose(f);
+    if (!ok || rename(tmp.c_str(), path) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+    out.insert(out.end(), (const uint8_t*)&v, (const uint8_t*)&v + sizeof(v));
+}
+
+void put_u64(std::vector<uint8_t>& out, uint64_t v) {
+    out.insert(out.end(), (const uint8_t*)&v, (const uint8_t*)&v + sizeof(v));
+}
+
+} // namespace
+
+extern "C" {
+
+// Diff `new_path` against `base_path` into `delta_path`. Sequential
+// same-offset comparison: O(n), no heuristics, exact output.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_model_delta_create(const char* base_path, const char* new_path, const char* delta_path) {
+    if (base_path == nullptr || new_path == nullptr || delta_path == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::vector<uint8_t> base;
+    std::vector<uint8_t> fresh;
+    if (!read_file(base_path, base) || !read_file(new_path, fresh)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    std::vector<uint8_t> delta;
+    delta.reserve(4096);
+    put_u32(delta, kDeltaMagic);
+    put_u64(delta, base.size());
+    put_u64(delta, fresh.size());
+    put_u64(delta, fnv1a64(base.data(), base.size()));
+    put_u64(delta, fnv1a64(fresh.data(), fresh.size()));
+
+    const size_t common = base.size() < fresh.size() ? base.size() : fresh.size();
+    size_t pos = 0;
+    while (pos < fresh.size()) {
+        // Length of the matching run at pos (0 past the base's end).
+        size_t match = pos;
+        while (match < common && base[match] == fresh[match]) {
+            match++;
+        }
+        size_t match_len = match - pos;
+        if (match_len >= kMinCopyRun || (match_len > 0 && match == fresh.size())) {
+            put_u32(delta, kOpCopy);
+            put_u32(delta, (uint32_t)match_len);
+            pos = match;
+            continue;
+        }
+        // Literal run: differing bytes plus any sub-threshold matches,
+        // until a worthwhile copy run (or the end) shows up.
+        size_t lit_end = pos + match_len;
+        while (lit_end < fresh.size()) {
+            if (lit_end >= common || base[lit_end] != fresh[lit_end]) {
+                lit_end++;
+                continue;
+            }
+            size_t run = lit_end;
+            while (run < common && base[run] == fresh[run]) {
+                run++;
+            }
+            if (run - lit_end >= kMinCopyRun || run == fresh.size()) {
+                break;
+            }
+            lit_end = run;
+        }
+        put_u32(delta, kOpLiteral);
+        put_u32(delta, (uint32_t)(lit_end - pos));
+        delta.insert(delta.end(), fresh.begin() + pos, fresh.begin() + lit_end);
+        pos = lit_end;
+    }
+
+    return write_file_atomic(delta_path, delta.data(), delta.size())
+               ? EI_IMPULSE_OK
+               : EI_IMPULSE_INFERENCE_ERROR;
+}
+
+// Reconstruct the new model at `out_path` from `base_path` + `delta_path`.
+// Fails -- leaving out_path untouched -- on a base mismatch, a malformed
+// delta, or an output hash mismatch.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_model_delta_apply(const char* base_path, const char* delta_path, const char* out_path) {
+    if (base_path == nullptr || delta_path == nullptr || out_path == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::vector<uint8_t> base;
+    std::vector<uint8_t> delta;
+    if (!read_file(base_path, base) || !read_file(delta_path, delta)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (delta.size() < 4 + 4 * 8) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    size_t cursor = 0;
+    auto get_u32 = [&](uint32_t* v) {
+        if (cursor + sizeof(*v) > delta.size()) {
+            return false;
+        }
+        memcpy(v, delta.data() + cursor, sizeof(*v));
+        cursor += sizeof(*v);
+        return true;
+    };
+    auto get_u64 = [&](uint64_t* v) {
+        if (cursor + sizeof(*v) > delta.size()) {
+            return false;
+        }
+        memcpy(v, delta.data() + cursor, sizeof(*v));
+        cursor += sizeof(*v);
+        return true;
+    };
+
+    uint32_t magic;
+    uint64_t base_size, new_size, base_hash, new_hash;
+    if (!get_u32(&magic) || magic != kDeltaMagic ||
+        !get_u64(&base_size) || !get_u64(&new_size) ||
+        !get_u64(&base_hash) || !get_u64(&new_hash)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (base.size() != base_size ||
+        fnv1a64(base.data(), base.size()) != base_hash) {
+        ei_printf("ERR: model delta: base file does not match the delta's base\n");
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    std::vector<uint8_t> fresh;
+    fresh.reserve((size_t)new_size);
+    while (fresh.size() < new_size) {
+        uint32_t kind, length;
+        if (!get_u32(&kind) || !get_u32(&length) ||
+            fresh.size() + length > new_size) {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        if (kind == kOpCopy) {
+            if (fresh.size() + length > base.size()) {
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+            fresh.insert(fresh.end(), base.begin() + fresh.size(),
+                         base.begin() + fresh.size() + length);
+        }
+        else if (kind == kOpLiteral) {
+            if (cursor + length > delta.size()) {
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+            fresh.insert(fresh.end(), delta.begin() + cursor,
+                         delta.begin() + cursor + length);
+            cursor += length;
+        }
+        else {
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+    }
+    if (fnv1a64(fresh.data(), fresh.size()) != new_hash) {
+        ei_printf("ERR: model delta: reconstructed model failed hash check\n");
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    return write_file_atomic(out_path, fresh.data(), fresh.size())
+               ? EI_IMPULSE_OK
+               : EI_IMPULSE_INFERENCE_ERROR;
+}
+
+// OTA convenience: apply the delta and hot-swap the result in one call.
+// Same quiesce contract as ei_ffi_hot_swap_model; on any delta failure
+// the running model is left untouched.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_model_delta_update(uint32_t learn_block_index, const char* base_path, const char* delta_path, const char* out_path) {
+    EI_IMPULSE_ERROR res = ei_ffi_model_delta_apply(base_path, delta_path, out_path);
+    if (res != EI_IMPULSE_OK) {
+        return res;
+    }
+    return ei_ffi_hot_swap_model(learn_block_index, out_path);
+}
+
+} // extern "C"
+
+#else // !(__linux__ || __APPLE__)
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_model_delta_create(const char*, const char*, const char*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_model_delta_apply(const char*, const char*, const char*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_model_delta_update(uint32_t, const char*, const char*, const char*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#endif // __linux__ || __APPLE__
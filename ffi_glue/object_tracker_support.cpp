@@ -0,0 +1,295 @@
+// Object tracking with spatially-indexed association.
+//
+// The SDK's object-tracking block matches every live track against every
+// detection, which is O(tracks x detections) per frame and dominates the
+// NN cost in crowded scenes. This tracker buckets detection centroids into
+// a uniform hash grid sized so that any overlapping pair lands within one
+// cell of each other; each track then scores IoU only against detections
+// in the 3x3 neighborhood of its own centroid cell. Candidate pairs are
+// matched greedily by descending IoU, so per-frame cost stays linear in
+// tracks + detections instead of their product.
+//
+// Inputs are planar (structure-of-arrays) box coordinates, same convention
+// as ei_ffi_nms; feed it the kept boxes straight out of NMS.
+#include "edge_impulse_wrapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct track {
+    uint32_t id = 0;
+    uint32_t label_id = 0;
+    float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    float score = 0;
+    uint32_t age = 0;
+    uint32_t missed = 0;
+};
+
+struct tracker {
+    std::mutex mutex;
+    std::vector<track> tracks;
+    float iou_threshold = 0.5f;
+    uint32_t keep_grace = 3;
+    uint16_t max_observations = 50;
+    uint32_t next_id = 1;
+    // Last state handed out by ei_ffi_get_result_delta, keyed by track id.
+    std::unordered_map<uint32_t, track> reported;
+};
+
+static tracker s_tracker;
+
+struct candidate_pair {
+    float iou;
+    uint32_t track_ix;
+    uint32_t det_ix;
+};
+
+float box_iou(const track& t, float dx0, float dy0, float dx1, float dy1) {
+    float ix0 = std::max(t.x0, dx0);
+    float iy0 = std::max(t.y0, dy0);
+    float ix1 = std::min(t.x1, dx1);
+    float iy1 = std::min(t.y1, dy1);
+    float iw = std::max(ix1 - ix0, 0.0f);
+    float ih = std::max(iy1 - iy0, 0.0f);
+    float inter = iw * ih;
+    float uni = (t.x1 - t.x0) * (t.y1 - t.y0) + (dx1 - dx0) * (dy1 - dy0) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+// Pack a signed cell coordinate pair into one hash key.
+uint64_t cell_key(int32_t cx, int32_t cy) {
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+void fill_track_out(ei_ffi_track_t& out, const track& t) {
+    out.track_id = t.id;
+    out.label_id = t.label_id;
+    out.x0 = t.x0;
+    out.y0 = t.y0;
+    out.x1 = t.x1;
+    out.y1 = t.y1;
+    out.score = t.score;
+    out.age = t.age;
+    out.missed = t.missed;
+}
+
+} // namespace
+
+extern "C" {
+
+// Configure the tracker. `iou_threshold` is the minimum overlap for a
+// detection to continue a track, `keep_grace` how many consecutive frames
+// a track survives unmatched, `max_observations` the live-track cap
+// (the same knobs as the SDK's object-tracking config).
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_tracker_init(float iou_threshold, uint32_t keep_grace, uint16_t max_observations) {
+    std::lock_guard<std::mutex> lock(s_tracker.mutex);
+    s_tracker.tracks.clear();
+    s_tracker.reported.clear();
+    s_tracker.iou_threshold = iou_threshold;
+    s_tracker.keep_grace = keep_grace;
+    s_tracker.max_observations = max_observations > 0 ? max_observations : 50;
+    s_tracker.next_id = 1;
+    return EI_IMPULSE_OK;
+}
+
+// Advance the tracker by one frame of detections (planar box coordinates,
+// as produced by ei_ffi_nms). Matched tracks take the detection's box and
+// score; unmatched detections open new tracks while under the cap;
+// unmatched tracks linger for keep_grace frames. Writes up to
+// `tracks_capacity` live tracks into `tracks_out` and returns the number
+// written.
+__attribute__((visibility("default"))) size_t ei_ffi_tracker_update(const float* x0, const float* y0, const float* x1, const float* y1, const float* scores, const uint32_t* label_ids, size_t n, ei_ffi_track_t* tracks_out, size_t tracks_capacity) {
+    if ((n > 0 && (x0 == nullptr || y0 == nullptr || x1 == nullptr || y1 == nullptr || scores == nullptr)) ||
+        tracks_out == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(s_tracker.mutex);
+
+    // Grid cell edge: the largest box dimension in play. Any pair of boxes
+    // with nonzero IoU then has centroids at most one cell apart, so the
+    // 3x3 neighborhood probe below cannot miss a valid match.
+    float cell = 0.0f;
+    for (size_t ix = 0; ix < n; ix++) {
+        cell = std::max(cell, std::max(x1[ix] - x0[ix], y1[ix] - y0[ix]));
+    }
+    for (const track& t : s_tracker.tracks) {
+        cell = std::max(cell, std::max(t.x1 - t.x0, t.y1 - t.y0));
+    }
+    if (cell <= 0.0f) {
+        cell = 1.0f;
+    }
+
+    // Bucket detection centroids.
+    std::unordered_map<uint64_t, std::vector<uint32_t>> grid;
+    grid.reserve(n * 2);
+    for (size_t ix = 0; ix < n; ix++) {
+        int32_t cx = (int32_t)std::floor(0.5f * (x0[ix] + x1[ix]) / cell);
+        int32_t cy = (int32_t)std::floor(0.5f * (y0[ix] + y1[ix]) / cell);
+        grid[cell_key(cx, cy)].push_back((uint32_t)ix);
+    }
+
+    // Score each track against nearby detections only.
+    std::vector<candidate_pair> pairs;
+    for (size_t tix = 0; tix < s_tracker.tracks.size(); tix++) {
+        const track& t = s_tracker.tracks[tix];
+        int32_t cx = (int32_t)std::floor(0.5f * (t.x0 + t.x1) / cell);
+        int32_t cy = (int32_t)std::floor(0.5f * (t.y0 + t.y1) / cell);
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dx = -1; dx <= 1; dx++) {
+                auto it = grid.find(cell_key(cx + dx, cy + dy));
+                if (it == grid.end()) {
+                    continue;
+                }
+                for (uint32_t dix : it->second) {
+                    if (label_ids != nullptr && label_ids[dix] != t.label_id) {
+                        continue;
+                    }
+                    float iou = box_iou(t, x0[dix], y0[dix], x1[dix], y1[dix]);
+                    if (iou >= s_tracker.iou_threshold) {
+                        pairs.push_back({iou, (uint32_t)tix, dix});
+                    }
+                }
+            }
+        }
+    }
+
+    // Greedy assignment, best overlap first.
+    std::sort(pairs.begin(), pairs.end(),
+              [](const candidate_pair& a, const candidate_pair& b) { return a.iou > b.iou; });
+    std::vector<uint8_t> track_matched(s_tracker.tracks.size(), 0);
+    std::vector<uint8_t> det_matched(n, 0);
+    for (const candidate_pair& p : pairs) {
+        if (track_matched[p.track_ix] || det_matched[p.det_ix]) {
+            continue;
+        }
+        track_matched[p.track_ix] = 1;
+        det_matched[p.det_ix] = 1;
+        track& t = s_tracker.tracks[p.track_ix];
+        t.x0 = x0[p.det_ix];
+        t.y0 = y0[p.det_ix];
+        t.x1 = x1[p.det_ix];
+        t.y1 = y1[p.det_ix];
+        t.score = scores[p.det_ix];
+        t.age++;
+        t.missed = 0;
+    }
+
+    // Age out tracks that ran past their grace period.
+    size_t live = 0;
+    for (size_t tix = 0; tix < s_tracker.tracks.size(); tix++) {
+        track& t = s_tracker.tracks[tix];
+        if (!track_matched[tix]) {
+            t.missed++;
+            t.age++;
+            if (t.missed > s_tracker.keep_grace) {
+                continue;
+            }
+        }
+        s_tracker.tracks[live++] = t;
+    }
+    s_tracker.tracks.resize(live);
+
+    // Open tracks for unmatched detections while under the cap.
+    for (size_t dix = 0; dix < n; dix++) {
+        if (det_matched[dix] || s_tracker.tracks.size() >= s_tracker.max_observations) {
+            continue;
+        }
+        track t;
+        t.id = s_tracker.next_id++;
+        t.label_id = label_ids != nullptr ? label_ids[dix] : 0;
+        t.x0 = x0[dix];
+        t.y0 = y0[dix];
+        t.x1 = x1[dix];
+        t.y1 = y1[dix];
+        t.score = scores[dix];
+        s_tracker.tracks.push_back(t);
+    }
+
+    size_t written = 0;
+    for (const track& t : s_tracker.tracks) {
+        if (written >= tracks_capacity) {
+            break;
+        }
+        fill_track_out(tracks_out[written++], t);
+    }
+    return written;
+}
+
+// Frame-delta view of the tracker: report only tracks that are new,
+// moved by at least `min_move` on any box coordinate, or lost since the
+// previous delta call. Unchanged tracks are omitted, so steady scenes
+// produce near-empty payloads. Deltas that do not fit in `deltas_out`
+// stay pending and are reported on the next call; returns the number
+// written.
+__attribute__((visibility("default"))) size_t ei_ffi_get_result_delta(ei_ffi_track_delta_t* deltas_out, size_t deltas_capacity, float min_move) {
+    if (deltas_out == nullptr || deltas_capacity == 0) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(s_tracker.mutex);
+
+    size_t written = 0;
+    std::unordered_map<uint32_t, const track*> live;
+    live.reserve(s_tracker.tracks.size() * 2);
+    for (const track& t : s_tracker.tracks) {
+        live.emplace(t.id, &t);
+
+        auto it = s_tracker.reported.find(t.id);
+        if (it == s_tracker.reported.end()) {
+            if (written < deltas_capacity) {
+                deltas_out[written].change = EI_FFI_TRACK_NEW;
+                fill_track_out(deltas_out[written].track, t);
+                written++;
+                s_tracker.reported.emplace(t.id, t);
+            }
+            continue;
+        }
+
+        const track& prev = it->second;
+        float moved = std::max(std::max(std::fabs(t.x0 - prev.x0), std::fabs(t.y0 - prev.y0)),
+                               std::max(std::fabs(t.x1 - prev.x1), std::fabs(t.y1 - prev.y1)));
+        if (moved >= min_move && moved > 0.0f) {
+            if (written < deltas_capacity) {
+                deltas_out[written].change = EI_FFI_TRACK_MOVED;
+                fill_track_out(deltas_out[written].track, t);
+                written++;
+                it->second = t;
+            }
+        } else {
+            // Geometry unchanged: refresh score/age silently so a later
+            // MOVED delta carries current values.
+            it->second = t;
+        }
+    }
+
+    // Tracks we reported before that are no longer live.
+    for (auto it = s_tracker.reported.begin(); it != s_tracker.reported.end();) {
+        if (live.count(it->first) == 0 && written < deltas_capacity) {
+            deltas_out[written].change = EI_FFI_TRACK_LOST;
+            fill_track_out(deltas_out[written].track, it->second);
+            written++;
+            it = s_tracker.reported.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return written;
+}
+
+// Drop all state; the next update starts from an empty track list.
+__attribute__((visibility("default"))) void ei_ffi_tracker_reset(void) {
+    std::lock_guard<std::mutex> lock(s_tracker.mutex);
+    s_tracker.tracks.clear();
+    s_tracker.reported.clear();
+    s_tracker.next_id = 1;
+}
+
+} // extern "C"
@@ -0,0 +1,159 @@
+// Hardware perf-counter instrumentation around the invoke path.
+//
+// Wall-clock timing says a frame was slow; it cannot say whether the
+// device was starved for DRAM or for ALUs, and the fix differs (layout
+// work vs. quantization). ei_ffi_perf_begin opens a per-thread
+// perf_event group for the requested counters, the caller runs its
+// invoke, and ei_ffi_perf_end reads the whole group with one read() and
+// tears it down. Counters are unprivileged per-thread events
+// (perf_event_paranoid <= 2 suffices; no cap_perfmon needed), so this is
+// usable in production at sampling frequency -- wrap one invoke every
+// few hundred, not every frame, and ship the ratios.
+//
+// time_enabled/time_running are reported so callers can detect and scale
+// for multiplexing when the PMU runs out of counters; with the three or
+// four counters here on one group that normally does not happen.
+#include "edge_impulse_wrapper.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kMaxEvents = 5;
+
+// Open group on this thread; leader first. fds[0] < 0 means inactive.
+struct perf_group {
+    int fds[kMaxEvents];
+    uint32_t ids[kMaxEvents]; // EI_FFI_PERF_* bit per slot
+    int count = 0;
+};
+
+thread_local perf_group s_perf = { { -1, -1, -1, -1, -1 }, { 0 }, 0 };
+
+struct event_map {
+    uint32_t flag;
+    uint32_t config;
+};
+
+constexpr event_map kEvents[] = {
+    { EI_FFI_PERF_CYCLES, PERF_COUNT_HW_CPU_CYCLES },
+    { EI_FFI_PERF_INSTRUCTIONS, PERF_COUNT_HW_INSTRUCTIONS },
+    { EI_FFI_PERF_CACHE_REFS, PERF_COUNT_HW_CACHE_REFERENCES },
+    { EI_FFI_PERF_CACHE_MISSES, PERF_COUNT_HW_CACHE_MISSES },
+    { EI_FFI_PERF_STALLS, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+};
+
+int open_event(uint32_t config, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = (group_fd == -1) ? 1 : 0;
+    attr.exclude_kernel = 1; // keeps the open unprivileged
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // This thread only, any CPU: the group migrates with the invoke.
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+void close_group() {
+    for (int ix = 0; ix < s_perf.count; ix++) {
+        close(s_perf.fds[ix]);
+        s_perf.fds[ix] = -1;
+    }
+    s_perf.count = 0;
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_perf_begin(uint32_t counters) {
+    if (counters == 0 || s_perf.count > 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    for (const event_map& ev : kEvents) {
+        if ((counters & ev.flag) == 0) {
+            continue;
+        }
+        int group_fd = (s_perf.count == 0) ? -1 : s_perf.fds[0];
+        int fd = open_event(ev.config, group_fd);
+        if (fd < 0) {
+            // Unsupported event on this PMU (stalled-cycles is missing on
+            // many parts) or perf_event_paranoid too strict: give the
+            // caller a clean failure, not a partial group.
+            close_group();
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        s_perf.fds[s_perf.count] = fd;
+        s_perf.ids[s_perf.count] = ev.flag;
+        s_perf.count++;
+    }
+    if (s_perf.count == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    ioctl(s_perf.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(s_perf.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_perf_end(ei_ffi_perf_counters_t* out) {
+    if (out == nullptr || s_perf.count == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    ioctl(s_perf.fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr].
+    uint64_t data[3 + kMaxEvents];
+    ssize_t n = read(s_perf.fds[0], data, sizeof(data));
+    bool ok = (n >= (ssize_t)((3 + (size_t)s_perf.count) * sizeof(uint64_t)))
+        && (data[0] == (uint64_t)s_perf.count);
+
+    memset(out, 0, sizeof(*out));
+    if (ok) {
+        out->time_enabled_ns = data[1];
+        out->time_running_ns = data[2];
+        for (int ix = 0; ix < s_perf.count; ix++) {
+            uint64_t value = data[3 + ix];
+            switch (s_perf.ids[ix]) {
+            case EI_FFI_PERF_CYCLES: out->cycles = value; break;
+            case EI_FFI_PERF_INSTRUCTIONS: out->instructions = value; break;
+            case EI_FFI_PERF_CACHE_REFS: out->cache_references = value; break;
+            case EI_FFI_PERF_CACHE_MISSES: out->cache_misses = value; break;
+            case EI_FFI_PERF_STALLS: out->stalled_cycles_backend = value; break;
+            default: break;
+            }
+        }
+    }
+    close_group();
+    return ok ? EI_IMPULSE_OK : EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#else // !__linux__
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_perf_begin(uint32_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_perf_end(ei_ffi_perf_counters_t*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#endif // __linux__
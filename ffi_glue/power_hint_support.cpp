@@ -0,0 +1,165 @@
+// Energy-aware DVFS hinting around inference bursts.
+//
+// On battery-powered targets the governor ramps frequency lazily, so the
+// first inferences of a burst run at the floor clock -- close to double the
+// steady-state latency. The hint below raises the scheduler's utilization
+// clamp (sched_setattr with SCHED_FLAG_UTIL_CLAMP_MIN) on every registered
+// inference thread for the duration of a burst: schedutil then places those
+// threads at full frequency immediately, without touching the global
+// governor policy or other workloads. Where uclamp is unavailable (old
+// kernel, no CAP_SYS_NICE for other threads), the global cpufreq boost file
+// is the fallback.
+//
+// Threads running inferences register themselves through the internal hook:
+// the glue's own workers (async engine, priority scheduler, audio stream
+// thread) do so on startup, and the thread calling the hint is always
+// included -- synchronous and pooled classification runs on the caller.
+#include "edge_impulse_wrapper.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// sched_setattr has no glibc wrapper; layout per sched(7), including the
+// v2 utilization-clamp fields.
+struct sched_attr_compat {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+    uint32_t sched_util_min;
+    uint32_t sched_util_max;
+};
+
+#ifndef SCHED_FLAG_KEEP_POLICY
+#define SCHED_FLAG_KEEP_POLICY 0x08
+#endif
+#ifndef SCHED_FLAG_KEEP_PARAMS
+#define SCHED_FLAG_KEEP_PARAMS 0x10
+#endif
+#ifndef SCHED_FLAG_UTIL_CLAMP_MIN
+#define SCHED_FLAG_UTIL_CLAMP_MIN 0x20
+#endif
+
+constexpr uint32_t kUclampMax = 1024; // kernel's SCHED_CAPACITY_SCALE
+
+bool set_uclamp_min(pid_t tid, uint32_t util_min) {
+    sched_attr_compat attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_flags = SCHED_FLAG_KEEP_POLICY | SCHED_FLAG_KEEP_PARAMS | SCHED_FLAG_UTIL_CLAMP_MIN;
+    attr.sched_util_min = util_min;
+    return syscall(SYS_sched_setattr, tid, &attr, 0) == 0;
+}
+
+// Global fallback: the cpufreq boost toggle, where the platform has one.
+bool write_boost_file(const char* value) {
+    int fd = open("/sys/devices/system/cpu/cpufreq/boost", O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, value, 1) == 1;
+    close(fd);
+    return ok;
+}
+
+std::mutex s_power_mutex;
+std::vector<pid_t> s_power_tids; // registered inference threads
+bool s_burst_active = false;
+bool s_boost_file_engaged = false;
+std::vector<pid_t> s_clamped_tids; // actually clamped, for symmetric release
+
+} // namespace
+
+extern "C" {
+
+// Registration hook for glue-owned inference threads; idempotent per
+// thread. Exited threads are pruned when a later clamp on them fails.
+__attribute__((visibility("default"))) void ei_ffi_internal_power_register_thread(void) {
+    pid_t tid = (pid_t)syscall(SYS_gettid);
+    std::lock_guard<std::mutex> lock(s_power_mutex);
+    if (std::find(s_power_tids.begin(), s_power_tids.end(), tid) == s_power_tids.end()) {
+        s_power_tids.push_back(tid);
+    }
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_power_hint(int hint) {
+    std::lock_guard<std::mutex> lock(s_power_mutex);
+    if (hint == EI_HINT_BURST_BEGIN) {
+        if (s_burst_active) {
+            return EI_IMPULSE_OK;
+        }
+        pid_t self = (pid_t)syscall(SYS_gettid);
+        std::vector<pid_t> targets = s_power_tids;
+        if (std::find(targets.begin(), targets.end(), self) == targets.end()) {
+            targets.push_back(self);
+        }
+        s_clamped_tids.clear();
+        for (size_t ix = 0; ix < targets.size(); ix++) {
+            if (set_uclamp_min(targets[ix], kUclampMax)) {
+                s_clamped_tids.push_back(targets[ix]);
+            }
+            else if (errno == ESRCH) {
+                s_power_tids.erase(
+                    std::remove(s_power_tids.begin(), s_power_tids.end(), targets[ix]),
+                    s_power_tids.end());
+            }
+        }
+        if (s_clamped_tids.empty()) {
+            // No uclamp support; fall back to the global boost toggle.
+            if (!write_boost_file("1")) {
+                return EI_IMPULSE_INFERENCE_ERROR;
+            }
+            s_boost_file_engaged = true;
+        }
+        s_burst_active = true;
+        return EI_IMPULSE_OK;
+    }
+    if (hint == EI_HINT_BURST_END) {
+        if (!s_burst_active) {
+            return EI_IMPULSE_OK;
+        }
+        for (size_t ix = 0; ix < s_clamped_tids.size(); ix++) {
+            set_uclamp_min(s_clamped_tids[ix], 0);
+        }
+        s_clamped_tids.clear();
+        if (s_boost_file_engaged) {
+            write_boost_file("0");
+            s_boost_file_engaged = false;
+        }
+        s_burst_active = false;
+        return EI_IMPULSE_OK;
+    }
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#else // !__linux__
+
+extern "C" {
+
+__attribute__((visibility("default"))) void ei_ffi_internal_power_register_thread(void) {}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_power_hint(int) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+} // extern "C"
+
+#endif // __linux__
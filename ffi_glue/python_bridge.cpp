@@ -0,0 +1,139 @@
+// Optional pybind11 bridge for notebook profiling (EI_PYTHON=1).
+//
+// Latency analysis done by re-exporting models to ONNX never matches the
+// deployed FFI path -- different runtime, different kernels, different
+// thread pool. This module wraps the same ei_ffi_* surface (and thus the
+// exact static library we ship) for Python, so numbers measured in a
+// notebook are numbers the device will reproduce. Features go in through
+// the numpy buffer protocol with no copy for contiguous float32 arrays;
+// output tensors come back as zero-copy views into interpreter memory.
+//
+// Only built when EI_FFI_PYTHON is set; the vendored pybind11 headers in
+// third_party/ are the only dependency beyond a Python installation.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace py = pybind11;
+
+namespace {
+
+// Flatten a result into plain Python containers; everything is copied out,
+// so the dict stays valid after the next inference reuses the SDK's result
+// storage.
+py::dict result_to_dict(const ei_impulse_result_t& result) {
+    py::dict out;
+    py::dict classes;
+    for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+        classes[result.classification[ix].label] = result.classification[ix].value;
+    }
+    out["classification"] = classes;
+
+    py::list boxes;
+    for (uint32_t ix = 0; ix < result.bounding_boxes_count; ix++) {
+        const ei_impulse_result_bounding_box_t& bb = result.bounding_boxes[ix];
+        py::dict box;
+        box["label"] = bb.label == nullptr ? "" : bb.label;
+        box["value"] = bb.value;
+        box["x"] = bb.x;
+        box["y"] = bb.y;
+        box["width"] = bb.width;
+        box["height"] = bb.height;
+        boxes.append(box);
+    }
+    out["bounding_boxes"] = boxes;
+
+#if EI_CLASSIFIER_HAS_ANOMALY
+    out["anomaly"] = result.anomaly;
+#endif
+
+    py::dict timing;
+    timing["dsp_us"] = result.timing.dsp_us;
+    timing["classification_us"] = result.timing.classification_us;
+    timing["anomaly_us"] = result.timing.anomaly_us;
+    out["timing"] = timing;
+    return out;
+}
+
+void raise_on_error(EI_IMPULSE_ERROR res, const char* what) {
+    if (res != EI_IMPULSE_OK) {
+        throw std::runtime_error(std::string(what) + " failed with EI_IMPULSE_ERROR " + std::to_string((int)res));
+    }
+}
+
+} // namespace
+
+PYBIND11_MODULE(ei_ffi, m) {
+    m.doc() = "Profiling bridge to the deployed Edge Impulse FFI library. "
+              "Runs the same static library the Rust crate links, so latency "
+              "and output numbers match the shipped binary exactly.";
+
+    m.attr("INPUT_FRAME_SIZE") = (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+    m.attr("LABEL_COUNT") = (size_t)EI_CLASSIFIER_LABEL_COUNT;
+
+    m.def(
+        "run_classifier",
+        [](py::array_t<float, py::array::c_style | py::array::forcecast> features, bool debug) {
+            if ((size_t)features.size() != (size_t)EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+                throw py::value_error("expected " + std::to_string(EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE)
+                                      + " features, got " + std::to_string(features.size()));
+            }
+            signal_t signal;
+            raise_on_error(ei_ffi_signal_from_buffer(features.data(), (size_t)features.size(), &signal),
+                           "signal_from_buffer");
+            ei_impulse_result_t result = {};
+            EI_IMPULSE_ERROR res;
+            {
+                // Long-running native call; let other notebook cells run.
+                py::gil_scoped_release release;
+                res = ei_ffi_run_classifier(&signal, &result, debug ? 1 : 0);
+            }
+            raise_on_error(res, "run_classifier");
+            return result_to_dict(result);
+        },
+        py::arg("features"), py::arg("debug") = false,
+        "Classify one window of raw features (float32, zero-copy for "
+        "contiguous arrays) and return classification, boxes and timing.");
+
+    m.def("profiling_start", []() { raise_on_error(ei_ffi_profiling_start(), "profiling_start"); },
+          "Start the per-op TFLite profiler (full TFLite builds).");
+
+    m.def("profiling_stop", []() { raise_on_error(ei_ffi_profiling_stop(), "profiling_stop"); },
+          "Stop the per-op profiler.");
+
+    m.def(
+        "profiling_summary",
+        []() {
+            std::string buf(65536, '\0');
+            int n = ei_ffi_profiling_summary(&buf[0], buf.size());
+            if (n < 0) {
+                throw std::runtime_error("no profile collected (is profiling started, and is this a full TFLite build?)");
+            }
+            buf.resize((size_t)n);
+            return buf;
+        },
+        "Per-op latency summary of the profiled invokes, as text.");
+
+    m.def("output_tensor_count", []() { return ei_ffi_output_tensor_count(); },
+          "Number of interpreter output tensors, or -1 on micro builds.");
+
+    m.def(
+        "output_tensor",
+        [](int index) {
+            const float* data = nullptr;
+            size_t len = 0;
+            raise_on_error(ei_ffi_get_output_tensor(index, &data, &len), "get_output_tensor");
+            // Zero-copy view into interpreter memory: valid until the next
+            // invoke, same contract as the C API. Copy before storing.
+            py::capsule borrow(data, [](void*) {});
+            return py::array_t<float>({(py::ssize_t)len}, {(py::ssize_t)sizeof(float)}, data, borrow);
+        },
+        py::arg("index"),
+        "Dequantized output tensor as a zero-copy numpy view (valid until "
+        "the next inference).");
+}
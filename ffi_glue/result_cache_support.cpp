@@ -0,0 +1,271 @@
+// Result memoization keyed by input content hash.
+//
+// Doc-scanning style deployments re-submit near-identical frames while the
+// scene is static, and every one of them pays a full invoke. With the
+// cache enabled, ei_ffi_run_classifier hashes the signal's samples
+// (XXH64; the four-accumulator stripe layout is what makes the inner loop
+// run at memory speed) and an exact hash + length hit returns a detached
+// copy of the earlier result before the DSP or interpreter run at all --
+// a static scene then costs one pass over the frame instead of an invoke.
+//
+// Scope and caveats, deliberately kept simple:
+//   - only the default-impulse ei_ffi_run_classifier path consults the
+//     cache; per-handle invokes may run different models for the same
+//     bytes, so they stay uncached.
+//   - hits are exact 64-bit hash + sample-count matches. Frames are not
+//     retained for byte-wise confirmation, so a hash collision would
+//     return the colliding entry's result; at 2^-64 per pair that is
+//     noise against sensor error rates.
+//   - timing fields in a cached result are the original invoke's; treat
+//     them as provenance, not as the cost of the hit.
+//   - clear the cache after ei_ffi_hot_swap_model -- entries made under
+//     the old weights are answers to a question the new model might
+//     score differently.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// XXH64 over the raw sample bytes. Stripes of four 8-byte lanes keep four
+// independent multiply-rotate chains in flight, which is the whole trick:
+// the loop is load-bound, not latency-bound.
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl64(uint64_t v, int r) {
+    return (v << r) | (v >> (64 - r));
+}
+
+inline uint64_t round64(uint64_t acc, uint64_t lane) {
+    return rotl64(acc + lane * kPrime2, 31) * kPrime1;
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t xxh64(const uint8_t* data, size_t len) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        uint64_t v1 = kPrime1 + kPrime2;
+        uint64_t v2 = kPrime2;
+        uint64_t v3 = 0;
+        uint64_t v4 = 0 - kPrime1;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = (h ^ round64(0, v1)) * kPrime1 + kPrime4;
+        h = (h ^ round64(0, v2)) * kPrime1 + kPrime4;
+        h = (h ^ round64(0, v3)) * kPrime1 + kPrime4;
+        h = (h ^ round64(0, v4)) * kPrime1 + kPrime4;
+    }
+    else {
+        h = kPrime5;
+    }
+    h += (uint64_t)len;
+
+    while (p + 8 <= end) {
+        h = rotl64(h ^ round64(0, read64(p)), 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        uint32_t v32;
+        memcpy(&v32, p, sizeof(v32));
+        h = rotl64(h ^ ((uint64_t)v32 * kPrime1), 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h = rotl64(h ^ ((uint64_t)(*p) * kPrime5), 11) * kPrime1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// One detached result. Label pointers inside the copied box/cell arrays
+// reference model statics and stay valid for the model's lifetime.
+struct cache_entry {
+    uint64_t hash;
+    size_t sample_count;
+    ei_impulse_result_t result;
+    std::vector<ei_impulse_result_bounding_box_t> boxes;
+    std::vector<ei_impulse_result_bounding_box_t> cells;
+};
+
+struct cache_state {
+    std::mutex mutex;
+    // LRU: list front = most recent; map values point into the list.
+    std::list<cache_entry> entries;
+    std::unordered_map<uint64_t, std::list<cache_entry>::iterator> index;
+    size_t capacity = 0;
+};
+
+cache_state s_cache;
+std::atomic<bool> s_cache_active{false};
+std::atomic<uint64_t> s_cache_hits{0};
+std::atomic<uint64_t> s_cache_misses{0};
+std::atomic<uint64_t> s_cache_evictions{0};
+
+// The hash computed by the last lookup on this thread, consumed by the
+// store that follows a miss -- avoids hashing the frame twice.
+thread_local uint64_t s_last_hash = 0;
+thread_local size_t s_last_count = 0;
+
+void fill_from_entry(const cache_entry& entry, ei_impulse_result_t* result) {
+    *result = entry.result;
+    result->bounding_boxes =
+        const_cast<ei_impulse_result_bounding_box_t*>(entry.boxes.data());
+    result->bounding_boxes_count = (uint32_t)entry.boxes.size();
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    result->visual_ad_grid_cells =
+        const_cast<ei_impulse_result_bounding_box_t*>(entry.cells.data());
+    result->visual_ad_count = (uint32_t)entry.cells.size();
+#endif
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_enable_result_cache(size_t entries) {
+    if (entries == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    s_cache.capacity = entries;
+    while (s_cache.entries.size() > entries) {
+        s_cache.index.erase(s_cache.entries.back().hash);
+        s_cache.entries.pop_back();
+    }
+    s_cache_hits.store(0, std::memory_order_relaxed);
+    s_cache_misses.store(0, std::memory_order_relaxed);
+    s_cache_evictions.store(0, std::memory_order_relaxed);
+    s_cache_active.store(true, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_disable_result_cache(void) {
+    s_cache_active.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    s_cache.entries.clear();
+    s_cache.index.clear();
+    s_cache.capacity = 0;
+}
+
+// Drop all entries but keep the cache enabled; call after a model hot
+// swap so stale results cannot be served under the new weights.
+__attribute__((visibility("default"))) void ei_ffi_result_cache_clear(void) {
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    s_cache.entries.clear();
+    s_cache.index.clear();
+}
+
+// Output pointers may be NULL. Hit rate below ~50% on a nominally static
+// scene usually means upstream jitter (AGC, timestamp overlays) is
+// defeating exact matching -- fix the source, the cache cannot.
+__attribute__((visibility("default"))) void ei_ffi_result_cache_stats(uint64_t* hits, uint64_t* misses, uint64_t* evictions) {
+    if (hits != nullptr) {
+        *hits = s_cache_hits.load(std::memory_order_relaxed);
+    }
+    if (misses != nullptr) {
+        *misses = s_cache_misses.load(std::memory_order_relaxed);
+    }
+    if (evictions != nullptr) {
+        *evictions = s_cache_evictions.load(std::memory_order_relaxed);
+    }
+}
+
+// Called by ei_ffi_run_classifier before the invoke; returns true and
+// fills `result` on a hit. Disabled cost is a single atomic load.
+__attribute__((visibility("default"))) bool ei_ffi_internal_result_cache_try(signal_t* signal, ei_impulse_result_t* result) {
+    if (!s_cache_active.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    static thread_local std::vector<float> samples;
+    samples.resize(signal->total_length);
+    if (signal->get_data(0, signal->total_length, samples.data()) != 0) {
+        s_last_count = 0;
+        return false;
+    }
+    s_last_hash = xxh64((const uint8_t*)samples.data(), samples.size() * sizeof(float));
+    s_last_count = samples.size();
+
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    auto it = s_cache.index.find(s_last_hash);
+    if (it == s_cache.index.end() || it->second->sample_count != s_last_count) {
+        s_cache_misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    s_cache.entries.splice(s_cache.entries.begin(), s_cache.entries, it->second);
+    fill_from_entry(s_cache.entries.front(), result);
+    s_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Called by ei_ffi_run_classifier after a successful uncached invoke;
+// detaches the result under the hash the preceding try computed.
+__attribute__((visibility("default"))) void ei_ffi_internal_result_cache_store(const ei_impulse_result_t* result) {
+    if (!s_cache_active.load(std::memory_order_acquire) || s_last_count == 0) {
+        return;
+    }
+
+    cache_entry entry;
+    entry.hash = s_last_hash;
+    entry.sample_count = s_last_count;
+    entry.result = *result;
+    if (result->bounding_boxes_count > 0 && result->bounding_boxes != nullptr) {
+        entry.boxes.assign(result->bounding_boxes,
+                           result->bounding_boxes + result->bounding_boxes_count);
+    }
+#if EI_CLASSIFIER_HAS_VISUAL_ANOMALY
+    if (result->visual_ad_count > 0 && result->visual_ad_grid_cells != nullptr) {
+        entry.cells.assign(result->visual_ad_grid_cells,
+                           result->visual_ad_grid_cells + result->visual_ad_count);
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    if (s_cache.capacity == 0) {
+        return; // disabled between try and store
+    }
+    auto it = s_cache.index.find(entry.hash);
+    if (it != s_cache.index.end()) {
+        s_cache.entries.erase(it->second);
+        s_cache.index.erase(it);
+    }
+    else if (s_cache.entries.size() >= s_cache.capacity) {
+        s_cache.index.erase(s_cache.entries.back().hash);
+        s_cache.entries.pop_back();
+        s_cache_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    s_cache.entries.push_front(std::move(entry));
+    s_cache.index.emplace(s_cache.entries.front().hash, s_cache.entries.begin());
+}
+
+} // extern "C"
@@ -0,0 +1,300 @@
+// Shared-memory result bus for multi-process consumers.
+//
+// Fanning every result out over Unix sockets costs one serialization plus
+// one syscall per consumer per frame. Here the publisher writes each
+// serialized result (the ei_ffi_serialize_result flat layout) once into a
+// seqlock-protected ring in POSIX shared memory; any number of reader
+// processes poll it with plain loads, no syscalls on the hot path, so
+// fan-out cost is independent of consumer count.
+//
+// Single publisher, many readers. Publish calls must come from one thread
+// at a time (in practice: the classifier thread). Readers never block the
+// publisher -- a reader that loses the seqlock race simply retries, and a
+// reader that falls a full ring behind sees only newer records. Results
+// whose serialized form exceeds the fixed slot payload are dropped and
+// counted rather than published truncated.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Ring layout in the mapping: header, then `depth` slots at kSlotStride.
+// The atomics live in shared memory and are used lock-free from every
+// attached process; the seqlock makes torn payload reads detectable.
+constexpr uint32_t kShmMagic = 0x42524945; // "EIRB" little-endian
+constexpr uint32_t kShmVersion = 1;
+// Fixed payload budget per slot. Generous for detection results with
+// interned labels; oversized results are dropped, not truncated.
+constexpr size_t kSlotPayload = 16 * 1024;
+constexpr size_t kMaxDepth = 1024;
+
+struct shm_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t depth;
+    uint32_t slot_payload;
+    // Absolute publish counter; slot index is (head - 1) % depth for the
+    // newest record. Monotonic, never wraps in practice.
+    std::atomic<uint64_t> head;
+};
+
+struct shm_slot {
+    // Seqlock word: odd while the publisher is writing, even when stable.
+    std::atomic<uint32_t> seq;
+    uint32_t len;
+    uint8_t payload[kSlotPayload];
+};
+
+constexpr size_t kSlotStride = (sizeof(shm_slot) + 63) & ~(size_t)63;
+
+struct shm_bus {
+    shm_header* header = nullptr;
+    size_t map_size = 0;
+    int fd = -1;
+    bool owner = false; // created (and will unlink) vs. merely opened
+    char name[256] = {};
+    uint64_t drops = 0;
+};
+
+shm_bus s_bus;
+
+shm_slot* slot_at(size_t ix) {
+    uint8_t* base = (uint8_t*)s_bus.header + sizeof(shm_header);
+    // Round the header up to the slot alignment too.
+    base = (uint8_t*)(((uintptr_t)base + 63) & ~(uintptr_t)63);
+    return (shm_slot*)(base + ix * kSlotStride);
+}
+
+size_t map_size_for(size_t depth) {
+    return ((sizeof(shm_header) + 63) & ~(size_t)63) + depth * kSlotStride;
+}
+
+void unmap_bus() {
+    if (s_bus.header != nullptr) {
+        munmap(s_bus.header, s_bus.map_size);
+        s_bus.header = nullptr;
+    }
+    if (s_bus.fd >= 0) {
+        close(s_bus.fd);
+        s_bus.fd = -1;
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Publisher side
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_results_shm_create(const char* name, size_t depth) {
+    if (name == nullptr || name[0] != '/' || depth == 0 || depth > kMaxDepth) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (s_bus.header != nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    size_t size = map_size_for(depth);
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        shm_unlink(name);
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+
+    s_bus.header = (shm_header*)base;
+    s_bus.map_size = size;
+    s_bus.fd = fd;
+    s_bus.owner = true;
+    s_bus.drops = 0;
+    strncpy(s_bus.name, name, sizeof(s_bus.name) - 1);
+
+    // Zero the slots (ftruncate guarantees this for a fresh segment, but a
+    // stale segment with the same name may survive a crashed publisher).
+    memset(base, 0, size);
+    s_bus.header->magic = kShmMagic;
+    s_bus.header->version = kShmVersion;
+    s_bus.header->depth = (uint32_t)depth;
+    s_bus.header->slot_payload = (uint32_t)kSlotPayload;
+    s_bus.header->head.store(0, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_results_shm_publish(const ei_impulse_result_t* result) {
+    if (result == nullptr || s_bus.header == nullptr || !s_bus.owner) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    uint64_t head = s_bus.header->head.load(std::memory_order_relaxed);
+    shm_slot* slot = slot_at((size_t)(head % s_bus.header->depth));
+
+    // Size first; an oversized result must not open the seqlock at all.
+    int needed = ei_ffi_serialize_result(result, nullptr, 0);
+    if (needed < 0 || (size_t)needed > kSlotPayload) {
+        s_bus.drops++;
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+
+    uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    int written = ei_ffi_serialize_result(result, slot->payload, kSlotPayload);
+    slot->len = (uint32_t)written;
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->seq.store(seq + 2, std::memory_order_release);
+    s_bus.header->head.store(head + 1, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+// Results dropped because their serialized form exceeded the slot payload.
+__attribute__((visibility("default"))) uint64_t ei_ffi_results_shm_drops(void) {
+    return s_bus.drops;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_results_shm_destroy(void) {
+    bool owner = s_bus.owner;
+    unmap_bus();
+    if (owner && s_bus.name[0] != '\0') {
+        shm_unlink(s_bus.name);
+    }
+    s_bus = shm_bus();
+}
+
+// ---------------------------------------------------------------------------
+// Reader side
+//
+// Provided so non-publisher processes that link this library (or bind it
+// from Rust) can consume the ring; readers in other languages only need
+// the layout above.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_results_shm_open(const char* name) {
+    if (name == nullptr || name[0] != '/' || s_bus.header != nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_header)) {
+        close(fd);
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+    shm_header* header = (shm_header*)base;
+    if (header->magic != kShmMagic || header->version != kShmVersion ||
+        (size_t)st.st_size < map_size_for(header->depth)) {
+        munmap(base, (size_t)st.st_size);
+        close(fd);
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_bus.header = header;
+    s_bus.map_size = (size_t)st.st_size;
+    s_bus.fd = fd;
+    s_bus.owner = false;
+    strncpy(s_bus.name, name, sizeof(s_bus.name) - 1);
+    return EI_IMPULSE_OK;
+}
+
+// Copies the newest published record into `buf` and returns its byte
+// length, or -1 when nothing has been published yet / `cap` is too small.
+// `seen` (optional) carries the last publish counter the caller consumed:
+// a record is only returned when newer, and the counter is updated -- pass
+// nullptr to always fetch the newest record.
+__attribute__((visibility("default"))) int ei_ffi_results_shm_read_latest(uint8_t* buf, size_t cap, uint64_t* seen) {
+    if (buf == nullptr || s_bus.header == nullptr) {
+        return -1;
+    }
+    uint64_t head = s_bus.header->head.load(std::memory_order_acquire);
+    if (head == 0 || (seen != nullptr && head <= *seen)) {
+        return -1;
+    }
+
+    shm_slot* slot = slot_at((size_t)((head - 1) % s_bus.header->depth));
+    for (int attempt = 0; attempt < 64; attempt++) {
+        uint32_t seq_before = slot->seq.load(std::memory_order_acquire);
+        if (seq_before & 1) {
+            continue; // publisher mid-write
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t len = slot->len;
+        if ((size_t)len > cap || (size_t)len > kSlotPayload) {
+            return -1;
+        }
+        memcpy(buf, slot->payload, len);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) == seq_before) {
+            if (seen != nullptr) {
+                *seen = head;
+            }
+            return (int)len;
+        }
+        // Torn read: the publisher lapped us inside the copy. Re-resolve
+        // the newest slot and try again.
+        head = s_bus.header->head.load(std::memory_order_acquire);
+        slot = slot_at((size_t)((head - 1) % s_bus.header->depth));
+    }
+    return -1;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_results_shm_close(void) {
+    if (s_bus.owner) {
+        return; // publishers use destroy()
+    }
+    unmap_bus();
+    s_bus = shm_bus();
+}
+
+#else // !__linux__
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_results_shm_create(const char*, size_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_results_shm_publish(const ei_impulse_result_t*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) uint64_t ei_ffi_results_shm_drops(void) {
+    return 0;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_results_shm_destroy(void) {
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_results_shm_open(const char*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_results_shm_read_latest(uint8_t*, size_t, uint64_t*) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_results_shm_close(void) {
+}
+
+#endif // __linux__
@@ -0,0 +1,156 @@
+// Persistent spectral frame cache for overlapping DSP windows.
+//
+// Spectral/MFE feature extraction recomputes every frame's FFT for every
+// window, even when consecutive windows share most of their frames. This
+// cache keys a frame's magnitude spectrum on its absolute sample offset in
+// the stream, so a frame is transformed once and every window that contains
+// it reuses the result. It sits in front of the SDK's FFT (ei::numpy::rfft)
+// rather than inside run_classifier, since the SDK's DSP path is generated
+// per model; callers assembling their own overlapping spectral features get
+// the 4x-at-75%-overlap saving directly.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/dsp/numpy.hpp"
+
+// Deployment-time DSP constants folded by build.rs (fft length, filter
+// counts); absent for raw-data impulses or model drops without the
+// recognized config fields, in which case only the generic path compiles.
+#if defined(__has_include)
+#if __has_include("model-parameters/ei_dsp_constexpr.h")
+#include "model-parameters/ei_dsp_constexpr.h"
+#endif
+#endif
+
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct spectral_cache {
+    std::mutex mutex;
+    size_t frame_length = 0;
+    size_t n_fft = 0;
+    size_t capacity = 0;
+    std::unordered_map<uint64_t, std::vector<float>> frames;
+    std::deque<uint64_t> eviction_order; // FIFO; offsets age out oldest-first
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+static spectral_cache s_cache;
+
+#if defined(EI_FFI_DSP_FFT_LENGTH)
+// Fixed-length transform for the deployment's configured FFT length: with
+// NFFT a template argument, the bin count and the rfft implementation's
+// plan/radix branching (numpy.hpp is header-only) resolve at compile time
+// instead of re-deciding per frame. The runtime config is still
+// authoritative -- the caller only lands here when its n_fft matches.
+template <size_t NFFT>
+int transform_frame_fixed(const float* samples, size_t frame_length, float* spectrum) {
+    constexpr size_t kBins = NFFT / 2 + 1;
+    return ei::numpy::rfft(samples, frame_length, spectrum, kBins, NFFT);
+}
+#endif
+
+int transform_frame(const float* samples, size_t frame_length, size_t n_fft, float* spectrum) {
+#if defined(EI_FFI_DSP_FFT_LENGTH)
+    if (n_fft == (size_t)EI_FFI_DSP_FFT_LENGTH) {
+        return transform_frame_fixed<(size_t)EI_FFI_DSP_FFT_LENGTH>(samples, frame_length, spectrum);
+    }
+#endif
+    return ei::numpy::rfft(samples, frame_length, spectrum, n_fft / 2 + 1, n_fft);
+}
+
+} // namespace
+
+extern "C" {
+
+// `capacity` bounds the number of cached frames (enough for one window of
+// overlap is plenty); 0 picks a default of 256.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_spectral_cache_init(size_t frame_length, size_t n_fft, size_t capacity) {
+    if (frame_length == 0 || n_fft == 0 || frame_length > n_fft) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    s_cache.frame_length = frame_length;
+    s_cache.n_fft = n_fft;
+    s_cache.capacity = capacity == 0 ? 256 : capacity;
+    s_cache.frames.clear();
+    s_cache.eviction_order.clear();
+    s_cache.hits = 0;
+    s_cache.misses = 0;
+    return EI_IMPULSE_OK;
+}
+
+// Magnitude spectrum (n_fft/2 + 1 bins) of the frame that starts at
+// absolute stream offset `sample_offset`. On a hit `samples` is not read;
+// on a miss the frame is transformed and cached. The returned pointer stays
+// valid until the entry ages out or the cache is reset/deinitialized.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_spectral_frame(const float* samples, uint64_t sample_offset, const float** spectrum_out) {
+    if (spectrum_out == nullptr) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    if (s_cache.n_fft == 0) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    auto found = s_cache.frames.find(sample_offset);
+    if (found != s_cache.frames.end()) {
+        s_cache.hits++;
+        *spectrum_out = found->second.data();
+        return EI_IMPULSE_OK;
+    }
+
+    if (samples == nullptr) {
+        return EI_IMPULSE_DSP_ERROR;
+    }
+    s_cache.misses++;
+
+    size_t bins = s_cache.n_fft / 2 + 1;
+    std::vector<float> spectrum(bins, 0.0f);
+    int ret = transform_frame(samples, s_cache.frame_length, s_cache.n_fft, spectrum.data());
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to run FFT (%d)\n", ret);
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    while (s_cache.frames.size() >= s_cache.capacity && !s_cache.eviction_order.empty()) {
+        s_cache.frames.erase(s_cache.eviction_order.front());
+        s_cache.eviction_order.pop_front();
+    }
+    auto inserted = s_cache.frames.emplace(sample_offset, std::move(spectrum));
+    s_cache.eviction_order.push_back(sample_offset);
+    *spectrum_out = inserted.first->second.data();
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_spectral_cache_stats(uint64_t* hits, uint64_t* misses) {
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    if (hits != nullptr) {
+        *hits = s_cache.hits;
+    }
+    if (misses != nullptr) {
+        *misses = s_cache.misses;
+    }
+}
+
+// Drop all cached frames (e.g. when the stream restarts and offsets reset)
+// but keep the configuration.
+__attribute__((visibility("default"))) void ei_ffi_spectral_cache_reset(void) {
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    s_cache.frames.clear();
+    s_cache.eviction_order.clear();
+}
+
+__attribute__((visibility("default"))) void ei_ffi_spectral_cache_deinit(void) {
+    std::lock_guard<std::mutex> lock(s_cache.mutex);
+    s_cache.frames.clear();
+    s_cache.eviction_order.clear();
+    s_cache.frame_length = 0;
+    s_cache.n_fft = 0;
+}
+
+} // extern "C"
@@ -0,0 +1,250 @@
+// Crash-safe persistent stats ring for post-mortem latency forensics.
+//
+// When a device crashes, the last minutes of latency data -- the ones
+// that explain the crash -- die with the process. This ring maps a
+// fixed-size file and appends one 32-byte record per successful
+// inference (wall-clock timestamp, timing breakdown, the app's queue
+// depth gauge, arena high water). Writes are plain stores into the
+// mapping, streamed past the cache on x86, with no fsync anywhere on
+// the hot path: the kernel owns writeback, so the data survives a
+// process crash or panic-reboot, and only a hard power cut can lose
+// the unsynced tail. A record is committed by the write counter in the
+// header, published after the record body with release ordering, so a
+// torn final record is never read back as valid.
+//
+// File layout (little-endian):
+//   header (64 bytes): magic "EISR", version, capacity (records),
+//                      record bytes, write counter (uint64, monotonic)
+//   ring:              capacity * 32-byte records, slot = counter % capacity
+//
+// Reopening an existing file with the same geometry resumes the
+// counter, which is what makes the post-mortem read work: after reboot,
+// ei_ffi_stats_ring_open + ei_ffi_stats_ring_read recovers the last
+// `capacity` inferences in order.
+//
+// The writer side assumes a single invoke thread; readers (same
+// process or post-mortem) are unrestricted.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t kRingMagic = 0x52534945; // "EISR"
+constexpr uint32_t kRingVersion = 1;
+constexpr uint32_t kDefaultCapacity = 4096;
+
+struct ring_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t record_bytes;
+    std::atomic<uint64_t> write_counter;
+    uint8_t reserved[40];
+};
+static_assert(sizeof(ring_header) == 64, "header must stay one cache line");
+static_assert(sizeof(ei_ffi_stats_record_t) == 32, "record layout is on disk");
+
+ring_header* s_header = nullptr;
+ei_ffi_stats_record_t* s_records = nullptr;
+size_t s_map_bytes = 0;
+int s_fd = -1;
+
+// Gates the note hook with a single relaxed load when the ring is closed.
+std::atomic<bool> s_ring_active{false};
+
+// App-maintained gauge (pending frames, channel backlog, whatever the
+// deployment queues in front of the classifier); sampled into each record.
+std::atomic<uint32_t> s_queue_depth{0};
+
+uint64_t wall_clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Copy one record into its slot. The slots are 32-byte aligned (the ring
+// starts at byte 64), so on x86 the two halves go out as non-temporal
+// stores and never displace model weights from the cache.
+void store_record(ei_ffi_stats_record_t* slot, const ei_ffi_stats_record_t* rec) {
+#if defined(__SSE2__)
+    const __m128i* src = (const __m128i*)rec;
+    __m128i* dst = (__m128i*)slot;
+    _mm_stream_si128(dst, _mm_loadu_si128(src));
+    _mm_stream_si128(dst + 1, _mm_loadu_si128(src + 1));
+    _mm_sfence();
+#else
+    memcpy(slot, rec, sizeof(*rec));
+#endif
+}
+
+void unmap_ring() {
+    if (s_header != nullptr) {
+        munmap(s_header, s_map_bytes);
+        s_header = nullptr;
+        s_records = nullptr;
+        s_map_bytes = 0;
+    }
+    if (s_fd >= 0) {
+        close(s_fd);
+        s_fd = -1;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_stats_ring_open(const char* path, uint32_t capacity) {
+    if (path == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (s_ring_active.load(std::memory_order_relaxed)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (capacity == 0) {
+        capacity = kDefaultCapacity;
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    size_t map_bytes = sizeof(ring_header) + (size_t)capacity * sizeof(ei_ffi_stats_record_t);
+
+    // A file that already carries this geometry is resumed in place --
+    // that is the post-mortem path. Anything else (fresh file, stale
+    // geometry) is re-initialized.
+    struct stat st;
+    bool resume = false;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == map_bytes) {
+        ring_header probe;
+        if (pread(fd, &probe, sizeof(probe), 0) == (ssize_t)sizeof(probe) &&
+            probe.magic == kRingMagic && probe.version == kRingVersion &&
+            probe.capacity == capacity &&
+            probe.record_bytes == sizeof(ei_ffi_stats_record_t)) {
+            resume = true;
+        }
+    }
+    if (!resume && ftruncate(fd, (off_t)map_bytes) != 0) {
+        close(fd);
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    void* map = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+
+    s_fd = fd;
+    s_map_bytes = map_bytes;
+    s_header = (ring_header*)map;
+    s_records = (ei_ffi_stats_record_t*)((uint8_t*)map + sizeof(ring_header));
+    if (!resume) {
+        memset(map, 0, sizeof(ring_header));
+        s_header->magic = kRingMagic;
+        s_header->version = kRingVersion;
+        s_header->capacity = capacity;
+        s_header->record_bytes = sizeof(ei_ffi_stats_record_t);
+        s_header->write_counter.store(0, std::memory_order_release);
+    }
+    s_ring_active.store(true, std::memory_order_release);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_stats_ring_close(void) {
+    if (!s_ring_active.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    // One deliberate sync at close so an orderly shutdown leaves nothing
+    // to writeback timing; crashes rely on the kernel surviving instead.
+    msync(s_header, s_map_bytes, MS_SYNC);
+    unmap_ring();
+}
+
+__attribute__((visibility("default"))) void ei_ffi_stats_ring_set_queue_depth(uint32_t depth) {
+    s_queue_depth.store(depth, std::memory_order_relaxed);
+}
+
+// Newest-last copy of up to `max_records` committed records into `out`;
+// returns the number copied. Reads the counter with acquire so a record
+// is only surfaced after its body is visible.
+__attribute__((visibility("default"))) uint32_t ei_ffi_stats_ring_read(ei_ffi_stats_record_t* out, uint32_t max_records) {
+    if (out == nullptr || max_records == 0 ||
+        !s_ring_active.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    uint64_t counter = s_header->write_counter.load(std::memory_order_acquire);
+    uint32_t capacity = s_header->capacity;
+    uint64_t available = counter < capacity ? counter : capacity;
+    uint32_t n = available < max_records ? (uint32_t)available : max_records;
+    for (uint32_t ix = 0; ix < n; ix++) {
+        uint64_t seq = counter - n + ix;
+        out[ix] = s_records[seq % capacity];
+    }
+    return n;
+}
+
+// Called from the classify wrappers after a successful invoke; a single
+// relaxed load when the ring is closed.
+__attribute__((visibility("default"))) void ei_ffi_internal_stats_ring_note(const ei_impulse_result_t* result) {
+    if (!s_ring_active.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ei_ffi_stats_record_t rec;
+    rec.timestamp_ns = wall_clock_ns();
+    rec.dsp_ms = result->timing.dsp;
+    rec.classification_ms = result->timing.classification;
+    rec.anomaly_ms = result->timing.anomaly;
+    rec.queue_depth = s_queue_depth.load(std::memory_order_relaxed);
+    ei_ffi_arena_stats_t arena;
+    rec.arena_high_water_kb =
+        ei_ffi_get_arena_stats(&arena) == EI_IMPULSE_OK
+            ? (uint32_t)(arena.high_water_bytes / 1024)
+            : 0;
+    rec.reserved = 0;
+
+    uint64_t counter = s_header->write_counter.load(std::memory_order_relaxed);
+    store_record(&s_records[counter % s_header->capacity], &rec);
+    // Commit: the counter moves only after the body is globally visible.
+    s_header->write_counter.store(counter + 1, std::memory_order_release);
+}
+
+} // extern "C"
+
+#else // !(__linux__ || __APPLE__)
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_stats_ring_open(const char*, uint32_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_stats_ring_close(void) {}
+
+__attribute__((visibility("default"))) void ei_ffi_stats_ring_set_queue_depth(uint32_t) {}
+
+__attribute__((visibility("default"))) uint32_t ei_ffi_stats_ring_read(ei_ffi_stats_record_t*, uint32_t) {
+    return 0;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_internal_stats_ring_note(const ei_impulse_result_t*) {}
+
+} // extern "C"
+
+#endif // __linux__ || __APPLE__
@@ -0,0 +1,256 @@
+// Concurrency stress/soak harness for the exported FFI surface.
+//
+// Not part of the shipped library: built only with EI_FFI_STRESS_TEST=1
+// (add EI_FFI_TSAN=1 to instrument the whole static library with
+// -fsanitize=thread). The harness hammers the surface the way misbehaving
+// integrations do -- concurrent invokes, live threshold mutation, instance
+// churn, lifecycle cycling -- and is meant to run until TSAN or the soak
+// duration says otherwise.
+//
+// Two modes, matching the contract documented in edge_impulse_wrapper.h:
+//
+//   ei_ffi_stress [seconds]            validate the library under its
+//                                      documented contract: lifecycle
+//                                      transitions are serialized against
+//                                      invokes (shared/exclusive lock),
+//                                      everything else runs concurrently.
+//   ei_ffi_stress [seconds] --torture  drop that serialization and call
+//                                      deinit while invokes are in flight
+//                                      -- the documented-undefined pattern
+//                                      that has produced use-after-frees.
+//                                      Expected to trip TSAN; exists so a
+//                                      report can be reproduced on demand,
+//                                      not as a pass/fail gate.
+//
+// A third, single-threaded mode exercises ei_ffi_teardown():
+//
+//   ei_ffi_stress [cycles] --churn     init -> invoke -> full teardown in
+//                                      a loop; the resident set must hold
+//                                      flat after a warm-up, or teardown
+//                                      missed an allocation. Build with
+//                                      EI_ASAN=1 for the leak report.
+#include "edge_impulse_wrapper.h"
+#include "edge-impulse-sdk/classifier/ei_run_classifier.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> s_stop{false};
+std::shared_mutex s_lifecycle; // shared: invoke; exclusive: init/deinit
+bool s_torture = false;
+
+std::atomic<uint64_t> s_invokes_ok{0};
+std::atomic<uint64_t> s_invokes_err{0};
+std::atomic<uint64_t> s_lifecycle_cycles{0};
+std::atomic<uint64_t> s_threshold_updates{0};
+std::atomic<uint64_t> s_instance_cycles{0};
+
+// Small per-thread xorshift; the features only need to be non-constant.
+uint32_t next_rand(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void fill_features(std::vector<float>& features, uint32_t& rng) {
+    for (size_t ix = 0; ix < features.size(); ix++) {
+        features[ix] = (float)(next_rand(rng) & 0xffff) / 65536.0f;
+    }
+}
+
+void invoke_thread(uint32_t seed) {
+    std::vector<float> features(EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+    uint32_t rng = seed;
+    while (!s_stop.load(std::memory_order_relaxed)) {
+        fill_features(features, rng);
+        signal_t signal;
+        if (ei_ffi_signal_from_buffer(features.data(), features.size(), &signal) != EI_IMPULSE_OK) {
+            s_invokes_err.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        ei_impulse_result_t result = {};
+        EI_IMPULSE_ERROR res;
+        if (s_torture) {
+            res = ei_ffi_run_classifier(&signal, &result, 0);
+        }
+        else {
+            std::shared_lock<std::shared_mutex> lock(s_lifecycle);
+            res = ei_ffi_run_classifier(&signal, &result, 0);
+        }
+        (res == EI_IMPULSE_OK ? s_invokes_ok : s_invokes_err)
+            .fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void lifecycle_thread() {
+    while (!s_stop.load(std::memory_order_relaxed)) {
+        if (s_torture) {
+            ei_ffi_run_classifier_deinit();
+            ei_ffi_run_classifier_init();
+        }
+        else {
+            std::unique_lock<std::shared_mutex> lock(s_lifecycle);
+            ei_ffi_run_classifier_deinit();
+            ei_ffi_run_classifier_init();
+        }
+        s_lifecycle_cycles.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+// Threshold setters mutate live postprocessing configs; per contract they
+// are safe concurrent with invokes, so they take no lock in either mode.
+void threshold_thread(uint32_t seed) {
+    uint32_t rng = seed;
+    while (!s_stop.load(std::memory_order_relaxed)) {
+        ei_threshold_update_t update = {};
+        update.block_id = next_rand(rng) % 4;
+        update.kind = next_rand(rng) % 3;
+        update.value = (float)(next_rand(rng) & 0xff) / 256.0f;
+        update.keep_grace = next_rand(rng) % 8;
+        update.max_observations = (uint16_t)(next_rand(rng) % 16);
+        ei_ffi_set_thresholds(&update, 1);
+        ei_ffi_set_topk(next_rand(rng) % 8);
+        s_threshold_updates.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+// Instance churn: per-handle state must never alias the default impulse's.
+void instance_thread(uint32_t seed) {
+    std::vector<float> features(EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+    uint32_t rng = seed;
+    while (!s_stop.load(std::memory_order_relaxed)) {
+        ei_impulse_handle_t* handle = ei_ffi_create_instance();
+        if (handle == nullptr) {
+            s_invokes_err.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        for (int ix = 0; ix < 4 && !s_stop.load(std::memory_order_relaxed); ix++) {
+            fill_features(features, rng);
+            signal_t signal;
+            ei_ffi_signal_from_buffer(features.data(), features.size(), &signal);
+            ei_impulse_result_t result = {};
+            EI_IMPULSE_ERROR res = ei_ffi_run_classifier_on(handle, &signal, &result, 0);
+            (res == EI_IMPULSE_OK ? s_invokes_ok : s_invokes_err)
+                .fetch_add(1, std::memory_order_relaxed);
+        }
+        ei_ffi_destroy_instance(handle);
+        s_instance_cycles.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Teardown/reload churn: the multi-tenant dlclose() pattern, minus the
+// dlclose. Each cycle runs init, a handful of invokes (enough to touch
+// the DSP arena, caches and the interpreter), then ei_ffi_teardown().
+// The first cycles warm allocator pools and lazy glue state, so the RSS
+// baseline is taken after them; monotonic growth past it afterwards
+// means teardown left something allocated.
+int run_churn(int cycles) {
+    const int warmup = cycles / 4 > 5 ? 5 : cycles / 4;
+    std::vector<float> features(EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+    uint32_t rng = 0x9e3779b9u;
+    long baseline_kb = 0;
+
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        ei_ffi_run_classifier_init();
+        ei_ffi_set_dsp_arena(64 * 1024);
+        for (int ix = 0; ix < 8; ix++) {
+            fill_features(features, rng);
+            signal_t signal;
+            ei_ffi_signal_from_buffer(features.data(), features.size(), &signal);
+            ei_impulse_result_t result = {};
+            EI_IMPULSE_ERROR res = ei_ffi_run_classifier(&signal, &result, 0);
+            (res == EI_IMPULSE_OK ? s_invokes_ok : s_invokes_err)
+                .fetch_add(1, std::memory_order_relaxed);
+        }
+        ei_ffi_teardown();
+
+        ei_ffi_mem_stats_t stats = {};
+        ei_ffi_get_memory_stats(&stats);
+        if (cycle + 1 == warmup) {
+            baseline_kb = stats.current_rss_kb;
+        }
+        if ((cycle + 1) % 16 == 0 || cycle + 1 == cycles) {
+            printf("churn: cycle %d/%d, rss %ld kB\n", cycle + 1, cycles,
+                   stats.current_rss_kb);
+        }
+    }
+
+    ei_ffi_mem_stats_t stats = {};
+    ei_ffi_get_memory_stats(&stats);
+    // Allocators retain some freed memory; a few percent over hundreds of
+    // cycles is noise, anything more is a teardown gap.
+    long slack_kb = baseline_kb / 20 > 2048 ? baseline_kb / 20 : 2048;
+    printf("churn: invokes ok/err %llu/%llu, baseline %ld kB, final %ld kB (slack %ld kB)\n",
+           (unsigned long long)s_invokes_ok.load(), (unsigned long long)s_invokes_err.load(),
+           baseline_kb, stats.current_rss_kb, slack_kb);
+    if (cycles > warmup && stats.current_rss_kb > baseline_kb + slack_kb) {
+        fprintf(stderr, "churn: resident set grew past the post-warmup baseline -- leak\n");
+        return 1;
+    }
+    return s_invokes_err.load() != 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int seconds = 30;
+    bool churn = false;
+    for (int ix = 1; ix < argc; ix++) {
+        if (strcmp(argv[ix], "--torture") == 0) {
+            s_torture = true;
+        }
+        else if (strcmp(argv[ix], "--churn") == 0) {
+            churn = true;
+        }
+        else {
+            seconds = atoi(argv[ix]);
+        }
+    }
+    if (seconds <= 0) {
+        fprintf(stderr, "usage: %s [seconds|cycles] [--torture|--churn]\n", argv[0]);
+        return 2;
+    }
+    if (churn) {
+        printf("stress: %d teardown/reload cycles, churn mode\n", seconds);
+        return run_churn(seconds);
+    }
+
+    printf("stress: %d s, %s mode\n", seconds, s_torture ? "torture (contract-violating)" : "contract");
+    ei_ffi_run_classifier_init();
+
+    unsigned hw = std::thread::hardware_concurrency();
+    unsigned n_invokers = hw > 4 ? 4 : (hw > 1 ? hw - 1 : 1);
+    std::vector<std::thread> threads;
+    for (unsigned ix = 0; ix < n_invokers; ix++) {
+        threads.emplace_back(invoke_thread, 0x9e3779b9u + ix);
+    }
+    threads.emplace_back(lifecycle_thread);
+    threads.emplace_back(threshold_thread, 0x85ebca6bu);
+    threads.emplace_back(instance_thread, 0xc2b2ae35u);
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    s_stop.store(true, std::memory_order_relaxed);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    ei_ffi_run_classifier_deinit();
+
+    printf("invokes ok/err: %llu/%llu, lifecycle cycles: %llu, threshold updates: %llu, instance cycles: %llu\n",
+           (unsigned long long)s_invokes_ok.load(), (unsigned long long)s_invokes_err.load(),
+           (unsigned long long)s_lifecycle_cycles.load(),
+           (unsigned long long)s_threshold_updates.load(),
+           (unsigned long long)s_instance_cycles.load());
+    // In contract mode any error is a finding; TSAN findings abort earlier.
+    return !s_torture && s_invokes_err.load() != 0 ? 1 : 0;
+}
@@ -0,0 +1,1543 @@
+// Per-op profiling support for full TensorFlow Lite builds.
+//
+// build.rs patches tflite_full.h to call ei_ffi_internal_attach_profiler()
+// when an interpreter is constructed; we hang a BufferedProfiler off it and
+// summarize with tflite::profiling::ProfileSummarizer on demand. On micro
+// builds the API is stubbed out and reports EI_IMPULSE_INFERENCE_ERROR.
+#include "edge_impulse_wrapper.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cerrno>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Peak-memory tracing
+//
+// The vendored memory_usage_monitor.cc pulls in absl, which we do not link,
+// so the sampler here does the same job with a plain thread: read resident
+// set every 25 ms and keep the high-water mark. Shared by the full-TFLite
+// and micro builds; arena numbers come from the interpreter below.
+// ---------------------------------------------------------------------------
+
+long read_current_rss_kb() {
+#if defined(__linux__)
+    long rss_pages = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm != nullptr) {
+        long vm_pages = 0;
+        if (fscanf(statm, "%ld %ld", &vm_pages, &rss_pages) != 2) {
+            rss_pages = 0;
+        }
+        fclose(statm);
+    }
+    return rss_pages * (sysconf(_SC_PAGESIZE) / 1024);
+#elif defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (long)(usage.ru_maxrss / 1024); // ru_maxrss is bytes on macOS
+#else
+    return 0;
+#endif
+}
+
+struct rss_tracer {
+    std::thread sampler;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool running = false;
+    std::atomic<long> peak_kb{0};
+};
+
+static rss_tracer s_rss;
+
+// ---------------------------------------------------------------------------
+// Telemetry event ring
+//
+// Producers are interpreter threads inside Invoke (and anyone calling
+// ei_ffi_telemetry_note); the consumer is the collector thread calling
+// ei_ffi_telemetry_drain. A bounded ring with per-cell sequence numbers
+// keeps the producer side to one CAS and a small copy -- no locks, no
+// allocation -- and drops events rather than ever blocking an invoke.
+// ---------------------------------------------------------------------------
+
+constexpr size_t kTelemetryRingSize = 1024; // power of two
+
+struct telemetry_cell {
+    std::atomic<uint64_t> seq;
+    ei_telemetry_event_t event;
+};
+
+struct telemetry_ring {
+    telemetry_cell cells[kTelemetryRingSize];
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+
+    telemetry_ring() {
+        for (size_t ix = 0; ix < kTelemetryRingSize; ix++) {
+            cells[ix].seq.store(ix, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const ei_telemetry_event_t& event) {
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            telemetry_cell& cell = cells[pos & (kTelemetryRingSize - 1)];
+            uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            int64_t dif = (int64_t)(seq - pos);
+            if (dif == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.event = event;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                // Full: the collector is behind. Drop, never block the invoke.
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(ei_telemetry_event_t& event) {
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            telemetry_cell& cell = cells[pos & (kTelemetryRingSize - 1)];
+            uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            int64_t dif = (int64_t)(seq - (pos + 1));
+            if (dif == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    event = cell.event;
+                    cell.seq.store(pos + kTelemetryRingSize, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false; // empty
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+static telemetry_ring s_telemetry;
+static std::atomic<ei_telemetry_cb_t> s_telemetry_cb{nullptr};
+static std::atomic<void*> s_telemetry_user{nullptr};
+static std::atomic<uint32_t> s_telemetry_handle{1};
+
+uint64_t telemetry_now_us() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void telemetry_push(uint8_t kind, const char* tag, uint32_t handle, int64_t op_idx, int64_t subgraph_idx, uint64_t metric) {
+    if (s_telemetry_cb.load(std::memory_order_relaxed) == nullptr) {
+        return; // no collector, zero cost beyond this load
+    }
+    ei_telemetry_event_t event;
+    event.kind = kind;
+    event.handle = handle;
+    event.op_idx = op_idx;
+    event.subgraph_idx = subgraph_idx;
+    event.timestamp_us = telemetry_now_us();
+    event.metric = metric;
+    if (tag != nullptr) {
+        strncpy(event.tag, tag, EI_TELEMETRY_TAG_LEN - 1);
+        event.tag[EI_TELEMETRY_TAG_LEN - 1] = '\0';
+    } else {
+        event.tag[0] = '\0';
+    }
+    s_telemetry.push(event);
+}
+
+} // namespace
+
+extern "C" {
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_start_memory_trace(void) {
+    std::lock_guard<std::mutex> lock(s_rss.mutex);
+    if (s_rss.running) {
+        return EI_IMPULSE_OK;
+    }
+    s_rss.peak_kb.store(read_current_rss_kb());
+    s_rss.running = true;
+    s_rss.sampler = std::thread([] {
+        std::unique_lock<std::mutex> lock(s_rss.mutex);
+        while (s_rss.running) {
+            long now = read_current_rss_kb();
+            if (now > s_rss.peak_kb.load()) {
+                s_rss.peak_kb.store(now);
+            }
+            s_rss.cv.wait_for(lock, std::chrono::milliseconds(25));
+        }
+    });
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_stop_memory_trace(void) {
+    {
+        std::lock_guard<std::mutex> lock(s_rss.mutex);
+        if (!s_rss.running) {
+            return;
+        }
+        s_rss.running = false;
+    }
+    s_rss.cv.notify_all();
+    if (s_rss.sampler.joinable()) {
+        s_rss.sampler.join();
+    }
+}
+
+// Register the collector callback (NULL unregisters and stops event
+// capture). Events are only captured while a callback is registered.
+__attribute__((visibility("default"))) void ei_ffi_register_telemetry(ei_telemetry_cb_t cb, void* user_data) {
+    s_telemetry_user.store(user_data);
+    s_telemetry_cb.store(cb);
+}
+
+// Pump buffered events through the callback on the caller's thread.
+// `max_events` of 0 drains everything currently buffered. Returns the
+// number of events delivered.
+__attribute__((visibility("default"))) size_t ei_ffi_telemetry_drain(size_t max_events) {
+    ei_telemetry_cb_t cb = s_telemetry_cb.load();
+    if (cb == nullptr) {
+        return 0;
+    }
+    void* user_data = s_telemetry_user.load();
+    size_t delivered = 0;
+    ei_telemetry_event_t event;
+    while ((max_events == 0 || delivered < max_events) && s_telemetry.pop(event)) {
+        cb(&event, user_data);
+        delivered++;
+    }
+    return delivered;
+}
+
+__attribute__((visibility("default"))) uint64_t ei_ffi_telemetry_dropped(void) {
+    return s_telemetry.dropped.load();
+}
+
+// Inject a non-interpreter timing (DSP block, postprocessing stage) into
+// the same event stream, on the same clock as the interpreter events.
+__attribute__((visibility("default"))) void ei_ffi_telemetry_note(const char* tag, uint64_t elapsed_us) {
+    telemetry_push(EI_TELEMETRY_NOTE, tag, 0, -1, -1, elapsed_us);
+}
+
+} // extern "C"
+
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE)
+
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/profile_summarizer.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 4096 events is enough for several invokes of any model we generate.
+constexpr int kMaxProfileEvents = 4096;
+
+static std::unique_ptr<tflite::profiling::BufferedProfiler> s_profiler;
+static tflite::Interpreter* s_interpreter = nullptr;
+static bool s_profiling_requested = false;
+
+// Cancellation callback registered by the scheduler; kept here so it can be
+// re-applied whenever a new interpreter is constructed.
+static bool (*s_cancel_check)(void*) = nullptr;
+static void* s_cancel_data = nullptr;
+
+// Invoke timeout: the run wrappers arm a steady-clock deadline just before
+// the classifier runs; the cancellation predicate (checked between subgraph
+// nodes) trips once the deadline passes, so a pathological invoke is
+// abandoned at node granularity and the interpreter stays reusable.
+static std::atomic<int64_t> s_invoke_timeout_ns{0};
+static std::atomic<int64_t> s_invoke_deadline_ns{0};
+
+static int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Single predicate slot on the interpreter, shared between the timeout and
+// whatever the scheduler registered: timeout first (cheap relaxed load),
+// then the client check.
+static bool combined_cancel_check(void*) {
+    int64_t deadline = s_invoke_deadline_ns.load(std::memory_order_relaxed);
+    if (deadline != 0 && steady_now_ns() >= deadline) {
+        return true;
+    }
+    return s_cancel_check != nullptr && s_cancel_check(s_cancel_data);
+}
+
+// Bridges the interpreter's profiler instrumentation points into the
+// telemetry ring. Added alongside the BufferedProfiler via AddProfiler, so
+// per-op summaries and the telemetry stream coexist.
+class telemetry_bridge : public tflite::Profiler {
+public:
+    uint32_t BeginEvent(const char* tag, EventType event_type, int64_t event_metadata1, int64_t event_metadata2) override {
+        if (event_type == EventType::OPERATOR_INVOKE_EVENT ||
+            event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT ||
+            event_type == EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT) {
+            uint32_t handle = s_telemetry_handle.fetch_add(1, std::memory_order_relaxed);
+            telemetry_push(EI_TELEMETRY_OP_BEGIN, tag, handle, event_metadata1, event_metadata2, 0);
+            return handle;
+        }
+        uint32_t handle = s_telemetry_handle.fetch_add(1, std::memory_order_relaxed);
+        telemetry_push(EI_TELEMETRY_RUNTIME, tag, handle, event_metadata1, event_metadata2, 0);
+        return handle;
+    }
+
+    void EndEvent(uint32_t event_handle) override {
+        telemetry_push(EI_TELEMETRY_OP_END, nullptr, event_handle, -1, -1, 0);
+    }
+
+    void AddEvent(const char* tag, EventType event_type, uint64_t metric, int64_t event_metadata1, int64_t event_metadata2) override {
+        // `metric` is elapsed usec for op events and a status code for
+        // runtime/delegate instrumentation and telemetry events.
+        uint8_t kind = (event_type == EventType::OPERATOR_INVOKE_EVENT ||
+                        event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT ||
+                        event_type == EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT)
+            ? EI_TELEMETRY_OP_EVENT
+            : EI_TELEMETRY_RUNTIME;
+        telemetry_push(kind, tag, 0, event_metadata1, event_metadata2, metric);
+    }
+};
+
+static telemetry_bridge s_telemetry_bridge;
+
+// ---------------------------------------------------------------------------
+// Tensor watchpoints
+//
+// Samples intermediate activations in production without a debug rebuild.
+// Follows the vendored SubgraphTensorProfiler's scheme -- hook the "Invoke"
+// event Subgraph::InvokeImpl emits and walk the subgraph's tensors when it
+// ends -- but computes min/max/mean in place instead of handing out tensor
+// pointers, and only on 1-in-sample_rate invokes. With no watches armed the
+// cost is one relaxed atomic load per invoke.
+// ---------------------------------------------------------------------------
+
+struct tensor_watch {
+    std::string name;
+    uint32_t sample_rate;
+    ei_ffi_tensor_watch_cb callback;
+    void* user_data;
+    uint64_t invokes = 0;
+};
+
+static std::mutex s_watch_mutex;
+static std::vector<tensor_watch> s_watches;
+static std::atomic<bool> s_watch_active{false};
+
+// Quantized-domain thresholds, keyed by output tensor index; values are
+// raw int8-domain cut-offs (widened to int32 so a threshold past the
+// tensor's range stays an always/never compare instead of saturating).
+static std::mutex s_q_threshold_mutex;
+static std::vector<std::pair<int, int32_t>> s_q_thresholds;
+
+// Reduce a tensor to min/max/mean natively. Returns false for element types
+// we do not summarize.
+bool watch_summarize(const TfLiteTensor* tensor, ei_ffi_tensor_stats_t* stats) {
+    double sum = 0.0;
+    float mn = 0.0f, mx = 0.0f;
+    size_t n = 0;
+    if (tensor->type == kTfLiteFloat32) {
+        n = tensor->bytes / sizeof(float);
+        if (n == 0 || tensor->data.f == nullptr) {
+            return false;
+        }
+        mn = mx = tensor->data.f[0];
+        for (size_t ix = 0; ix < n; ix++) {
+            float v = tensor->data.f[ix];
+            mn = v < mn ? v : mn;
+            mx = v > mx ? v : mx;
+            sum += v;
+        }
+    } else if (tensor->type == kTfLiteInt8 || tensor->type == kTfLiteUInt8) {
+        n = tensor->bytes;
+        if (n == 0 || tensor->data.raw == nullptr) {
+            return false;
+        }
+        float scale = tensor->params.scale != 0.0f ? tensor->params.scale : 1.0f;
+        int32_t zero_point = tensor->params.zero_point;
+        for (size_t ix = 0; ix < n; ix++) {
+            int32_t raw = tensor->type == kTfLiteInt8
+                ? (int32_t)tensor->data.int8[ix]
+                : (int32_t)tensor->data.uint8[ix];
+            float v = scale * (float)(raw - zero_point);
+            if (ix == 0) {
+                mn = mx = v;
+            }
+            mn = v < mn ? v : mn;
+            mx = v > mx ? v : mx;
+            sum += v;
+        }
+    } else {
+        return false;
+    }
+    stats->elements = (uint32_t)n;
+    stats->min = mn;
+    stats->max = mx;
+    stats->mean = (float)(sum / (double)n);
+    return true;
+}
+
+class tensor_watch_profiler : public tflite::Profiler {
+public:
+    uint32_t BeginEvent(const char* tag, EventType, int64_t, int64_t event_metadata2) override {
+        // Only the "Invoke" event from Subgraph::InvokeImpl; metadata2 is
+        // the subgraph index. Handle 0 means "not ours".
+        if (!s_watch_active.load(std::memory_order_relaxed) || strcmp(tag, "Invoke") != 0) {
+            return 0;
+        }
+        return (uint32_t)event_metadata2 + 1;
+    }
+
+    void EndEvent(uint32_t event_handle) override {
+        if (event_handle == 0 || s_interpreter == nullptr) {
+            return;
+        }
+        int subgraph_index = (int)event_handle - 1;
+        const tflite::Subgraph* subgraph = s_interpreter->subgraph(subgraph_index);
+        if (subgraph == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(s_watch_mutex);
+        for (tensor_watch& watch : s_watches) {
+            if (++watch.invokes % watch.sample_rate != 0) {
+                continue;
+            }
+            for (int ix = 0; ix < (int)subgraph->tensors_size(); ix++) {
+                const TfLiteTensor* tensor = subgraph->tensor(ix);
+                if (tensor == nullptr || tensor->name == nullptr ||
+                    strcmp(tensor->name, watch.name.c_str()) != 0) {
+                    continue;
+                }
+                ei_ffi_tensor_stats_t stats = {};
+                strncpy(stats.name, tensor->name, sizeof(stats.name) - 1);
+                stats.tensor_index = ix;
+                stats.subgraph_index = subgraph_index;
+                if (watch_summarize(tensor, &stats)) {
+                    watch.callback(&stats, watch.user_data);
+                }
+                break;
+            }
+        }
+    }
+};
+
+static tensor_watch_profiler s_watch_profiler;
+
+// ---------------------------------------------------------------------------
+// Quantization calibration ranges
+//
+// Re-quantizing a model needs per-tensor activation ranges from data that
+// looks like production -- which is exactly what the capture log holds.
+// While armed, every subgraph invoke folds the min/max of every float32
+// activation tensor into a running table (same "Invoke"-event scheme as
+// the tensor watchpoints above; weights are skipped by allocation type).
+// ei_ffi_calibration_table then emits the scale/zero-point table the
+// converter consumes. Disarmed cost is one relaxed load per invoke; the
+// ei_ffi_calibrate harness drives the whole loop from a capture log.
+// ---------------------------------------------------------------------------
+
+struct calib_entry {
+    int tensor_index;
+    std::string name;
+    float min;
+    float max;
+};
+
+static std::mutex s_calib_mutex;
+static std::vector<calib_entry> s_calib_entries;
+static uint64_t s_calib_frames = 0;
+static std::atomic<bool> s_calib_active{false};
+
+class calibration_profiler : public tflite::Profiler {
+public:
+    uint32_t BeginEvent(const char* tag, EventType, int64_t, int64_t event_metadata2) override {
+        if (!s_calib_active.load(std::memory_order_relaxed) || strcmp(tag, "Invoke") != 0) {
+            return 0;
+        }
+        return (uint32_t)event_metadata2 + 1;
+    }
+
+    void EndEvent(uint32_t event_handle) override {
+        if (event_handle == 0 || s_interpreter == nullptr) {
+            return;
+        }
+        const tflite::Subgraph* subgraph = s_interpreter->subgraph((int)event_handle - 1);
+        if (subgraph == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(s_calib_mutex);
+        s_calib_frames++;
+        for (int ix = 0; ix < (int)subgraph->tensors_size(); ix++) {
+            const TfLiteTensor* tensor = subgraph->tensor(ix);
+            if (tensor == nullptr || tensor->type != kTfLiteFloat32 ||
+                tensor->data.f == nullptr || tensor->bytes == 0 ||
+                tensor->allocation_type == kTfLiteMmapRo) {
+                continue; // not a float activation (weights are mmap-ro)
+            }
+            float mn = tensor->data.f[0];
+            float mx = mn;
+            size_t n = tensor->bytes / sizeof(float);
+            for (size_t e = 1; e < n; e++) {
+                float v = tensor->data.f[e];
+                mn = v < mn ? v : mn;
+                mx = v > mx ? v : mx;
+            }
+            calib_entry* entry = nullptr;
+            for (calib_entry& known : s_calib_entries) {
+                if (known.tensor_index == ix) {
+                    entry = &known;
+                    break;
+                }
+            }
+            if (entry == nullptr) {
+                s_calib_entries.push_back(calib_entry{
+                    ix, tensor->name != nullptr ? tensor->name : "", mn, mx });
+            }
+            else {
+                entry->min = mn < entry->min ? mn : entry->min;
+                entry->max = mx > entry->max ? mx : entry->max;
+            }
+        }
+    }
+};
+
+static calibration_profiler s_calib_profiler;
+
+} // namespace
+
+// Defined with the named-output section below: drop the cached name map
+// when a new interpreter attaches (re-init or hot swap).
+extern "C" void ei_ffi_internal_invalidate_output_names();
+
+extern "C" {
+
+// Called from the patched tflite_full.h each time an interpreter is built.
+// With multiple instances the most recently constructed interpreter is the
+// one profiled, which is what you want when profiling a dedicated process.
+__attribute__((visibility("default"))) void ei_ffi_internal_attach_profiler(void* interpreter) {
+    s_interpreter = static_cast<tflite::Interpreter*>(interpreter);
+    ei_ffi_internal_invalidate_output_names();
+    if (s_profiler == nullptr) {
+        s_profiler.reset(new tflite::profiling::BufferedProfiler(kMaxProfileEvents));
+    }
+    s_interpreter->SetProfiler(s_profiler.get());
+    s_interpreter->AddProfiler(&s_telemetry_bridge);
+    s_interpreter->AddProfiler(&s_watch_profiler);
+    s_interpreter->AddProfiler(&s_calib_profiler);
+    if (s_profiling_requested) {
+        s_profiler->StartProfiling();
+    }
+    s_interpreter->SetCancellationFunction(nullptr, combined_cancel_check);
+}
+
+// Route a cancellation predicate to the registered interpreter. The check
+// runs between subgraph nodes during Invoke, so a cooperating caller (the
+// priority scheduler) can abort a running invoke at node granularity.
+// Registering before any interpreter exists is fine; the predicate is
+// applied on attach.
+__attribute__((visibility("default"))) void ei_ffi_internal_set_cancellation(bool (*check)(void*), void* data) {
+    s_cancel_check = check;
+    s_cancel_data = data;
+}
+
+// Bound worst-case invoke latency: once a classify runs longer than `ms`
+// the in-flight invoke is cancelled between subgraph nodes and the run
+// wrapper reports EI_IMPULSE_CANCELED. 0 disables. Cancellation leaves the
+// interpreter in a consistent state, so the next classify proceeds without
+// any re-init -- no process-level recovery needed.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_invoke_timeout(uint32_t ms) {
+    s_invoke_timeout_ns.store((int64_t)ms * 1000000, std::memory_order_relaxed);
+    if (ms == 0) {
+        s_invoke_deadline_ns.store(0, std::memory_order_relaxed);
+    }
+    return EI_IMPULSE_OK;
+}
+
+// Glue-to-glue hooks for the run wrappers: arm the deadline at classify
+// start, and after a failed run tell whether the timeout is what tripped.
+__attribute__((visibility("default"))) void ei_ffi_internal_arm_invoke_deadline(void) {
+    int64_t timeout = s_invoke_timeout_ns.load(std::memory_order_relaxed);
+    s_invoke_deadline_ns.store(timeout == 0 ? 0 : steady_now_ns() + timeout,
+                               std::memory_order_relaxed);
+}
+
+__attribute__((visibility("default"))) bool ei_ffi_internal_invoke_timed_out(void) {
+    int64_t deadline = s_invoke_deadline_ns.load(std::memory_order_relaxed);
+    return deadline != 0 && steady_now_ns() >= deadline;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_profiling_start(void) {
+    s_profiling_requested = true;
+    if (s_profiler == nullptr) {
+        // No interpreter constructed yet; profiling starts on attach.
+        return EI_IMPULSE_OK;
+    }
+    s_profiler->Reset();
+    s_profiler->StartProfiling();
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_profiling_stop(void) {
+    s_profiling_requested = false;
+    if (s_profiler == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    s_profiler->StopProfiling();
+    return EI_IMPULSE_OK;
+}
+
+// Write the per-op summary (the same table the TFLite benchmark tool
+// prints) into `out`. Returns the number of bytes written excluding the
+// NUL terminator, or -1 when no profile data is available. Truncates when
+// the buffer is too small.
+__attribute__((visibility("default"))) int ei_ffi_profiling_summary(char* out, size_t out_len) {
+    if (out == nullptr || out_len == 0) {
+        return -1;
+    }
+    if (s_profiler == nullptr || s_interpreter == nullptr) {
+        return -1;
+    }
+    tflite::profiling::ProfileSummarizer summarizer;
+    summarizer.ProcessProfiles(s_profiler->GetProfileEvents(), *s_interpreter);
+    std::string summary = summarizer.GetOutputString();
+
+    size_t n = summary.size() < out_len - 1 ? summary.size() : out_len - 1;
+    memcpy(out, summary.data(), n);
+    out[n] = '\0';
+    return (int)n;
+}
+
+// Walk the loaded graph and emit a JSON description: per-node op name,
+// output tensor shapes, constant parameter bytes and an analytic MAC
+// estimate, plus model-level totals. For conv / depthwise / fully-
+// connected shapes the estimate is exact (output elements x per-element
+// filter taps, which reduces to out_elems * weight_elems / out_channels
+// for all three); ops without a constant weights tensor report 0. The
+// provisioning side predicts latency and memory from this alone, before
+// shipping the model to a device class. Written by hand rather than via
+// the vendored JSON library, which is only compiled in for opt-in
+// features; the schema is flat enough that snprintf is the whole story.
+__attribute__((visibility("default"))) int ei_ffi_describe_model(char* json, size_t cap) {
+    if (json == nullptr || cap == 0 || s_interpreter == nullptr) {
+        return -1;
+    }
+    std::string out;
+    out.reserve(4096);
+    char item[256];
+    uint64_t total_param_bytes = 0;
+    uint64_t total_macs = 0;
+
+    out += "{\"nodes\":[";
+    bool first = true;
+    for (int ix = 0; ix < (int)s_interpreter->nodes_size(); ix++) {
+        const auto* entry = s_interpreter->node_and_registration(ix);
+        if (entry == nullptr) {
+            continue;
+        }
+        const TfLiteNode& node = entry->first;
+        const TfLiteRegistration& reg = entry->second;
+
+        uint64_t param_bytes = 0;
+        const TfLiteTensor* weights = nullptr;
+        for (int in = 0; in < node.inputs->size; in++) {
+            const int tensor_ix = node.inputs->data[in];
+            if (tensor_ix < 0) {
+                continue;
+            }
+            const TfLiteTensor* tensor = s_interpreter->tensor(tensor_ix);
+            if (tensor == nullptr || tensor->allocation_type != kTfLiteMmapRo) {
+                continue;
+            }
+            param_bytes += tensor->bytes;
+            if (weights == nullptr && tensor->dims != nullptr && tensor->dims->size >= 2) {
+                weights = tensor;
+            }
+        }
+
+        const TfLiteTensor* output = nullptr;
+        uint64_t out_elems = 0;
+        if (node.outputs->size > 0 && node.outputs->data[0] >= 0) {
+            output = s_interpreter->tensor(node.outputs->data[0]);
+        }
+        if (output != nullptr && output->dims != nullptr) {
+            out_elems = 1;
+            for (int d = 0; d < output->dims->size; d++) {
+                out_elems *= (uint64_t)output->dims->data[d];
+            }
+        }
+
+        uint64_t macs = 0;
+        if (weights != nullptr && output != nullptr && output->dims != nullptr &&
+            output->dims->size > 0) {
+            uint64_t weight_elems = 1;
+            for (int d = 0; d < weights->dims->size; d++) {
+                weight_elems *= (uint64_t)weights->dims->data[d];
+            }
+            const uint64_t out_channels =
+                (uint64_t)output->dims->data[output->dims->size - 1];
+            if (out_channels > 0) {
+                macs = out_elems * weight_elems / out_channels;
+            }
+        }
+        total_param_bytes += param_bytes;
+        total_macs += macs;
+
+        if (!first) {
+            out += ",";
+        }
+        first = false;
+        snprintf(item, sizeof(item),
+                 "{\"index\":%d,\"op\":\"%s\",\"builtin_code\":%d,"
+                 "\"param_bytes\":%llu,\"macs\":%llu,\"output_shape\":[",
+                 ix,
+                 reg.custom_name != nullptr
+                     ? reg.custom_name
+                     : tflite::EnumNameBuiltinOperator(
+                           (tflite::BuiltinOperator)reg.builtin_code),
+                 (int)reg.builtin_code,
+                 (unsigned long long)param_bytes,
+                 (unsigned long long)macs);
+        out += item;
+        if (output != nullptr && output->dims != nullptr) {
+            for (int d = 0; d < output->dims->size; d++) {
+                snprintf(item, sizeof(item), "%s%d", d > 0 ? "," : "",
+                         output->dims->data[d]);
+                out += item;
+            }
+        }
+        out += "]}";
+    }
+
+    snprintf(item, sizeof(item),
+             "],\"node_count\":%d,\"tensor_count\":%d,"
+             "\"total_param_bytes\":%llu,\"total_macs\":%llu}",
+             (int)s_interpreter->nodes_size(),
+             (int)s_interpreter->tensors_size(),
+             (unsigned long long)total_param_bytes,
+             (unsigned long long)total_macs);
+    out += item;
+
+    size_t n = out.size() < cap - 1 ? out.size() : cap - 1;
+    memcpy(json, out.data(), n);
+    json[n] = '\0';
+    return n == out.size() ? (int)n : -1;
+}
+
+// ---------------------------------------------------------------------------
+// Direct output tensor access
+//
+// The registered interpreter (the same one the profiler hangs off) also
+// gives custom postprocessing a window onto raw output tensors, skipping
+// ei_impulse_result_t marshalling entirely. Pointers are valid until the
+// next invoke or re-init; read them before running the next frame.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) int ei_ffi_output_tensor_count(void) {
+    if (s_interpreter == nullptr) {
+        return -1;
+    }
+    return (int)s_interpreter->outputs().size();
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_tensor(int index, const float** data, size_t* len) {
+    if (data == nullptr || len == nullptr || s_interpreter == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (index < 0 || (size_t)index >= s_interpreter->outputs().size()) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    TfLiteTensor* tensor = s_interpreter->tensor(s_interpreter->outputs()[index]);
+    if (tensor == nullptr || tensor->type != kTfLiteFloat32) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    *data = tensor->data.f;
+    *len = tensor->bytes / sizeof(float);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_tensor_quantized(int index, const int8_t** data, size_t* len, float* scale, int32_t* zero_point) {
+    if (data == nullptr || len == nullptr || s_interpreter == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (index < 0 || (size_t)index >= s_interpreter->outputs().size()) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    TfLiteTensor* tensor = s_interpreter->tensor(s_interpreter->outputs()[index]);
+    if (tensor == nullptr || tensor->type != kTfLiteInt8) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    *data = tensor->data.int8;
+    *len = tensor->bytes;
+    if (scale != nullptr) {
+        *scale = tensor->params.scale;
+    }
+    if (zero_point != nullptr) {
+        *zero_point = tensor->params.zero_point;
+    }
+    return EI_IMPULSE_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Named output access
+//
+// Multi-head models (boxes + embedding + quality score and the like) fall
+// outside ei_impulse_result_t, and raw-tensor access by index breaks
+// whenever a re-export reorders the heads. Output tensor names ride in
+// the flatbuffer and survive re-export, so names are the stable key: the
+// map below is built once per interpreter (invalidated on attach, i.e.
+// re-init or hot swap) and lookups after that are a short linear scan at
+// resolve time only -- resolve the index once at init and the per-invoke
+// path through ei_ffi_get_output_tensor stays exactly as cheap as before.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::mutex s_output_name_mutex;
+std::vector<std::string> s_output_names;
+const tflite::Interpreter* s_output_names_for = nullptr;
+
+// Caller holds s_output_name_mutex.
+void ensure_output_names() {
+    if (s_output_names_for == s_interpreter) {
+        return;
+    }
+    s_output_names.clear();
+    for (size_t ix = 0; ix < s_interpreter->outputs().size(); ix++) {
+        const char* name = s_interpreter->GetOutputName((int)ix);
+        s_output_names.push_back(name != nullptr ? name : "");
+    }
+    s_output_names_for = s_interpreter;
+}
+
+} // namespace
+
+void ei_ffi_internal_invalidate_output_names() {
+    std::lock_guard<std::mutex> lock(s_output_name_mutex);
+    s_output_names.clear();
+    s_output_names_for = nullptr;
+}
+
+// Resolve an output tensor name to its output position (the index the
+// ei_ffi_get_output_tensor family takes). Returns -1 when no output has
+// that name or no interpreter is loaded. Resolve once at init and keep
+// the index; it is stable for the interpreter's lifetime.
+__attribute__((visibility("default"))) int ei_ffi_output_index_by_name(const char* name) {
+    if (name == nullptr || s_interpreter == nullptr) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(s_output_name_mutex);
+    ensure_output_names();
+    for (size_t ix = 0; ix < s_output_names.size(); ix++) {
+        if (s_output_names[ix] == name) {
+            return (int)ix;
+        }
+    }
+    return -1;
+}
+
+// Convenience lookups delegating to the indexed accessors; same pointer
+// validity rules (until the next invoke or re-init).
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_by_name(const char* name, const float** data, size_t* len) {
+    const int index = ei_ffi_output_index_by_name(name);
+    if (index < 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    return ei_ffi_get_output_tensor(index, data, len);
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_by_name_quantized(const char* name, const int8_t** data, size_t* len, float* scale, int32_t* zero_point) {
+    const int index = ei_ffi_output_index_by_name(name);
+    if (index < 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    return ei_ffi_get_output_tensor_quantized(index, data, len, scale, zero_point);
+}
+
+// Integer-domain thresholding: the caller's float threshold is translated
+// into the output tensor's quantized domain once at config time, so the
+// per-frame compare runs over raw int8 scores with no dequantize loop at
+// all. Configure after init (the quantization params come off the live
+// tensor); reconfigure after a hot swap, since the swapped graph may
+// carry different scales.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_quantized_threshold(int index, float threshold) {
+    if (s_interpreter == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (index < 0 || (size_t)index >= s_interpreter->outputs().size()) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    TfLiteTensor* tensor = s_interpreter->tensor(s_interpreter->outputs()[index]);
+    if (tensor == nullptr || tensor->type != kTfLiteInt8 || tensor->params.scale == 0.0f) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    int32_t raw = (int32_t)lrintf(threshold / tensor->params.scale) + tensor->params.zero_point;
+
+    std::lock_guard<std::mutex> lock(s_q_threshold_mutex);
+    for (auto& entry : s_q_thresholds) {
+        if (entry.first == index) {
+            entry.second = raw;
+            return EI_IMPULSE_OK;
+        }
+    }
+    s_q_thresholds.emplace_back(index, raw);
+    return EI_IMPULSE_OK;
+}
+
+// Scan output tensor `index` against its configured quantized threshold
+// and write the class indices at or above it. Returns the total number of
+// classes over threshold (callers sizing buffers can pass capacity 0), or
+// -1 when no threshold is configured for that tensor / no interpreter is
+// registered. Pure integer compares; the raw scores are never dequantized.
+__attribute__((visibility("default"))) int ei_ffi_classify_quantized(int index, uint32_t* indices_out, size_t capacity) {
+    if (s_interpreter == nullptr) {
+        return -1;
+    }
+    int32_t raw_threshold;
+    {
+        std::lock_guard<std::mutex> lock(s_q_threshold_mutex);
+        auto found = std::find_if(s_q_thresholds.begin(), s_q_thresholds.end(),
+                                  [index](const std::pair<int, int32_t>& e) { return e.first == index; });
+        if (found == s_q_thresholds.end()) {
+            return -1;
+        }
+        raw_threshold = found->second;
+    }
+    if (index < 0 || (size_t)index >= s_interpreter->outputs().size()) {
+        return -1;
+    }
+    TfLiteTensor* tensor = s_interpreter->tensor(s_interpreter->outputs()[index]);
+    if (tensor == nullptr || tensor->type != kTfLiteInt8) {
+        return -1;
+    }
+
+    const int8_t* scores = tensor->data.int8;
+    size_t n = tensor->bytes;
+    int over = 0;
+    for (size_t ix = 0; ix < n; ix++) {
+        if ((int32_t)scores[ix] >= raw_threshold) {
+            if (indices_out != nullptr && (size_t)over < capacity) {
+                indices_out[over] = (uint32_t)ix;
+            }
+            over++;
+        }
+    }
+    return over;
+}
+
+// Watch a named tensor: every `sample_rate`-th invoke of the subgraph that
+// owns it, min/max/mean are computed in place and handed to `cb` on the
+// invoking thread. Watching an already-watched name updates its settings.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_watch_tensor(const char* name, uint32_t sample_rate, ei_ffi_tensor_watch_cb cb, void* user_data) {
+    if (name == nullptr || name[0] == '\0' || cb == nullptr || sample_rate == 0) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_watch_mutex);
+    for (tensor_watch& watch : s_watches) {
+        if (watch.name == name) {
+            watch.sample_rate = sample_rate;
+            watch.callback = cb;
+            watch.user_data = user_data;
+            return EI_IMPULSE_OK;
+        }
+    }
+    tensor_watch watch;
+    watch.name = name;
+    watch.sample_rate = sample_rate;
+    watch.callback = cb;
+    watch.user_data = user_data;
+    s_watches.push_back(watch);
+    s_watch_active.store(true, std::memory_order_relaxed);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_unwatch_tensor(const char* name) {
+    if (name == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    std::lock_guard<std::mutex> lock(s_watch_mutex);
+    for (size_t ix = 0; ix < s_watches.size(); ix++) {
+        if (s_watches[ix].name == name) {
+            s_watches.erase(s_watches.begin() + ix);
+            if (s_watches.empty()) {
+                s_watch_active.store(false, std::memory_order_relaxed);
+            }
+            return EI_IMPULSE_OK;
+        }
+    }
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+// RSS comes from the sampler above; arena and scratch numbers come from the
+// registered interpreter's per-subgraph allocation info.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_memory_stats(ei_ffi_mem_stats_t* stats) {
+    if (stats == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->current_rss_kb = read_current_rss_kb();
+    long peak = s_rss.peak_kb.load();
+    stats->peak_rss_kb = peak > stats->current_rss_kb ? peak : stats->current_rss_kb;
+    if (s_interpreter != nullptr) {
+        stats->subgraph_count = (uint32_t)s_interpreter->subgraphs_size();
+        for (size_t ix = 0; ix < s_interpreter->subgraphs_size(); ix++) {
+            tflite::Subgraph::SubgraphAllocInfo info = {};
+            s_interpreter->subgraph((int)ix)->GetMemoryAllocInfo(&info);
+            stats->arena_bytes += info.arena_size;
+            stats->arena_persist_bytes += info.arena_persist_size;
+            stats->dynamic_bytes += info.dynamic_size;
+        }
+    }
+    return EI_IMPULSE_OK;
+}
+
+// High-water mark of arena-resident tensor bytes, glue-owned so it spans
+// interpreter hot-swaps -- drift across swaps is exactly what it exists
+// to surface.
+static std::atomic<size_t> s_arena_high_water{0};
+
+// Per-inference arena snapshot: capacity is what the memory planner
+// reserved (arena + persistent blocks), used is the bytes of live
+// arena-resident tensors, and heap fallbacks count tensors the planner
+// pushed out to dynamic (heap) allocation. One tensor walk per call --
+// cheap enough to sample every frame.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_arena_stats(ei_ffi_arena_stats_t* stats) {
+    if (stats == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    memset(stats, 0, sizeof(*stats));
+    if (s_interpreter == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    for (size_t sg = 0; sg < s_interpreter->subgraphs_size(); sg++) {
+        const tflite::Subgraph* subgraph = s_interpreter->subgraph((int)sg);
+        tflite::Subgraph::SubgraphAllocInfo info = {};
+        s_interpreter->subgraph((int)sg)->GetMemoryAllocInfo(&info);
+        stats->capacity_bytes += info.arena_size + info.arena_persist_size;
+        for (int ix = 0; ix < (int)subgraph->tensors_size(); ix++) {
+            const TfLiteTensor* tensor = subgraph->tensor(ix);
+            if (tensor->allocation_type == kTfLiteArenaRw ||
+                tensor->allocation_type == kTfLiteArenaRwPersistent) {
+                stats->used_bytes += tensor->bytes;
+            }
+            else if (tensor->allocation_type == kTfLiteDynamic) {
+                stats->heap_fallback_allocs++;
+            }
+        }
+    }
+    size_t high = s_arena_high_water.load(std::memory_order_relaxed);
+    while (stats->used_bytes > high &&
+           !s_arena_high_water.compare_exchange_weak(high, stats->used_bytes,
+                                                     std::memory_order_relaxed)) {
+    }
+    stats->high_water_bytes = stats->used_bytes > high ? stats->used_bytes : high;
+    return EI_IMPULSE_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Arena pinning / pre-touching
+//
+// After an idle period the kernel reclaims the arena's pages; the next
+// invoke soft-faults them back in, one page at a time, which is the
+// post-idle latency spike. mlock removes the reclaim; the toucher is the
+// unprivileged fallback that keeps the pages recently-referenced instead.
+// Regions are computed per subgraph from the arena-resident tensors'
+// data pointers (the planner packs them into one contiguous arena), and
+// re-collected on every toucher pass so hot swaps are picked up.
+// ---------------------------------------------------------------------------
+
+#if defined(__linux__) || defined(__APPLE__)
+
+struct arena_region {
+    uintptr_t start;
+    size_t length;
+};
+
+static std::mutex s_pin_mutex;
+static std::vector<arena_region> s_pinned;
+
+struct arena_toucher {
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool running = false;
+    uint32_t interval_ms = 1000;
+};
+
+static arena_toucher s_toucher;
+
+// One page-aligned region per subgraph, spanning its arena-resident
+// tensors. Empty until AllocateTensors has run.
+static void collect_arena_regions(std::vector<arena_region>& out) {
+    out.clear();
+    if (s_interpreter == nullptr) {
+        return;
+    }
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (size_t sg = 0; sg < s_interpreter->subgraphs_size(); sg++) {
+        const tflite::Subgraph* subgraph = s_interpreter->subgraph((int)sg);
+        uintptr_t lo = UINTPTR_MAX;
+        uintptr_t hi = 0;
+        for (int ix = 0; ix < (int)subgraph->tensors_size(); ix++) {
+            const TfLiteTensor* tensor = subgraph->tensor(ix);
+            if ((tensor->allocation_type != kTfLiteArenaRw &&
+                 tensor->allocation_type != kTfLiteArenaRwPersistent) ||
+                tensor->data.raw == nullptr || tensor->bytes == 0) {
+                continue;
+            }
+            uintptr_t start = (uintptr_t)tensor->data.raw;
+            lo = start < lo ? start : lo;
+            hi = start + tensor->bytes > hi ? start + tensor->bytes : hi;
+        }
+        if (lo < hi) {
+            arena_region region;
+            region.start = lo & ~(uintptr_t)(page - 1);
+            region.length = ((hi - region.start) + page - 1) & ~(page - 1);
+            out.push_back(region);
+        }
+    }
+}
+
+// Read one byte per page; volatile so the loop survives optimization.
+static void touch_regions(const std::vector<arena_region>& regions) {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (const arena_region& region : regions) {
+        const volatile uint8_t* p = (const volatile uint8_t*)region.start;
+        for (size_t off = 0; off < region.length; off += page) {
+            (void)p[off];
+        }
+    }
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pin_arena(bool use_mlock) {
+    std::vector<arena_region> regions;
+    collect_arena_regions(regions);
+    if (regions.empty()) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    if (!use_mlock) {
+        touch_regions(regions);
+        return EI_IMPULSE_OK;
+    }
+    std::lock_guard<std::mutex> lock(s_pin_mutex);
+    for (const arena_region& region : s_pinned) {
+        munlock((const void*)region.start, region.length);
+    }
+    s_pinned.clear();
+    for (const arena_region& region : regions) {
+        if (mlock((const void*)region.start, region.length) != 0) {
+            ei_printf("WARN: mlock failed (%s); raise RLIMIT_MEMLOCK or use "
+                      "the arena toucher instead\n", strerror(errno));
+            for (const arena_region& locked : s_pinned) {
+                munlock((const void*)locked.start, locked.length);
+            }
+            s_pinned.clear();
+            return EI_IMPULSE_INFERENCE_ERROR;
+        }
+        s_pinned.push_back(region);
+    }
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_unpin_arena(void) {
+    std::lock_guard<std::mutex> lock(s_pin_mutex);
+    for (const arena_region& region : s_pinned) {
+        munlock((const void*)region.start, region.length);
+    }
+    s_pinned.clear();
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_arena_toucher_start(uint32_t interval_ms) {
+    std::lock_guard<std::mutex> lock(s_toucher.mutex);
+    if (s_toucher.running) {
+        s_toucher.interval_ms = interval_ms == 0 ? 1000 : interval_ms;
+        return EI_IMPULSE_OK;
+    }
+    s_toucher.interval_ms = interval_ms == 0 ? 1000 : interval_ms;
+    s_toucher.running = true;
+    s_toucher.worker = std::thread([]() {
+        std::vector<arena_region> regions;
+        std::unique_lock<std::mutex> lock(s_toucher.mutex);
+        while (s_toucher.running) {
+            uint32_t interval = s_toucher.interval_ms;
+            lock.unlock();
+            collect_arena_regions(regions);
+            touch_regions(regions);
+            lock.lock();
+            s_toucher.cv.wait_for(lock, std::chrono::milliseconds(interval),
+                                  []() { return !s_toucher.running; });
+        }
+    });
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_arena_toucher_stop(void) {
+    {
+        std::lock_guard<std::mutex> lock(s_toucher.mutex);
+        if (!s_toucher.running) {
+            return;
+        }
+        s_toucher.running = false;
+    }
+    s_toucher.cv.notify_all();
+    s_toucher.worker.join();
+}
+
+// ---------------------------------------------------------------------------
+// Lazy residency for rarely-run subgraphs
+//
+// A heavyweight auxiliary head that runs 1-in-N frames still holds its
+// full arena slice resident the other N-1. The planner's layout is baked
+// into the prebuilt interpreter, but residency is ours: offload hands the
+// subgraph's scratch-arena pages back to the kernel (MADV_DONTNEED), and
+// the next run of that head re-materializes them by page fault. Scratch
+// (kTfLiteArenaRw) tensors hold nothing between invokes, so dropping
+// their pages is always safe; persistent arena tensors live in a separate
+// allocation and are never included. The span is page-rounded inward so
+// neighbouring heap memory is never dropped.
+// ---------------------------------------------------------------------------
+
+__attribute__((visibility("default"))) int ei_ffi_subgraph_count(void) {
+    if (s_interpreter == nullptr) {
+        return -1;
+    }
+    return (int)s_interpreter->subgraphs_size();
+}
+
+// The subgraph's scratch span: lo/hi over kTfLiteArenaRw tensors only.
+static bool subgraph_scratch_span(int subgraph_index, uintptr_t& lo, uintptr_t& hi) {
+    if (s_interpreter == nullptr || subgraph_index < 0 ||
+        (size_t)subgraph_index >= s_interpreter->subgraphs_size()) {
+        return false;
+    }
+    const tflite::Subgraph* subgraph = s_interpreter->subgraph(subgraph_index);
+    lo = UINTPTR_MAX;
+    hi = 0;
+    for (int ix = 0; ix < (int)subgraph->tensors_size(); ix++) {
+        const TfLiteTensor* tensor = subgraph->tensor(ix);
+        if (tensor->allocation_type != kTfLiteArenaRw ||
+            tensor->data.raw == nullptr || tensor->bytes == 0) {
+            continue;
+        }
+        uintptr_t start = (uintptr_t)tensor->data.raw;
+        lo = start < lo ? start : lo;
+        hi = start + tensor->bytes > hi ? start + tensor->bytes : hi;
+    }
+    return lo < hi;
+}
+
+__attribute__((visibility("default"))) int64_t ei_ffi_subgraph_arena_bytes(int subgraph_index) {
+    uintptr_t lo, hi;
+    if (!subgraph_scratch_span(subgraph_index, lo, hi)) {
+        return -1;
+    }
+    return (int64_t)(hi - lo);
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_offload_subgraph(int subgraph_index) {
+    uintptr_t lo, hi;
+    if (!subgraph_scratch_span(subgraph_index, lo, hi)) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (lo + page - 1) & ~(page - 1); // inward: never touch
+    uintptr_t end = hi & ~(page - 1);                // neighbouring memory
+    if (start >= end) {
+        return EI_IMPULSE_OK; // span smaller than a page; nothing to drop
+    }
+    if (madvise((void*)start, end - start, MADV_DONTNEED) != 0) {
+        ei_printf("WARN: subgraph offload madvise failed (%s)\n", strerror(errno));
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    return EI_IMPULSE_OK;
+}
+
+#else // !(__linux__ || __APPLE__)
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_pin_arena(bool) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_unpin_arena(void) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_arena_toucher_start(uint32_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_arena_toucher_stop(void) {}
+
+// Residency is a kernel concept; no offload without madvise.
+__attribute__((visibility("default"))) int ei_ffi_subgraph_count(void) {
+    return s_interpreter == nullptr ? -1 : (int)s_interpreter->subgraphs_size();
+}
+
+__attribute__((visibility("default"))) int64_t ei_ffi_subgraph_arena_bytes(int) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_offload_subgraph(int) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+#endif // __linux__ || __APPLE__
+
+// Arm range collection (clearing any previous run) / disarm it. Replay
+// the representative frames between the two, then read the table.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_calibration_begin(void) {
+    std::lock_guard<std::mutex> lock(s_calib_mutex);
+    s_calib_entries.clear();
+    s_calib_frames = 0;
+    s_calib_active.store(true, std::memory_order_relaxed);
+    return EI_IMPULSE_OK;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_calibration_end(void) {
+    s_calib_active.store(false, std::memory_order_relaxed);
+}
+
+// Serialize the collected ranges as one JSON document: per float
+// activation tensor its observed [min, max] and the int8 asymmetric
+// scale/zero-point the converter derives from it (range widened to
+// include 0, per the quantization spec). Same contract as
+// ei_ffi_describe_model: bytes written on success, -1 when `cap` is too
+// small -- never a truncated document.
+__attribute__((visibility("default"))) int ei_ffi_calibration_table(char* json, size_t cap) {
+    if (json == nullptr || cap == 0) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(s_calib_mutex);
+
+    std::string out;
+    char item[256];
+    snprintf(item, sizeof(item), "{\"frames\":%llu,\"tensors\":[",
+             (unsigned long long)s_calib_frames);
+    out += item;
+    for (size_t ix = 0; ix < s_calib_entries.size(); ix++) {
+        const calib_entry& entry = s_calib_entries[ix];
+        // The quantized range must represent 0.0 exactly.
+        float lo = entry.min < 0.0f ? entry.min : 0.0f;
+        float hi = entry.max > 0.0f ? entry.max : 0.0f;
+        float scale = (hi - lo) / 255.0f;
+        int32_t zero_point = 0;
+        if (scale > 0.0f) {
+            float zp = -128.0f - lo / scale;
+            zero_point = (int32_t)lroundf(zp < -128.0f ? -128.0f : (zp > 127.0f ? 127.0f : zp));
+        }
+        else {
+            scale = 1.0f; // constant-zero tensor; any scale represents it
+        }
+        snprintf(item, sizeof(item),
+                 "%s{\"index\":%d,\"name\":\"%s\",\"min\":%.9g,\"max\":%.9g,"
+                 "\"scale\":%.9g,\"zero_point\":%d}",
+                 ix == 0 ? "" : ",", entry.tensor_index, entry.name.c_str(),
+                 entry.min, entry.max, scale, zero_point);
+        out += item;
+    }
+    out += "]}";
+
+    size_t n = out.size() < cap - 1 ? out.size() : cap - 1;
+    memcpy(json, out.data(), n);
+    json[n] = '\0';
+    return n == out.size() ? (int)n : -1;
+}
+
+// ---------------------------------------------------------------------------
+// Engine release
+// ---------------------------------------------------------------------------
+
+// Called from ei_ffi_teardown() (edge_impulse_c_api.cpp) after
+// run_classifier_deinit() has destroyed the interpreter. Every pointer
+// this TU cached -- the interpreter itself, the profiler's event buffer,
+// tensor watches, pinned arena regions -- either dangles or keeps the
+// old arena's pages referenced, so drop all of it. A subsequent init
+// re-attaches through ei_ffi_internal_attach_profiler as usual.
+__attribute__((visibility("default"))) void ei_ffi_internal_profiler_release(void) {
+    ei_ffi_arena_toucher_stop();
+    ei_ffi_unpin_arena();
+    s_interpreter = nullptr;
+    s_profiler.reset();
+    s_profiling_requested = false;
+    s_cancel_check = nullptr;
+    s_cancel_data = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(s_watch_mutex);
+        s_watches.clear();
+        s_watches.shrink_to_fit();
+        s_watch_active.store(false, std::memory_order_release);
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_q_threshold_mutex);
+        s_q_thresholds.clear();
+        s_q_thresholds.shrink_to_fit();
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_calib_mutex);
+        s_calib_active.store(false, std::memory_order_release);
+        s_calib_entries.clear();
+        s_calib_entries.shrink_to_fit();
+        s_calib_frames = 0;
+    }
+    ei_ffi_internal_invalidate_output_names();
+}
+
+} // extern "C"
+
+#else // !EI_CLASSIFIER_USE_FULL_TFLITE
+
+extern "C" {
+
+__attribute__((visibility("default"))) void ei_ffi_internal_attach_profiler(void*) {}
+
+// Nothing cached here on micro builds, so nothing to release.
+__attribute__((visibility("default"))) void ei_ffi_internal_profiler_release(void) {}
+
+// Micro interpreters run to completion; invokes cannot be cancelled.
+__attribute__((visibility("default"))) void ei_ffi_internal_set_cancellation(bool (*)(void*), void*) {}
+
+// No cancellation hook means no invoke timeout either.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_invoke_timeout(uint32_t) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_internal_arm_invoke_deadline(void) {}
+
+__attribute__((visibility("default"))) bool ei_ffi_internal_invoke_timed_out(void) {
+    return false;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_profiling_start(void) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_profiling_stop(void) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_profiling_summary(char*, size_t) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_describe_model(char*, size_t) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_output_index_by_name(const char*) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_by_name(const char*, const float**, size_t*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_by_name_quantized(const char*, const int8_t**, size_t*, float*, int32_t*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_output_tensor_count(void) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_tensor(int, const float**, size_t*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_output_tensor_quantized(int, const int8_t**, size_t*, float*, int32_t*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_set_quantized_threshold(int, float) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) int ei_ffi_classify_quantized(int, uint32_t*, size_t) {
+    return -1;
+}
+
+// Micro interpreters expose no per-subgraph tensor walk.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_watch_tensor(const char*, uint32_t, ei_ffi_tensor_watch_cb, void*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+// Micro builds have no per-subgraph arena to offload.
+__attribute__((visibility("default"))) int ei_ffi_subgraph_count(void) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) int64_t ei_ffi_subgraph_arena_bytes(int) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_offload_subgraph(int) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+// No tensor walk also means no calibration ranges.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_calibration_begin(void) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+__attribute__((visibility("default"))) void ei_ffi_calibration_end(void) {}
+
+__attribute__((visibility("default"))) int ei_ffi_calibration_table(char*, size_t) {
+    return -1;
+}
+
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_unwatch_tensor(const char*) {
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+// Micro builds have no interpreter arena introspection.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_arena_stats(ei_ffi_arena_stats_t* stats) {
+    if (stats != nullptr) {
+        memset(stats, 0, sizeof(*stats));
+    }
+    return EI_IMPULSE_INFERENCE_ERROR;
+}
+
+// Micro builds have no interpreter arena introspection; RSS still works.
+__attribute__((visibility("default"))) EI_IMPULSE_ERROR ei_ffi_get_memory_stats(ei_ffi_mem_stats_t* stats) {
+    if (stats == nullptr) {
+        return EI_IMPULSE_INFERENCE_ERROR;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->current_rss_kb = read_current_rss_kb();
+    long peak = s_rss.peak_kb.load();
+    stats->peak_rss_kb = peak > stats->current_rss_kb ? peak : stats->current_rss_kb;
+    return EI_IMPULSE_OK;
+}
+
+} // extern "C"
+
+#endif // EI_CLASSIFIER_USE_FULL_TFLITE
@@ -0,0 +1,118 @@
+// XNNPACK weights-cache: pack conv weights once, reuse everywhere.
+//
+// XNNPACK rewrites every conv filter into its blocked, cache-line-aligned
+// layout when a delegate initializes -- and throws that work away per
+// interpreter. Opt-in (USE_XNNPACK_CACHE=1), this TU creates the delegate
+// explicitly with a process-wide weights cache attached: the first
+// interpreter pays the repack, every later one (pool instances, re-init,
+// hot swap of the same weights) maps the already-packed blocks, and
+// steady-state reads stream from the aligned copies.
+//
+// The delegate headers are not vendored; like the GPU delegate TU this
+// declares the stable C entry points directly. The options struct is
+// consumed through its long-stable prefix (num_threads, flags,
+// weights_cache) inside an oversized zeroed buffer, so fields appended by
+// newer archives read their zero defaults. Persisting the packed form on
+// disk would need the file-backed cache option, whose struct offset moves
+// between the prebuilt archives -- so the cache scope here is the
+// process, not the filesystem.
+#include "edge_impulse_wrapper.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#if defined(EI_CLASSIFIER_USE_FULL_TFLITE) && defined(EI_FFI_XNNPACK_CACHE)
+
+#include "tensorflow/lite/interpreter.h"
+
+struct TfLiteXNNPackDelegateWeightsCache;
+
+extern "C" TfLiteXNNPackDelegateWeightsCache* TfLiteXNNPackDelegateWeightsCacheCreate();
+extern "C" bool TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(TfLiteXNNPackDelegateWeightsCache* cache);
+extern "C" TfLiteDelegate* TfLiteXNNPackDelegateCreate(const void* options);
+
+namespace {
+
+// The stable leading fields of TfLiteXNNPackDelegateOptions; the rest of
+// the buffer stays zero, which is every later field's default.
+struct xnnpack_options_prefix {
+    int32_t num_threads;
+    uint32_t flags;
+    TfLiteXNNPackDelegateWeightsCache* weights_cache;
+};
+
+std::atomic<uint32_t> s_cache_hits{0}; // interpreters served after the first
+
+} // namespace
+
+extern "C" {
+
+// Called from ei_ffi_internal_apply_delegate once per interpreter
+// construction (after GPU-delegate handling -- an interpreter on the GPU
+// path never reaches XNNPACK packing in the first place).
+__attribute__((visibility("default"))) void ei_ffi_internal_xnnpack_cache_apply(void* interpreter) {
+    if (interpreter == nullptr) {
+        return;
+    }
+    static TfLiteXNNPackDelegateWeightsCache* cache =
+        TfLiteXNNPackDelegateWeightsCacheCreate();
+    if (cache == nullptr) {
+        return;
+    }
+
+    unsigned char options[256];
+    memset(options, 0, sizeof(options));
+    xnnpack_options_prefix prefix = {};
+    prefix.num_threads = ei_ffi_get_xnnpack_threads(0);
+    prefix.weights_cache = cache;
+    memcpy(options, &prefix, sizeof(prefix));
+
+    TfLiteDelegate* delegate = TfLiteXNNPackDelegateCreate(options);
+    if (delegate == nullptr) {
+        fprintf(stderr, "WARN: XNNPACK cache delegate creation failed\n");
+        return;
+    }
+    tflite::Interpreter* interp = static_cast<tflite::Interpreter*>(interpreter);
+    if (interp->ModifyGraphWithDelegate(delegate) != kTfLiteOk) {
+        fprintf(stderr, "WARN: XNNPACK cache delegate rejected the graph\n");
+        return;
+    }
+
+    // After the first interpreter the cache holds every packed weight
+    // this model needs; soft finalize lets later delegates look up
+    // without taking the packing path while still accepting new entries
+    // should a hot swap bring different weights.
+    static std::atomic<uint32_t> s_applies{0};
+    if (s_applies.fetch_add(1, std::memory_order_relaxed) == 0) {
+        if (!TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(cache)) {
+            fprintf(stderr, "WARN: XNNPACK weights cache finalize failed\n");
+        }
+    }
+    else {
+        s_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Interpreters that found their weights already packed (0 until the
+// second interpreter construction; the first one fills the cache).
+__attribute__((visibility("default"))) uint32_t ei_ffi_xnnpack_cache_hits(void) {
+    return s_cache_hits.load(std::memory_order_relaxed);
+}
+
+} // extern "C"
+
+#else // !EI_CLASSIFIER_USE_FULL_TFLITE || !EI_FFI_XNNPACK_CACHE
+
+extern "C" {
+
+__attribute__((visibility("default"))) void ei_ffi_internal_xnnpack_cache_apply(void*) {}
+
+// Not compiled in (build with USE_XNNPACK_CACHE=1 on full TFLite).
+__attribute__((visibility("default"))) uint32_t ei_ffi_xnnpack_cache_hits(void) {
+    return 0;
+}
+
+} // extern "C"
+
+#endif // EI_CLASSIFIER_USE_FULL_TFLITE && EI_FFI_XNNPACK_CACHE
@@ -0,0 +1,60 @@
+//! Allocation-free label handling.
+//!
+//! Result structs carry label `const char*` pointers that aim into the
+//! model's static category table. Instead of copying each one into an
+//! owned `String` per class per frame, copy the table once via
+//! [`get_labels`] and resolve per-result pointers to indices with
+//! [`label_index`] (a pointer compare on the C side, no allocation).
+
+use crate::bindings::*;
+use std::ffi::CStr;
+use std::os::raw::c_char;
+use std::sync::OnceLock;
+
+static LABELS: OnceLock<Vec<&'static str>> = OnceLock::new();
+
+/// The model's label table, fetched from the C side once and cached for
+/// the lifetime of the process. The strings live in the model's static
+/// data, so the borrows are genuinely `'static`.
+pub fn get_labels() -> &'static [&'static str] {
+    LABELS
+        .get_or_init(|| {
+            let mut table: *const *const c_char = std::ptr::null();
+            let mut count: usize = 0;
+            let result_code = unsafe { ei_ffi_get_labels(&mut table, &mut count) };
+            if result_code != EI_IMPULSE_ERROR::EI_IMPULSE_OK || table.is_null() {
+                return Vec::new();
+            }
+            (0..count)
+                .map(|ix| {
+                    let ptr = unsafe { *table.add(ix) };
+                    if ptr.is_null() {
+                        ""
+                    } else {
+                        unsafe { CStr::from_ptr(ptr) }.to_str().unwrap_or("")
+                    }
+                })
+                .collect()
+        })
+        .as_slice()
+}
+
+/// Resolve a result's label pointer to its index in the label table
+/// (pointer identity on the C side, no string copy). `None` when the
+/// pointer is null or not a model label.
+pub fn label_index(label: *const c_char) -> Option<usize> {
+    if label.is_null() {
+        return None;
+    }
+    let ix = unsafe { ei_ffi_label_index(label) };
+    if ix < 0 {
+        None
+    } else {
+        Some(ix as usize)
+    }
+}
+
+/// Resolve a result's label pointer straight to the cached `&'static str`.
+pub fn resolve(label: *const c_char) -> Option<&'static str> {
+    label_index(label).and_then(|ix| get_labels().get(ix).copied())
+}
@@ -8,5 +8,12 @@ pub mod bindings;
 pub mod model_metadata;
 pub mod thresholds;
 
+pub mod labels;
+
+// Shared classifier fixture for integration tests; see the module docs
+// for the fork-safety story.
+#[cfg(feature = "test-support")]
+pub mod test_support;
+
 // Re-export the bindings for convenience
 pub use bindings::*;
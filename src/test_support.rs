@@ -0,0 +1,67 @@
+//! Shared classifier fixture for integration tests (`test-support` feature).
+//!
+//! Interpreter construction costs on the order of a second; paying it in
+//! every `#[test]` dominates suite wall time. [`classifier()`] initializes
+//! the classifier exactly once per process and hands every caller the same
+//! guard, so a test binary pays startup once no matter how many tests (or
+//! test threads) run:
+//!
+//! ```no_run
+//! #[test]
+//! fn classifies_silence() {
+//!     let _guard = edge_impulse_ffi_rs::test_support::classifier();
+//!     // ... ei_ffi_run_classifier(...) ...
+//! }
+//! ```
+//!
+//! The guard amortizes within one process. `cargo test` still builds one
+//! process per integration-test file, so a suite split across many files
+//! pays startup per file regardless; merging integration tests into a
+//! single binary (one `tests/*.rs` file declaring the rest as `mod`s) is
+//! what lets the whole suite pay it once. For sharing a warm interpreter
+//! across unrelated processes, run the `ei_infer_daemon` or
+//! `ei_eim_compat` glue binaries and talk to their socket instead.
+//!
+//! # Fork safety
+//!
+//! `ei_ffi_run_classifier_init` state is **not** fork-safe. Beyond the
+//! interpreter and its arenas, the glue owns background threads (RSS
+//! sampler, weight prefetcher, arena toucher, pool workers) that do not
+//! exist in a forked child, while the mutexes and condition variables
+//! they held fork in whatever state they were in -- a child that touches
+//! the classifier can deadlock on a lock whose owner was never copied.
+//! If a test harness forks (e.g. to isolate aborts), either fork before
+//! the first call to [`classifier()`], or treat the child as
+//! uninitialized and call `ei_ffi_run_classifier_init` there itself.
+//! `posix_spawn`/`exec` after fork is always safe: the child never
+//! touches the inherited state.
+
+use crate::bindings::ei_ffi_run_classifier_init;
+use std::sync::OnceLock;
+
+/// Witness that the process-wide classifier has been initialized.
+///
+/// Holding one (or having called [`classifier()`] at all) guarantees
+/// `ei_ffi_run_classifier_init` has completed. There is deliberately no
+/// `Drop` impl calling `ei_ffi_run_classifier_deinit`: tests run
+/// concurrently on the same instance, and the OS reclaims everything at
+/// process exit anyway.
+pub struct ClassifierGuard {
+    _private: (),
+}
+
+static CLASSIFIER: OnceLock<ClassifierGuard> = OnceLock::new();
+
+/// Initialize the classifier on first call and return the shared guard.
+///
+/// Safe to call from any number of tests and threads; `OnceLock` makes
+/// concurrent first calls race-free, and every later call is a cheap
+/// atomic load.
+pub fn classifier() -> &'static ClassifierGuard {
+    CLASSIFIER.get_or_init(|| {
+        unsafe {
+            ei_ffi_run_classifier_init();
+        }
+        ClassifierGuard { _private: () }
+    })
+}